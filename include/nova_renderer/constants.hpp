@@ -10,14 +10,35 @@ namespace nova::renderer {
     constexpr const char* MODEL_MATRIX_BUFFER_NAME = "NovaModelMatrixUBO";
     constexpr const char* PER_FRAME_DATA_NAME = "NovaPerFrameUBO";
 
+    /*!
+     * \brief The uniform buffer with the current dynamic render scale. Shaders which sample screen-relative render targets can bind it to
+     * find the part of the render target that was rendered to
+     */
+    constexpr const char* RENDER_SCALE_DATA_NAME = "NovaRenderScaleUBO";
+
     constexpr uint32_t AMD_PCI_VENDOR_ID = 0x1022;
     constexpr uint32_t INTEL_PCI_VENDOR_ID = 8086;
     constexpr uint32_t NVIDIA_PCI_VENDOR_ID = 0x10DE;
 
+    /*!
+     * \brief The maximum number of frames that may be in flight at once
+     *
+     * `NovaSettings::max_in_flight_frames` can lower this at runtime
+     */
     constexpr uint32_t NUM_IN_FLIGHT_FRAMES = 3;
 
+    /*!
+     * \brief The number of model matrices that each in-flight frame has its own space for in the model matrix buffer
+     */
+    constexpr uint32_t MODEL_MATRICES_PER_FRAME = 0xFFFF / NUM_IN_FLIGHT_FRAMES;
+
     constexpr mem::Bytes PER_FRAME_MEMORY_SIZE = 2_mb;
 
+    /*!
+     * \brief The number of frames that `NovaRenderer::get_frame_statistics_history` returns the statistics of
+     */
+    constexpr uint32_t FRAME_STATISTICS_HISTORY_SIZE = 120;
+
     constexpr const char* RENDERPACK_DIRECTORY = "renderpacks";
     constexpr const char* MATERIALS_DIRECTORY = "materials";
     constexpr const char* SHADERS_DIRECTORY = "shaders";
@@ -84,4 +105,6 @@ namespace nova::renderer {
     constexpr const char* BACKBUFFER_NAME = "NovaBackbuffer";
 
     constexpr const char* POINT_SAMPLER_NAME = "NovaPointSampler";
+
+    constexpr const char* LINEAR_SAMPLER_NAME = "NovaLinearSampler";
 } // namespace nova::renderer
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <rx/core/concurrency/mutex.h>
+#include <rx/core/vector.h>
+
+#include "nova_renderer/memory/allocation_structs.hpp"
+#include "nova_renderer/nova_settings.hpp"
+#include "nova_renderer/rhi/forward_decls.hpp"
+#include "nova_renderer/rhi/rhi_types.hpp"
+
+namespace nova::mem {
+    class TlsfAllocationStrategy;
+} // namespace nova::mem
+
+namespace nova::renderer {
+    /*!
+     * \brief A buffer that the defragmenter copied to a new place in its memory
+     */
+    struct BufferMove {
+        rhi::RhiBuffer* old_buffer = nullptr;
+        rhi::RhiBuffer* new_buffer = nullptr;
+    };
+
+    /*!
+     * \brief Moves buffers around in a memory pool, a few at a time, so that the pool's free memory ends up in large blocks
+     *
+     * Each call to `update` finishes the moves that the last call started, then starts new moves if the pool is fragmented. A move creates
+     * a new buffer in the pool and copies the old buffer into it on the transfer queue. Only moves that put a buffer closer to the start of
+     * the pool are made, so the buffers slide towards the start of the pool and the free memory collects at the end
+     *
+     * Buffers are replaced, not rebound, so the caller must point everything that used a moved buffer at the new buffer, and destroy the
+     * old buffer once the GPU has finished every frame that used it
+     *
+     * Buffers can be added and removed from any thread, but only one thread may call `update`
+     */
+    class DeviceMemoryDefragmenter {
+    public:
+        /*!
+         * \param device The device to copy the buffers with
+         * \param memory The memory pool to defragment. Its allocation strategy must be `strategy`
+         * \param strategy The allocation strategy of the pool
+         * \param allocator The allocator to allocate new buffers and internal data with
+         */
+        DeviceMemoryDefragmenter(rhi::RenderDevice& device,
+                                 DeviceMemoryResource& memory,
+                                 mem::TlsfAllocationStrategy& strategy,
+                                 rx::memory::allocator* allocator);
+
+        DeviceMemoryDefragmenter(const DeviceMemoryDefragmenter& other) = delete;
+        DeviceMemoryDefragmenter& operator=(const DeviceMemoryDefragmenter& other) = delete;
+
+        DeviceMemoryDefragmenter(DeviceMemoryDefragmenter&& old) noexcept = delete;
+        DeviceMemoryDefragmenter& operator=(DeviceMemoryDefragmenter&& old) noexcept = delete;
+
+        /*!
+         * \brief Waits for the moves that are in progress, destroys their new buffers, and destroys the copy fence
+         *
+         * The old buffers are left alone, so the caller can destroy them with everything else
+         */
+        ~DeviceMemoryDefragmenter();
+
+        /*!
+         * \brief Lets the defragmenter move the provided buffer
+         *
+         * \param buffer The buffer. It must be in the pool
+         * \param create_info The info that the buffer was created with. Moved buffers are created with the same info
+         * \param state The state that the buffer is in when the GPU uses it
+         * \param upload_frame The frame that waits for the buffer's contents to be uploaded. The copies aren't synchronized with the
+         * upload, so the buffer isn't moved until the GPU has finished this frame
+         */
+        void add_buffer(rhi::RhiBuffer* buffer,
+                        const rhi::RhiBufferCreateInfo& create_info,
+                        rhi::ResourceState state,
+                        uint64_t upload_frame);
+
+        /*!
+         * \brief Stops the defragmenter from moving the provided buffer, such as because it's about to be destroyed
+         *
+         * If the buffer is being moved, the move is cancelled. The buffer stays in use until the next call to `update`, so it must not be
+         * destroyed before that call
+         */
+        void remove_buffer(rhi::RhiBuffer* buffer);
+
+        /*!
+         * \brief Finishes the moves from the last call, and starts new moves if the pool is fragmented enough
+         *
+         * Waits for the last call's copies, which usually finished long ago
+         *
+         * \param options How much to move
+         * \param last_finished_frame The last frame that the GPU has finished. Only buffers whose uploads that frame waited for are moved
+         *
+         * \return The moves that finished. Each old buffer must be replaced with its new buffer before the GPU uses either of them again
+         */
+        [[nodiscard]] rx::vector<BufferMove> update(const NovaSettings::MeshDefragmentationOptions& options, uint64_t last_finished_frame);
+
+        /*!
+         * \brief Gets how fragmented the pool's free memory is
+         */
+        [[nodiscard]] mem::FragmentationStats get_fragmentation_stats() const;
+
+    private:
+        struct MovableBuffer {
+            rhi::RhiBuffer* buffer = nullptr;
+
+            rhi::RhiBufferCreateInfo create_info;
+
+            rhi::ResourceState state{};
+
+            uint64_t upload_frame = 0;
+        };
+
+        struct PendingMove {
+            BufferMove move;
+
+            /*!
+             * \brief True if the old buffer was removed while it was being copied, so the new buffer isn't wanted anymore
+             */
+            bool is_cancelled = false;
+        };
+
+        rhi::RenderDevice& device;
+
+        DeviceMemoryResource& memory;
+
+        mem::TlsfAllocationStrategy& strategy;
+
+        rx::memory::allocator* allocator;
+
+        /*!
+         * \brief Guards the movable buffers and the pending moves, because meshes are created and destroyed on other threads
+         */
+        rx::concurrency::mutex buffers_mutex;
+
+        rx::vector<MovableBuffer> movable_buffers;
+
+        rx::vector<PendingMove> pending_moves;
+
+        /*!
+         * \brief A single fence, which is signaled when the copies of the pending moves are done
+         */
+        rx::vector<rhi::RhiFence*> copy_fences;
+
+        /*!
+         * \brief Waits for the copies of the pending moves, and destroys the new buffers of the cancelled moves
+         *
+         * \return The moves that weren't cancelled
+         */
+        rx::vector<BufferMove> finish_pending_moves();
+
+        /*!
+         * \brief Starts moving buffers, starting with the buffers that are furthest from the start of the pool
+         */
+        void start_moves(const NovaSettings::MeshDefragmentationOptions& options, uint64_t last_finished_frame);
+    };
+} // namespace nova::renderer
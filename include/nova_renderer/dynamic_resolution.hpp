@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+#include "nova_renderer/nova_settings.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief Picks the render scale that keeps the GPU's frame time near the target frame time
+     *
+     * The controller averages the GPU times of several frames, then changes the render scale by how far that average is from the target.
+     * The GPU's work is mostly proportional to the number of pixels that it renders, which is proportional to the square of the render
+     * scale. Small differences from the target are ignored, so that the render scale doesn't bounce back and forth between two values
+     */
+    class DynamicResolutionController {
+    public:
+        /*!
+         * \brief Tells the controller how long the GPU took to render a frame
+         *
+         * \param gpu_frame_time How long the GPU took to render the frame, in milliseconds
+         * \param options The options for dynamic resolution
+         *
+         * \return True if the render scale changed
+         */
+        bool add_frame_time(double gpu_frame_time, const NovaSettings::DynamicResolutionOptions& options);
+
+        /*!
+         * \brief Gets the render scale for the next frame
+         */
+        [[nodiscard]] float get_render_scale() const;
+
+        /*!
+         * \brief Goes back to rendering at full resolution, and forgets every frame time that the controller was told about
+         */
+        void reset();
+
+    private:
+        float render_scale = 1.0F;
+
+        double frame_time_sum = 0;
+
+        uint32_t num_frame_times = 0;
+
+        /*!
+         * \brief The number of frame times to ignore before averaging frame times again
+         *
+         * Frame times are read a few frames after they're rendered, so the first few frame times after the render scale changes are from
+         * frames that were rendered with the old render scale
+         */
+        uint32_t num_frame_times_to_skip = 0;
+    };
+
+    /*!
+     * \brief Gets the size of the part of a render target that a renderpass renders to at the provided render scale
+     *
+     * The size is rounded up, and is at least one pixel in each dimension
+     */
+    [[nodiscard]] glm::uvec2 get_scaled_size(const glm::uvec2& size, float render_scale);
+} // namespace nova::renderer
@@ -1,13 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 
 #include <rx/core/memory/allocator.h>
+#include <rx/core/optional.h>
 
 #include "nova_renderer/rhi/forward_decls.hpp"
 
 namespace nova::renderer {
     class NovaRenderer;
+    class GpuProfiler;
 
     /*!
      * \brief All the per-frame data that Nova itself cares about
@@ -33,8 +36,39 @@ namespace nova::renderer {
          */
         rhi::RhiFramebuffer* swapchain_framebuffer;
 
-        size_t cur_model_matrix_index = 0;
+        /*!
+         * \brief Index of the next free slot in the model matrix buffer
+         *
+         * Renderpasses are recorded on multiple threads at once, so reserve all the slots you need at once with `reserve_model_matrices`
+         */
+        std::atomic<size_t> cur_model_matrix_index{0};
+
+        /*!
+         * \brief One past the last slot in the model matrix buffer that this frame may use
+         *
+         * The slots after it belong to the next in-flight frame, which the GPU may still be reading
+         */
+        size_t model_matrix_slice_end = 0;
 
         rx::memory::allocator* allocator = nullptr;
+
+        /*!
+         * \brief Writes the timestamps around each renderpass, or nullptr if the GPU isn't being profiled
+         */
+        GpuProfiler* gpu_profiler = nullptr;
+
+        /*!
+         * \brief The fraction of each screen-relative render target that this frame renders to
+         *
+         * Always 1 unless dynamic resolution is enabled. See `NovaSettings::dynamic_resolution`
+         */
+        float render_scale = 1.0F;
+
+        /*!
+         * \brief Reserves consecutive slots in this frame's part of the model matrix buffer
+         *
+         * \return The index of the first reserved slot, or an empty optional if this frame doesn't have that many slots left
+         */
+        [[nodiscard]] rx::optional<size_t> reserve_model_matrices(size_t num_matrices);
     };
 } // namespace nova::renderer
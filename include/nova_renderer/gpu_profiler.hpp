@@ -0,0 +1,148 @@
+#pragma once
+
+#include <rx/core/array.h>
+#include <rx/core/concurrency/mutex.h>
+#include <rx/core/optional.h>
+#include <rx/core/string.h>
+#include <rx/core/vector.h>
+
+#include "nova_renderer/constants.hpp"
+#include "nova_renderer/rhi/forward_decls.hpp"
+
+namespace nova::renderer {
+    struct CompiledRenderpass;
+
+    namespace tracing {
+        struct Track;
+    }
+
+    /*!
+     * \brief How long a renderpass took on the GPU
+     */
+    struct RenderpassGpuTime {
+        rx::string renderpass_name;
+
+        double milliseconds = 0;
+    };
+
+    /*!
+     * \brief Measures how long each renderpass takes on the GPU with timestamp queries
+     *
+     * Each in-flight frame has its own query pool with a pair of timestamps for every compiled renderpass. A frame's timestamps are read
+     * the next time its frame index is used, after the frame's fence has been waited on, so reading them never waits for the GPU
+     *
+     * When the frame was traced, each renderpass's GPU time is also recorded as a trace event on the "GPU" track. The GPU's clock isn't
+     * the CPU's clock, so the events are placed relative to the CPU time at the start of the frame, which puts them roughly where they
+     * happened
+     */
+    class GpuProfiler {
+    public:
+        /*!
+         * \brief Creates a profiler which writes timestamps on the provided device. The device must support timestamps
+         */
+        GpuProfiler(rhi::RenderDevice& device, rx::memory::allocator* allocator);
+
+        GpuProfiler(const GpuProfiler& other) = delete;
+        GpuProfiler& operator=(const GpuProfiler& other) = delete;
+
+        GpuProfiler(GpuProfiler&& old) noexcept = delete;
+        GpuProfiler& operator=(GpuProfiler&& old) noexcept = delete;
+
+        /*!
+         * \brief Destroys the query pools. The GPU must have finished every frame that the profiler measured
+         */
+        ~GpuProfiler();
+
+        /*!
+         * \brief Reads the timestamps of the last frame that had the same frame index, and gets ready to measure the renderpasses of the
+         * new frame
+         *
+         * The caller must have waited for the fence of the last frame that had the same frame index
+         *
+         * \param frame_idx The index of the frame that's starting
+         * \param renderpasses The compiled renderpasses that the frame will execute
+         */
+        void begin_frame(uint32_t frame_idx, const rx::vector<CompiledRenderpass>& renderpasses);
+
+        /*!
+         * \brief Resets the current frame's queries
+         *
+         * Must be recorded outside of a renderpass, in a command list which is submitted before any command list that writes the current
+         * frame's timestamps
+         */
+        void reset_queries(rhi::CommandList& cmds) const;
+
+        /*!
+         * \brief Writes the timestamp for the start of a renderpass
+         *
+         * Safe to call from any thread, as long as each renderpass's timestamps are only written from one thread
+         *
+         * \param cmds The command list to write the timestamp in
+         * \param renderpass_idx The index of the renderpass in the compiled renderpasses
+         */
+        void begin_renderpass(rhi::CommandList& cmds, uint32_t renderpass_idx) const;
+
+        /*!
+         * \brief Writes the timestamp for the end of a renderpass
+         *
+         * \param cmds The command list to write the timestamp in
+         * \param renderpass_idx The index of the renderpass in the compiled renderpasses
+         */
+        void end_renderpass(rhi::CommandList& cmds, uint32_t renderpass_idx) const;
+
+        /*!
+         * \brief Gets how long each renderpass took in the most recent frame whose timestamps have been read, in execution order
+         *
+         * Renderpasses which were skipped in that frame are left out. Safe to call from any thread
+         */
+        [[nodiscard]] rx::vector<RenderpassGpuTime> get_renderpass_times() const;
+
+        /*!
+         * \brief Gets how long the GPU took to render the most recent frame whose timestamps have been read, in milliseconds
+         *
+         * The frame time runs from the earliest renderpass start to the latest renderpass end, so work outside of renderpasses isn't
+         * counted. Empty if no frame has been measured yet. Safe to call from any thread
+         */
+        [[nodiscard]] rx::optional<double> get_frame_time() const;
+
+    private:
+        struct FrameQueries {
+            rhi::RhiQueryPool* pool = nullptr;
+
+            /*!
+             * \brief The names of the renderpasses whose timestamps are in the pool. Renderpass `i` has queries `2i` and `2i + 1`
+             */
+            rx::vector<rx::string> renderpass_names;
+
+            /*!
+             * \brief The CPU time when the frame started, in `rx::time::qpc_ticks` ticks
+             */
+            uint64_t cpu_start_ticks = 0;
+
+            /*!
+             * \brief Whether the frame was traced, so its GPU times should be recorded as trace events
+             */
+            bool is_traced = false;
+        };
+
+        rhi::RenderDevice& device;
+
+        rx::memory::allocator* allocator;
+
+        float timestamp_period;
+
+        tracing::Track& gpu_track;
+
+        rx::array<FrameQueries[NUM_IN_FLIGHT_FRAMES]> frames;
+
+        uint32_t cur_frame_idx = 0;
+
+        mutable rx::concurrency::mutex times_mutex;
+
+        rx::vector<RenderpassGpuTime> renderpass_times;
+
+        rx::optional<double> frame_time;
+
+        void read_timestamps(FrameQueries& queries);
+    };
+} // namespace nova::renderer
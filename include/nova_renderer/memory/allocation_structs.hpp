@@ -23,4 +23,32 @@ namespace nova::mem {
          */
         void* internal_data = nullptr;
     };
+
+    /*!
+     * \brief How fragmented the free memory of an allocation strategy is
+     */
+    struct FragmentationStats {
+        /*!
+         * \brief The number of bytes that aren't allocated
+         */
+        Bytes free_size{0};
+
+        /*!
+         * \brief The size of the largest free block. No allocation larger than this can succeed
+         */
+        Bytes largest_free_block{0};
+
+        /*!
+         * \brief Gets the fraction of the free memory that's outside the largest free block
+         *
+         * 0 means that all the free memory is in one block, and values near 1 mean that the free memory is split into many small blocks
+         */
+        [[nodiscard]] float get_fragmentation() const {
+            if(free_size == Bytes(0)) {
+                return 0;
+            }
+
+            return 1.0F - static_cast<float>(largest_free_block.b_count()) / static_cast<float>(free_size.b_count());
+        }
+    };
 } // namespace nova::mem
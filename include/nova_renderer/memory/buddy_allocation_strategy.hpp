@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+#include <rx/core/vector.h>
+
+#include "nova_renderer/memory/allocation_strategy.hpp"
+#include "nova_renderer/memory/bytes.hpp"
+
+namespace rx {
+    namespace memory {
+        struct allocator;
+    }
+} // namespace rx
+
+namespace nova::mem {
+    struct AllocationInfo;
+
+    /*!
+     * \brief A buddy allocation strategy
+     *
+     * Memory is split into blocks whose sizes are the minimum block size times a power of two. Each allocation gets the smallest block that
+     * can hold it, so allocations whose sizes are powers of two waste nothing. When a block and its buddy - the other half of the block
+     * they were split from - are both free, they're merged back together
+     *
+     * The blocks are tracked by a complete binary tree that's stored in an array, with one byte per node. Each node stores the order of
+     * the largest free block in its subtree, plus one, or zero if its subtree is full. Allocating and freeing both walk a single path
+     * through the tree, so they take O(log n) time, and there are no per-block heap allocations
+     */
+    class BuddyAllocationStrategy final : public AllocationStrategy {
+    public:
+        /*!
+         * \brief Initializes this allocator with the total size of the memory it can work with
+         *
+         * If the size isn't the minimum block size times a power of two, the tree covers the next such size, and the blocks past the end
+         * of the memory are never allocated
+         *
+         * \param allocator_in The allocator to allocate the block tree with
+         * \param size The size of the memory that this allocator can allocate from
+         * \param min_block_size_in The size of the smallest block. It's also the alignment of every allocation, and must be a power of
+         * two
+         */
+        BuddyAllocationStrategy(rx::memory::allocator* allocator_in, Bytes size, Bytes min_block_size_in);
+
+        /*!
+         * \brief Allocates the smallest block that can hold `size` bytes, filling out `allocation` if the allocation is successful
+         *
+         * `allocation.size` is the size of the whole block
+         *
+         * \return True if the allocation succeeds, false if there's no free block that's large enough
+         */
+        bool allocate(Bytes size, AllocationInfo& allocation) override;
+
+        void free(const AllocationInfo& alloc) override;
+
+        /*!
+         * \brief Gets the number of bytes that aren't allocated. They may be spread across several free blocks
+         */
+        [[nodiscard]] Bytes get_free_size() const;
+
+    private:
+        Bytes min_block_size;
+
+        /*!
+         * \brief The order of the block that the root of the tree covers. A block of order `n` is `min_block_size * 2^n` bytes
+         */
+        uint32_t max_order = 0;
+
+        Bytes usable_size{0};
+
+        Bytes allocated{0};
+
+        /*!
+         * \brief The tree of blocks. The children of node `i` are nodes `2i + 1` and `2i + 2`
+         */
+        rx::vector<uint8_t> tree;
+
+        /*!
+         * \brief Recalculates the nodes above the provided node, after the provided node changed
+         */
+        void update_parents(uint64_t node_idx, uint32_t node_order);
+    };
+} // namespace nova::mem
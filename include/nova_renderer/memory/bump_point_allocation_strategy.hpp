@@ -23,6 +23,14 @@ namespace nova::mem {
 
         void free(const AllocationInfo&) override;
 
+        /*!
+         * \brief Frees every allocation at once
+         *
+         * Nothing may use the memory of any allocation from this allocator anymore. Use `RingAllocationStrategy` for memory that's reused
+         * every frame
+         */
+        void reset();
+
     private:
         Bytes memory_size;
         Bytes alignment;
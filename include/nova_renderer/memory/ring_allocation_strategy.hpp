@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+
+#include <rx/core/concurrency/mutex.h>
+#include <rx/core/vector.h>
+
+#include "nova_renderer/memory/allocation_strategy.hpp"
+#include "nova_renderer/memory/bytes.hpp"
+
+namespace rx {
+    namespace memory {
+        struct allocator;
+    }
+} // namespace rx
+
+namespace nova::mem {
+    struct AllocationInfo;
+
+    /*!
+     * \brief Allocates memory linearly around a ring, and reclaims each frame's memory once the GPU has finished that frame
+     *
+     * Every allocation belongs to the frame that's ended next with `end_frame`. Individual allocations can't be freed - `free` does
+     * nothing - but once `retire_frames` says that a frame is done, all of its memory can be allocated again. When an allocation doesn't
+     * fit before the end of the memory, the rest of the memory is skipped and the allocation starts at the beginning, as long as the
+     * oldest frame that's still in flight has been retired past it
+     *
+     * Safe to use from multiple threads, so the renderer can end and retire frames while other threads allocate
+     */
+    class RingAllocationStrategy final : public AllocationStrategy {
+    public:
+        /*!
+         * \param allocator_in The allocator to allocate the list of in-flight frames with
+         * \param size_in The size of the memory that this allocator can allocate from
+         * \param alignment_in The alignment of all allocations from this allocator
+         */
+        RingAllocationStrategy(rx::memory::allocator* allocator_in, Bytes size_in, Bytes alignment_in = Bytes(0));
+
+        bool allocate(Bytes size, AllocationInfo& allocation) override;
+
+        /*!
+         * \brief Does nothing. The allocation's memory is reclaimed when its frame is retired
+         */
+        void free(const AllocationInfo& alloc) override;
+
+        /*!
+         * \brief Ends the current frame. Everything allocated since the last call belongs to this frame
+         *
+         * \param frame_count The number of the frame that just ended
+         */
+        void end_frame(uint64_t frame_count);
+
+        /*!
+         * \brief Reclaims the memory of every frame up to and including the provided frame
+         *
+         * The GPU must have finished those frames
+         */
+        void retire_frames(uint64_t last_finished_frame);
+
+        /*!
+         * \brief Gets the number of bytes that aren't used by an in-flight frame. They may be split between the end and the beginning of
+         * the memory
+         */
+        [[nodiscard]] Bytes get_free_size() const;
+
+    private:
+        /*!
+         * \brief The memory that a frame used
+         */
+        struct FrameRegion {
+            uint64_t frame_count = 0;
+
+            /*!
+             * \brief The number of bytes that the frame used, including any memory skipped at the end of the ring
+             */
+            Bytes size{0};
+        };
+
+        Bytes memory_size;
+        Bytes alignment;
+
+        /*!
+         * \brief Where the next allocation starts
+         */
+        Bytes head{0};
+
+        /*!
+         * \brief Where the memory of the oldest in-flight frame starts
+         */
+        Bytes tail{0};
+
+        /*!
+         * \brief The number of bytes used by the in-flight frames and the current frame
+         */
+        Bytes used{0};
+
+        /*!
+         * \brief The number of bytes that the current frame has used
+         */
+        Bytes current_frame_size{0};
+
+        /*!
+         * \brief The frames that have ended but haven't been retired, oldest first
+         */
+        rx::vector<FrameRegion> in_flight_frames;
+
+        mutable rx::concurrency::mutex mutex;
+    };
+} // namespace nova::mem
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+
+#include <rx/core/vector.h>
+
+#include "nova_renderer/memory/allocation_strategy.hpp"
+#include "nova_renderer/memory/bytes.hpp"
+
+namespace rx {
+    namespace memory {
+        struct allocator;
+    }
+} // namespace rx
+
+namespace nova::mem {
+    struct AllocationInfo;
+    struct FragmentationStats;
+
+    /*!
+     * \brief A Two-Level Segregated Fit allocation strategy
+     *
+     * TLSF keeps a free list for each range of block sizes. The first level splits sizes into powers of two, and the second level splits
+     * each power of two into `NUM_SECOND_LEVELS` equal ranges. A bitmap for each level says which free lists have blocks, so finding a
+     * free block that's large enough is a couple of bit scans, and allocating and freeing both take constant time no matter how many
+     * allocations there are. Blocks that are next to each other in memory are merged when they're both free
+     *
+     * Block headers come from pools of `BLOCKS_PER_CHUNK` headers, and freed headers are reused, so splitting and merging blocks rarely
+     * allocates
+     */
+    class TlsfAllocationStrategy final : public AllocationStrategy {
+    public:
+        /*!
+         * \brief Initializes this allocator with the total size of the memory it can work with
+         *
+         * \param allocator_in The allocator to use when allocating block headers
+         * \param size The size of the memory that this allocator can allocate from
+         * \param alignment_in The alignment of all allocations from this allocator
+         */
+        TlsfAllocationStrategy(rx::memory::allocator* allocator_in, Bytes size, Bytes alignment_in = Bytes(0));
+
+        TlsfAllocationStrategy(const TlsfAllocationStrategy& other) = delete;
+        TlsfAllocationStrategy& operator=(const TlsfAllocationStrategy& other) = delete;
+
+        TlsfAllocationStrategy(TlsfAllocationStrategy&& old) noexcept = delete;
+        TlsfAllocationStrategy& operator=(TlsfAllocationStrategy&& old) noexcept = delete;
+
+        ~TlsfAllocationStrategy() override;
+
+        /*!
+         * \brief Allocates the specified amount of memory, filling out `allocation` if the allocation is successful
+         *
+         * The allocation comes from the smallest free list whose blocks are all large enough. If the block is larger than the requested
+         * size, the rest of the block goes back into the free lists
+         *
+         * \return True if the allocation succeeds, false if there's no free block that's large enough
+         */
+        bool allocate(Bytes size, AllocationInfo& allocation) override;
+
+        void free(const AllocationInfo& alloc) override;
+
+        /*!
+         * \brief Gets the number of bytes that aren't allocated. They may be spread across several free blocks
+         */
+        [[nodiscard]] Bytes get_free_size() const;
+
+        /*!
+         * \brief Gets the free size and the size of the largest free block
+         *
+         * Only the free list with the largest blocks is searched, so this is fast enough to call every frame
+         */
+        [[nodiscard]] FragmentationStats get_fragmentation_stats() const;
+
+    private:
+        struct Block {
+            Bytes offset{0};
+            Bytes size{0};
+
+            /*!
+             * \brief The blocks before and after this block in memory
+             */
+            Block* previous_physical = nullptr;
+            Block* next_physical = nullptr;
+
+            /*!
+             * \brief The blocks before and after this block in its free list. When the header is unused, `next_free` links the unused
+             * headers
+             */
+            Block* previous_free = nullptr;
+            Block* next_free = nullptr;
+
+            bool free = true;
+        };
+
+        /*!
+         * \brief log2 of the number of second-level free lists for each first-level size range
+         */
+        static constexpr uint32_t SECOND_LEVEL_INDEX_BITS = 5;
+
+        static constexpr uint32_t NUM_SECOND_LEVELS = 1 << SECOND_LEVEL_INDEX_BITS;
+
+        /*!
+         * \brief Blocks smaller than this many granules all share the first first-level range, which is split linearly
+         */
+        static constexpr uint64_t SMALL_BLOCK_GRANULES = NUM_SECOND_LEVELS;
+
+        static constexpr uint32_t NUM_FIRST_LEVELS = 64 - SECOND_LEVEL_INDEX_BITS + 1;
+
+        static constexpr uint32_t BLOCKS_PER_CHUNK = 256;
+
+        rx::memory::allocator* allocator;
+
+        Bytes memory_size{0};
+
+        /*!
+         * \brief The size that every block is a multiple of. It's the allocation alignment, or one byte if there's no alignment
+         */
+        Bytes granularity{1};
+
+        Bytes allocated{0};
+
+        uint64_t first_level_bitmap = 0;
+        uint32_t second_level_bitmaps[NUM_FIRST_LEVELS] = {};
+
+        Block* free_lists[NUM_FIRST_LEVELS][NUM_SECOND_LEVELS] = {};
+
+        /*!
+         * \brief The chunks of block headers that this allocator has allocated
+         */
+        rx::vector<Block*> block_chunks;
+
+        /*!
+         * \brief Headers that aren't used by any block
+         */
+        Block* unused_blocks = nullptr;
+
+        /*!
+         * \brief Gets the free list that blocks of the provided number of granules go into
+         */
+        static void get_list_indices(uint64_t num_granules, uint32_t& first_level, uint32_t& second_level);
+
+        /*!
+         * \brief Finds a free block with at least the provided number of granules, or returns nullptr if there isn't one
+         */
+        Block* find_free_block(uint64_t num_granules) const;
+
+        void insert_free_block(Block* block);
+
+        void remove_free_block(Block* block);
+
+        Block* make_new_block(Bytes offset, Bytes size);
+
+        void recycle_block(Block* block);
+    };
+} // namespace nova::mem
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <atomic>
+
+#include <rx/core/concurrency/mutex.h>
+
 #include "nova_renderer/constants.hpp"
+#include "nova_renderer/device_memory_defragmenter.hpp"
+#include "nova_renderer/dynamic_resolution.hpp"
 #include "nova_renderer/filesystem/virtual_filesystem.hpp"
+#include "nova_renderer/gpu_profiler.hpp"
 #include "nova_renderer/nova_settings.hpp"
 #include "nova_renderer/pipeline_storage.hpp"
 #include "nova_renderer/procedural_mesh.hpp"
+#include "nova_renderer/render_statistics.hpp"
 #include "nova_renderer/renderables.hpp"
 #include "nova_renderer/renderdoc_app.h"
 #include "nova_renderer/rendergraph.hpp"
@@ -18,6 +26,10 @@ namespace rx {
     namespace memory {
         struct bump_point_allocator;
     }
+
+    namespace concurrency {
+        struct thread_pool;
+    }
 } // namespace rx
 
 void init_rex();
@@ -28,6 +40,11 @@ namespace spirv_cross {
     struct Resource;
 } // namespace spirv_cross
 
+namespace nova::mem {
+    class RingAllocationStrategy;
+    class TlsfAllocationStrategy;
+} // namespace nova::mem
+
 namespace nova::renderer {
     using LogHandles = rx::vector<rx::log::event_type::handle>;
 
@@ -114,7 +131,7 @@ namespace nova::renderer {
         template <typename RenderpassType, typename... Args>
         RenderpassType* create_ui_renderpass(Args&&... args);
 
-        [[nodiscard]] const rx::vector<MaterialPass>& get_material_passes_for_pipeline(rhi::RhiPipeline* const pipeline);
+        [[nodiscard]] const rx::vector<MaterialPass>& get_material_passes_for_pipeline(const rhi::RhiPipelineInterface* pipeline_interface);
 
         [[nodiscard]] rx::optional<RenderpassMetadata> get_renderpass_metadata(const rx::string& renderpass_name) const;
 
@@ -127,6 +144,46 @@ namespace nova::renderer {
 
         [[nodiscard]] rx::memory::allocator* get_global_allocator() const;
 
+        /*!
+         * \brief Gets how long each renderpass took on the GPU, in execution order
+         *
+         * The times are from the most recent frame whose timestamps have been read. Timestamps are read when their frame's index is
+         * reused, so the times lag a few frames behind the frame that's being recorded. Skipped renderpasses are left out
+         *
+         * Returns an empty vector if `NovaSettings::profile_gpu` is false or if the GPU can't write timestamps
+         */
+        [[nodiscard]] rx::vector<RenderpassGpuTime> get_renderpass_gpu_times() const;
+
+        /*!
+         * \brief Gets the fraction of each screen-relative render target that the renderpack renders to
+         *
+         * Always 1 unless `NovaSettings::dynamic_resolution` is enabled
+         */
+        [[nodiscard]] float get_render_scale() const;
+
+        /*!
+         * \brief Gets how much work Nova did in the most recent frame, such as how many draw calls it recorded and how many bytes it
+         * uploaded
+         *
+         * Work that happened between two frames, such as creating a mesh, is counted in the later frame. Safe to call from any thread
+         */
+        [[nodiscard]] FrameStatistics get_frame_statistics() const;
+
+        /*!
+         * \brief Gets how much work Nova did in each of the last `FRAME_STATISTICS_HISTORY_SIZE` frames, oldest first
+         *
+         * Safe to call from any thread
+         */
+        [[nodiscard]] rx::vector<FrameStatistics> get_frame_statistics_history() const;
+
+        /*!
+         * \brief Gets how fragmented the free memory of the mesh memory pool is
+         *
+         * When the fragmentation reaches `NovaSettings::mesh_defragmentation.fragmentation_threshold`, Nova starts moving meshes to
+         * defragment the pool
+         */
+        [[nodiscard]] mem::FragmentationStats get_mesh_memory_fragmentation() const;
+
 #pragma region Meshes
         /*!
          * \brief Tells Nova how many meshes you expect to have in your scene
@@ -201,8 +258,54 @@ namespace nova::renderer {
         RENDERDOC_API_1_3_0* render_doc;
         rx::vector<rx::memory::bump_point_allocator*> frame_allocators;
 
+        /*!
+         * \brief Threads which record renderpasses into secondary command lists, or nullptr if every renderpass is recorded on the main
+         * thread
+         */
+        rx::concurrency::thread_pool* recording_threads = nullptr;
+
+        /*!
+         * \brief Measures how long each renderpass takes on the GPU, or nullptr if the GPU isn't being profiled
+         */
+        GpuProfiler* gpu_profiler = nullptr;
+
+        DynamicResolutionController dynamic_resolution;
+
+        /*!
+         * \brief Whether we've already told the user that dynamic resolution needs the GPU profiler
+         */
+        bool warned_about_dynamic_resolution = false;
+
+        /*!
+         * \brief The render scale uniforms of each in-flight frame
+         *
+         * Each frame that changes the render scale writes its own slot and copies it to the render scale uniform buffer on the GPU, so the
+         * other in-flight frames can keep reading the old render scale
+         */
+        rhi::RhiBuffer* render_scale_staging_buffer = nullptr;
+
+        /*!
+         * \brief Whether the next frame must write the render scale uniforms
+         */
+        bool render_scale_changed = false;
+
+        mutable rx::concurrency::mutex frame_statistics_mutex;
+
+        /*!
+         * \brief The statistics of the most recent frames. Once it has `FRAME_STATISTICS_HISTORY_SIZE` elements, each new frame replaces
+         * the oldest one
+         */
+        rx::vector<FrameStatistics> frame_statistics_history;
+
+        rx_size oldest_frame_statistics_idx = 0;
+
         rhi::RhiSampler* point_sampler;
 
+        /*!
+         * \brief Bilinear sampler which the backbuffer output pass upscales the scene output with
+         */
+        rhi::RhiSampler* linear_sampler;
+
         MeshId fullscreen_triangle_id;
 
         RenderableId backbuffer_output_renderable;
@@ -226,17 +329,36 @@ namespace nova::renderer {
 
         DeviceMemoryResource* mesh_memory;
 
+        /*!
+         * \brief The allocation strategy of `mesh_memory`
+         */
+        mem::TlsfAllocationStrategy* mesh_memory_strategy = nullptr;
+
+        /*!
+         * \brief Moves meshes around in `mesh_memory` when it gets fragmented, or nullptr if there's no mesh memory
+         */
+        DeviceMemoryDefragmenter* mesh_memory_defragmenter = nullptr;
+
         DeviceMemoryResource* ubo_memory;
 
         rhi::RhiDescriptorPool* global_descriptor_pool;
 
         DeviceMemoryResource* staging_buffer_memory;
 
+        /*!
+         * \brief The allocation strategy of `staging_buffer_memory`. Each frame's staging memory is reclaimed once the frame is done
+         */
+        mem::RingAllocationStrategy* staging_buffer_strategy = nullptr;
+
         void* staging_buffer_memory_ptr;
 
 #pragma region Initialization
         void create_global_allocators();
 
+        void create_recording_threads();
+
+        void create_gpu_profiler();
+
         static void initialize_virtual_filesystem();
 
         /*!
@@ -291,7 +413,16 @@ namespace nova::renderer {
 
         rx::map<rx::string, renderpack::TextureCreateInfo> dynamic_texture_infos;
 
-        void create_dynamic_textures(const rx::vector<renderpack::TextureCreateInfo>& texture_create_infos);
+        /*!
+         * \brief Creates the renderpack's dynamic textures
+         *
+         * Dynamic textures which are never used at the same time share memory. The renderpasses are ordered the same way the rendergraph
+         * will order them, to find out when each texture is used
+         *
+         * \return The number of bytes of VRAM that sharing memory saved
+         */
+        uint64_t create_dynamic_textures(const rx::vector<renderpack::TextureCreateInfo>& texture_create_infos,
+                                         const rx::vector<renderpack::RenderPassCreateInfo>& pass_create_infos);
 
         void create_render_passes(const rx::vector<renderpack::RenderPassCreateInfo>& pass_create_infos,
                                   const rx::vector<renderpack::PipelineData>& pipelines) const;
@@ -304,14 +435,19 @@ namespace nova::renderer {
 #pragma region Rendering pipelines
         PipelineStorage* pipeline_storage;
 
-        rx::map<rhi::RhiPipeline*, rx::vector<MaterialPass>> passes_by_pipeline;
+        /*!
+         * \brief The material passes of every pipeline, keyed by the pipeline's interface
+         *
+         * The interface is used because it exists before the pipeline has been compiled
+         */
+        rx::map<const rhi::RhiPipelineInterface*, rx::vector<MaterialPass>> passes_by_pipeline;
 
         rx::map<FullMaterialPassName, MaterialPassMetadata> material_metadatas;
 
         void create_pipelines_and_materials(const rx::vector<renderpack::PipelineData>& pipeline_create_infos,
                                             const rx::vector<renderpack::MaterialData>& materials);
 
-        void create_materials_for_pipeline(const renderer::Pipeline& pipeline,
+        void create_materials_for_pipeline(rhi::RhiPipelineInterface* pipeline_interface,
                                            const rx::vector<renderpack::MaterialData>& materials,
                                            const rx::string& pipeline_name);
 
@@ -325,20 +461,191 @@ namespace nova::renderer {
 
         rx::map<MeshId, Mesh> meshes;
         rx::map<MeshId, ProceduralMesh> proc_meshes;
+
+        /*!
+         * \brief A buffer that will be destroyed once the GPU has finished every frame that might use it
+         */
+        struct RetiredBuffer {
+            rhi::RhiBuffer* buffer = nullptr;
+
+            /*!
+             * \brief The last frame that might use the buffer
+             */
+            uint64_t frame_count = 0;
+        };
+
+        rx::concurrency::mutex retired_buffers_mutex;
+        rx::vector<RetiredBuffer> retired_buffers;
+
+        /*!
+         * \brief Destroys the provided buffer once the GPU has finished the provided frame
+         */
+        void retire_buffer(rhi::RhiBuffer* buffer, uint64_t last_frame);
+
+        /*!
+         * \brief Guards the uploads that no frame has waited for yet
+         *
+         * Uploads hold it from creating their staging buffer until they're submitted, and frames hold it while they take the pending
+         * uploads and end the staging memory's frame, so each upload's staging memory belongs to the frame that waits for the upload
+         */
+        rx::concurrency::mutex upload_mutex;
+
+        /*!
+         * \brief Signaled by the uploads that the next frame will wait for
+         */
+        rx::vector<rhi::RhiSemaphore*> pending_upload_semaphores;
+
+        /*!
+         * \brief The staging buffers of the uploads that the next frame will wait for
+         */
+        rx::vector<rhi::RhiBuffer*> pending_staging_buffers;
+
+        /*!
+         * \brief The upload semaphores that each in-flight frame waited for. They can be reused once the frame's fence is signaled
+         */
+        rx::array<rx::vector<rhi::RhiSemaphore*>[NUM_IN_FLIGHT_FRAMES]> waited_upload_semaphores;
+
+        rx::vector<rhi::RhiSemaphore*> free_upload_semaphores;
+
+        /*!
+         * \brief Submits a command list that copies data from the provided staging buffer on the transfer queue
+         *
+         * The next frame waits for the copy before it starts, and the staging buffer is destroyed once that frame is done. `upload_mutex`
+         * must be held from before the staging buffer was created
+         */
+        void submit_upload(rhi::CommandList* cmds, rhi::RhiBuffer* staging_buffer);
+
+        /*!
+         * \brief Destroys the retired buffers whose last frame is at or before the provided frame
+         *
+         * The GPU must have finished that frame
+         */
+        void destroy_retired_buffers(uint64_t last_finished_frame);
+
+        /*!
+         * \brief Finishes the mesh moves that the mesh memory defragmenter started last frame, and lets it start new moves
+         *
+         * Every mesh and mesh batch that used a moved buffer is pointed at the buffer's new copy, and the old buffer is retired
+         *
+         * \param last_finished_frame The last frame that the GPU has finished
+         */
+        void defragment_mesh_memory(uint64_t last_finished_frame);
 #pragma endregion
 
 #pragma region Rendering
-        uint64_t frame_count = 0;
-        uint8_t cur_frame_idx = 0;
+        /*!
+         * \brief The number of the frame that's being recorded. Atomic because threads that destroy meshes read it
+         */
+        std::atomic<uint64_t> frame_count{0};
+
+        /*!
+         * \brief The number of frames that may be in flight at once, from `NovaSettings::max_in_flight_frames`
+         */
+        uint32_t num_in_flight_frames = NUM_IN_FLIGHT_FRAMES;
+
+        /*!
+         * \brief Index of the in-flight frame that's being recorded. Indexes the per-frame fences, semaphores, and allocators
+         */
+        uint32_t cur_frame_idx = 0;
+
+        /*!
+         * \brief Index of the swapchain image that the current frame renders to
+         */
+        uint8_t cur_swapchain_image_idx = 0;
 
         rx::vector<rx::string> builtin_buffer_names;
         uint32_t cur_model_matrix_index = 0;
 
+        /*!
+         * \brief Signalled when the GPU finishes each in-flight frame
+         */
         rx::array<rhi::RhiFence* [NUM_IN_FLIGHT_FRAMES]> frame_fences;
 
+        /*!
+         * \brief Signalled when the swapchain image for each in-flight frame may be rendered to
+         */
+        rx::array<rhi::RhiSemaphore* [NUM_IN_FLIGHT_FRAMES]> image_acquired_semaphores;
+
+        /*!
+         * \brief Signalled when each in-flight frame has finished rendering, so its swapchain image can be presented
+         */
+        rx::array<rhi::RhiSemaphore* [NUM_IN_FLIGHT_FRAMES]> render_finished_semaphores;
+
+        /*!
+         * \brief Semaphores which order the rendergraph's submissions within each in-flight frame
+         *
+         * Grows whenever a frame needs more semaphores than it's needed before
+         */
+        rx::array<rx::vector<rhi::RhiSemaphore*>[NUM_IN_FLIGHT_FRAMES]> submission_semaphores;
+
         rx::map<FullMaterialPassName, MaterialPassKey> material_pass_keys;
 
         rx::concurrency::mutex ui_function_mutex;
+
+        /*!
+         * \brief The swapchain options that the swapchain was last created with
+         */
+        NovaSettings::SwapchainOptions applied_swapchain_options;
+
+        /*!
+         * \brief The size of the window's framebuffer when the swapchain was last created
+         */
+        glm::uvec2 applied_window_size{0};
+
+        /*!
+         * \brief Gets the size that the swapchain should have
+         *
+         * The headless backend has no window to present to, so it uses the window size from the settings
+         */
+        [[nodiscard]] glm::uvec2 get_window_framebuffer_size() const;
+
+        /*!
+         * \brief Checks if the swapchain must be recreated before the next frame, because it's out of date, the window was resized, or
+         * the swapchain settings changed
+         */
+        [[nodiscard]] bool needs_new_swapchain() const;
+
+        /*!
+         * \brief Recreates the swapchain, then resizes the screen-relative render targets and everything that uses them
+         *
+         * Waits for every in-flight frame to finish first
+         */
+        void recreate_swapchain(const glm::uvec2& window_size);
+
+        /*!
+         * \brief Waits for the GPU to finish every in-flight frame
+         */
+        void wait_for_all_frames();
+
+        /*!
+         * \brief Tells the dynamic resolution controller how long the GPU took to render the last measured frame, and marks the render
+         * scale uniforms for writing if the render scale changed
+         */
+        void update_render_scale();
+
+        /*!
+         * \brief Writes the current render scale to this frame's slot of the render scale staging buffer, and records a copy from that
+         * slot to the render scale uniform buffer
+         *
+         * \param cmds A command list on the graphics queue, which is submitted before the backbuffer output pass
+         */
+        void write_render_scale_uniforms(rhi::CommandList& cmds);
+
+        /*!
+         * \brief Resizes the screen-relative render targets, the render targets that alias them, and the framebuffers, dispatches, and
+         * descriptor sets that use them
+         */
+        void resize_screen_relative_textures(const glm::uvec2& swapchain_size);
+
+        /*!
+         * \brief Records the contents of every renderpass into its own secondary command list, spreading the renderpasses across the
+         * recording threads
+         *
+         * \return One secondary command list per renderpass, in the same order as `renderpasses`, or an empty vector if there are no
+         * recording threads
+         */
+        [[nodiscard]] rx::vector<rhi::CommandList*> record_renderpass_contents(const rx::vector<CompiledRenderpass>& renderpasses,
+                                                                               FrameContext& ctx) const;
 #pragma endregion
     };
 
@@ -56,6 +56,51 @@ namespace nova::renderer {
         virtual void on_config_loaded(const NovaSettingsAccessManager& config) = 0;
     };
 
+    /*!
+     * \brief The graphics APIs that Nova can render with
+     */
+    enum class GraphicsApi {
+        /*!
+         * \brief Render with Vulkan
+         */
+        Vulkan,
+
+        /*!
+         * \brief Don't render anything at all
+         *
+         * Every command is recorded into an in-memory command stream and every fence is always signaled. Nova does all its usual CPU work,
+         * but never touches a GPU. This is useful for benchmarking and testing Nova on machines that don't have a GPU
+         */
+        Headless,
+    };
+
+    /*!
+     * \brief How the swapchain shows the images that Nova renders
+     */
+    enum class PresentMode {
+        /*!
+         * \brief Show each image as soon as it's presented, even if the screen is in the middle of a refresh
+         *
+         * Has the lowest latency and doesn't cap the frame rate, but tears. Useful for benchmarking. Nova uses Mailbox if the GPU can't
+         * present immediately
+         */
+        Immediate,
+
+        /*!
+         * \brief Show the newest presented image at each refresh of the screen, throwing away images that were never shown
+         *
+         * Doesn't cap the frame rate and doesn't tear. Nova uses Fifo if the GPU doesn't support it
+         */
+        Mailbox,
+
+        /*!
+         * \brief Show every presented image in order, one per refresh of the screen
+         *
+         * Caps the frame rate at the refresh rate of the screen. Every GPU supports it
+         */
+        Fifo,
+    };
+
     struct NovaSettings {
         /*!
          * \brief Options for configuring the way mesh memory is allocated
@@ -142,6 +187,62 @@ namespace nova::renderer {
             } renderdoc;
         } debug;
 
+        /*!
+         * \brief Options for capturing Nova's rendering commands to a file
+         *
+         * A capture has every resource Nova creates and every command list Nova submits, from when the render device is created until
+         * `num_frames` frames have been presented. `nova-replay` can replay a capture with any graphics API, without the game that made
+         * it
+         */
+        struct CaptureOptions {
+            /*!
+             * \brief If true, Nova will write a capture file
+             *
+             * Capturing costs some CPU time for every command and every resource, so this should be off unless you want a capture
+             */
+            bool enabled = false;
+
+            /*!
+             * \brief The file to write the capture to
+             */
+            const char* file_path = "nova_frames.capture";
+
+            /*!
+             * \brief The number of frames to capture
+             */
+            uint32_t num_frames = 1;
+        } capture;
+
+        /*!
+         * \brief Options for recording trace events, which show what Nova's threads and the GPU were doing in each frame
+         *
+         * Events are kept in memory, in a fixed-size ring buffer for each thread, and are only written to disk when
+         * `tracing::write_trace` is called or when Nova shuts down. See tracing.hpp
+         */
+        struct TraceOptions {
+            /*!
+             * \brief If true, Nova records trace events
+             */
+            bool enabled = false;
+
+            /*!
+             * \brief The number of frames between two traced frames. 1 traces every frame
+             *
+             * Higher values make tracing cheaper, so that it can stay on while the game is being played
+             */
+            uint32_t sample_interval = 1;
+
+            /*!
+             * \brief The number of events that each thread keeps. The oldest events are overwritten when a thread has more events
+             */
+            uint32_t events_per_thread = 16384;
+
+            /*!
+             * \brief The file that the trace is written to when Nova shuts down. If this is nullptr, the trace isn't written on shutdown
+             */
+            const char* shutdown_trace_path = "trace.json";
+        } trace;
+
         /*!
          * \brief Settings that Nova can change, but which are still stored in a config
          */
@@ -174,6 +275,23 @@ namespace nova::renderer {
             uint32_t height{};
         } window;
 
+        /*!
+         * \brief Options for the swapchain that Nova renders to
+         *
+         * These may be changed at any time. Nova checks them at the start of every frame and recreates the swapchain if they changed
+         */
+        struct SwapchainOptions {
+            PresentMode present_mode = PresentMode::Mailbox;
+
+            /*!
+             * \brief The number of images in the swapchain
+             *
+             * More images let Nova start rendering a new frame while older frames wait to be shown. The driver may use a different number
+             * if it can't use this many
+             */
+            uint32_t num_images = 3;
+        } swapchain;
+
         /*!
          * \brief Options that are specific to Nova's Vulkan rendering backend
          */
@@ -187,6 +305,14 @@ namespace nova::renderer {
              * \brief The application version to pass to Vulkan
              */
             Semver application_version = {0, 8, 4};
+
+            /*!
+             * \brief Where to save compiled pipelines, so that later launches don't have to compile them again
+             *
+             * The vendor and device IDs of the GPU are appended to this path, so that every GPU gets its own cache. If this is nullptr,
+             * pipelines aren't saved
+             */
+            const char* pipeline_cache_path = "nova_pipeline_cache";
         } vulkan;
 
         /*!
@@ -199,8 +325,132 @@ namespace nova::renderer {
             bool is_uma = false;
         } system_info;
 
+        /*!
+         * \brief The number of frames that the CPU may record while the GPU is still rendering earlier frames
+         *
+         * More frames in flight let the CPU and GPU work at the same time, at the cost of latency. This is clamped to the range
+         * [1, NUM_IN_FLIGHT_FRAMES]
+         */
         uint32_t max_in_flight_frames = 3;
 
+        /*!
+         * \brief The number of threads that record renderpasses into secondary command lists in parallel
+         *
+         * If this is 0, every renderpass is recorded on the main thread
+         */
+        uint32_t num_recording_threads = 4;
+
+        /*!
+         * \brief The number of threads that compile a renderpack's pipelines in the background
+         *
+         * While a pipeline is compiling, its materials are drawn with the pipeline's fallback pipeline, or not drawn at all if the
+         * pipeline has no fallback or if the fallback has a different interface. If this is 0, every pipeline is compiled before the
+         * renderpack finishes loading
+         */
+        uint32_t num_pipeline_compile_threads = 0;
+
+        /*!
+         * \brief If true, Nova reorders the renderpasses in the rendergraph so that they need fewer barriers
+         *
+         * Independent renderpasses are moved between renderpasses that depend on each other, so that they can share barriers and so that
+         * the GPU has other work while it waits for a renderpass to finish. This can make render targets live longer. Renderpasses which
+         * read the outputs of another renderpass through input attachments stay right after it, so that they can still be merged
+         */
+        bool reorder_renderpasses = true;
+
+        /*!
+         * \brief If true, Nova merges renderpasses which read the outputs of the renderpass before them through input attachments into
+         * the subpasses of one renderpass
+         *
+         * On tiled GPUs, this keeps the outputs in tile memory instead of writing them to VRAM and reading them back
+         */
+        bool merge_renderpasses = true;
+
+        /*!
+         * \brief If true, compute renderpasses which allow async compute run on the async compute queue, at the same time as the graphics
+         * renderpasses that don't depend on them
+         *
+         * If false, every renderpass runs on the graphics queue
+         */
+        bool async_compute = true;
+
+        /*!
+         * \brief If true, Nova measures how long each renderpass takes on the GPU
+         *
+         * See `NovaRenderer::get_renderpass_gpu_times`. Does nothing if the GPU can't write timestamps
+         */
+        bool profile_gpu = true;
+
+        /*!
+         * \brief Options for lowering the resolution of the renderpack's renderpasses when the GPU can't keep up
+         *
+         * Renderpasses which write to screen-relative render targets only render to the top-left part of their targets, and the
+         * backbuffer output renderpass upscales the scene to the whole window. The render targets are never reallocated
+         */
+        struct DynamicResolutionOptions {
+            /*!
+             * \brief If true, Nova changes the render scale to keep the GPU's frame time near `target_frame_time`
+             *
+             * Nova measures the GPU's frame time with timestamp queries, so this does nothing unless `profile_gpu` is true and the GPU can
+             * write timestamps
+             */
+            bool enabled = false;
+
+            /*!
+             * \brief How long the GPU should take to render a frame, in milliseconds
+             */
+            float target_frame_time = 16.0F;
+
+            /*!
+             * \brief The lowest render scale that Nova may use, as a fraction of the size of each render target
+             */
+            float min_scale = 0.5F;
+
+            /*!
+             * \brief The highest render scale that Nova may use. Render targets are allocated at their full size, so Nova never renders
+             * with a scale higher than 1
+             */
+            float max_scale = 1.0F;
+
+            /*!
+             * \brief The most that the render scale may change by at once
+             */
+            float max_scale_step = 0.1F;
+
+            /*!
+             * \brief The number of frames whose GPU times are averaged before the render scale is changed
+             */
+            uint32_t adjustment_interval = 16;
+        } dynamic_resolution;
+
+        /*!
+         * \brief Options for moving meshes around in the mesh memory pool, so that loading and unloading meshes doesn't leave the free
+         * memory split into pieces that are too small for new meshes
+         *
+         * Nova copies a few meshes each frame on the transfer queue, starting with the meshes at the end of the pool, and only moves a mesh
+         * if its new place is closer to the start of the pool
+         */
+        struct MeshDefragmentationOptions {
+            bool enabled = true;
+
+            /*!
+             * \brief Nova starts moving meshes when the fraction of the free mesh memory that's outside the largest free block is higher
+             * than this
+             */
+            float fragmentation_threshold = 0.5F;
+
+            /*!
+             * \brief The most mesh data that Nova may copy in one frame, in bytes. Nova always moves at least one mesh while the mesh
+             * memory is fragmented
+             */
+            uint32_t max_bytes_per_frame = 4 * 1024 * 1024;
+        } mesh_defragmentation;
+
+        /*!
+         * \brief The graphics API that Nova should render with
+         */
+        GraphicsApi api = GraphicsApi::Vulkan;
+
         /*!
          * \brief Settings for how Nova should allocate vertex memory
          */
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <rx/core/concurrency/mutex.h>
+
 #include "nova_renderer/rendergraph.hpp"
 #include "nova_renderer/rhi/forward_decls.hpp"
 #include "nova_renderer/util/result.hpp"
@@ -9,9 +11,14 @@ namespace spirv_cross {
     class CompilerGLSL;
 } // namespace spirv_cross
 
+namespace rx::concurrency {
+    struct thread_pool;
+} // namespace rx::concurrency
+
 namespace nova::renderer {
     struct ShaderSource;
     struct PipelineStateCreateInfo;
+    struct ComputePipelineCreateInfo;
 
     struct PipelineReturn {
         Pipeline pipeline;
@@ -31,12 +38,66 @@ namespace nova::renderer {
         PipelineStorage(PipelineStorage&& old) noexcept = delete;
         PipelineStorage& operator=(PipelineStorage&& old) noexcept = delete;
 
-        ~PipelineStorage() = default;
+        /*!
+         * \brief Waits for every pipeline that's still compiling
+         */
+        ~PipelineStorage();
 
+        /*!
+         * \brief Gets the pipeline to draw a pipeline's materials with
+         *
+         * If the pipeline is still compiling, or failed to compile, this returns the pipeline's fallback pipeline with the pipeline's own
+         * interface, so that the pipeline's material passes can draw with the fallback. If the fallback isn't ready either, or if it can't
+         * draw the pipeline's material passes, this returns rx::nullopt and the pipeline's material passes should be skipped
+         *
+         * Safe to call from any thread
+         */
         [[nodiscard]] rx::optional<Pipeline> get_pipeline(const rx::string& pipeline_name) const;
 
+        /*!
+         * \brief Gets the interface of a pipeline, even if the pipeline is still compiling
+         */
+        [[nodiscard]] rhi::RhiPipelineInterface* get_pipeline_interface(const rx::string& pipeline_name) const;
+
+        /*!
+         * \brief Creates a pipeline on the calling thread
+         */
         [[nodiscard]] bool create_pipeline(const PipelineStateCreateInfo& create_info);
 
+        /*!
+         * \brief Creates a pipeline's interface on the calling thread, and compiles the pipeline on a background thread
+         *
+         * Until the pipeline is compiled, `get_pipeline` returns its fallback pipeline instead. Once every pipeline has been compiled, the
+         * render device's pipeline cache is saved
+         *
+         * If `NovaSettings::num_pipeline_compile_threads` is 0, this compiles the pipeline on the calling thread
+         *
+         * \param create_info The pipeline to create
+         * \param fallback_name The name of the pipeline to draw this pipeline's materials with while it's compiling. May be empty
+         *
+         * \return True if the pipeline's interface was created, false if it wasn't
+         */
+        [[nodiscard]] bool create_pipeline_async(const PipelineStateCreateInfo& create_info, const rx::string& fallback_name);
+
+        /*!
+         * \brief Creates a compute pipeline and its interface on the calling thread
+         *
+         * Compute pipelines have no fallbacks, so there's nothing to draw with while they compile in the background
+         */
+        [[nodiscard]] bool create_compute_pipeline(const ComputePipelineCreateInfo& create_info);
+
+        /*!
+         * \brief Recomputes how many workgroups a compute pipeline dispatches after the output of its pass was resized
+         *
+         * Does nothing for compute pipelines whose renderpack set their workgroup count
+         */
+        void resize_dispatches(const rx::string& pipeline_name, const glm::uvec2& output_size);
+
+        /*!
+         * \brief Checks if pipelines will be compiled on background threads
+         */
+        [[nodiscard]] bool is_async() const;
+
     private:
         NovaRenderer& renderer;
 
@@ -48,8 +109,60 @@ namespace nova::renderer {
 
         rx::map<FullMaterialPassName, MaterialPassKey> material_pass_keys;
 
+        /*!
+         * \brief Whether a waiting pipeline's fallback can draw the waiting pipeline's material passes
+         */
+        enum class FallbackState {
+            /*!
+             * \brief The fallback hasn't been compiled yet, so we don't know
+             */
+            Unchecked,
+
+            Compatible,
+
+            /*!
+             * \brief The pipeline has no fallback, or the fallback has a different interface or different attachments
+             */
+            Incompatible,
+        };
+
+        /*!
+         * \brief A pipeline whose interface has been created, but whose RhiPipeline isn't available because it's still compiling or
+         * because it failed to compile
+         */
+        struct WaitingPipeline {
+            rhi::RhiPipelineInterface* pipeline_interface = nullptr;
+
+            rx::string fallback_name;
+
+            FallbackState fallback_state = FallbackState::Unchecked;
+        };
+
+        /*!
+         * \brief Guards the pipelines, the waiting pipelines, the pipeline metadata, and the number of compiling pipelines
+         */
+        mutable rx::concurrency::mutex pipelines_mutex;
+
         rx::map<rx::string, Pipeline> pipelines;
 
+        mutable rx::map<rx::string, WaitingPipeline> waiting_pipelines;
+
+        uint32_t num_compiling_pipelines = 0;
+
+        rx::concurrency::thread_pool* compile_threads = nullptr;
+
+        /*!
+         * \brief Compiles a pipeline whose interface has already been created. Runs on one of the compile threads
+         */
+        void compile_pipeline(rhi::RhiPipelineInterface* pipeline_interface, const PipelineStateCreateInfo& create_info);
+
+        /*!
+         * \brief Checks if a pipeline's material passes can be drawn with another pipeline. Must be called with pipelines_mutex held
+         */
+        [[nodiscard]] bool can_draw_with_fallback(const rx::string& pipeline_name,
+                                                  const rhi::RhiPipelineInterface& pipeline_interface,
+                                                  const rx::string& fallback_name) const;
+
         [[nodiscard]] ntl::Result<PipelineReturn> create_graphics_pipeline(rhi::RhiPipelineInterface* pipeline_interface,
                                                                            const PipelineStateCreateInfo& pipeline_create_info) const;
 
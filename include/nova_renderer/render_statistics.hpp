@@ -0,0 +1,128 @@
+/*!
+ * \file render_statistics.hpp
+ *
+ * \brief Counts the work that Nova gives the GPU each frame, such as draw calls, pipeline binds, and uploads
+ *
+ * The RHI backends add to the counters of the thread that does the work, so counting never takes a lock while a renderpass is being
+ * recorded. NovaRenderer sums every thread's counters at the end of each frame
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <rx/core/string.h>
+#include <rx/core/vector.h>
+
+namespace nova::renderer {
+    struct CompiledRenderpass;
+
+    /*!
+     * \brief How much of each kind of work Nova did
+     */
+    struct RenderStatistics {
+        uint64_t num_draw_calls = 0;
+
+        /*!
+         * \brief The number of indices that the draw calls drew, counting every instance
+         */
+        uint64_t num_indices = 0;
+
+        uint64_t num_pipeline_binds = 0;
+
+        uint64_t num_descriptor_set_binds = 0;
+
+        /*!
+         * \brief The number of resource barriers, counting each resource separately
+         */
+        uint64_t num_barriers = 0;
+
+        /*!
+         * \brief The number of bytes that the CPU wrote into buffers with `RenderDevice::write_data_to_buffer`
+         */
+        uint64_t num_bytes_written = 0;
+
+        /*!
+         * \brief The number of bytes that the GPU copied with `CommandList::copy_buffer` and `CommandList::upload_data_to_image`, which
+         * Nova uses to upload data from staging buffers
+         */
+        uint64_t num_staging_bytes_uploaded = 0;
+
+        uint64_t num_command_lists = 0;
+
+        RenderStatistics& operator+=(const RenderStatistics& other);
+    };
+
+    /*!
+     * \brief The work that one renderpass did in a frame
+     */
+    struct RenderpassStatistics {
+        rx::string renderpass_name;
+
+        RenderStatistics statistics;
+    };
+
+    /*!
+     * \brief The work that Nova did in one frame
+     */
+    struct FrameStatistics {
+        uint64_t frame_count = 0;
+
+        /*!
+         * \brief All the work in the frame, including work that wasn't part of any renderpass, such as mesh uploads
+         */
+        RenderStatistics total;
+
+        /*!
+         * \brief The work of each compiled renderpass, in execution order. Skipped renderpasses are left out
+         */
+        rx::vector<RenderpassStatistics> renderpasses;
+    };
+
+    namespace statistics {
+        /*!
+         * \brief Adds to one of the calling thread's counters
+         *
+         * The work is counted for the renderpass that the calling thread is recording, if there is one
+         *
+         * \param counter The counter to add to, such as `&RenderStatistics::num_draw_calls`
+         * \param amount The amount to add
+         */
+        void count(uint64_t RenderStatistics::*counter, uint64_t amount = 1);
+
+        /*!
+         * \brief Counts the calling thread's work for a renderpass until the scope ends
+         */
+        class RenderpassScope {
+        public:
+            /*!
+             * \param renderpass_idx The index of the renderpass in the compiled renderpasses
+             */
+            explicit RenderpassScope(uint32_t renderpass_idx);
+
+            RenderpassScope(const RenderpassScope& other) = delete;
+            RenderpassScope& operator=(const RenderpassScope& other) = delete;
+
+            RenderpassScope(RenderpassScope&& old) noexcept = delete;
+            RenderpassScope& operator=(RenderpassScope&& old) noexcept = delete;
+
+            ~RenderpassScope();
+
+        private:
+            uint32_t previous_renderpass_idx;
+        };
+
+        /*!
+         * \brief Sums every thread's counters into the statistics for a frame, and resets the counters
+         *
+         * No thread may be inside a `RenderpassScope` while this runs
+         *
+         * \param frame_count The number of the frame that just ended
+         * \param renderpasses The compiled renderpasses that the frame executed
+         * \param allocator The allocator to allocate the frame statistics with
+         */
+        [[nodiscard]] FrameStatistics end_frame(uint64_t frame_count,
+                                                const rx::vector<CompiledRenderpass>& renderpasses,
+                                                rx::memory::allocator* allocator);
+    } // namespace statistics
+} // namespace nova::renderer
@@ -10,6 +10,7 @@
 #include "nova_renderer/rhi/rhi_types.hpp"
 #include "nova_renderer/renderpack_data.hpp"
 #include "nova_renderer/util/container_accessor.hpp"
+#include "nova_renderer/util/result.hpp"
 
 #include "resource_loader.hpp"
 #include "rhi/pipeline_create_info.hpp"
@@ -24,8 +25,71 @@ namespace nova::renderer {
     }
 
 #pragma region Structs for rendering
+    /*!
+     * \brief The render commands of a mesh batch, and how many of them are visible
+     *
+     * Change `commands` through the functions here, so that `num_visible_commands` stays correct. The rendergraph reads that count
+     * every frame to decide what to draw, instead of scanning every command
+     */
+    template <typename RenderCommandType>
+    struct RenderCommandBatch {
+        rx::vector<RenderCommandType> commands;
+
+        uint32_t num_visible_commands = 0;
+
+        void add_command(const RenderCommandType& command) {
+            commands.push_back(command);
+            if(command.is_visible) {
+                num_visible_commands++;
+            }
+        }
+
+        /*!
+         * \brief Removes the command for the renderable with the provided ID
+         *
+         * \return True if the batch had a command for the renderable, false otherwise
+         */
+        bool remove_command(const RenderableId id) {
+            const auto idx = commands.find_if([&](const RenderCommandType& command) { return command.id == id; });
+            if(idx == rx::vector<RenderCommandType>::k_npos) {
+                return false;
+            }
+
+            if(commands[idx].is_visible) {
+                num_visible_commands--;
+            }
+            commands.erase(idx, idx + 1);
+
+            return true;
+        }
+
+        /*!
+         * \brief Shows or hides the command for the renderable with the provided ID
+         *
+         * \return True if the batch had a command for the renderable, false otherwise
+         */
+        bool set_command_visible(const RenderableId id, const bool is_visible) {
+            const auto idx = commands.find_if([&](const RenderCommandType& command) { return command.id == id; });
+            if(idx == rx::vector<RenderCommandType>::k_npos) {
+                return false;
+            }
+
+            auto& command = commands[idx];
+            if(command.is_visible != is_visible) {
+                command.is_visible = is_visible;
+                if(is_visible) {
+                    num_visible_commands++;
+                } else {
+                    num_visible_commands--;
+                }
+            }
+
+            return true;
+        }
+    };
+
     template <typename RenderCommandType>
-    struct MeshBatch {
+    struct MeshBatch : RenderCommandBatch<RenderCommandType> {
         size_t num_vertex_attributes{};
         uint32_t num_indices{};
 
@@ -41,12 +105,10 @@ namespace nova::renderer {
          * more renderables than the buffer can hold, it gets reallocated from the RHI
          */
         rhi::RhiBuffer* per_renderable_data = nullptr;
-
-        rx::vector<RenderCommandType> commands;
     };
 
     template <typename RenderCommandType>
-    struct ProceduralMeshBatch {
+    struct ProceduralMeshBatch : RenderCommandBatch<RenderCommandType> {
         MapAccessor<MeshId, ProceduralMesh> mesh;
 
         /*!
@@ -59,8 +121,6 @@ namespace nova::renderer {
          */
         rhi::RhiBuffer* per_renderable_data = nullptr;
 
-        rx::vector<RenderCommandType> commands;
-
         ProceduralMeshBatch(rx::map<MeshId, ProceduralMesh>* meshes, const MeshId key) : mesh(meshes, key) {}
     };
 
@@ -73,6 +133,13 @@ namespace nova::renderer {
 
         void record(rhi::CommandList& cmds, FrameContext& ctx) const;
 
+        /*!
+         * \brief Counts the draws that `record` would record, which is the number of mesh batches that have visible renderables
+         *
+         * This reads each mesh batch's count of visible commands, so it doesn't look at the commands themselves
+         */
+        [[nodiscard]] uint32_t get_num_draws() const;
+
         static void record_rendering_static_mesh_batch(const MeshBatch<StaticMeshRenderCommand>& batch,
                                                        rhi::CommandList& cmds,
                                                        FrameContext& ctx);
@@ -83,9 +150,40 @@ namespace nova::renderer {
 
     struct Pipeline {
         rhi::RhiPipeline* pipeline = nullptr;
+
+        /*!
+         * \brief The interface of the pipeline whose material passes this pipeline draws
+         *
+         * If `pipeline` is a fallback for a pipeline that's still compiling, this is the compiling pipeline's interface
+         */
         rhi::RhiPipelineInterface* pipeline_interface = nullptr;
 
+        /*!
+         * \brief Whether this is a compute pipeline, which dispatches once for each of its material passes instead of drawing meshes
+         */
+        bool is_compute = false;
+
+        /*!
+         * \brief The number of workgroups in each of a compute pipeline's dispatches
+         */
+        glm::uvec3 workgroup_count{1, 1, 1};
+
+        /*!
+         * \brief The size of a compute pipeline's workgroups, or zero if the workgroup count doesn't depend on the size of the pass's output
+         */
+        glm::uvec3 workgroup_size{0, 0, 0};
+
+        /*!
+         * \brief Records the material passes of this pipeline which have something to draw
+         *
+         * The pipeline is only bound if at least one material pass has something to draw
+         */
         void record(rhi::CommandList& cmds, FrameContext& ctx) const;
+
+        /*!
+         * \brief Counts the draws or dispatches that `record` would record in the current frame
+         */
+        [[nodiscard]] uint32_t get_num_draws(FrameContext& ctx) const;
     };
 #pragma endregion
 
@@ -146,6 +244,28 @@ namespace nova::renderer {
         rhi::RhiRenderpass* renderpass = nullptr;
         rhi::RhiFramebuffer* framebuffer = nullptr;
 
+        /*!
+         * \brief The renderpass that this renderpass is a subpass of, if the rendergraph merged it with the renderpasses next to it
+         *
+         * If this is nullptr, this renderpass renders with `renderpass` and `framebuffer`
+         */
+        rhi::RhiRenderpass* merged_renderpass = nullptr;
+
+        /*!
+         * \brief The framebuffer of `merged_renderpass`
+         */
+        rhi::RhiFramebuffer* merged_framebuffer = nullptr;
+
+        /*!
+         * \brief The index of this renderpass's subpass in `merged_renderpass`
+         */
+        uint32_t subpass_index = 0;
+
+        /*!
+         * \brief Whether this renderpass is the last subpass of `merged_renderpass`, and has to end it
+         */
+        bool is_last_subpass = true;
+
         /*!
          * \brief Names of all the pipelines which are in this renderpass
          */
@@ -153,8 +273,53 @@ namespace nova::renderer {
 
         bool writes_to_backbuffer = false;
 
-        rx::vector<rhi::RhiResourceBarrier> read_texture_barriers;
-        rx::vector<rhi::RhiResourceBarrier> write_texture_barriers;
+        /*!
+         * \brief Whether this renderpass dispatches compute pipelines
+         *
+         * Compute renderpasses have no RHI renderpass or framebuffer. They write their outputs as storage images
+         */
+        bool is_compute = false;
+
+        /*!
+         * \brief Whether this compute renderpass may run on the async compute queue
+         *
+         * Compute renderpasses which use buffers always run on the graphics queue
+         */
+        bool allows_async_compute = false;
+
+        /*!
+         * \brief Whether this renderpass renders at the dynamic render scale
+         *
+         * When the render scale is below 1, this renderpass only renders to the top-left part of its outputs. See
+         * `NovaSettings::dynamic_resolution`
+         */
+        bool scales_with_resolution = false;
+
+        /*!
+         * \brief The size of this renderpass's outputs, in pixels
+         */
+        glm::uvec2 output_size{0};
+
+        /*!
+         * \brief Render targets that this renderpass reads from
+         *
+         * The rendergraph transitions these before the renderpass executes
+         */
+        rx::vector<rhi::RhiImage*> read_textures;
+
+        /*!
+         * \brief Render targets that this renderpass reads through input attachments
+         *
+         * These are also in `read_textures`
+         */
+        rx::vector<rhi::RhiImage*> input_attachments;
+
+        /*!
+         * \brief Render targets that this renderpass renders to, including its depth texture
+         *
+         * The rendergraph transitions these before the renderpass executes
+         */
+        rx::vector<rhi::RhiImage*> write_textures;
 
         /*!
          * \brief Performs the rendering work of this renderpass
@@ -169,17 +334,49 @@ namespace nova::renderer {
          * \param ctx The context for the current frame. Contains information about the available resources, the current frame, and
          * everything you should need to render. If there's something you need that isn't in the frame context, submit an issue on the Nova
          * GitHub
+         *
+         * \param recorded_contents A secondary command list that `record_contents` already recorded this renderpass's contents into, or
+         * nullptr to record the contents directly into `cmds`
+         */
+        virtual void execute(rhi::CommandList& cmds, FrameContext& ctx, rhi::CommandList* recorded_contents = nullptr);
+
+        /*!
+         * \brief Records the contents of this renderpass into a secondary command list, so that `execute` can execute it later
+         *
+         * Nova calls this method on one of its recording threads, at the same time as other renderpasses record their contents. It runs
+         * before `execute` calls `setup_renderpass`, so `record_renderpass_contents` must not depend on anything `setup_renderpass` does
+         * on the CPU
+         *
+         * \param cmds A secondary command list that was created for this renderpass
+         * \param ctx The context for the current frame
          */
-        virtual void execute(rhi::CommandList& cmds, FrameContext& ctx);
+        void record_contents(rhi::CommandList& cmds, FrameContext& ctx);
 
         /*!
          * \brief Returns the framebuffer that this renderpass should render to
          */
         [[nodiscard]] rhi::RhiFramebuffer* get_framebuffer(const FrameContext& ctx) const;
 
+        /*!
+         * \brief Returns the renderpass that this renderpass should render in, which is `merged_renderpass` if it has one
+         */
+        [[nodiscard]] rhi::RhiRenderpass* get_renderpass() const;
+
+        /*!
+         * \brief Counts the draws that this renderpass records in the current frame
+         *
+         * The rendergraph skips renderpasses which have no draws, if nothing depends on them clearing their outputs. The default
+         * implementation counts the draws of the pipelines in `pipeline_names`, so renderpasses which record other work must override
+         * this method or be builtin
+         */
+        [[nodiscard]] virtual uint32_t get_num_draws(FrameContext& ctx) const;
+
     protected:
         /*!
-         * \brief Records all the resource barriers that need to take place before this renderpass renders anything
+         * \brief Records any resource barriers that need to take place before this renderpass renders anything
+         *
+         * The rendergraph already transitions `read_textures`, `write_textures`, and the backbuffer, so the default implementation does
+         * nothing. Override this method if your renderpass uses other resources
          *
          * By default `render` calls this method before calling `setup_renderpass`. If you override `render`, you'll need to call
          * this method yourself before using any of this renderpass's resources
@@ -212,12 +409,99 @@ namespace nova::renderer {
         virtual void record_renderpass_contents(rhi::CommandList& cmds, FrameContext& ctx);
 
         /*!
-         * \brief Records all the resource barriers that need to take place after this renderpass renders anything
+         * \brief Records any resource barriers that need to take place after this renderpass renders anything
+         *
+         * The default implementation does nothing
          *
          * By default `render` calls this method after calling `render_renderpass_contents`. If you override `render`, you'll need to call
          * this method yourself near the end of your `render` method
          */
         virtual void record_post_renderpass_barriers(rhi::CommandList& cmds, FrameContext& ctx) const;
+
+        /*!
+         * \brief Limits the viewport and scissor rect to the part of the outputs that this renderpass renders to at the current render
+         * scale
+         *
+         * Does nothing unless `scales_with_resolution` is true. The default `execute` and `record_contents` call this method right after
+         * the renderpass or subpass begins, so if you override `execute`, you'll need to call it yourself
+         */
+        void set_scaled_viewport(rhi::CommandList& cmds, const FrameContext& ctx) const;
+    };
+
+    /*!
+     * \brief A resource transition that the rendergraph computed when it was compiled
+     */
+    struct RendergraphTransition {
+        /*!
+         * \brief The resource to transition, or nullptr to transition the swapchain image of the current frame
+         */
+        rhi::RhiResource* resource = nullptr;
+
+        rhi::ResourceState state = rhi::ResourceState::Undefined;
+
+        rx::optional<rhi::PipelineStage> stages;
+
+        /*!
+         * \brief If not nullptr, `resource` takes over the memory of this resource, and `state` and `stages` are ignored
+         */
+        rhi::RhiResource* previous_resource = nullptr;
+    };
+
+    /*!
+     * \brief A renderpass in the compiled rendergraph
+     *
+     * The transitions are ranges in the rendergraph's array of transitions, so that executing the rendergraph only has to walk two flat
+     * arrays. The transitions before a renderpass may include the transitions of later renderpasses, so that they share a barrier
+     */
+    struct CompiledRenderpass {
+        Renderpass* renderpass = nullptr;
+
+        uint32_t first_transition_before = 0;
+        uint32_t num_transitions_before = 0;
+
+        uint32_t first_transition_after = 0;
+        uint32_t num_transitions_after = 0;
+
+        /*!
+         * \brief Whether the renderpass can be left out of frames where it has nothing to draw
+         *
+         * This is false for builtin renderpasses, renderpasses which write to the backbuffer, merged renderpasses, and renderpasses which
+         * clear a texture that another renderpass uses
+         */
+        bool can_skip = false;
+
+        /*!
+         * \brief Whether the renderpass is left out of the current frame
+         *
+         * A skipped renderpass's transitions are still recorded, since the transitions of later renderpasses depend on them. The command
+         * list merges them with the transitions of the next renderpass, so they don't cost a barrier of their own
+         */
+        bool is_skipped = false;
+
+        /*!
+         * \brief The queue that the renderpass executes on
+         *
+         * Only compute renderpasses which allow async compute execute on the async compute queue
+         */
+        rhi::QueueType queue = rhi::QueueType::Graphics;
+    };
+
+    /*!
+     * \brief A range of compiled renderpasses which are submitted to a queue together
+     *
+     * Renderpasses on the async compute queue are each submitted on their own, so that the graphics queue only waits for the compute
+     * renderpasses that it depends on
+     */
+    struct RendergraphSubmission {
+        rhi::QueueType queue = rhi::QueueType::Graphics;
+
+        uint32_t first_renderpass = 0;
+        uint32_t num_renderpasses = 0;
+
+        /*!
+         * \brief The indices of the earlier submissions which must finish before this submission starts
+         */
+        rx::vector<uint32_t> wait_submissions;
     };
 
     /*!
@@ -267,13 +551,115 @@ namespace nova::renderer {
 
         void destroy_renderpass(const rx::string& name);
 
-        [[nodiscard]] rx::vector<rx::string> calculate_renderpass_execution_order();
+        /*!
+         * \brief Merges renderpasses which are next to each other in the execution order into the subpasses of one renderpass
+         *
+         * A renderpass joins the renderpass before it when it reads some of that renderpass's outputs through input attachments, it has
+         * the same framebuffer size, it doesn't sample any texture that the merged renderpass writes, and the merged renderpass doesn't
+         * read any texture that it writes. Builtin renderpasses and renderpasses which write to the backbuffer are never merged. Merged
+         * renderpasses keep their outputs in tile memory between subpasses on GPUs which have it
+         *
+         * Adding or destroying a renderpass splits the merged renderpasses up again, so call this after adding all the renderpasses and
+         * before creating the pipelines which render in them
+         */
+        void merge_renderpasses();
+
+        /*!
+         * \brief Updates the renderpasses after some render targets or the swapchain were resized
+         *
+         * Renderpasses which write to the backbuffer take the size of the swapchain. Renderpasses which render to a resized image get new
+         * framebuffers, and merged renderpasses which use a resized image get a new framebuffer for all their subpasses. The RHI
+         * renderpasses are kept, so pipelines don't need to be recreated
+         *
+         * \param resized_images The images that were resized
+         * \param resource_storage The storage to look up the new sizes of the render targets in
+         */
+        void resize_framebuffers(const rx::vector<rhi::RhiImage*>& resized_images, DeviceResources& resource_storage);
+
+        [[nodiscard]] const rx::vector<rx::string>& calculate_renderpass_execution_order();
+
+        /*!
+         * \brief Orders the rendergraph's renderpasses together with some renderpasses which haven't been added yet
+         *
+         * The order is the same as the execution order that the rendergraph will use once the new renderpasses are added in the order
+         * they're provided in, so this lets you plan resources for renderpasses before the renderpasses exist. A new renderpass replaces
+         * an existing renderpass with the same name
+         */
+        [[nodiscard]] ntl::Result<rx::vector<renderpack::RenderPassCreateInfo>> order_renderpasses_with(
+            const rx::vector<renderpack::RenderPassCreateInfo>& new_passes) const;
+
+        /*!
+         * \brief Gets all the renderpasses in execution order, compiling the rendergraph first if it's changed since it was last compiled
+         *
+         * The returned vector stays valid until a renderpass is added or destroyed
+         */
+        [[nodiscard]] const rx::vector<CompiledRenderpass>& get_compiled_renderpasses();
+
+        /*!
+         * \brief Gets the submissions that the compiled renderpasses are split into, in submission order
+         *
+         * The first submission and the last submission are always on the graphics queue, and the last submission waits for every
+         * submission that no other submission waits for. Only valid after `get_compiled_renderpasses`
+         */
+        [[nodiscard]] const rx::vector<RendergraphSubmission>& get_submissions() const;
+
+        /*!
+         * \brief Marks the compiled renderpasses which can be skipped and have nothing to draw in the current frame as skipped
+         *
+         * Call this after `get_compiled_renderpasses` and before recording any renderpasses. Skipped renderpasses must not be recorded
+         * or executed
+         */
+        void skip_empty_renderpasses(FrameContext& ctx);
+
+        /*!
+         * \brief Records the compiled renderpasses of one submission, along with the transitions between them
+         *
+         * Compute queues can't wait for graphics stages, so a graphics submission also records the transitions of the async compute
+         * submissions which directly follow it
+         *
+         * \param cmds The command list to record the renderpasses into. It must be for the submission's queue
+         * \param ctx The context for the current frame
+         * \param renderpass_contents One secondary command list per compiled renderpass that already has the renderpass's contents, or an
+         * empty vector to record the contents directly into `cmds`
+         * \param submission_idx The index of the submission in `get_submissions`
+         */
+        void execute(rhi::CommandList& cmds,
+                     FrameContext& ctx,
+                     const rx::vector<rhi::CommandList*>& renderpass_contents,
+                     uint32_t submission_idx) const;
 
         [[nodiscard]] Renderpass* get_renderpass(const rx::string& name) const;
 
         [[nodiscard]] rx::optional<RenderpassMetadata> get_metadata_for_renderpass(const rx::string& name) const;
 
+        /*!
+         * \brief Checks if a renderpass can become the next subpass of the renderpasses in `subpasses`
+         *
+         * The renderpass has to read the outputs of the subpasses through input attachments, and only through input attachments. It only
+         * looks at the renderpasses themselves, so the caller has to make sure that the renderpass comes right after the last subpass
+         *
+         * \param subpasses The renderpasses that are merged so far. Must not be empty
+         * \param renderpass The renderpass to check
+         * \param allocator The allocator for the check's temporary memory
+         */
+        [[nodiscard]] static bool can_merge(const rx::vector<Renderpass*>& subpasses,
+                                            const Renderpass& renderpass,
+                                            rx::memory::allocator* allocator);
+
     private:
+        /*!
+         * \brief Renderpasses which the rendergraph merged into the subpasses of one RHI renderpass
+         */
+        struct MergedRenderpass {
+            rhi::RhiRenderpass* renderpass = nullptr;
+            rhi::RhiFramebuffer* framebuffer = nullptr;
+
+            /*!
+             * \brief The renderpasses in subpass order
+             */
+            rx::vector<Renderpass*> subpasses;
+        };
+
         bool is_dirty = false;
 
         rx::memory::allocator* allocator;
@@ -284,6 +670,68 @@ namespace nova::renderer {
 
         rx::vector<rx::string> cached_execution_order;
         rx::map<rx::string, RenderpassMetadata> renderpass_metadatas;
+
+        /*!
+         * \brief The names of all the renderpasses in the order they were added
+         *
+         * The renderpasses are ordered from this list instead of from the maps, so that the execution order only depends on the
+         * renderpasses and the order they were added in
+         */
+        rx::vector<rx::string> renderpass_names;
+
+        bool is_compiled = false;
+
+        rx::vector<CompiledRenderpass> compiled_renderpasses;
+        rx::vector<RendergraphTransition> compiled_transitions;
+        rx::vector<RendergraphSubmission> compiled_submissions;
+
+        rx::vector<MergedRenderpass> merged_renderpasses;
+
+        /*!
+         * \brief Creates the RHI renderpass and framebuffer for renderpasses which can be merged, and makes them subpasses of it
+         */
+        void create_merged_renderpass(const rx::vector<Renderpass*>& subpasses);
+
+        /*!
+         * \brief Creates the framebuffer for renderpasses which are merged into one RHI renderpass
+         */
+        [[nodiscard]] rhi::RhiFramebuffer* create_merged_framebuffer(rhi::RhiRenderpass* renderpass,
+                                                                     const rx::vector<Renderpass*>& subpasses,
+                                                                     const glm::uvec2& framebuffer_size);
+
+        /*!
+         * \brief Destroys all the merged renderpasses, so that every renderpass renders on its own again
+         */
+        void split_merged_renderpasses();
+
+        /*!
+         * \brief Checks if a renderpass can be skipped in frames where it has nothing to draw
+         */
+        [[nodiscard]] bool can_skip_renderpass(const Renderpass& renderpass) const;
+
+        /*!
+         * \brief Flattens the renderpasses into `compiled_renderpasses`, and computes the transitions they need
+         *
+         * Transitions that are redundant within a frame are left out. The first time a resource is used each frame, the rendergraph
+         * always transitions it, since it doesn't know what the resource was doing before the frame started
+         *
+         * If none of the resources that a renderpass transitions were used since the last batch of transitions, its transitions are added
+         * to that batch, so that they share one barrier
+         *
+         * Before a renderpass uses an image which shares memory with other images, the rendergraph makes the image take over the memory
+         * from the image that used it last. At the start of a frame, the memory belongs to the image that used it last in the frame before
+         *
+         * There can't be barriers between the subpasses of a merged renderpass, so all the transitions of a merged renderpass happen
+         * before its first subpass. Each image goes to the state of its first use in the merged renderpass, and the RHI renderpass
+         * handles the rest
+         *
+         * Compute renderpasses which allow async compute get a submission on the async compute queue, unless they use the memory of an
+         * async compute renderpass that the graphics queue hasn't waited for yet. A graphics renderpass which uses the memory of such a
+         * renderpass starts a new graphics submission that waits for it
+         */
+        void compile();
+
+        void record_transitions(rhi::CommandList& cmds, const FrameContext& ctx, uint32_t first_transition, uint32_t num_transitions) const;
     };
 
     template <typename RenderpassType, typename... Args>
@@ -363,6 +811,32 @@ namespace nova::renderer {
             return nullptr;
         }
 
+        rx::vector<rhi::RhiImage*> input_attachments;
+        input_attachments.reserve(create_info.input_attachments.size());
+
+        create_info.input_attachments.each_fwd([&](const renderpack::TextureAttachmentInfo& attachment_info) {
+            const auto render_target_opt = resource_storage.get_render_target(attachment_info.name);
+            if(!render_target_opt) {
+                rg_log(rx::log::level::k_error, "No render target named %s", attachment_info.name);
+                missing_render_targets = true;
+                return;
+            }
+
+            auto* image = (*render_target_opt)->image;
+            if(image->is_depth_tex) {
+                attachment_errors.push_back(rx::string::format(
+                    "Pass %s reads depth texture %s through an input attachment, but only color textures can be input attachments",
+                    create_info.name,
+                    attachment_info.name));
+            }
+
+            input_attachments.push_back(image);
+        });
+
+        if(missing_render_targets) {
+            return nullptr;
+        }
+
         // Can't combine these if statements and I don't want to `.find` twice
         const auto depth_attachment = [&]() -> rx::optional<rhi::RhiImage*> {
             if(create_info.depth_texture) {
@@ -374,6 +848,23 @@ namespace nova::renderer {
             return rx::nullopt;
         }();
 
+        if(create_info.is_compute) {
+            if(renderpass->writes_to_backbuffer) {
+                attachment_errors.push_back(rx::string::format(
+                    "Compute pass %s writes to the backbuffer, but compute passes can only write to render targets",
+                    create_info.name));
+            }
+            if(create_info.depth_texture) {
+                attachment_errors.push_back(
+                    rx::string::format("Compute pass %s has a depth texture, but compute passes can't use depth textures", create_info.name));
+            }
+            if(!input_attachments.is_empty()) {
+                attachment_errors.push_back(rx::string::format(
+                    "Compute pass %s has input attachments, but only graphics passes can have input attachments",
+                    create_info.name));
+            }
+        }
+
         if(!attachment_errors.is_empty()) {
             attachment_errors.each_fwd([&](const rx::string& err) { rg_log(rx::log::level::k_error, "%s", err); });
 
@@ -384,34 +875,71 @@ namespace nova::renderer {
             return nullptr;
         }
 
-        ntl::Result<rhi::RhiRenderpass*> renderpass_result = device.create_renderpass(create_info, framebuffer_size, allocator);
-        if(renderpass_result) {
-            renderpass->renderpass = renderpass_result.value;
+        // Compute passes write their outputs from shaders, so they don't need a renderpass or a framebuffer
+        if(!create_info.is_compute) {
+            ntl::Result<rhi::RhiRenderpass*> renderpass_result = device.create_renderpass(create_info, framebuffer_size, allocator);
+            if(renderpass_result) {
+                renderpass->renderpass = renderpass_result.value;
 
-        } else {
-            rg_log(rx::log::level::k_error, "Could not create renderpass %s: %s", create_info.name, renderpass_result.error.to_string());
-            return nullptr;
+            } else {
+                rg_log(rx::log::level::k_error, "Could not create renderpass %s: %s", create_info.name, renderpass_result.error.to_string());
+                return nullptr;
+            }
         }
 
         // Backbuffer framebuffers are owned by the swapchain, not the renderpass that writes to them, so if the
         // renderpass writes to the backbuffer then we don't need to create a framebuffer for it
-        if(!renderpass->writes_to_backbuffer) {
+        if(!create_info.is_compute && !renderpass->writes_to_backbuffer) {
+            // The renderpass's attachments are its outputs followed by the input attachments which aren't also outputs
+            auto framebuffer_attachments = color_attachments;
+            input_attachments.each_fwd([&](rhi::RhiImage* image) {
+                if(framebuffer_attachments.find(image) == rx::vector<rhi::RhiImage*>::k_npos) {
+                    framebuffer_attachments.push_back(image);
+                }
+            });
+
             renderpass->framebuffer = device.create_framebuffer(renderpass->renderpass,
-                                                                color_attachments,
+                                                                framebuffer_attachments,
                                                                 depth_attachment,
                                                                 framebuffer_size,
                                                                 allocator);
         }
 
+        renderpass->write_textures = color_attachments;
+        if(depth_attachment) {
+            renderpass->write_textures.push_back(*depth_attachment);
+        }
+
+        // Texture inputs which aren't render targets are never rendered to, so they're always ready to be read
+        create_info.texture_inputs.each_fwd([&](const rx::string& texture_name) {
+            if(const auto render_target = resource_storage.get_render_target(texture_name); render_target) {
+                renderpass->read_textures.push_back((*render_target)->image);
+            }
+        });
+
+        renderpass->input_attachments = input_attachments;
+
+        renderpass->is_compute = create_info.is_compute;
+
+        // The rendergraph only knows which render targets a renderpass uses, so it can only make a renderpass wait for another queue's
+        // renderpasses if they share render targets
+        renderpass->allows_async_compute = create_info.allows_async_compute && create_info.input_buffers.is_empty() &&
+                                           create_info.output_buffers.is_empty();
+        renderpass->output_size = framebuffer_size;
+
         renderpass->pipeline_names = create_info.pipeline_names;
         renderpass->id = static_cast<uint32_t>(renderpass_metadatas.size());
 
+        split_merged_renderpasses();
+
         destroy_renderpass(create_info.name);
 
         renderpasses.insert(create_info.name, renderpass);
         renderpass_metadatas.insert(create_info.name, metadata);
+        renderpass_names.push_back(create_info.name);
 
         is_dirty = true;
+        is_compiled = false;
 
         return renderpass;
     }
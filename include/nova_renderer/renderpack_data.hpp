@@ -290,6 +290,19 @@ namespace nova::renderer::renderpack {
         rx::optional<RenderpackShaderSource> tessellation_evaluation_shader;
         rx::optional<RenderpackShaderSource> fragment_shader;
 
+        /*!
+         * \brief The compute shader of this pipeline. If this is set, this is a compute pipeline, and it has no other shaders
+         */
+        rx::optional<RenderpackShaderSource> compute_shader;
+
+        /*!
+         * \brief How many workgroups each of this compute pipeline's dispatches launches
+         *
+         * If this isn't set, Nova launches enough workgroups to cover the size of the pipeline's pass, using the workgroup size that
+         * the compute shader declares
+         */
+        rx::optional<glm::uvec3> workgroup_count;
+
         static PipelineData from_json(const rx::json& json);
     };
 
@@ -434,6 +447,14 @@ namespace nova::renderer::renderpack {
          */
         rx::vector<rx::string> texture_inputs{};
 
+        /*!
+         * \brief The color textures that this pass only reads at the pixel it's shading, through `subpassInput`s
+         *
+         * Every input attachment is also in `texture_inputs`. Nova can merge this pass into the same renderpass as the passes which write
+         * its input attachments, so that the attachments never have to leave tile memory
+         */
+        rx::vector<TextureAttachmentInfo> input_attachments{};
+
         /*!
          * \brief The textures that this pass will write to
          */
@@ -459,6 +480,18 @@ namespace nova::renderer::renderpack {
          */
         rx::vector<rx::string> pipeline_names;
 
+        /*!
+         * \brief Whether this pass dispatches compute pipelines instead of drawing with graphics pipelines
+         *
+         * Compute passes don't have a renderpass or framebuffer. They write their texture outputs as storage images
+         */
+        bool is_compute = false;
+
+        /*!
+         * \brief Whether this compute pass may run on the async compute queue, alongside the graphics passes that it doesn't depend on
+         */
+        bool allows_async_compute = false;
+
         RenderPassCreateInfo() = default;
 
         static RenderPassCreateInfo from_json(const rx::json& json);
@@ -18,4 +18,12 @@ namespace nova::renderer::renderpack {
 
     rx::optional<PipelineStateCreateInfo> to_pipeline_state_create_info(const renderpack::PipelineData& data,
                                                                         const Rendergraph& rendergraph);
+
+    /*!
+     * \brief Converts a pipeline with a compute shader to a compute pipeline create info
+     *
+     * If the pipeline doesn't say how many workgroups to launch, it launches enough to cover the size of its pass's outputs
+     */
+    rx::optional<ComputePipelineCreateInfo> to_compute_pipeline_create_info(const renderpack::PipelineData& data,
+                                                                            const Rendergraph& rendergraph);
 };
@@ -93,6 +93,7 @@ namespace nova::renderer {
          * \param allocator The allocator to use for any host memory this methods needs to allocate
          * \param can_be_sampled If true, the render target may be sampled by a shader. If false, this render target may only be presented
          * to the screen
+         * \param aliased_image The image whose memory the render target should use, or nullptr to give the render target its own memory
          *
          * \return The new render target if it could be created, or am empty optional if it could not
          */
@@ -101,7 +102,24 @@ namespace nova::renderer {
                                                                                   rx_size height,
                                                                                   rhi::PixelFormat pixel_format,
                                                                                   rx::memory::allocator* allocator,
-                                                                                  bool can_be_sampled = false);
+                                                                                  bool can_be_sampled = false,
+                                                                                  rhi::RhiImage* aliased_image = nullptr);
+
+        /*!
+         * \brief Changes the size of a render target
+         *
+         * The render target keeps its RhiImage, so anything that refers to the image stays valid. Its contents are lost, framebuffers which
+         * use it must be recreated, and descriptor sets which refer to it must be written again. A render target which aliases another
+         * image keeps aliasing it if it still fits in the other image's memory
+         *
+         * \param name The name of the render target
+         * \param width The new width of the render target, in pixels
+         * \param height The new height of the render target, in pixels
+         * \param allocator The allocator to use for any host memory this methods needs to allocate
+         *
+         * \return True if the render target was resized, false if it doesn't exist or couldn't be recreated
+         */
+        bool resize_render_target(const rx::string& name, rx_size width, rx_size height, rx::memory::allocator* allocator);
 
         /*!
          * \brief Retrieves the render target with the specified name
@@ -113,7 +131,7 @@ namespace nova::renderer {
         /*!
          * \brief Retrieves a staging buffer at least the specified size
          *
-         * The actual buffer returned may be larger than what you need
+         * The size is rounded up to a power of two, so the actual buffer returned may be larger than what you need
          *
          * When you're done with the staging buffer, return it to the pool with `return_staging_buffer`
          */
@@ -140,8 +158,18 @@ namespace nova::renderer {
 
         rx::map<rx::string, BufferResource> uniform_buffers;
 
+        /*!
+         * \brief Transitions a render target into the state that renderpasses expect it to be in, and waits for the transition to finish
+         */
+        void transition_to_render_target_state(const TextureResource& resource, rx::memory::allocator* allocator);
+
         void allocate_staging_buffer_memory();
 
         void allocate_uniform_buffer_memory();
     };
+
+    /*!
+     * \brief Gets the number of bytes that one pixel with the given format uses
+     */
+    [[nodiscard]] size_t size_in_bytes(rhi::PixelFormat pixel_format);
 } // namespace nova::renderer
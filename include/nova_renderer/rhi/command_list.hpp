@@ -2,6 +2,9 @@
 
 #include <stdint.h> // needed for uint****
 
+#include <rx/core/optional.h>
+#include <rx/core/vector.h>
+
 #include "nova_renderer/rhi/forward_decls.hpp"
 #include "nova_renderer/rhi/rhi_enums.hpp"
 #include "nova_renderer/rhi/rhi_types.hpp"
@@ -25,6 +28,10 @@ namespace nova::renderer::rhi {
      *
      * A command list may only be recorded to from one thread at a time
      *
+     * Command lists track the state of every resource you transition with `transition_resource`, and generate the barriers needed to get
+     * each resource into the state you ask for. The tracked state is updated when commands are recorded, so command lists that
+     * transition the same resources must be submitted in the order they were recorded in
+     *
      * Command lists are fully bound to ChaiScript
      */
     class CommandList {
@@ -34,7 +41,29 @@ namespace nova::renderer::rhi {
             Secondary,
         };
 
-        CommandList() = default;
+        /*!
+         * \brief Where the commands inside a renderpass come from
+         */
+        enum class RenderpassContents {
+            /*!
+             * \brief The commands inside the renderpass are recorded directly into the command list that began the renderpass
+             */
+            Inline,
+
+            /*!
+             * \brief The renderpass only contains `execute_command_lists` commands, which execute secondary command lists that were
+             * created for this renderpass
+             */
+            SecondaryCommandLists,
+        };
+
+        /*!
+         * \brief Initializes the resource state tracking for this command list
+         *
+         * \param allocator The allocator to use for this command list's pending barriers. This should be the allocator that the command
+         * list itself is allocated from
+         */
+        explicit CommandList(rx::memory::allocator* allocator);
 
         CommandList(CommandList&& old) noexcept = default;
         CommandList& operator=(CommandList&& old) noexcept = default;
@@ -47,10 +76,50 @@ namespace nova::renderer::rhi {
          */
         virtual void set_debug_name(const rx::string& name) = 0;
 
+        /*!
+         * \brief Transitions a resource into a new state
+         *
+         * Nova doesn't record a barrier right away. Instead, it collects the transitions until the next command which might use a
+         * resource, then records all of them as a single barrier command. Transitioning a resource into the state it's already in doesn't
+         * generate a barrier, and transitioning a resource more than once before the next command only generates one barrier
+         *
+         * \param resource The resource to transition
+         * \param new_state The state that the resource should be in after the transition
+         * \param queue The queue which will use the resource after the transition. If another queue last used the resource, the
+         * barrier finishes that queue's work with it. Submit this command list with a semaphore that the new queue waits on
+         * \param stages The pipeline stages which will use the resource after the transition. Defaults to all the stages which can use a
+         * resource in `new_state`
+         */
+        void transition_resource(RhiResource* resource,
+                                 ResourceState new_state,
+                                 QueueType queue = QueueType::Graphics,
+                                 rx::optional<PipelineStage> stages = rx::nullopt);
+
+        /*!
+         * \brief Records a barrier for all the transitions since the last flush
+         *
+         * Command lists call this before every command which might use a resource, and render devices call this before submitting a
+         * command list, so you shouldn't need to call it yourself
+         */
+        void flush_barriers();
+
+        /*!
+         * \brief Records that a resource takes over memory which another resource used until now
+         *
+         * The contents of `resource` are discarded, and the next transition of `resource` waits for all the work that used
+         * `previous_resource` to finish
+         *
+         * \param previous_resource The resource which used the memory before
+         * \param resource The resource which uses the memory from now on
+         */
+        void alias_resource(const RhiResource* previous_resource, RhiResource* resource);
+
         /*!
          * \brief Inserts a barrier so that all access to a resource before the barrier is resolved before any access
          * to the resource after the barrier
          *
+         * This doesn't update the tracked state of the resources it barriers, so prefer `transition_resource`
+         *
          * \param stages_before_barrier The pipeline stages that should be completed before the barriers take effect
          * \param stages_after_barrier The pipeline stages that must wait for the barrier
          * \param barriers All the resource barriers to use
@@ -112,8 +181,20 @@ namespace nova::renderer::rhi {
          *
          * \param renderpass The renderpass to begin
          * \param framebuffer The framebuffer to render to
+         * \param contents Whether the commands inside the renderpass will be recorded into this command list or into secondary command
+         * lists
+         */
+        virtual void begin_renderpass(RhiRenderpass* renderpass,
+                                      RhiFramebuffer* framebuffer,
+                                      RenderpassContents contents = RenderpassContents::Inline) = 0;
+
+        /*!
+         * \brief Moves on to the next subpass of the current renderpass
+         *
+         * \param contents Whether the commands inside the next subpass will be recorded into this command list or into secondary command
+         * lists
          */
-        virtual void begin_renderpass(RhiRenderpass* renderpass, RhiFramebuffer* framebuffer) = 0;
+        virtual void next_subpass(RenderpassContents contents = RenderpassContents::Inline) = 0;
 
         virtual void end_renderpass() = 0;
 
@@ -150,6 +231,68 @@ namespace nova::renderer::rhi {
 
         virtual void set_scissor_rect(uint32_t x, uint32_t y, uint32_t width, uint32_t height) = 0;
 
+        /*!
+         * \brief Sets the part of the framebuffer that draws render to
+         *
+         * Every pipeline has a dynamic viewport, which `begin_renderpass` sets to the whole framebuffer. The depth range is always 0 to 1
+         */
+        virtual void set_viewport(float x, float y, float width, float height) = 0;
+
+        /*!
+         * \brief Records a dispatch of the currently bound compute pipeline
+         *
+         * \param num_groups_x The number of workgroups to launch in the X dimension
+         * \param num_groups_y The number of workgroups to launch in the Y dimension
+         * \param num_groups_z The number of workgroups to launch in the Z dimension
+         */
+        virtual void dispatch(uint32_t num_groups_x, uint32_t num_groups_y = 1, uint32_t num_groups_z = 1) = 0;
+
+        /*!
+         * \brief Records a dispatch of the currently bound compute pipeline, reading the number of workgroups from a buffer
+         *
+         * \param buffer The buffer to read the workgroup counts from. It must be in the `IndirectBuffer` state
+         * \param offset The offset in the buffer of three tightly-packed `uint32_t`s with the X, Y, and Z workgroup counts
+         */
+        virtual void dispatch_indirect(const RhiBuffer* buffer, mem::Bytes offset = 0) = 0;
+
+        /*!
+         * \brief Resets some queries so that the GPU can write them again
+         *
+         * Must be recorded outside of a renderpass, before any command that writes the queries
+         */
+        virtual void reset_queries(RhiQueryPool* pool, uint32_t first_query, uint32_t num_queries) = 0;
+
+        /*!
+         * \brief Writes the GPU's timestamp into a query once all the commands before this one have reached a pipeline stage
+         *
+         * The query must have been reset since it was last written. Inside a renderpass whose contents are secondary command lists, the
+         * timestamp must be written by one of the secondary command lists
+         *
+         * \param pool The pool that the query is in
+         * \param query_idx The index of the query in the pool
+         * \param stage The pipeline stage to wait for. Must be a single stage
+         */
+        virtual void write_timestamp(RhiQueryPool* pool, uint32_t query_idx, PipelineStage stage) = 0;
+
         virtual ~CommandList() = default;
+
+    private:
+        /*!
+         * \brief A transition which hasn't been recorded yet
+         */
+        struct ResourceTransition {
+            RhiResource* resource;
+
+            ResourceState old_state;
+            ResourceAccess old_access;
+            PipelineStage old_stages;
+            QueueType old_queue;
+
+            ResourceState new_state;
+            PipelineStage new_stages;
+            QueueType new_queue;
+        };
+
+        rx::vector<ResourceTransition> pending_transitions;
     };
 } // namespace nova::renderer::rhi
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <rx/core/concurrency/mutex.h>
+#include <rx/core/optional.h>
+
 #include "nova_renderer/memory/allocation_strategy.hpp"
 #include "nova_renderer/memory/allocation_structs.hpp"
 #include "nova_renderer/memory/bytes.hpp"
@@ -10,20 +13,50 @@ using namespace nova::mem::operators;
 namespace nova::renderer {
     struct DeviceMemoryAllocation {
         rhi::RhiDeviceMemory* memory = nullptr;
+
+        /*!
+         * \brief The allocation that the allocation strategy made. Give it back with `DeviceMemoryResource::free`
+         */
         mem::AllocationInfo allocation_info;
+
+        /*!
+         * \brief Where the allocated memory starts in `memory`
+         *
+         * This may be after `allocation_info.offset`, so that the memory has the alignment that was asked for
+         */
+        mem::Bytes offset{0};
     };
 
     /*!
      * \brief Couples an allocation strategy with a device memory object, allowing you to subdivide the device memory for use in individual
      * buffers, textures, etc
+     *
+     * Safe to use from multiple threads
      */
     struct DeviceMemoryResource {
         DeviceMemoryResource(rhi::RhiDeviceMemory* memory, mem::AllocationStrategy* allocation_strategy);
 
-        [[nodiscard]] DeviceMemoryAllocation allocate(mem::Bytes size) const;
+        /*!
+         * \brief Allocates some of the device memory
+         *
+         * \param size The number of bytes to allocate
+         * \param alignment The alignment of the allocated memory's offset in the device memory, or 0 for the allocation strategy's
+         * alignment
+         *
+         * \return The allocation, or an empty optional if the allocation strategy doesn't have enough free memory
+         */
+        [[nodiscard]] rx::optional<DeviceMemoryAllocation> allocate(mem::Bytes size, mem::Bytes alignment = 0_b);
+
+        /*!
+         * \brief Gives an allocation back to the allocation strategy
+         */
+        void free(const DeviceMemoryAllocation& allocation);
 
         mem::AllocationStrategy* allocation_strategy;
 
         rhi::RhiDeviceMemory* memory;
+
+    private:
+        rx::concurrency::mutex mutex;
     };
 } // namespace nova::renderer
@@ -17,6 +17,7 @@ namespace nova::renderer::rhi {
     struct RhiSampler;
     struct RhiPresentSemaphore;
     struct RhiDescriptorPool;
+    struct RhiQueryPool;
 
     class Swapchain;
     class CommandList;
@@ -371,7 +371,10 @@ namespace nova::renderer {
         rx::vector<rhi::RhiVertexField> vertex_fields{};
 
         /*!
-         * \brief Size of the viewport that this pipeline state renders to, measured in pixels
+         * \brief Size of the viewport that this pipeline state renders to, measured in pixels, when the pipeline was created
+         *
+         * The viewport is dynamic state, and command lists set it to the size of the framebuffer when they begin a renderpass, so
+         * pipelines keep working after their render targets are resized
          */
         glm::vec2 viewport_size{};
 
@@ -426,5 +429,41 @@ namespace nova::renderer {
          * \brief The depth texture that this pipeline writes to, if it writes to a depth texture
          */
         rx::optional<renderpack::TextureAttachmentInfo> depth_texture{};
+
+        /*!
+         * \brief The renderpass that this pipeline renders in
+         *
+         * If this is nullptr, the pipeline renders in a renderpass which only has `color_attachments` and `depth_texture`
+         */
+        const rhi::RhiRenderpass* renderpass = nullptr;
+
+        /*!
+         * \brief The subpass of `renderpass` that this pipeline renders in
+         */
+        uint32_t subpass_index = 0;
+    };
+
+    /*!
+     * \brief All the data needed for the RHI to create a compute pipeline
+     */
+    struct ComputePipelineCreateInfo {
+        rx::string name{};
+
+        ShaderSource compute_shader{};
+
+        /*!
+         * \brief How many workgroups each dispatch with this pipeline launches
+         *
+         * The RHI doesn't use this, it's here so that the renderer knows how big to make its dispatches
+         */
+        glm::uvec3 workgroup_count{1, 1, 1};
+
+        /*!
+         * \brief The size of the compute shader's workgroups, if `workgroup_count` was derived from the size of the pass's output
+         *
+         * Zero if the renderpack set the workgroup count itself. The renderer uses this to recompute the workgroup count when the pass's
+         * output is resized
+         */
+        glm::uvec3 workgroup_size{0, 0, 0};
     };
 } // namespace nova::renderer
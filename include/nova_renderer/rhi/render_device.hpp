@@ -11,6 +11,7 @@
 
 namespace nova::renderer {
     struct PipelineStateCreateInfo;
+    struct ComputePipelineCreateInfo;
     struct DeviceMemoryResource;
 } // namespace nova::renderer
 
@@ -50,9 +51,17 @@ namespace nova::renderer::rhi {
 
         bool supports_raytracing = false;
         bool supports_mesh_shaders = false;
-    };
 
-#define NUM_THREADS 1
+        /*!
+         * \brief Whether command lists on the graphics and compute queues can write timestamps
+         */
+        bool supports_timestamps = false;
+
+        /*!
+         * \brief The number of nanoseconds between two ticks of the GPU's timestamp counter
+         */
+        float timestamp_period = 1;
+    };
 
     /*!
      * \brief Interface to a logical device which can render to an operating system window
@@ -97,6 +106,27 @@ namespace nova::renderer::rhi {
                                                                          const glm::uvec2& framebuffer_size,
                                                                          rx::memory::allocator* allocator) = 0;
 
+        /*!
+         * \brief Creates one renderpass with a subpass for each of the provided renderpasses, in the order they're provided in
+         *
+         * Each subpass may read the attachments that the subpasses before it wrote through its input attachments. The attachments of
+         * the renderpass are the color outputs and then the input attachments of each subpass in order, leaving out attachments that an
+         * earlier subpass already uses, followed by the depth texture. Framebuffers for the renderpass must provide their color
+         * attachments in that order. All subpasses which have a depth texture must use the same one
+         *
+         * At the end of the renderpass every attachment is back in the state that its first subpass used it in
+         *
+         * \param subpasses The renderpasses to create subpasses from
+         * \param framebuffer_size The size in pixels of the framebuffer that the renderpass will write to
+         * \param allocator The allocator to allocate the renderpass from
+         *
+         * \return The newly created renderpass
+         */
+        [[nodiscard]] virtual ntl::Result<RhiRenderpass*> create_merged_renderpass(
+            const rx::vector<renderpack::RenderPassCreateInfo>& subpasses,
+            const glm::uvec2& framebuffer_size,
+            rx::memory::allocator* allocator) = 0;
+
         [[nodiscard]] virtual RhiFramebuffer* create_framebuffer(const RhiRenderpass* renderpass,
                                                               const rx::vector<RhiImage*>& color_attachments,
                                                               const rx::optional<RhiImage*> depth_attachment,
@@ -124,8 +154,19 @@ namespace nova::renderer::rhi {
                                                                      const PipelineStateCreateInfo& data,
                                                                      rx::memory::allocator* allocator) = 0;
 
+        [[nodiscard]] virtual ntl::Result<RhiPipeline*> create_compute_pipeline(RhiPipelineInterface* pipeline_interface,
+                                                                             const ComputePipelineCreateInfo& data,
+                                                                             rx::memory::allocator* allocator) = 0;
+
         /*!
          * \brief Creates a buffer with undefined contents
+         *
+         * The buffer is placed in memory that's allocated from `memory`. If `memory` doesn't have enough room, or its memory type can't
+         * hold the buffer, the buffer gets memory of its own instead
+         *
+         * \param info What kind of buffer to create
+         * \param memory The memory to place the buffer in. Must outlive the buffer
+         * \param allocator The allocator to allocate the buffer object with
          */
         [[nodiscard]] virtual RhiBuffer* create_buffer(const RhiBufferCreateInfo& info,
                                                     DeviceMemoryResource& memory,
@@ -160,6 +201,42 @@ namespace nova::renderer::rhi {
         [[nodiscard]] virtual RhiImage* create_image(const renderpack::TextureCreateInfo& info,
                                                   rx::memory::allocator* allocator) = 0;
 
+        /*!
+         * \brief Creates an empty image which uses the same memory as another image
+         *
+         * Only one of the images may be used at a time. Use `CommandList::alias_resource` when switching from one image to the other
+         *
+         * If the new image doesn't fit in the other image's memory, it gets its own memory. Check `RhiImage::aliased_image` to find out
+         * if the images share memory
+         *
+         * \param info The image to create
+         * \param aliased_image The image whose memory to use. Must have its own memory
+         * \param allocator The allocator to allocate the image's host memory from
+         */
+        [[nodiscard]] virtual RhiImage* create_aliased_image(const renderpack::TextureCreateInfo& info,
+                                                          RhiImage* aliased_image,
+                                                          rx::memory::allocator* allocator) = 0;
+
+        /*!
+         * \brief Recreates an image from new create info, such as a new size
+         *
+         * The RhiImage object stays the same, so everything that points to it stays valid, but the image's contents are lost and it goes
+         * back to the Undefined state. Framebuffers which use the image must be recreated, and descriptor sets which use it must be
+         * written again. The GPU must not be using the image
+         *
+         * \param image The image to recreate
+         * \param info The new create info for the image
+         * \param aliased_image The image whose memory the image should use, or nullptr to give the image its own memory. Must have its
+         * own memory
+         * \param allocator The allocator that the image was created with
+         *
+         * \return True if the image was recreated, false if it couldn't be. An image which couldn't be recreated must not be used
+         */
+        [[nodiscard]] virtual bool recreate_image(RhiImage* image,
+                                                  const renderpack::TextureCreateInfo& info,
+                                                  RhiImage* aliased_image,
+                                                  rx::memory::allocator* allocator) = 0;
+
         [[nodiscard]] virtual RhiSemaphore* create_semaphore(rx::memory::allocator* allocator) = 0;
 
         [[nodiscard]] virtual rx::vector<RhiSemaphore*> create_semaphores(uint32_t num_semaphores,
@@ -182,6 +259,29 @@ namespace nova::renderer::rhi {
 
         virtual void reset_fences(const rx::vector<RhiFence*>& fences) = 0;
 
+        /*!
+         * \brief Creates a pool of timestamp queries
+         *
+         * Only valid if `DeviceInfo::supports_timestamps` is true. Reset the queries with `CommandList::reset_queries` before writing them
+         */
+        [[nodiscard]] virtual RhiQueryPool* create_timestamp_query_pool(uint32_t num_queries, rx::memory::allocator* allocator) = 0;
+
+        /*!
+         * \brief Reads the timestamps that the GPU wrote into some queries, without waiting for the GPU
+         *
+         * \param pool The pool to read the timestamps from
+         * \param first_query The index of the first query to read
+         * \param num_queries The number of queries to read
+         * \param allocator The allocator to allocate the returned vector from
+         *
+         * \return One timestamp per query, in ticks of the GPU's timestamp counter. Queries which the GPU hasn't written since they
+         * were reset are empty. Multiply the difference between two timestamps by `DeviceInfo::timestamp_period` to get nanoseconds
+         */
+        [[nodiscard]] virtual rx::vector<rx::optional<uint64_t>> get_timestamps(RhiQueryPool* pool,
+                                                                             uint32_t first_query,
+                                                                             uint32_t num_queries,
+                                                                             rx::memory::allocator* allocator) = 0;
+
         /*!
          * \brief Clean up any GPU objects a Renderpass may own
          *
@@ -222,6 +322,13 @@ namespace nova::renderer::rhi {
          */
         virtual void destroy_texture(RhiImage* resource, rx::memory::allocator* allocator) = 0;
 
+        /*!
+         * \brief Destroys a buffer, and gives its memory back to the DeviceMemoryResource that it was created from
+         *
+         * The GPU must not be using the buffer anymore
+         */
+        virtual void destroy_buffer(RhiBuffer* buffer, rx::memory::allocator* allocator) = 0;
+
         /*!
          * \brief Clean up any GPU objects a Semaphores may own
          *
@@ -238,8 +345,37 @@ namespace nova::renderer::rhi {
          */
         virtual void destroy_fences(const rx::vector<RhiFence*>& fences, rx::memory::allocator* allocator) = 0;
 
+        /*!
+         * \brief Clean up any GPU objects a QueryPool may own
+         *
+         * The GPU must not be using the query pool anymore
+         */
+        virtual void destroy_query_pool(RhiQueryPool* pool, rx::memory::allocator* allocator) = 0;
+
         [[nodiscard]] Swapchain* get_swapchain() const;
 
+        /*!
+         * \brief Recreates the swapchain's images with a new size, and with the present mode and number of images in
+         * `NovaSettings::swapchain`
+         *
+         * Waits for the GPU to finish all its work first. The swapchain stays the same object, but its images, framebuffers, and fences
+         * are replaced, so get them from the swapchain again afterwards. Screen-relative images which are created or recreated afterwards
+         * are relative to the new size
+         *
+         * \param window_size The size of the window's framebuffer, in pixels
+         */
+        virtual void recreate_swapchain(const glm::uvec2& window_size) = 0;
+
+        /*!
+         * \brief Tells the device that the CPU is starting to record a new frame
+         *
+         * The caller must have waited for the fence of the last frame that had the same index. The device reuses the command lists from
+         * that frame, so any command list that was allocated the last time this frame index was used becomes invalid
+         *
+         * \param frame_idx The index of the frame that's starting, in the range [0, NUM_IN_FLIGHT_FRAMES)
+         */
+        virtual void begin_frame(uint32_t frame_idx) = 0;
+
         /*!
          * \brief Allocates a new command list that can be used from the provided thread and has the desired type
          *
@@ -247,17 +383,29 @@ namespace nova::renderer::rhi {
          * to a queue. Submitting it gives ownership back to the render engine, and recording commands into a
          * submitted command list is not supported
          *
-         * There is one command list pool per swapchain image per thread. All the pools for one swapchain image are
-         * reset at the beginning of a frame that renders to that swapchain image. This means that any command list
-         * allocated in one frame will not be valid in the next frame. DO NOT hold on to command lists
+         * There is one command list pool per in-flight frame per thread. All the pools for one frame are reset by
+         * `begin_frame`. This means that any command list allocated in one frame will not be valid the next time that
+         * frame index is used. DO NOT hold on to command lists
          *
          * Command lists allocated by this method are returned ready to record commands into - the caller doesn't need
          * to begin the command list
+         *
+         * Each thread that records commands must use its own `thread_idx`. Index 0 is the main thread, indices 1 through
+         * `NovaSettings::num_recording_threads` are for the threads that record renderpasses in parallel. Other threads, such as the
+         * threads that upload meshes, also use index 0, and the device gives each of them their own pools
+         *
+         * \param renderpass If `level` is `Secondary`, the renderpass that the command list will be executed in, or nullptr if the
+         * command list will be executed outside of a renderpass
+         * \param framebuffer If `renderpass` is not nullptr, the framebuffer that the renderpass will render to
+         * \param subpass If `renderpass` is not nullptr, the subpass of the renderpass that the command list will be executed in
          */
         virtual CommandList* create_command_list(uint32_t thread_idx,
                                                  QueueType needed_queue_type,
                                                  CommandList::Level level,
-                                                 rx::memory::allocator* allocator) = 0;
+                                                 rx::memory::allocator* allocator,
+                                                 const RhiRenderpass* renderpass = nullptr,
+                                                 const RhiFramebuffer* framebuffer = nullptr,
+                                                 uint32_t subpass = 0) = 0;
 
         virtual void submit_command_list(CommandList* cmds,
                                          QueueType queue,
@@ -265,6 +413,15 @@ namespace nova::renderer::rhi {
                                          const rx::vector<RhiSemaphore*>& wait_semaphores = {},
                                          const rx::vector<RhiSemaphore*>& signal_semaphores = {}) = 0;
 
+        /*!
+         * \brief Writes every pipeline this device has compiled to disk, so that the next launch can create those pipelines without
+         * compiling them again
+         *
+         * Devices also save their pipelines when they're destroyed. Call this after creating a lot of pipelines, so that they're saved
+         * even if the program doesn't shut down cleanly
+         */
+        virtual void save_pipeline_cache() = 0;
+
         [[nodiscard]] rx::memory::allocator* get_allocator() const;
 
     protected:
@@ -41,7 +41,7 @@ namespace nova::renderer::rhi {
         Invalid,
     };
 
-    enum class DescriptorType { CombinedImageSampler, UniformBuffer, StorageBuffer, Texture, Sampler };
+    enum class DescriptorType { CombinedImageSampler, UniformBuffer, StorageBuffer, Texture, Sampler, InputAttachment, StorageImage };
 
     enum class ResourceAccess {
         IndirectCommandRead,
@@ -83,6 +83,7 @@ namespace nova::renderer::rhi {
         UniformBuffer,
         VertexBuffer,
         IndexBuffer,
+        IndirectBuffer,
 
         ShaderRead,
         ShaderWrite,
@@ -158,6 +159,11 @@ namespace nova::renderer::rhi {
         IndexBuffer,
         VertexBuffer,
         StagingBuffer,
+
+        /*!
+         * \brief Buffer which shaders can read and write, and which can hold the arguments of indirect dispatches
+         */
+        StorageBuffer,
     };
 
     enum class ResourceType {
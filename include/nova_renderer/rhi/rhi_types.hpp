@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 
 #include "nova_renderer/memory/bytes.hpp"
+#include "nova_renderer/rhi/device_memory_resource.hpp"
 #include "nova_renderer/rhi/forward_decls.hpp"
 #include "nova_renderer/rhi/rhi_enums.hpp"
 #include "nova_renderer/renderpack_data.hpp"
@@ -29,6 +30,24 @@ namespace nova::renderer::rhi {
     struct RhiResource {
         ResourceType type = {};
         bool is_dynamic = true;
+
+        /*!
+         * \brief The state that this resource will be in after every command that's been recorded so far has executed
+         *
+         * Command lists update this when you call `CommandList::transition_resource`, so command lists must be submitted in the order
+         * they were recorded in
+         */
+        ResourceState state = ResourceState::Undefined;
+
+        /*!
+         * \brief The pipeline stages which use this resource in its current state
+         */
+        PipelineStage stages = PipelineStage::TopOfPipe;
+
+        /*!
+         * \brief The queue which uses this resource in its current state
+         */
+        QueueType queue = QueueType::Graphics;
     };
 
     struct RhiSamplerCreateInfo {
@@ -56,10 +75,26 @@ namespace nova::renderer::rhi {
 
     struct RhiImage : RhiResource {
         bool is_depth_tex = false;
+
+        /*!
+         * \brief The image whose memory this image uses, or nullptr if this image has its own memory
+         */
+        RhiImage* aliased_image = nullptr;
     };
 
     struct RhiBuffer : RhiResource {
         mem::Bytes size = 0;
+
+        /*!
+         * \brief The memory resource that the buffer is placed in, or nullptr if the buffer has its own memory because the memory
+         * resource was full
+         */
+        DeviceMemoryResource* memory_resource = nullptr;
+
+        /*!
+         * \brief Where the buffer is in `memory_resource`'s memory
+         */
+        DeviceMemoryAllocation memory_allocation;
     };
 
     struct RhiFramebuffer {
@@ -137,7 +172,19 @@ namespace nova::renderer::rhi {
 
     struct RhiDescriptorSet {};
 
-    // TODO: Resource state tracking in the command list so we don't need all this bullshit
+    /*!
+     * \brief A pool of GPU timestamp queries
+     */
+    struct RhiQueryPool {
+        uint32_t num_queries = 0;
+    };
+
+    /*!
+     * \brief A single barrier for `CommandList::resource_barriers`
+     *
+     * You usually don't need to build these yourself - `CommandList::transition_resource` generates them from each resource's tracked
+     * state
+     */
     struct RhiResourceBarrier {
         RhiResource* resource_to_barrier;
 
@@ -244,4 +291,8 @@ namespace nova::renderer::rhi {
 #pragma endregion
 
     ShaderStage operator|=(ShaderStage lhs, ShaderStage rhs);
+
+    PipelineStage operator|(PipelineStage lhs, PipelineStage rhs);
+
+    PipelineStage& operator|=(PipelineStage& lhs, PipelineStage rhs);
 } // namespace nova::renderer::rhi
@@ -19,14 +19,32 @@ namespace nova::renderer::rhi {
         /*!
          * \brief Acquires the next image in the swapchain
          *
+         * \param image_acquired_semaphore Semaphore to signal when the image may be rendered to. Command lists which render to the image
+         * must wait for this semaphore. If this is nullptr, this method blocks until the image may be rendered to
+         *
+         * If the swapchain is out of date, no image is acquired and the semaphore isn't signalled. Check `is_out_of_date` after acquiring
+         * an image, and recreate the swapchain with `RenderDevice::recreate_swapchain` if it's out of date
+         *
          * \return The index of the swapchain image we just acquired
          */
-        virtual uint8_t acquire_next_swapchain_image(rx::memory::allocator* allocator = nullptr) = 0;
+        virtual uint8_t acquire_next_swapchain_image(RhiSemaphore* image_acquired_semaphore = nullptr,
+                                                     rx::memory::allocator* allocator = nullptr) = 0;
 
         /*!
          * \brief Presents the specified swapchain image
+         *
+         * \param image_idx The index of the image to present
+         * \param render_finished_semaphore Semaphore that's signalled when rendering to the image has finished. The presentation waits for
+         * it on the GPU. If this is nullptr, rendering to the image must have finished already
          */
-        virtual void present(uint32_t image_idx) = 0;
+        virtual void present(uint32_t image_idx, RhiSemaphore* render_finished_semaphore = nullptr) = 0;
+
+        /*!
+         * \brief Checks if the swapchain no longer matches the window it presents to, such as after the window was resized
+         *
+         * An out of date swapchain must be recreated with `RenderDevice::recreate_swapchain`
+         */
+        [[nodiscard]] bool is_out_of_date() const;
 
         [[nodiscard]] RhiFramebuffer* get_framebuffer(uint32_t frame_idx) const;
 
@@ -36,9 +54,17 @@ namespace nova::renderer::rhi {
 
         [[nodiscard]] glm::uvec2 get_size() const;
 
+        [[nodiscard]] uint32_t get_num_images() const;
+
     protected:
-        const uint32_t num_images;
-        const glm::uvec2 size;
+        uint32_t num_images;
+        glm::uvec2 size;
+
+        /*!
+         * \brief Set by the swapchain implementations when the graphics API reports that the swapchain is out of date, and cleared when
+         * the swapchain is recreated
+         */
+        bool out_of_date = false;
 
         // Arrays of the per-frame swapchain resources. Each swapchain implementation is responsible for filling these arrays with
         // API-specific objects
@@ -0,0 +1,148 @@
+/*!
+ * \file tracing.hpp
+ *
+ * \brief Records trace events which show what Nova was doing and when, in the format that chrome://tracing and Perfetto read
+ *
+ * Each thread writes its events into its own fixed-size ring buffer, without taking any locks, and the oldest events are overwritten
+ * when a buffer is full. Nothing is written to disk until `write_trace` is called, so tracing can stay on in the field and the last few
+ * frames can be written out when something goes wrong
+ *
+ * While tracing is disabled, or while the current frame isn't sampled, a trace scope costs one relaxed atomic load
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+#include <rx/core/string.h>
+
+namespace nova::renderer::tracing {
+    /*!
+     * \brief A timeline that trace events are recorded on. Each thread has its own track
+     */
+    struct Track;
+
+    namespace detail {
+        extern std::atomic<bool> is_recording;
+    } // namespace detail
+
+    /*!
+     * \brief Turns tracing on or off. Safe to call from any thread
+     */
+    void set_enabled(bool enabled);
+
+    [[nodiscard]] bool is_enabled();
+
+    /*!
+     * \brief Sets how often frames are traced
+     *
+     * \param interval The number of frames between two traced frames. 1 traces every frame
+     */
+    void set_sample_interval(uint32_t interval);
+
+    /*!
+     * \brief Sets the number of events that each track can hold
+     *
+     * Only affects tracks which are created after this is called, so call it before tracing anything. Rounded up to a power of two. A
+     * trace has the newest `num_events - 1` events of each track, because the recording thread may be overwriting the oldest one
+     */
+    void set_events_per_track(uint32_t num_events);
+
+    /*!
+     * \brief Tells the tracer that a new frame has started, so it can decide whether to trace the frame
+     */
+    void begin_frame(uint64_t frame_idx);
+
+    /*!
+     * \brief Checks if trace events should be recorded right now
+     */
+    [[nodiscard]] inline bool is_recording() { return detail::is_recording.load(std::memory_order_relaxed); }
+
+    /*!
+     * \brief Sets the name of the calling thread's track
+     */
+    void set_thread_name(const char* name);
+
+    /*!
+     * \brief Gets the calling thread's track, creating it if needed
+     */
+    [[nodiscard]] Track& get_thread_track();
+
+    /*!
+     * \brief Creates a track which isn't tied to a thread, such as a track for GPU work
+     *
+     * Only one thread may record events on the track at a time
+     */
+    [[nodiscard]] Track& create_track(const char* name);
+
+    /*!
+     * \brief Gets a copy of a string which lives until the program exits, for trace event names which aren't string literals
+     *
+     * Takes a lock, so only call it when `is_recording` is true
+     */
+    [[nodiscard]] const char* intern(const rx::string& str);
+
+    /*!
+     * \brief Records an event which started and ended at the provided times
+     *
+     * \param track The track to record the event on
+     * \param category The category of the event. Must live until the program exits
+     * \param name The name of the event. Must live until the program exits
+     * \param start_ticks When the event started, in `rx::time::qpc_ticks` ticks
+     * \param end_ticks When the event ended, in `rx::time::qpc_ticks` ticks
+     */
+    void record_event(Track& track, const char* category, const char* name, uint64_t start_ticks, uint64_t end_ticks);
+
+    /*!
+     * \brief Writes the recorded events to a JSON file
+     *
+     * Safe to call from any thread, while other threads are still recording events
+     *
+     * \param path The file to write the events to
+     * \param num_frames How many of the most recent frames to write the events of
+     *
+     * \return True if the file was written, false if it couldn't be opened
+     */
+    bool write_trace(const rx::string& path, uint64_t num_frames = UINT64_MAX);
+
+    /*!
+     * \brief Records an event on the calling thread's track which lasts until the end of the enclosing scope
+     */
+    class ScopedEvent {
+    public:
+        ScopedEvent(const char* category, const char* name);
+
+        /*!
+         * \brief Records an event whose name isn't a string literal. The name is only copied if the event is recorded
+         */
+        ScopedEvent(const char* category, const rx::string& name);
+
+        ScopedEvent(const ScopedEvent& other) = delete;
+        ScopedEvent& operator=(const ScopedEvent& other) = delete;
+
+        ScopedEvent(ScopedEvent&& old) noexcept = delete;
+        ScopedEvent& operator=(ScopedEvent&& old) noexcept = delete;
+
+        ~ScopedEvent();
+
+    private:
+        const char* category = nullptr;
+
+        /*!
+         * \brief The name of the event, or nullptr if the event isn't being recorded
+         */
+        const char* name = nullptr;
+
+        uint64_t start_ticks = 0;
+    };
+} // namespace nova::renderer::tracing
+
+#define NOVA_TRACE_CONCAT_IMPL(a, b) a##b
+#define NOVA_TRACE_CONCAT(a, b) NOVA_TRACE_CONCAT_IMPL(a, b)
+
+/*!
+ * \brief Records a trace event which lasts until the end of the enclosing scope
+ */
+#define NOVA_TRACE_SCOPE(category, name)                                                                                                   \
+    const ::nova::renderer::tracing::ScopedEvent NOVA_TRACE_CONCAT(nova_trace_scope_, __LINE__) { category, name }
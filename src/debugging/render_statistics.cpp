@@ -0,0 +1,133 @@
+#include "nova_renderer/render_statistics.hpp"
+
+#include <rx/core/concurrency/mutex.h>
+#include <rx/core/concurrency/scope_lock.h>
+#include <rx/core/memory/system_allocator.h>
+
+#include "nova_renderer/rendergraph.hpp"
+
+namespace nova::renderer {
+    RenderStatistics& RenderStatistics::operator+=(const RenderStatistics& other) {
+        num_draw_calls += other.num_draw_calls;
+        num_indices += other.num_indices;
+        num_pipeline_binds += other.num_pipeline_binds;
+        num_descriptor_set_binds += other.num_descriptor_set_binds;
+        num_barriers += other.num_barriers;
+        num_bytes_written += other.num_bytes_written;
+        num_staging_bytes_uploaded += other.num_staging_bytes_uploaded;
+        num_command_lists += other.num_command_lists;
+
+        return *this;
+    }
+
+    namespace statistics {
+        constexpr uint32_t NO_RENDERPASS = UINT32_MAX;
+
+        /*!
+         * \brief The counters of one thread
+         */
+        struct ThreadStatistics {
+            /*!
+             * \brief The counters for each compiled renderpass
+             *
+             * Only the owning thread touches these while it records renderpasses, and `end_frame` only reads them after every renderpass
+             * has been recorded, so they don't need a lock
+             */
+            rx::vector<RenderStatistics> renderpasses;
+
+            uint32_t cur_renderpass_idx = NO_RENDERPASS;
+
+            /*!
+             * \brief Guards `outside_renderpasses`
+             */
+            rx::concurrency::mutex mutex;
+
+            /*!
+             * \brief The counters for work outside of any renderpass, which can happen at any time, such as mesh uploads from the game's
+             * threads
+             */
+            RenderStatistics outside_renderpasses;
+        };
+
+        static rx::concurrency::mutex threads_mutex;
+
+        static rx::vector<ThreadStatistics*> threads;
+
+        static thread_local ThreadStatistics* thread_statistics = nullptr;
+
+        static ThreadStatistics& get_thread_statistics() {
+            if(thread_statistics == nullptr) {
+                thread_statistics = rx::memory::g_system_allocator->create<ThreadStatistics>();
+
+                rx::concurrency::scope_lock l(threads_mutex);
+                threads.push_back(thread_statistics);
+            }
+
+            return *thread_statistics;
+        }
+
+        void count(uint64_t RenderStatistics::*counter, const uint64_t amount) {
+            auto& stats = get_thread_statistics();
+
+            if(stats.cur_renderpass_idx != NO_RENDERPASS) {
+                stats.renderpasses[stats.cur_renderpass_idx].*counter += amount;
+
+            } else {
+                rx::concurrency::scope_lock l(stats.mutex);
+                stats.outside_renderpasses.*counter += amount;
+            }
+        }
+
+        RenderpassScope::RenderpassScope(const uint32_t renderpass_idx) {
+            auto& stats = get_thread_statistics();
+
+            if(stats.renderpasses.size() <= renderpass_idx) {
+                stats.renderpasses.resize(renderpass_idx + 1);
+            }
+
+            previous_renderpass_idx = stats.cur_renderpass_idx;
+            stats.cur_renderpass_idx = renderpass_idx;
+        }
+
+        RenderpassScope::~RenderpassScope() { get_thread_statistics().cur_renderpass_idx = previous_renderpass_idx; }
+
+        FrameStatistics end_frame(const uint64_t frame_count,
+                                  const rx::vector<CompiledRenderpass>& renderpasses,
+                                  rx::memory::allocator* allocator) {
+            FrameStatistics frame_statistics{frame_count, {}, rx::vector<RenderpassStatistics>{allocator}};
+
+            rx::vector<RenderStatistics> renderpass_statistics{allocator};
+            renderpass_statistics.resize(renderpasses.size());
+
+            rx::concurrency::scope_lock l(threads_mutex);
+
+            threads.each_fwd([&](ThreadStatistics* stats) {
+                for(uint32_t i = 0; i < stats->renderpasses.size(); i++) {
+                    // The renderpasses may have been recompiled since the thread counted its work
+                    if(i < renderpass_statistics.size()) {
+                        renderpass_statistics[i] += stats->renderpasses[i];
+                    }
+
+                    stats->renderpasses[i] = {};
+                }
+
+                rx::concurrency::scope_lock thread_lock(stats->mutex);
+                frame_statistics.total += stats->outside_renderpasses;
+                stats->outside_renderpasses = {};
+            });
+
+            for(uint32_t i = 0; i < renderpasses.size(); i++) {
+                // Skipped renderpasses still record their transitions, so their barriers are part of the total
+                frame_statistics.total += renderpass_statistics[i];
+
+                if(renderpasses[i].is_skipped) {
+                    continue;
+                }
+
+                frame_statistics.renderpasses.push_back(RenderpassStatistics{renderpasses[i].renderpass->name, renderpass_statistics[i]});
+            }
+
+            return frame_statistics;
+        }
+    } // namespace statistics
+} // namespace nova::renderer
@@ -0,0 +1,305 @@
+#include "nova_renderer/tracing.hpp"
+
+#include <stdio.h>
+
+#include <rx/core/algorithm/max.h>
+#include <rx/core/concurrency/mutex.h>
+#include <rx/core/concurrency/scope_lock.h>
+#include <rx/core/filesystem/file.h>
+#include <rx/core/global.h>
+#include <rx/core/log.h>
+#include <rx/core/map.h>
+#include <rx/core/memory/system_allocator.h>
+#include <rx/core/time/qpc.h>
+#include <rx/core/vector.h>
+
+namespace nova::renderer::tracing {
+    RX_LOG("Tracing", logger);
+
+    struct TraceEvent {
+        const char* category = nullptr;
+        const char* name = nullptr;
+
+        uint64_t start_ticks = 0;
+        uint64_t end_ticks = 0;
+
+        uint64_t frame_idx = 0;
+    };
+
+    /*!
+     * \brief A ring buffer of trace events with a single writer
+     *
+     * The writer fills in the slot after the last event, then publishes it by incrementing `num_written`. Readers copy the events
+     * without locking, then check `num_written` again and throw away the events that the writer might have overwritten while they were
+     * copying. The writer may be filling in the slot of the oldest event at any time, so readers only see the newest `capacity - 1`
+     * events
+     */
+    struct Track {
+        uint32_t id = 0;
+
+        rx::string name;
+
+        /*!
+         * \brief The events in the ring buffer. The size is a power of two
+         */
+        rx::vector<TraceEvent> events;
+
+        /*!
+         * \brief The number of events which have ever been written to this track
+         */
+        std::atomic<uint64_t> num_written{0};
+    };
+
+    namespace detail {
+        std::atomic<bool> is_recording{false};
+    } // namespace detail
+
+    static std::atomic<bool> is_tracing_enabled{false};
+    static std::atomic<uint32_t> sample_interval{1};
+    static std::atomic<uint64_t> cur_frame_idx{0};
+
+    static uint32_t events_per_track = 16384;
+
+    /*!
+     * \brief Guards the list of tracks, the names of the tracks, and the interned strings
+     */
+    static rx::concurrency::mutex tracks_mutex;
+
+    static rx::vector<Track*> tracks;
+
+    /*!
+     * \brief A global so that it's constructed after the system allocator, because maps allocate as soon as they're constructed
+     */
+    static RX_GLOBAL<rx::map<rx::string, rx::string*>> interned_strings{"Nova", "TracingInternedStrings"};
+
+    static thread_local Track* thread_track = nullptr;
+
+    static void update_is_recording() {
+        const auto frame_idx = cur_frame_idx.load(std::memory_order_relaxed);
+        const auto interval = sample_interval.load(std::memory_order_relaxed);
+        detail::is_recording.store(is_tracing_enabled.load(std::memory_order_relaxed) && frame_idx % interval == 0,
+                                   std::memory_order_relaxed);
+    }
+
+    void set_enabled(const bool enabled) {
+        is_tracing_enabled.store(enabled, std::memory_order_relaxed);
+        update_is_recording();
+    }
+
+    bool is_enabled() { return is_tracing_enabled.load(std::memory_order_relaxed); }
+
+    void set_sample_interval(const uint32_t interval) {
+        sample_interval.store(rx::algorithm::max(interval, 1u), std::memory_order_relaxed);
+        update_is_recording();
+    }
+
+    void set_events_per_track(const uint32_t num_events) {
+        rx::concurrency::scope_lock l(tracks_mutex);
+
+        events_per_track = 1;
+        while(events_per_track < num_events) {
+            events_per_track *= 2;
+        }
+    }
+
+    void begin_frame(const uint64_t frame_idx) {
+        cur_frame_idx.store(frame_idx, std::memory_order_relaxed);
+        update_is_recording();
+    }
+
+    void set_thread_name(const char* name) {
+        auto& track = get_thread_track();
+
+        rx::concurrency::scope_lock l(tracks_mutex);
+        track.name = name;
+    }
+
+    Track& get_thread_track() {
+        if(thread_track == nullptr) {
+            const auto thread_idx = [] {
+                rx::concurrency::scope_lock l(tracks_mutex);
+                return tracks.size();
+            }();
+
+            thread_track = &create_track(rx::string::format("Thread %zu", thread_idx).data());
+        }
+
+        return *thread_track;
+    }
+
+    Track& create_track(const char* name) {
+        auto* track = rx::memory::g_system_allocator->create<Track>();
+
+        rx::concurrency::scope_lock l(tracks_mutex);
+        track->id = static_cast<uint32_t>(tracks.size());
+        track->name = name;
+        track->events.resize(events_per_track);
+
+        tracks.push_back(track);
+
+        return *track;
+    }
+
+    const char* intern(const rx::string& str) {
+        rx::concurrency::scope_lock l(tracks_mutex);
+
+        if(auto* const* interned = interned_strings->find(str)) {
+            return (*interned)->data();
+        }
+
+        auto* interned = rx::memory::g_system_allocator->create<rx::string>(str);
+        interned_strings->insert(str, interned);
+
+        return interned->data();
+    }
+
+    void record_event(Track& track, const char* category, const char* name, const uint64_t start_ticks, const uint64_t end_ticks) {
+        const auto event_idx = track.num_written.load(std::memory_order_relaxed);
+
+        auto& event = track.events[event_idx & (track.events.size() - 1)];
+        event.category = category;
+        event.name = name;
+        event.start_ticks = start_ticks;
+        event.end_ticks = end_ticks;
+        event.frame_idx = cur_frame_idx.load(std::memory_order_relaxed);
+
+        track.num_written.store(event_idx + 1, std::memory_order_release);
+    }
+
+    /*!
+     * \brief Copies the events that a track still has
+     */
+    static rx::vector<TraceEvent> copy_events(const Track& track) {
+        const auto capacity = track.events.size();
+
+        // The slot after the last published event holds the oldest event, which the writer may be overwriting right now
+        const auto num_written = track.num_written.load(std::memory_order_acquire);
+        const auto first_event = num_written + 1 > capacity ? num_written + 1 - capacity : 0;
+
+        rx::vector<TraceEvent> copied_events;
+        copied_events.reserve(num_written - first_event);
+        for(auto i = first_event; i < num_written; i++) {
+            copied_events.push_back(track.events[i & (capacity - 1)]);
+        }
+
+        // The writer may have wrapped around and overwritten some of the events while we copied them
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto num_written_after_copy = track.num_written.load(std::memory_order_relaxed);
+        const auto first_valid_event = num_written_after_copy + 1 > capacity ? num_written_after_copy + 1 - capacity : 0;
+        if(first_valid_event <= first_event) {
+            return copied_events;
+        }
+
+        rx::vector<TraceEvent> events;
+        for(auto i = first_valid_event; i < num_written; i++) {
+            events.push_back(copied_events[i - first_event]);
+        }
+
+        return events;
+    }
+
+    static void append_json_string(rx::string& json, const char* str) {
+        json.append('"');
+        for(const char* c = str; *c != '\0'; c++) {
+            if(*c == '"' || *c == '\\') {
+                json.append('\\');
+                json.append(*c);
+
+            } else if(static_cast<unsigned char>(*c) < 0x20) {
+                // Control characters don't belong in event names anyway
+                json.append(' ');
+
+            } else {
+                json.append(*c);
+            }
+        }
+        json.append('"');
+    }
+
+    bool write_trace(const rx::string& path, const uint64_t num_frames) {
+        const auto last_frame = cur_frame_idx.load(std::memory_order_relaxed);
+        const auto first_frame = num_frames > last_frame ? 0 : last_frame - num_frames + 1;
+
+        const auto ticks_per_us = static_cast<double>(rx::time::qpc_frequency()) / 1000000.0;
+
+        rx::string json;
+        json.append("{\"traceEvents\":[");
+
+        bool is_first_event = true;
+        char number_buffer[128];
+
+        rx::concurrency::scope_lock l(tracks_mutex);
+
+        tracks.each_fwd([&](const Track* track) {
+            if(!is_first_event) {
+                json.append(',');
+            }
+            is_first_event = false;
+
+            snprintf(number_buffer, sizeof(number_buffer), "{\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":", track->id);
+            json.append(number_buffer);
+            append_json_string(json, track->name.data());
+            json.append("}}");
+
+            const auto events = copy_events(*track);
+            events.each_fwd([&](const TraceEvent& event) {
+                if(event.frame_idx < first_frame) {
+                    return;
+                }
+
+                json.append(",{\"ph\":\"X\",\"cat\":");
+                append_json_string(json, event.category);
+                json.append(",\"name\":");
+                append_json_string(json, event.name);
+
+                snprintf(number_buffer,
+                         sizeof(number_buffer),
+                         ",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+                         track->id,
+                         static_cast<double>(event.start_ticks) / ticks_per_us,
+                         static_cast<double>(event.end_ticks - event.start_ticks) / ticks_per_us,
+                         static_cast<unsigned long long>(event.frame_idx));
+                json.append(number_buffer);
+            });
+        });
+
+        json.append("]}");
+
+        rx::filesystem::file file{path, "wb"};
+        if(!file) {
+            logger(rx::log::level::k_error, "Could not open trace file %s", path);
+            return false;
+        }
+
+        if(file.write(reinterpret_cast<const rx_byte*>(json.data()), json.size()) != json.size()) {
+            logger(rx::log::level::k_error, "Could not write trace file %s", path);
+            return false;
+        }
+
+        logger(rx::log::level::k_info, "Wrote trace of frames %llu to %llu to %s", first_frame, last_frame, path);
+
+        return true;
+    }
+
+    ScopedEvent::ScopedEvent(const char* category, const char* name) {
+        if(is_recording()) {
+            this->category = category;
+            this->name = name;
+            start_ticks = rx::time::qpc_ticks();
+        }
+    }
+
+    ScopedEvent::ScopedEvent(const char* category, const rx::string& name) {
+        if(is_recording()) {
+            this->category = category;
+            this->name = intern(name);
+            start_ticks = rx::time::qpc_ticks();
+        }
+    }
+
+    ScopedEvent::~ScopedEvent() {
+        if(name != nullptr) {
+            record_event(get_thread_track(), category, name, start_ticks, rx::time::qpc_ticks());
+        }
+    }
+} // namespace nova::renderer::tracing
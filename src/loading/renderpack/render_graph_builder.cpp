@@ -1,35 +1,25 @@
 #include "render_graph_builder.hpp"
 
-#include <minitrace.h>
 #include <rx/core/algorithm/max.h>
 #include <rx/core/algorithm/min.h>
 #include <rx/core/log.h>
 
 #include "nova_renderer/constants.hpp"
+#include "nova_renderer/tracing.hpp"
 
 namespace nova::renderer::renderpack {
     RX_LOG("RenderGraphBuilder", logger);
 
     /*!
-     * \brief Adds all the passes that `pass_name` depends on to the list of ordered passes
+     * \brief Sets the value for a key in a map, and returns a pointer to the value in the map
      *
-     * This method performs a depth-first traversal of the pass tree. It shouldn't matter whether we do depth or
-     * breadth first, but depth first feels cleaner
-     *
-     * \param pass_name The passes that were just added to the list of ordered passes
-     * \param passes A map from pass name to pass. Useful for the explicit dependencies of a pass
-     * \param ordered_passes The passes in submissions order... almost. When this function adds to ordered_passes the
-     * list has a lot of duplicates. They're removed in a later step
-     * \param resource_to_write_pass A map from resource name to list of passes that write to that resource. Useful for
-     * resolving the implicit dependencies of a pass
-     * \param depth The depth in the tree that we're at. If this number ever grows bigger than the total number of
-     * passes, there's a circular dependency somewhere in the render graph. This is Bad and we hate it
+     * rx::map::insert returns the wrong value when the new value displaces another one, so this looks the new value up instead
      */
-    void add_dependent_passes(const rx::string& pass_name,
-                              const rx::map<rx::string, RenderPassCreateInfo>& passes,
-                              rx::vector<rx::string>& ordered_passes,
-                              const rx::map<rx::string, rx::vector<rx::string>>& resource_to_write_pass,
-                              uint32_t depth);
+    template <typename KeyType, typename ValueType>
+    static ValueType* insert_or_assign(rx::map<KeyType, ValueType>& map, const KeyType& key, const ValueType& value) {
+        map.insert(key, value);
+        return map.find(key);
+    }
 
     bool Range::has_writer() const { return first_write_pass <= last_write_pass; }
 
@@ -77,164 +67,342 @@ namespace nova::renderer::renderpack {
         return left || right;
     }
 
-    ntl::Result<rx::vector<RenderPassCreateInfo>> order_passes(const rx::vector<RenderPassCreateInfo>& passes) {
-        MTR_SCOPE("Renderpass", "order_passes");
+    /*!
+     * \brief Counts the barriers that the passes need when they're submitted in the provided order
+     *
+     * A pass needs a barrier if it depends on a pass which was submitted after the most recent barrier. A pass which only depends on
+     * passes before the most recent barrier can share that barrier
+     */
+    static uint32_t count_barriers(const rx::vector<uint32_t>& ordered_passes,
+                                   const rx::vector<rx::vector<uint32_t>>& dependencies,
+                                   const uint32_t num_passes) {
+        rx::vector<uint32_t> positions;
+        positions.resize(num_passes, 0);
+
+        uint32_t num_barriers = 0;
+        uint32_t last_barrier_position = 0;
+
+        for(uint32_t position = 0; position < ordered_passes.size(); position++) {
+            const auto pass_idx = ordered_passes[position];
+            positions[pass_idx] = position;
+
+            bool needs_barrier = false;
+            dependencies[pass_idx].each_fwd([&](const uint32_t dependency_idx) {
+                if(positions[dependency_idx] >= last_barrier_position) {
+                    needs_barrier = true;
+                }
+            });
 
-        logger(rx::log::level::k_verbose, "Executing Pass Scheduler");
+            if(needs_barrier) {
+                num_barriers++;
+                last_barrier_position = position;
+            }
+        }
 
-        rx::map<rx::string, RenderPassCreateInfo> render_passes_to_order;
-        passes.each_fwd([&](const RenderPassCreateInfo& create_info) { render_passes_to_order.insert(create_info.name, create_info); });
+        return num_barriers;
+    }
 
-        rx::vector<rx::string> ordered_passes;
-        ordered_passes.reserve(passes.size());
+    ntl::Result<rx::vector<RenderPassCreateInfo>> order_passes(const rx::vector<RenderPassCreateInfo>& passes,
+                                                               const bool reorder_to_reduce_barriers) {
+        NOVA_TRACE_SCOPE("Renderpass", "order_passes");
+
+        logger(rx::log::level::k_verbose, "Executing Pass Scheduler");
+
+        const auto num_passes = static_cast<uint32_t>(passes.size());
 
         /*
          * Build some acceleration structures
          */
 
         logger(rx::log::level::k_verbose, "Collecting passes that write to each resource...");
-        // Maps from resource name to pass that writes to that resource, then from resource name to pass that reads from
-        // that resource
-        auto resource_to_write_pass = rx::map<rx::string, rx::vector<rx::string>>{};
-
-        passes.each_fwd([&](const RenderPassCreateInfo& pass) {
-            pass.texture_outputs.each_fwd([&](const TextureAttachmentInfo& output) {
-                auto* write_pass_list = resource_to_write_pass.find(output.name);
-                if(!write_pass_list) {
-                    write_pass_list = resource_to_write_pass.insert(output.name, {});
-                }
-                write_pass_list->push_back(pass.name);
-            });
+        // Map from resource name to the indices of the passes that write to that resource
+        rx::map<rx::string, rx::vector<uint32_t>> resource_to_write_passes;
 
-            pass.output_buffers.each_fwd([&](const rx::string& buffer_name) {
-                auto* write_pass_list = resource_to_write_pass.find(buffer_name);
-                if(!write_pass_list) {
-                    write_pass_list = resource_to_write_pass.insert(buffer_name, {});
-                }
-                write_pass_list->push_back(pass.name);
-            });
-        });
+        const auto add_write_pass = [&](const rx::string& resource_name, const uint32_t pass_idx) {
+            auto* write_passes = resource_to_write_passes.find(resource_name);
+            if(!write_passes) {
+                write_passes = insert_or_assign(resource_to_write_passes, resource_name, {});
+            }
+            write_passes->push_back(pass_idx);
+        };
 
-        /*
-         * Initial ordering of passes
-         */
+        for(uint32_t pass_idx = 0; pass_idx < num_passes; pass_idx++) {
+            const auto& pass = passes[pass_idx];
+            pass.texture_outputs.each_fwd([&](const TextureAttachmentInfo& output) { add_write_pass(output.name, pass_idx); });
+            pass.output_buffers.each_fwd([&](const rx::string& buffer_name) { add_write_pass(buffer_name, pass_idx); });
+        }
 
-        logger(rx::log::level::k_verbose, "First pass at ordering passes...");
-        // The passes, in simple dependency order
-        if(resource_to_write_pass.find(BACKBUFFER_NAME) == nullptr) {
+        const auto* backbuffer_writes = resource_to_write_passes.find(BACKBUFFER_NAME);
+        if(backbuffer_writes == nullptr) {
             logger(rx::log::level::k_error,
                    "This render graph does not write to the backbuffer. Unable to load this renderpack because it can't render anything");
             return ntl::Result<rx::vector<RenderPassCreateInfo>>(ntl::NovaError("Failed to order passes because no backbuffer was found"));
         }
 
-        const auto& backbuffer_writes = *resource_to_write_pass.find(BACKBUFFER_NAME);
-        ordered_passes += backbuffer_writes;
+        /*
+         * Build the dependency graph
+         */
 
-        backbuffer_writes.each_fwd([&](const rx::string& pass_name) {
-            add_dependent_passes(pass_name, render_passes_to_order, ordered_passes, resource_to_write_pass, 1);
-        });
+        logger(rx::log::level::k_verbose, "Building the pass dependency graph...");
+        // A pass depends on every other pass that writes to a resource it reads. `dependencies` holds the edges backwards, from each pass
+        // to the passes it depends on, and `dependents` holds them forwards
+        rx::vector<rx::vector<uint32_t>> dependencies;
+        dependencies.resize(num_passes);
+
+        rx::vector<rx::vector<uint32_t>> dependents;
+        dependents.resize(num_passes);
+
+        const auto add_read = [&](const uint32_t pass_idx, const rx::string& resource_name, const char* resource_type) {
+            const auto* write_passes = resource_to_write_passes.find(resource_name);
+            if(write_passes == nullptr) {
+                // TODO: Ignore the implicitly defined resources
+                logger(rx::log::level::k_error,
+                       "Pass %s reads from %s %s, but nothing writes to it",
+                       passes[pass_idx].name,
+                       resource_type,
+                       resource_name);
+                return;
+            }
+
+            write_passes->each_fwd([&](const uint32_t write_pass_idx) {
+                // A pass which reads and writes the same resource only depends on the other passes that write to it
+                if(write_pass_idx != pass_idx) {
+                    dependencies[pass_idx].push_back(write_pass_idx);
+                    dependents[write_pass_idx].push_back(pass_idx);
+                }
+            });
+        };
 
-        // We're going to loop through the original list of passes and remove them from the original list of passes
-        // We want to keep the original passes around
+        for(uint32_t pass_idx = 0; pass_idx < num_passes; pass_idx++) {
+            const auto& pass = passes[pass_idx];
+            pass.texture_inputs.each_fwd([&](const rx::string& texture_name) { add_read(pass_idx, texture_name, "resource"); });
+            pass.input_buffers.each_fwd([&](const rx::string& buffer_name) { add_read(pass_idx, buffer_name, "buffer"); });
+        }
 
-        // This code taken from `RenderGraph::filter_passes` in the Granite engine
-        // It loops through the ordered passes. When it sees the name of a new pass, it writes the pass to
-        // ordered_passes and increments the write position. After all the passes are written, we remove all the
-        // passes after the last one we wrote to, shrinking the list of ordered passes to only include the exact passes we want
+        /*
+         * Find the passes that contribute to the backbuffer
+         */
 
-        rx::vector<rx::string> unique_passes;
+        logger(rx::log::level::k_verbose, "Finding the passes that contribute to the backbuffer...");
+        rx::vector<bool> is_used;
+        is_used.resize(num_passes, false);
 
-        ordered_passes.each_rev([&](const rx::string& pass_name) {
-            if(unique_passes.find(pass_name) == rx::vector<rx::string>::k_npos) {
-                unique_passes.push_back(pass_name);
+        rx::vector<uint32_t> passes_to_visit;
+        passes_to_visit.reserve(num_passes);
+
+        backbuffer_writes->each_fwd([&](const uint32_t pass_idx) {
+            if(!is_used[pass_idx]) {
+                is_used[pass_idx] = true;
+                passes_to_visit.push_back(pass_idx);
             }
         });
 
-        ordered_passes = unique_passes;
+        uint32_t num_used_passes = 0;
+        while(num_used_passes < passes_to_visit.size()) {
+            const auto pass_idx = passes_to_visit[num_used_passes];
+            num_used_passes++;
 
-        // Granite does some reordering to try and find a submission order that has the fewest pipeline barriers. Not
-        // gonna worry about that now
+            dependencies[pass_idx].each_fwd([&](const uint32_t dependency_idx) {
+                if(!is_used[dependency_idx]) {
+                    is_used[dependency_idx] = true;
+                    passes_to_visit.push_back(dependency_idx);
+                }
+            });
+        }
 
-        rx::vector<RenderPassCreateInfo> passes_in_submission_order;
-        passes_in_submission_order.reserve(ordered_passes.size());
+        /*
+         * Order the passes with Kahn's algorithm
+         */
+
+        logger(rx::log::level::k_verbose, "Ordering passes...");
+        // Every dependency of a used pass is also used, so counting the dependencies of the used passes counts exactly the edges between
+        // used passes
+        rx::vector<uint32_t> num_unscheduled_dependencies;
+        num_unscheduled_dependencies.resize(num_passes, 0);
+
+        // The length of the longest chain of dependencies that ends at each pass
+        rx::vector<uint32_t> depths;
+        depths.resize(num_passes, 0);
+        uint32_t max_depth = 0;
+
+        rx::vector<uint32_t> ordered_passes;
+        ordered_passes.reserve(num_used_passes);
+
+        for(uint32_t pass_idx = 0; pass_idx < num_passes; pass_idx++) {
+            if(is_used[pass_idx]) {
+                num_unscheduled_dependencies[pass_idx] = static_cast<uint32_t>(dependencies[pass_idx].size());
+                if(num_unscheduled_dependencies[pass_idx] == 0) {
+                    ordered_passes.push_back(pass_idx);
+                }
+            }
+        }
 
-        ordered_passes.each_fwd(
-            [&](const rx::string& pass_name) { passes_in_submission_order.push_back(*render_passes_to_order.find(pass_name)); });
+        // `ordered_passes` doubles as the queue of passes whose dependencies have all been scheduled
+        for(uint32_t next_pass = 0; next_pass < ordered_passes.size(); next_pass++) {
+            const auto pass_idx = ordered_passes[next_pass];
 
-        return ntl::Result(passes_in_submission_order);
-    }
+            dependents[pass_idx].each_fwd([&](const uint32_t dependent_idx) {
+                if(is_used[dependent_idx]) {
+                    depths[dependent_idx] = rx::algorithm::max(depths[dependent_idx], depths[pass_idx] + 1);
+                    max_depth = rx::algorithm::max(max_depth, depths[dependent_idx]);
+
+                    num_unscheduled_dependencies[dependent_idx]--;
+                    if(num_unscheduled_dependencies[dependent_idx] == 0) {
+                        ordered_passes.push_back(dependent_idx);
+                    }
+                }
+            });
+        }
+
+        if(ordered_passes.size() < num_used_passes) {
+            rx::string passes_in_cycle;
+            for(uint32_t pass_idx = 0; pass_idx < num_passes; pass_idx++) {
+                if(is_used[pass_idx] && num_unscheduled_dependencies[pass_idx] > 0) {
+                    passes_in_cycle.append(passes_in_cycle.is_empty() ? "" : ", ");
+                    passes_in_cycle.append(passes[pass_idx].name);
+                }
+            }
 
-    void add_dependent_passes(const rx::string& pass_name,
-                              const rx::map<rx::string, RenderPassCreateInfo>& passes,
-                              rx::vector<rx::string>& ordered_passes,
-                              const rx::map<rx::string, rx::vector<rx::string>>& resource_to_write_pass,
-                              const uint32_t depth) {
-        if(depth > passes.size()) {
             logger(rx::log::level::k_error,
-                   "Circular render graph detected! Please fix your render graph to not have circular dependencies");
+                   "Circular render graph detected! Please fix your render graph to not have circular dependencies. These passes are in or after a cycle: %s",
+                   passes_in_cycle);
+            return ntl::Result<rx::vector<RenderPassCreateInfo>>(
+                MAKE_ERROR("Failed to order passes because the render graph has a cycle: %s", passes_in_cycle));
         }
 
-        const auto& pass = *passes.find(pass_name);
+        /*
+         * Reorder the passes to need fewer barriers
+         */
 
-        pass.texture_inputs.each_fwd([&](const rx::string& texture_name) {
-            if(const auto write_passes = resource_to_write_pass.find(texture_name); write_passes == nullptr) {
-                // TODO: Ignore the implicitly defined resources
-                logger(rx::log::level::k_error, "Pass %s reads from resource %s, but nothing writes to it", pass_name, texture_name);
-            } else {
-                ordered_passes += *write_passes;
+        if(reorder_to_reduce_barriers) {
+            logger(rx::log::level::k_verbose, "Reordering passes to reduce barriers...");
 
-                write_passes->each_fwd([&](const rx::string& write_pass) {
-                    add_dependent_passes(write_pass, passes, ordered_passes, resource_to_write_pass, depth + 1);
-                });
+            // Submitting the passes one depth at a time means that every pass at a given depth can share one barrier, which is the fewest
+            // barriers that any order can have. It also puts independent passes between every producer and its consumers, so the
+            // consumers don't have to wait for the pass right before them. The sort is stable, so passes at the same depth keep their
+            // order
+            const auto num_barriers_before_reordering = count_barriers(ordered_passes, dependencies, num_passes);
+
+            rx::vector<uint32_t> first_position_at_depth;
+            first_position_at_depth.resize(max_depth + 1, 0);
+            ordered_passes.each_fwd([&](const uint32_t pass_idx) {
+                if(depths[pass_idx] < max_depth) {
+                    first_position_at_depth[depths[pass_idx] + 1]++;
+                }
+            });
+
+            for(uint32_t depth = 1; depth <= max_depth; depth++) {
+                first_position_at_depth[depth] += first_position_at_depth[depth - 1];
             }
-        });
 
-        pass.input_buffers.each_fwd([&](const rx::string& buffer_name) {
-            if(const auto& write_passes = resource_to_write_pass.find(buffer_name); write_passes == nullptr) {
-                logger(rx::log::level::k_error, "Pass %s reads from buffer %s, but no passes write to it", pass_name, buffer_name);
-            } else {
-                ordered_passes += *write_passes;
+            rx::vector<uint32_t> reordered_passes;
+            reordered_passes.resize(ordered_passes.size(), 0);
+            ordered_passes.each_fwd([&](const uint32_t pass_idx) {
+                auto& position = first_position_at_depth[depths[pass_idx]];
+                reordered_passes[position] = pass_idx;
+                position++;
+            });
 
-                write_passes->each_fwd([&](const rx::string& write_pass) {
-                    add_dependent_passes(write_pass, passes, ordered_passes, resource_to_write_pass, depth + 1);
+            // Grouping by depth separates every pass from the passes that read its outputs through input attachments, and the rendergraph
+            // can only merge passes which are next to each other. Each of those readers is pulled in right after the pass it reads from,
+            // as long as everything else that it depends on has already been submitted
+            rx::vector<rx::vector<uint32_t>> input_attachment_readers;
+            input_attachment_readers.resize(num_passes);
+            reordered_passes.each_fwd([&](const uint32_t pass_idx) {
+                passes[pass_idx].input_attachments.each_fwd([&](const TextureAttachmentInfo& attachment) {
+                    if(const auto* write_passes = resource_to_write_passes.find(attachment.name)) {
+                        write_passes->each_fwd([&](const uint32_t write_pass_idx) {
+                            if(write_pass_idx != pass_idx) {
+                                input_attachment_readers[write_pass_idx].push_back(pass_idx);
+                            }
+                        });
+                    }
                 });
-            }
-        });
+            });
+
+            rx::vector<bool> is_submitted;
+            is_submitted.resize(num_passes, false);
+
+            ordered_passes.clear();
+            reordered_passes.each_fwd([&](const uint32_t pass_idx) {
+                if(is_submitted[pass_idx]) {
+                    return;
+                }
+
+                // The passes from `next_pass` on double as the queue of passes whose input attachment readers haven't been pulled in
+                auto next_pass = static_cast<uint32_t>(ordered_passes.size());
+                ordered_passes.push_back(pass_idx);
+                is_submitted[pass_idx] = true;
+
+                for(; next_pass < ordered_passes.size(); next_pass++) {
+                    input_attachment_readers[ordered_passes[next_pass]].each_fwd([&](const uint32_t reader_idx) {
+                        if(is_submitted[reader_idx]) {
+                            return;
+                        }
+
+                        bool is_ready = true;
+                        dependencies[reader_idx].each_fwd([&](const uint32_t dependency_idx) {
+                            is_ready = is_submitted[dependency_idx];
+                            return is_ready;
+                        });
+
+                        if(is_ready) {
+                            ordered_passes.push_back(reader_idx);
+                            is_submitted[reader_idx] = true;
+                        }
+                    });
+                }
+            });
+
+            const auto num_barriers = count_barriers(ordered_passes, dependencies, num_passes);
+            logger(rx::log::level::k_info,
+                   "After reordering, the renderpasses need %u barriers between dependent passes instead of %u",
+                   num_barriers,
+                   num_barriers_before_reordering);
+        }
+
+        rx::vector<RenderPassCreateInfo> passes_in_submission_order;
+        passes_in_submission_order.reserve(ordered_passes.size());
+
+        ordered_passes.each_fwd([&](const uint32_t pass_idx) { passes_in_submission_order.push_back(passes[pass_idx]); });
+
+        return ntl::Result(passes_in_submission_order);
     }
 
     void determine_usage_order_of_textures(const rx::vector<RenderPassCreateInfo>& passes,
                                            rx::map<rx::string, Range>& resource_used_range,
                                            rx::vector<rx::string>& resources_in_order) {
-        uint32_t pass_idx = 0;
-        passes.each_fwd([&](const RenderPassCreateInfo& pass) {
-            // color attachments
-            pass.texture_inputs.each_fwd([&](const rx::string& input) {
-                const auto tex_range = resource_used_range.find(input);
-
-                if(pass_idx < tex_range->first_write_pass) {
-                    tex_range->first_write_pass = pass_idx;
-                } else if(pass_idx > tex_range->last_write_pass) {
-                    tex_range->last_write_pass = pass_idx;
-                }
+        const auto get_range = [&](const rx::string& name) {
+            auto* range = resource_used_range.find(name);
+            if(range == nullptr) {
+                range = insert_or_assign(resource_used_range, name, {});
+                resources_in_order.push_back(name);
+            }
 
-                if(resources_in_order.find(input) == rx::vector<rx::string>::k_npos) {
-                    resources_in_order.push_back(input);
-                }
-            });
+            return range;
+        };
 
-            pass.texture_outputs.each_fwd([&](const TextureAttachmentInfo& output) {
-                const auto tex_range = resource_used_range.find(output.name);
+        const auto add_read = [&](const rx::string& name, const uint32_t pass_idx) {
+            auto* range = get_range(name);
+            range->first_read_pass = rx::algorithm::min(range->first_read_pass, pass_idx);
+            range->last_read_pass = rx::algorithm::max(range->last_read_pass, pass_idx);
+        };
 
-                if(pass_idx < tex_range->first_write_pass) {
-                    tex_range->first_write_pass = pass_idx;
-                } else if(pass_idx > tex_range->last_write_pass) {
-                    tex_range->last_write_pass = pass_idx;
-                }
+        const auto add_write = [&](const rx::string& name, const uint32_t pass_idx) {
+            auto* range = get_range(name);
+            range->first_write_pass = rx::algorithm::min(range->first_write_pass, pass_idx);
+            range->last_write_pass = rx::algorithm::max(range->last_write_pass, pass_idx);
+        };
 
-                if(resources_in_order.find(output.name) == rx::vector<rx::string>::k_npos) {
-                    resources_in_order.push_back(output.name);
-                }
-            });
+        uint32_t pass_idx = 0;
+        passes.each_fwd([&](const RenderPassCreateInfo& pass) {
+            pass.texture_inputs.each_fwd([&](const rx::string& input) { add_read(input, pass_idx); });
+
+            pass.texture_outputs.each_fwd([&](const TextureAttachmentInfo& output) { add_write(output.name, pass_idx); });
+
+            if(pass.depth_texture) {
+                add_write(pass.depth_texture->name, pass_idx);
+            }
 
             pass_idx++;
         });
@@ -245,33 +413,56 @@ namespace nova::renderer::renderpack {
                                                                    const rx::vector<rx::string>& resources_in_order) {
         rx::map<rx::string, rx::string> aliases;
 
-        for(size_t i = 0; i < resources_in_order.size(); i++) {
-            const auto& to_alias_name = resources_in_order[i];
-            logger(rx::log::level::k_verbose,
-                   "Determining if we can alias `%s`. Does it exist? %d",
-                   to_alias_name,
-                   (textures.find(to_alias_name) != nullptr));
+        // The textures which have their own memory, in usage order, and the names of all the textures which use each of their memory
+        rx::vector<rx::string> memory_owners;
+        rx::map<rx::string, rx::vector<rx::string>> memory_users;
 
-            if(to_alias_name == BACKBUFFER_NAME || to_alias_name == SCENE_OUTPUT_RT_NAME) {
+        resources_in_order.each_fwd([&](const rx::string& to_alias_name) {
+            if(to_alias_name == BACKBUFFER_NAME || to_alias_name == SCENE_OUTPUT_RT_NAME || to_alias_name == UI_OUTPUT_RT_NAME) {
                 // Yay special cases!
-                continue;
+                return;
             }
 
-            const auto& to_alias_format = textures.find(to_alias_name)->format;
-
-            // Only try to alias with lower-indexed resources
-            for(size_t j = 0; j < i; j++) {
-                logger(rx::log::level::k_verbose, "Trying to alias it with resource at index %zu out of %zu", j, resources_in_order.size());
-                const rx::string& try_alias_name = resources_in_order[j];
-                if(resource_used_range.find(to_alias_name)->is_disjoint_with(*resource_used_range.find(try_alias_name))) {
-                    // They can be aliased if they have the same format
-                    const auto& try_alias_format = textures.find(try_alias_name)->format;
-                    if(to_alias_format == try_alias_format) {
-                        aliases.insert(to_alias_name, try_alias_name);
-                    }
+            const auto* to_alias = textures.find(to_alias_name);
+            if(to_alias == nullptr) {
+                // Only dynamic textures can be aliased
+                return;
+            }
+
+            const auto& to_alias_range = *resource_used_range.find(to_alias_name);
+
+            // A texture can use the memory of an earlier texture if they have the same format, and if no texture which already uses that
+            // memory is used at the same time as the new texture
+            const auto owner_idx = memory_owners.find_if([&](const rx::string& owner_name) {
+                if(!(textures.find(owner_name)->format == to_alias->format)) {
+                    return false;
                 }
+
+                bool is_disjoint = true;
+                memory_users.find(owner_name)->each_fwd([&](const rx::string& user_name) {
+                    if(!to_alias_range.is_disjoint_with(*resource_used_range.find(user_name))) {
+                        is_disjoint = false;
+                    }
+                });
+
+                return is_disjoint;
+            });
+
+            if(owner_idx != rx::vector<rx::string>::k_npos) {
+                const auto& owner_name = memory_owners[owner_idx];
+                logger(rx::log::level::k_verbose, "Texture %s can use the memory of texture %s", to_alias_name, owner_name);
+
+                aliases.insert(to_alias_name, owner_name);
+                memory_users.find(owner_name)->push_back(to_alias_name);
+
+            } else {
+                memory_owners.push_back(to_alias_name);
+
+                rx::vector<rx::string> users;
+                users.push_back(to_alias_name);
+                memory_users.insert(to_alias_name, users);
             }
-        }
+        });
 
         return aliases;
     }
@@ -28,17 +28,31 @@ namespace nova::renderer::renderpack {
     /*!
      * \brief Orders the provided render passes to satisfy both their implicit and explicit dependencies
      *
+     * Only the passes which contribute to the backbuffer are ordered. A pass depends on every other pass which writes to a resource that
+     * it reads. The passes are sorted with Kahn's algorithm, so ordering takes time linear in the number of passes plus the number of
+     * dependencies
+     *
+     * If `reorder_to_reduce_barriers` is true, the sorted passes are then grouped by the length of the longest chain of dependencies that
+     * ends at them. All the passes in a group can share one barrier, and independent passes end up between producers and their
+     * consumers. This may make render targets live longer, which leaves fewer render targets that can be aliased. A pass which reads
+     * another pass's outputs through input attachments is kept right after that pass when its other dependencies allow it, so that the
+     * rendergraph can still merge them
+     *
+     * Fails if no pass writes to the backbuffer, or if the passes have a circular dependency
+     *
      * \param passes A map from pass name to pass of all the passes to order
+     * \param reorder_to_reduce_barriers Whether to reorder the sorted passes so that they need fewer barriers
      * \return The names of the passes in submission order
      */
-    ntl::Result<rx::vector<RenderPassCreateInfo>> order_passes(const rx::vector<RenderPassCreateInfo>& passes);
+    ntl::Result<rx::vector<RenderPassCreateInfo>> order_passes(const rx::vector<RenderPassCreateInfo>& passes,
+                                                               bool reorder_to_reduce_barriers = true);
 
     /*!
      * \brief Puts textures in usage order and determines which have overlapping usage ranges
      *
      * Knowing which textures have an overlapping usage range is super important cause if their ranges overlap, they can't be aliased
      *
-     * \param passes All the passes in the current frame graph
+     * \param passes All the passes in the current frame graph, in submission order
      * \param resource_used_range A map to hold the usage ranges of each texture
      * \param resources_in_order A vector to hold the textures in usage order
      */
@@ -47,13 +61,17 @@ namespace nova::renderer::renderpack {
                                            rx::vector<rx::string>& resources_in_order);
 
     /*!
-     * \brief Determines which textures can be aliased to which other textures
+     * \brief Determines which textures can share memory with which other textures
+     *
+     * Textures can share memory if they have the same format and if their usage ranges don't overlap. Textures which are read before
+     * they're written in a frame need to keep their contents from the previous frame, so they always get their own memory
      *
      * \param textures All the dynamic textures that this frame graph needs
      * \param resource_used_range The range of passes where each texture is used
      * \param resources_in_order The dynamic textures in usage order
      *
-     * \return A map from texture name to the name of the texture the first texture can be aliased with
+     * \return A map from texture name to the name of the texture whose memory the first texture can use. Textures which need their own
+     * memory aren't in the map
      */
     rx::map<rx::string, rx::string> determine_aliasing_of_textures(const rx::map<rx::string, TextureCreateInfo>& textures,
                                                                    const rx::map<rx::string, Range>& resource_used_range,
@@ -73,6 +73,16 @@ namespace nova::renderer::renderpack {
         RenderPassCreateInfo info = {};
 
         info.texture_inputs = get_json_array<rx::string>(json, "textureInputs");
+
+        get_json_array<rx::string>(json, "inputAttachments").each_fwd([&](const rx::string& attachment_name) {
+            TextureAttachmentInfo attachment = {};
+            attachment.name = attachment_name;
+            info.input_attachments.push_back(attachment);
+
+            if(info.texture_inputs.find(attachment_name) == rx::vector<rx::string>::k_npos) {
+                info.texture_inputs.push_back(attachment_name);
+            }
+        });
         info.texture_outputs = get_json_array<TextureAttachmentInfo>(json, "textureOutputs");
         info.depth_texture = get_json_opt<TextureAttachmentInfo>(json, "depthTexture");
 
@@ -81,6 +91,9 @@ namespace nova::renderer::renderpack {
 
         info.name = get_json_value<rx::string>(json, "name", "<NAME_MISSING>");
 
+        info.is_compute = get_json_value<bool>(json, "compute", false);
+        info.allows_async_compute = info.is_compute && get_json_value<bool>(json, "asyncCompute", false);
+
         return info;
     }
 
@@ -185,6 +198,17 @@ namespace nova::renderer::renderpack {
             pipeline.fragment_shader->filename = *fragment_shader_name;
         }
 
+        const auto compute_shader_name = get_json_opt<rx::string>(json, "computeShader");
+        if(compute_shader_name) {
+            pipeline.compute_shader = RenderpackShaderSource{};
+            pipeline.compute_shader->filename = *compute_shader_name;
+        }
+
+        const auto workgroup_count = get_json_array<uint32_t>(json, "workgroupCount");
+        if(workgroup_count.size() == 3) {
+            pipeline.workgroup_count = glm::uvec3{workgroup_count[0], workgroup_count[1], workgroup_count[2]};
+        }
+
         return pipeline;
     }
 
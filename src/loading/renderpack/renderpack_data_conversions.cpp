@@ -4,6 +4,7 @@
 #include "nova_renderer/rhi/rhi_enums.hpp"
 #include "nova_renderer/renderpack_data.hpp"
 
+#include "rx/core/algorithm/max.h"
 #include "rx/core/log.h"
 #include "spirv_glsl.hpp"
 
@@ -221,6 +222,21 @@ namespace nova::renderer::renderpack {
         }
     }
 
+    /*!
+     * \brief Gets the workgroup size that a compute shader declares
+     */
+    glm::uvec3 get_workgroup_size(const ShaderSource& compute_shader) {
+        const CompilerGLSL shader_compiler{compute_shader.source.data(), compute_shader.source.size()};
+
+        glm::uvec3 workgroup_size;
+        for(uint32_t i = 0; i < 3; i++) {
+            // Workgroup sizes which come from specialization constants read as 0
+            workgroup_size[i] = rx::algorithm::max(shader_compiler.get_execution_mode_argument(spv::ExecutionModeLocalSize, i), 1u);
+        }
+
+        return workgroup_size;
+    }
+
     rx::optional<PipelineStateCreateInfo> to_pipeline_state_create_info(const PipelineData& data,
                                                                         const Rendergraph& rendergraph) {
         constexpr auto npos = rx::vector<RasterizerState>::k_npos;
@@ -249,6 +265,9 @@ namespace nova::renderer::renderpack {
         }
         info.viewport_size = pass->framebuffer->size;
 
+        info.renderpass = pass->get_renderpass();
+        info.subpass_index = pass->subpass_index;
+
         info.enable_scissor_test = data.scissor_mode == ScissorTestMode::DynamicScissorRect;
 
         // Input assembly
@@ -337,4 +356,39 @@ namespace nova::renderer::renderpack {
 
         return info;
     }
+
+    rx::optional<ComputePipelineCreateInfo> to_compute_pipeline_create_info(const PipelineData& data, const Rendergraph& rendergraph) {
+        if(!data.compute_shader) {
+            logger(rx::log::level::k_error, "Pipeline %s doesn't have a compute shader", data.name);
+            return rx::nullopt;
+        }
+
+        const auto* pass = rendergraph.get_renderpass(data.pass);
+        if(pass == nullptr) {
+            logger(rx::log::level::k_error, "Could not find render pass %s, which pipeline %s needs", data.pass, data.name);
+            return rx::nullopt;
+        }
+
+        if(!pass->is_compute) {
+            logger(rx::log::level::k_error, "Compute pipeline %s is in pass %s, which isn't a compute pass", data.name, data.pass);
+            return rx::nullopt;
+        }
+
+        ComputePipelineCreateInfo info{};
+        info.name = data.name;
+        info.compute_shader = to_shader_source(*data.compute_shader);
+
+        if(data.workgroup_count) {
+            info.workgroup_count = *data.workgroup_count;
+
+        } else {
+            const auto workgroup_size = get_workgroup_size(info.compute_shader);
+            info.workgroup_size = workgroup_size;
+            info.workgroup_count = {(pass->output_size.x + workgroup_size.x - 1) / workgroup_size.x,
+                                    (pass->output_size.y + workgroup_size.y - 1) / workgroup_size.y,
+                                    1};
+        }
+
+        return info;
+    }
 }; // namespace nova::renderer::renderpack
@@ -11,9 +11,9 @@
 #include "nova_renderer/filesystem/filesystem_helpers.hpp"
 #include "nova_renderer/filesystem/folder_accessor.hpp"
 #include "nova_renderer/filesystem/virtual_filesystem.hpp"
+#include "nova_renderer/tracing.hpp"
 
 #include "../json_utils.hpp"
-#include "minitrace.h"
 #include "render_graph_builder.hpp"
 #include "renderpack_validator.hpp"
 
@@ -177,6 +177,17 @@ namespace nova::renderer::renderpack {
                 return true;
             });
 
+            pass.input_attachments.each_fwd([&](TextureAttachmentInfo& input) {
+                textures.each_fwd([&](const TextureCreateInfo& texture_info) {
+                    if(texture_info.name == input.name) {
+                        input.pixel_format = texture_info.format.pixel_format;
+                        return false;
+                    }
+
+                    return true;
+                });
+            });
+
             if(pass.depth_texture) {
                 rx::optional<rhi::PixelFormat> pixel_format;
                 textures.each_fwd([&](const TextureCreateInfo& texture_info) {
@@ -198,7 +209,7 @@ namespace nova::renderer::renderpack {
     void cache_pipelines_by_renderpass(RenderpackData& data);
 
     RenderpackData load_renderpack_data(const rx::string& renderpack_name) {
-        MTR_SCOPE("load_renderpack_data", renderpack_name.data());
+        NOVA_TRACE_SCOPE("load_renderpack_data", renderpack_name);
 
         FolderAccessorBase* folder_access = VirtualFilesystem::get_instance()->get_folder_accessor(renderpack_name);
 
@@ -230,7 +241,7 @@ namespace nova::renderer::renderpack {
     }
 
     rx::optional<RenderpackResourcesData> load_dynamic_resources_file(FolderAccessorBase* folder_access) {
-        MTR_SCOPE("load_dynamic_resource_file", "Self");
+        NOVA_TRACE_SCOPE("load_dynamic_resource_file", "Self");
 
         const rx::string resources_string = folder_access->read_text_file(RESOURCES_FILE);
 
@@ -245,7 +256,7 @@ namespace nova::renderer::renderpack {
     }
 
     ntl::Result<RendergraphData> load_rendergraph_file(FolderAccessorBase* folder_access) {
-        MTR_SCOPE("load_rendergraph_file", "Self");
+        NOVA_TRACE_SCOPE("load_rendergraph_file", "Self");
 
         const auto passes_bytes = folder_access->read_text_file("rendergraph.json");
 
@@ -283,7 +294,7 @@ namespace nova::renderer::renderpack {
     }
 
     rx::vector<PipelineData> load_pipeline_files(FolderAccessorBase* folder_access) {
-        MTR_SCOPE("load_pipeline_files", "Self");
+        NOVA_TRACE_SCOPE("load_pipeline_files", "Self");
 
         rx::vector<rx::string> potential_pipeline_files = folder_access->get_all_items_in_folder("materials");
 
@@ -308,7 +319,7 @@ namespace nova::renderer::renderpack {
     }
 
     rx::optional<PipelineData> load_single_pipeline(FolderAccessorBase* folder_access, const rx::string& pipeline_path) {
-        MTR_SCOPE("load_single_pipeline", pipeline_path.data());
+        NOVA_TRACE_SCOPE("load_single_pipeline", pipeline_path);
 
         const auto pipeline_bytes = folder_access->read_text_file(pipeline_path);
 
@@ -321,6 +332,17 @@ namespace nova::renderer::renderpack {
         }
 
         auto new_pipeline = json_pipeline.decode<PipelineData>({});
+        if(new_pipeline.compute_shader) {
+            (*new_pipeline.compute_shader).source = load_shader_file((*new_pipeline.compute_shader).filename,
+                                                                     folder_access,
+                                                                     rhi::ShaderStage::Compute,
+                                                                     new_pipeline.defines);
+
+            logger(rx::log::level::k_verbose, "Load of compute pipeline %s succeeded", pipeline_path);
+
+            return new_pipeline;
+        }
+
         new_pipeline.vertex_shader.source = load_shader_file(new_pipeline.vertex_shader.filename,
                                                              folder_access,
                                                              rhi::ShaderStage::Vertex,
@@ -365,7 +387,7 @@ namespace nova::renderer::renderpack {
                                           FolderAccessorBase* folder_access,
                                           const rhi::ShaderStage stage,
                                           const rx::vector<rx::string>& defines) {
-        MTR_SCOPE("load_shader_file", filename.data());
+        NOVA_TRACE_SCOPE("load_shader_file", filename);
 
         if(filename.ends_with(".spirv")) {
             // SPIR-V file!
@@ -394,7 +416,7 @@ namespace nova::renderer::renderpack {
     }
 
     rx::vector<MaterialData> load_material_files(FolderAccessorBase* folder_access) {
-        MTR_SCOPE("load_material_files", "Self");
+        NOVA_TRACE_SCOPE("load_material_files", "Self");
 
         rx::vector<rx::string> potential_material_files = folder_access->get_all_items_in_folder("materials");
 
@@ -415,7 +437,7 @@ namespace nova::renderer::renderpack {
     }
 
     MaterialData load_single_material(FolderAccessorBase* folder_access, const rx::string& material_path) {
-        MTR_SCOPE("load_single_material", material_path.data());
+        NOVA_TRACE_SCOPE("load_single_material", material_path);
 
         const rx::string material_text = folder_access->read_text_file(material_path);
 
@@ -496,7 +518,7 @@ namespace nova::renderer::renderpack {
     }
 
     rx::vector<uint32_t> compile_shader(const rx::string& source, const rhi::ShaderStage stage, const rhi::ShaderLanguage source_language) {
-        MTR_SCOPE("compile_shader", "Self");
+        NOVA_TRACE_SCOPE("compile_shader", "Self");
 
         const auto glslang_stage = to_glslang_shader_stage(stage);
 
@@ -45,7 +45,7 @@ namespace nova::renderer::renderpack {
                                                         "geometryShader"};
     ;
 
-    const rx::array<rx::string[3]> required_graphics_pipeline_fields = {"name", "pass", "vertexShader"};
+    const rx::array<rx::string[2]> required_pipeline_fields = {"name", "pass"};
 
     const rx::array<rx::string[2]> required_texture_fields = {"pixelFormat", "dimensionType"};
 
@@ -71,14 +71,19 @@ namespace nova::renderer::renderpack {
         }
 
         // Check required items
-        report.errors.reserve(required_graphics_pipeline_fields.size());
-        for(uint32_t i = 0; i < required_graphics_pipeline_fields.size(); i++) {
-            const auto& field_name = required_graphics_pipeline_fields[i];
+        report.errors.reserve(required_pipeline_fields.size() + 1);
+        for(uint32_t i = 0; i < required_pipeline_fields.size(); i++) {
+            const auto& field_name = required_pipeline_fields[i];
             if(!pipeline_json[field_name.data()]) {
                 report.errors.emplace_back(pipeline_msg(name, field_name));
             }
         }
 
+        // Compute pipelines have a compute shader instead of a vertex shader
+        if(!pipeline_json["vertexShader"] && !pipeline_json["computeShader"]) {
+            report.errors.emplace_back(pipeline_msg(name, "vertexShader"));
+        }
+
         return report;
     }
 
@@ -22,9 +22,7 @@ namespace nova::mem {
         Block* current = head;
 
         while(current) {
-            if(current->next) {
-                next = current->next;
-            }
+            next = current->next;
 
             allocator->deallocate(reinterpret_cast<rx_byte*>(current));
 
@@ -62,9 +60,15 @@ namespace nova::mem {
 
             block->next = best_fit->next;
             block->previous = best_fit;
+            if(best_fit->next) {
+                best_fit->next->previous = block;
+            }
             best_fit->next = block;
+
+            best_fit->size = size;
         }
 
+        best_fit->free = false;
         allocated += size;
 
         allocation.size = size;
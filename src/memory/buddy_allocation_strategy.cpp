@@ -0,0 +1,118 @@
+#include "nova_renderer/memory/buddy_allocation_strategy.hpp"
+
+#include <rx/core/algorithm/max.h>
+#include <rx/core/assert.h>
+#include <rx/core/math/log2.h>
+
+#include "nova_renderer/memory/allocation_structs.hpp"
+
+using namespace nova::mem::operators;
+
+namespace nova::mem {
+    /*!
+     * \brief Gets the order of the smallest power of two that's at least `value`
+     */
+    static uint32_t ceil_log2(const uint64_t value) {
+        return value <= 1 ? 0 : static_cast<uint32_t>(rx::math::log2(static_cast<rx_u64>(value - 1))) + 1;
+    }
+
+    /*!
+     * \brief Gets the value of a node from the values of its children
+     *
+     * \param left The value of the left child
+     * \param right The value of the right child
+     * \param child_order The order of the children's blocks
+     */
+    static uint8_t combine_children(const uint8_t left, const uint8_t right, const uint32_t child_order) {
+        const auto free_child = static_cast<uint8_t>(child_order + 1);
+        if(left == free_child && right == free_child) {
+            // Both halves are free, so the node's whole block is free
+            return static_cast<uint8_t>(child_order + 2);
+        }
+
+        return rx::algorithm::max(left, right);
+    }
+
+    BuddyAllocationStrategy::BuddyAllocationStrategy(rx::memory::allocator* allocator_in,
+                                                     const Bytes size,
+                                                     const Bytes min_block_size_in)
+        : min_block_size(min_block_size_in), tree(allocator_in) {
+        RX_ASSERT(min_block_size > 0_b && (min_block_size & (min_block_size - 1)) == 0_b,
+                  "The minimum block size must be a power of two");
+
+        const uint64_t num_min_blocks = size.b_count() / min_block_size.b_count();
+        usable_size = min_block_size * num_min_blocks;
+
+        max_order = ceil_log2(num_min_blocks);
+
+        const uint64_t num_leaves = uint64_t{1} << max_order;
+        tree.resize(num_leaves * 2 - 1);
+
+        // The leaves past the end of the memory are marked as allocated, so no block that contains them is ever allocated
+        const uint64_t first_leaf_idx = num_leaves - 1;
+        for(uint64_t leaf = 0; leaf < num_leaves; leaf++) {
+            tree[first_leaf_idx + leaf] = leaf < num_min_blocks ? 1 : 0;
+        }
+
+        for(uint32_t order = 1; order <= max_order; order++) {
+            const uint64_t first_node_idx = (uint64_t{1} << (max_order - order)) - 1;
+            for(uint64_t node_idx = first_node_idx; node_idx < first_node_idx * 2 + 1; node_idx++) {
+                tree[node_idx] = combine_children(tree[node_idx * 2 + 1], tree[node_idx * 2 + 2], order - 1);
+            }
+        }
+    }
+
+    bool BuddyAllocationStrategy::allocate(const Bytes size, AllocationInfo& allocation) {
+        const auto min_block_bytes = min_block_size.b_count();
+        const uint64_t num_min_blocks = size > 0_b ? (size.b_count() + min_block_bytes - 1) / min_block_bytes : 1;
+        const uint32_t order = ceil_log2(num_min_blocks);
+
+        if(order > max_order || tree[0] < order + 1) {
+            return false;
+        }
+
+        // Walk down to a free block of the right order, preferring the left child so that allocations pack towards the start
+        uint64_t node_idx = 0;
+        for(uint32_t node_order = max_order; node_order > order; node_order--) {
+            const uint64_t left_child_idx = node_idx * 2 + 1;
+            node_idx = tree[left_child_idx] >= order + 1 ? left_child_idx : left_child_idx + 1;
+        }
+
+        tree[node_idx] = 0;
+        update_parents(node_idx, order);
+
+        const Bytes block_size = min_block_size * (uint64_t{1} << order);
+        const uint64_t first_node_idx = (uint64_t{1} << (max_order - order)) - 1;
+
+        allocated += block_size;
+
+        allocation.size = block_size;
+        allocation.offset = block_size * (node_idx - first_node_idx);
+        allocation.internal_data = nullptr;
+
+        return true;
+    }
+
+    void BuddyAllocationStrategy::free(const AllocationInfo& alloc) {
+        const uint32_t order = ceil_log2(alloc.size.b_count() / min_block_size.b_count());
+        const uint64_t first_node_idx = (uint64_t{1} << (max_order - order)) - 1;
+        const uint64_t node_idx = first_node_idx + alloc.offset.b_count() / alloc.size.b_count();
+
+        tree[node_idx] = static_cast<uint8_t>(order + 1);
+        update_parents(node_idx, order);
+
+        allocated -= alloc.size;
+    }
+
+    Bytes BuddyAllocationStrategy::get_free_size() const { return usable_size - allocated; }
+
+    void BuddyAllocationStrategy::update_parents(uint64_t node_idx, uint32_t node_order) {
+        while(node_idx > 0) {
+            node_idx = (node_idx - 1) / 2;
+
+            tree[node_idx] = combine_children(tree[node_idx * 2 + 1], tree[node_idx * 2 + 2], node_order);
+
+            node_order++;
+        }
+    }
+} // namespace nova::mem
@@ -6,6 +6,8 @@
 
 #include "../util/memory_utils.hpp"
 
+using namespace nova::mem::operators;
+
 namespace nova::mem {
     BumpPointAllocationStrategy::BumpPointAllocationStrategy(const Bytes size_in, const Bytes alignment_in)
         : memory_size(size_in), alignment(alignment_in) {}
@@ -14,7 +16,7 @@ namespace nova::mem {
         const Bytes free_space = memory_size - allocated_bytes;
         const Bytes aligned_size = align(size, alignment);
 
-        if(aligned_size < free_space) {
+        if(aligned_size > free_space) {
             return false;
         }
 
@@ -27,4 +29,6 @@ namespace nova::mem {
     }
 
     void BumpPointAllocationStrategy::free(const AllocationInfo&) { RX_ASSERT(false && "Cannot free from a bump-point allocator!\n"); }
+
+    void BumpPointAllocationStrategy::reset() { allocated_bytes = 0_b; }
 } // namespace nova::mem
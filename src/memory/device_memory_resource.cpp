@@ -1,13 +1,31 @@
 #include "nova_renderer/rhi/device_memory_resource.hpp"
 
+#include <rx/core/concurrency/scope_lock.h>
+
+#include "../util/memory_utils.hpp"
+
 namespace nova::renderer {
     DeviceMemoryResource::DeviceMemoryResource(rhi::RhiDeviceMemory* memory, mem::AllocationStrategy* allocation_strategy)
         : allocation_strategy(allocation_strategy), memory(memory) {}
 
-    DeviceMemoryAllocation DeviceMemoryResource::allocate(const mem::Bytes size) const {
+    rx::optional<DeviceMemoryAllocation> DeviceMemoryResource::allocate(const mem::Bytes size, const mem::Bytes alignment) {
+        // The allocation strategy doesn't know about the alignment, so allocate enough extra memory to move the start of the allocation
+        // to the next aligned offset
+        const auto padded_size = alignment > 1_b ? size + alignment - 1_b : size;
+
         mem::AllocationInfo alloc_info;
-        allocation_strategy->allocate(size, alloc_info);
+        {
+            rx::concurrency::scope_lock l(mutex);
+            if(!allocation_strategy->allocate(padded_size, alloc_info)) {
+                return rx::nullopt;
+            }
+        }
+
+        return DeviceMemoryAllocation{memory, alloc_info, mem::align(alloc_info.offset, alignment)};
+    }
 
-        return {memory, alloc_info};
+    void DeviceMemoryResource::free(const DeviceMemoryAllocation& allocation) {
+        rx::concurrency::scope_lock l(mutex);
+        allocation_strategy->free(allocation.allocation_info);
     }
-} // namespace nova::renderer
\ No newline at end of file
+} // namespace nova::renderer
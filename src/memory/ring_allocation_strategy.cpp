@@ -0,0 +1,96 @@
+#include "nova_renderer/memory/ring_allocation_strategy.hpp"
+
+#include <rx/core/concurrency/scope_lock.h>
+
+#include "nova_renderer/memory/allocation_structs.hpp"
+
+#include "../util/memory_utils.hpp"
+
+using namespace nova::mem::operators;
+
+namespace nova::mem {
+    RingAllocationStrategy::RingAllocationStrategy(rx::memory::allocator* allocator_in, const Bytes size_in, const Bytes alignment_in)
+        : memory_size(size_in), alignment(alignment_in), in_flight_frames(allocator_in) {}
+
+    bool RingAllocationStrategy::allocate(const Bytes size, AllocationInfo& allocation) {
+        rx::concurrency::scope_lock l(mutex);
+
+        const Bytes aligned_size = align(size > 0_b ? size : 1_b, alignment);
+        if(aligned_size > memory_size - used) {
+            return false;
+        }
+
+        if(used == 0_b) {
+            // Nothing is in flight, so start over at the beginning of the memory to get as much contiguous space as possible
+            head = 0_b;
+            tail = 0_b;
+        }
+
+        Bytes offset{0};
+        Bytes skipped_size{0};
+
+        if(head >= tail) {
+            // The free memory is after the head and before the tail
+            if(memory_size - head >= aligned_size) {
+                offset = head;
+
+            } else if(tail >= aligned_size) {
+                skipped_size = memory_size - head;
+                offset = 0_b;
+
+            } else {
+                return false;
+            }
+
+        } else if(tail - head >= aligned_size) {
+            // The free memory is between the head and the tail
+            offset = head;
+
+        } else {
+            return false;
+        }
+
+        head = offset + aligned_size;
+        used += aligned_size + skipped_size;
+        current_frame_size += aligned_size + skipped_size;
+
+        allocation.size = aligned_size;
+        allocation.offset = offset;
+
+        return true;
+    }
+
+    void RingAllocationStrategy::free(const AllocationInfo& /* alloc */) {}
+
+    void RingAllocationStrategy::end_frame(const uint64_t frame_count) {
+        rx::concurrency::scope_lock l(mutex);
+
+        in_flight_frames.push_back(FrameRegion{frame_count, current_frame_size});
+        current_frame_size = 0_b;
+    }
+
+    void RingAllocationStrategy::retire_frames(const uint64_t last_finished_frame) {
+        rx::concurrency::scope_lock l(mutex);
+
+        uint32_t num_retired_frames = 0;
+        while(num_retired_frames < in_flight_frames.size() && in_flight_frames[num_retired_frames].frame_count <= last_finished_frame) {
+            const Bytes frame_size = in_flight_frames[num_retired_frames].size;
+            if(frame_size > 0_b) {
+                tail = (tail + frame_size) % memory_size;
+                used -= frame_size;
+            }
+
+            num_retired_frames++;
+        }
+
+        if(num_retired_frames > 0) {
+            in_flight_frames.erase(0, num_retired_frames);
+        }
+    }
+
+    Bytes RingAllocationStrategy::get_free_size() const {
+        rx::concurrency::scope_lock l(mutex);
+
+        return memory_size - used;
+    }
+} // namespace nova::mem
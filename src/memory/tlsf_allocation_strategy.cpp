@@ -0,0 +1,250 @@
+#include "nova_renderer/memory/tlsf_allocation_strategy.hpp"
+
+#include <rx/core/math/log2.h>
+#include <rx/core/memory/allocator.h>
+#include <rx/core/utility/bit.h>
+#include <rx/core/utility/construct.h>
+
+#include "nova_renderer/memory/allocation_structs.hpp"
+
+using namespace nova::mem::operators;
+
+namespace nova::mem {
+    TlsfAllocationStrategy::TlsfAllocationStrategy(rx::memory::allocator* allocator_in, const Bytes size, const Bytes alignment_in)
+        : allocator(allocator_in), block_chunks(allocator_in) {
+        if(alignment_in > 0_b) {
+            granularity = alignment_in;
+        }
+
+        // Every block is a whole number of granules, so any bytes past the last whole granule can't be allocated
+        memory_size = size - size % granularity;
+
+        if(memory_size > 0_b) {
+            insert_free_block(make_new_block(0_b, memory_size));
+        }
+    }
+
+    TlsfAllocationStrategy::~TlsfAllocationStrategy() {
+        block_chunks.each_fwd([&](Block* chunk) { allocator->deallocate(reinterpret_cast<rx_byte*>(chunk)); });
+    }
+
+    bool TlsfAllocationStrategy::allocate(const Bytes size, AllocationInfo& allocation) {
+        const auto granule_size = granularity.b_count();
+        const uint64_t num_granules = size > 0_b ? (size.b_count() + granule_size - 1) / granule_size : 1;
+
+        Block* block = find_free_block(num_granules);
+        if(block == nullptr) {
+            return false;
+        }
+
+        remove_free_block(block);
+
+        const Bytes aligned_size = granularity * num_granules;
+        if(block->size > aligned_size) {
+            // Give the rest of the block back to the free lists
+            Block* remainder = make_new_block(block->offset + aligned_size, block->size - aligned_size);
+
+            remainder->previous_physical = block;
+            remainder->next_physical = block->next_physical;
+            if(block->next_physical) {
+                block->next_physical->previous_physical = remainder;
+            }
+            block->next_physical = remainder;
+            block->size = aligned_size;
+
+            insert_free_block(remainder);
+        }
+
+        block->free = false;
+        allocated += aligned_size;
+
+        allocation.size = aligned_size;
+        allocation.offset = block->offset;
+        allocation.internal_data = block;
+
+        return true;
+    }
+
+    void TlsfAllocationStrategy::free(const AllocationInfo& alloc) {
+        auto* block = static_cast<Block*>(alloc.internal_data);
+        block->free = true;
+
+        allocated -= block->size;
+
+        if(Block* previous = block->previous_physical; previous && previous->free) {
+            // Merge this block into the free block before it
+            remove_free_block(previous);
+
+            previous->size += block->size;
+            previous->next_physical = block->next_physical;
+            if(block->next_physical) {
+                block->next_physical->previous_physical = previous;
+            }
+
+            recycle_block(block);
+
+            block = previous;
+        }
+
+        if(Block* next = block->next_physical; next && next->free) {
+            // Merge the free block after this block into this block
+            remove_free_block(next);
+
+            block->size += next->size;
+            block->next_physical = next->next_physical;
+            if(next->next_physical) {
+                next->next_physical->previous_physical = block;
+            }
+
+            recycle_block(next);
+        }
+
+        insert_free_block(block);
+    }
+
+    Bytes TlsfAllocationStrategy::get_free_size() const { return memory_size - allocated; }
+
+    FragmentationStats TlsfAllocationStrategy::get_fragmentation_stats() const {
+        FragmentationStats stats;
+        stats.free_size = get_free_size();
+
+        if(first_level_bitmap == 0) {
+            return stats;
+        }
+
+        // The largest free block is in the non-empty list with the largest blocks, but that list covers a range of sizes
+        const auto first_level = static_cast<uint32_t>(rx::math::log2(static_cast<rx_u64>(first_level_bitmap)));
+        const auto second_level = static_cast<uint32_t>(rx::math::log2(static_cast<rx_u32>(second_level_bitmaps[first_level])));
+
+        for(const Block* block = free_lists[first_level][second_level]; block; block = block->next_free) {
+            if(block->size > stats.largest_free_block) {
+                stats.largest_free_block = block->size;
+            }
+        }
+
+        return stats;
+    }
+
+    void TlsfAllocationStrategy::get_list_indices(const uint64_t num_granules, uint32_t& first_level, uint32_t& second_level) {
+        if(num_granules < SMALL_BLOCK_GRANULES) {
+            first_level = 0;
+            second_level = static_cast<uint32_t>(num_granules);
+
+        } else {
+            const auto most_significant_bit = static_cast<uint32_t>(rx::math::log2(static_cast<rx_u64>(num_granules)));
+
+            first_level = most_significant_bit - SECOND_LEVEL_INDEX_BITS + 1;
+            second_level = static_cast<uint32_t>(num_granules >> (most_significant_bit - SECOND_LEVEL_INDEX_BITS)) - NUM_SECOND_LEVELS;
+        }
+    }
+
+    TlsfAllocationStrategy::Block* TlsfAllocationStrategy::find_free_block(const uint64_t num_granules) const {
+        uint64_t rounded_num_granules = num_granules;
+        if(num_granules >= SMALL_BLOCK_GRANULES) {
+            // Round the size up to the start of the next free list, so that every block in the list we pick is large enough
+            const auto most_significant_bit = rx::math::log2(static_cast<rx_u64>(num_granules));
+            rounded_num_granules += (uint64_t{1} << (most_significant_bit - SECOND_LEVEL_INDEX_BITS)) - 1;
+        }
+
+        uint32_t first_level;
+        uint32_t second_level;
+        get_list_indices(rounded_num_granules, first_level, second_level);
+
+        // Look for a list in the same first-level range that's at least as large as the one we need
+        uint32_t second_level_map = second_level_bitmaps[first_level] & (~0u << second_level);
+        if(second_level_map == 0) {
+            // There are none, so take the smallest list from a larger first-level range
+            const uint64_t first_level_map = first_level_bitmap & (~uint64_t{0} << (first_level + 1));
+            if(first_level_map == 0) {
+                // The list that the size itself falls into may still have a block that's large enough, such as when the whole memory
+                // is allocated at once
+                uint32_t exact_first_level;
+                uint32_t exact_second_level;
+                get_list_indices(num_granules, exact_first_level, exact_second_level);
+
+                Block* block = free_lists[exact_first_level][exact_second_level];
+                if(block != nullptr && block->size >= granularity * num_granules) {
+                    return block;
+                }
+
+                return nullptr;
+            }
+
+            first_level = static_cast<uint32_t>(bit_search_lsb(static_cast<rx_u64>(first_level_map)));
+            second_level_map = second_level_bitmaps[first_level];
+        }
+
+        second_level = static_cast<uint32_t>(bit_search_lsb(static_cast<rx_u32>(second_level_map)));
+
+        return free_lists[first_level][second_level];
+    }
+
+    void TlsfAllocationStrategy::insert_free_block(Block* block) {
+        uint32_t first_level;
+        uint32_t second_level;
+        get_list_indices(block->size.b_count() / granularity.b_count(), first_level, second_level);
+
+        Block* head = free_lists[first_level][second_level];
+        block->previous_free = nullptr;
+        block->next_free = head;
+        if(head) {
+            head->previous_free = block;
+        }
+
+        free_lists[first_level][second_level] = block;
+
+        first_level_bitmap |= uint64_t{1} << first_level;
+        second_level_bitmaps[first_level] |= 1u << second_level;
+    }
+
+    void TlsfAllocationStrategy::remove_free_block(Block* block) {
+        uint32_t first_level;
+        uint32_t second_level;
+        get_list_indices(block->size.b_count() / granularity.b_count(), first_level, second_level);
+
+        if(block->previous_free) {
+            block->previous_free->next_free = block->next_free;
+        } else {
+            free_lists[first_level][second_level] = block->next_free;
+        }
+
+        if(block->next_free) {
+            block->next_free->previous_free = block->previous_free;
+        }
+
+        block->previous_free = nullptr;
+        block->next_free = nullptr;
+
+        if(free_lists[first_level][second_level] == nullptr) {
+            second_level_bitmaps[first_level] &= ~(1u << second_level);
+            if(second_level_bitmaps[first_level] == 0) {
+                first_level_bitmap &= ~(uint64_t{1} << first_level);
+            }
+        }
+    }
+
+    TlsfAllocationStrategy::Block* TlsfAllocationStrategy::make_new_block(const Bytes offset, const Bytes size) {
+        if(unused_blocks == nullptr) {
+            auto* chunk = reinterpret_cast<Block*>(allocator->allocate(sizeof(Block) * BLOCKS_PER_CHUNK));
+            block_chunks.push_back(chunk);
+
+            for(uint32_t i = 0; i < BLOCKS_PER_CHUNK; i++) {
+                recycle_block(rx::utility::construct<Block>(chunk + i));
+            }
+        }
+
+        Block* block = unused_blocks;
+        unused_blocks = block->next_free;
+
+        *block = {};
+        block->offset = offset;
+        block->size = size;
+
+        return block;
+    }
+
+    void TlsfAllocationStrategy::recycle_block(Block* block) {
+        block->next_free = unused_blocks;
+        unused_blocks = block;
+    }
+} // namespace nova::mem
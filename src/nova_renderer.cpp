@@ -6,12 +6,16 @@
 #pragma warning(push, 0)
 #include <glm/ext.hpp>
 #include <glm/glm.hpp>
-#include <minitrace.h>
 #include <spirv_glsl.hpp>
 #pragma warning(pop)
 
 #include <glslang/MachineIndependent/Initialize.h>
+#include <rx/core/algorithm/clamp.h>
+#include <rx/core/algorithm/min.h>
 #include <rx/core/array.h>
+#include <rx/core/concurrency/scope_lock.h>
+#include <rx/core/concurrency/thread_pool.h>
+#include <rx/core/concurrency/wait_group.h>
 #include <rx/core/global.h>
 #include <rx/core/log.h>
 #include <rx/core/memory/bump_point_allocator.h>
@@ -20,11 +24,15 @@
 #include "nova_renderer/loading/renderpack_loading.hpp"
 #include "nova_renderer/memory/block_allocation_strategy.hpp"
 #include "nova_renderer/memory/bump_point_allocation_strategy.hpp"
+#include "nova_renderer/memory/ring_allocation_strategy.hpp"
+#include "nova_renderer/memory/tlsf_allocation_strategy.hpp"
 #include "nova_renderer/procedural_mesh.hpp"
+#include "nova_renderer/render_statistics.hpp"
 #include "nova_renderer/rendergraph.hpp"
 #include "nova_renderer/renderpack_data_conversions.hpp"
 #include "nova_renderer/rhi/command_list.hpp"
 #include "nova_renderer/rhi/swapchain.hpp"
+#include "nova_renderer/tracing.hpp"
 #include "nova_renderer/ui_renderer.hpp"
 #include "nova_renderer/util/platform.hpp"
 
@@ -32,6 +40,8 @@
 #include "loading/renderpack/render_graph_builder.hpp"
 #include "render_objects/uniform_structs.hpp"
 #include "renderer/builtin/backbuffer_output_pass.hpp"
+#include "rhi/capture/capture_render_device.hpp"
+#include "rhi/headless/headless_render_device.hpp"
 #include "rhi/vulkan/vulkan_render_device.hpp"
 using namespace nova::mem;
 using namespace operators;
@@ -144,6 +154,17 @@ namespace nova::renderer {
             [[vk::binding(2, 0)]]
             SamplerState tex_sampler : register(s0);
 
+            struct RenderScale {
+                float2 scene_uv_scale;
+                float scale;
+            };
+
+            [[vk::binding(3, 0)]]
+            ConstantBuffer<RenderScale> render_scale : register(b0);
+
+            [[vk::binding(4, 0)]]
+            SamplerState scene_sampler : register(s1);
+
             struct VsOutput {
                 float4 position : SV_POSITION;
                 float2 uv : TEXCOORD;
@@ -151,7 +172,14 @@ namespace nova::renderer {
 
             float3 main(VsOutput input) : SV_Target {
                 float4 ui_color = ui_output.Sample(tex_sampler, input.uv);
-                float4 scene_color = scene_output.Sample(tex_sampler, input.uv);
+
+                // The scene may have been rendered to only the top-left part of the scene output. Keep the bilinear filter from reading
+                // the texels past the edge of that part
+                float2 scene_size;
+                scene_output.GetDimensions(scene_size.x, scene_size.y);
+                float2 max_scene_uv = render_scale.scene_uv_scale - 0.5 / scene_size;
+                float2 scene_uv = min(input.uv * render_scale.scene_uv_scale, max_scene_uv);
+                float4 scene_color = scene_output.Sample(scene_sampler, scene_uv);
 
                 float3 combined_color = lerp(scene_color.rgb, ui_color.rgb, ui_color.a);
 
@@ -165,7 +193,8 @@ namespace nova::renderer {
 
         vertex_fields.emplace_back("position", rhi::VertexFieldFormat::Float2);
 
-        // TODO: Figure out how to make the input textures into input attachments
+        // The backbuffer output pass renders into the swapchain's framebuffers and is never merged with the passes which write its
+        // inputs, so it samples its inputs instead of reading them through input attachments
         color_attachments.emplace_back(BACKBUFFER_NAME, rhi::PixelFormat::Rgba8, false);
     }
 
@@ -187,17 +216,17 @@ namespace nova::renderer {
 
         initialize_virtual_filesystem();
 
-        mtr_init("trace.json");
+        tracing::set_events_per_track(settings.trace.events_per_thread);
+        tracing::set_sample_interval(settings.trace.sample_interval);
+        tracing::set_enabled(settings.trace.enabled);
+        tracing::set_thread_name("Main");
 
-        MTR_META_PROCESS_NAME("NovaRenderer");
-        MTR_META_THREAD_NAME("Main");
-
-        MTR_SCOPE("Init", "nova_renderer::nova_renderer");
+        NOVA_TRACE_SCOPE("Init", "nova_renderer::nova_renderer");
 
         window = std::make_unique<NovaWindow>(settings);
 
         if(settings.debug.renderdoc.enabled) {
-            MTR_SCOPE("Init", "LoadRenderdoc");
+            NOVA_TRACE_SCOPE("Init", "LoadRenderdoc");
             auto rd_load_result = load_renderdoc(settings.debug.renderdoc.renderdoc_dll_path);
 
             rd_load_result
@@ -222,12 +251,29 @@ namespace nova::renderer {
                 .on_error([](const ntl::NovaError& error) { rg_log(rx::log::level::k_error, "%s", error.to_string()); });
         }
 
-        {
-            MTR_SCOPE("Init", "InitVulkanRenderDevice");
-            device = std::make_unique<rhi::VulkanRenderDevice>(render_settings, *window, global_allocator);
+        switch(settings.api) {
+            case GraphicsApi::Vulkan: {
+                NOVA_TRACE_SCOPE("Init", "InitVulkanRenderDevice");
+                device = std::make_unique<rhi::VulkanRenderDevice>(render_settings, *window, global_allocator);
+            } break;
+
+            case GraphicsApi::Headless: {
+                NOVA_TRACE_SCOPE("Init", "InitHeadlessRenderDevice");
+                device = std::make_unique<rhi::HeadlessRenderDevice>(render_settings, *window, global_allocator);
+            } break;
+        }
+
+        if(settings.capture.enabled) {
+            device = std::make_unique<rhi::CaptureRenderDevice>(std::move(device), render_settings, *window, global_allocator);
         }
 
         swapchain = device->get_swapchain();
+        applied_swapchain_options = settings.swapchain;
+        applied_window_size = get_window_framebuffer_size();
+
+        create_recording_threads();
+
+        create_gpu_profiler();
 
         create_global_gpu_pools();
 
@@ -250,56 +296,539 @@ namespace nova::renderer {
         create_builtin_renderpasses();
     }
 
-    NovaRenderer::~NovaRenderer() { mtr_shutdown(); }
+    NovaRenderer::~NovaRenderer() {
+        // Let the GPU finish the frames that are still in flight before we destroy anything they use
+        wait_for_all_frames();
+
+        // No frame has waited for the uploads since the last frame, so they may still be reading their staging buffers
+        if(!pending_upload_semaphores.is_empty()) {
+            rhi::CommandList* cmds = device->create_command_list(0,
+                                                                 rhi::QueueType::Graphics,
+                                                                 rhi::CommandList::Level::Primary,
+                                                                 global_allocator);
+            cmds->set_debug_name("WaitForUploads");
+
+            rx::vector<rhi::RhiFence*> upload_fences = device->create_fences(1, false, global_allocator);
+            device->submit_command_list(cmds, rhi::QueueType::Graphics, upload_fences[0], pending_upload_semaphores);
+            device->wait_for_fences(upload_fences);
+            device->destroy_fences(upload_fences, global_allocator);
+
+            pending_staging_buffers.each_fwd([&](rhi::RhiBuffer* staging_buffer) { retire_buffer(staging_buffer, frame_count); });
+        }
+
+        pending_upload_semaphores.each_fwd([&](rhi::RhiSemaphore* semaphore) { free_upload_semaphores.push_back(semaphore); });
+        for(uint32_t i = 0; i < num_in_flight_frames; i++) {
+            waited_upload_semaphores[i].each_fwd([&](rhi::RhiSemaphore* semaphore) { free_upload_semaphores.push_back(semaphore); });
+        }
+        device->destroy_semaphores(free_upload_semaphores, global_allocator);
+
+        if(mesh_memory_defragmenter != nullptr) {
+            global_allocator->destroy<DeviceMemoryDefragmenter>(mesh_memory_defragmenter);
+        }
+
+        destroy_retired_buffers(frame_count);
+
+        // Waits for any pipelines that are still compiling, since they need the render device
+        global_allocator->destroy<PipelineStorage>(pipeline_storage);
+
+        if(gpu_profiler != nullptr) {
+            global_allocator->destroy<GpuProfiler>(gpu_profiler);
+        }
+
+        if(recording_threads != nullptr) {
+            global_allocator->destroy<rx::concurrency::thread_pool>(recording_threads);
+        }
+
+        if(tracing::is_enabled() && render_settings->trace.shutdown_trace_path != nullptr) {
+            tracing::write_trace(render_settings->trace.shutdown_trace_path);
+        }
+    }
 
     NovaSettingsAccessManager& NovaRenderer::get_settings() { return render_settings; }
 
     rx::memory::allocator* NovaRenderer::get_global_allocator() const { return global_allocator; }
 
+    rx::vector<RenderpassGpuTime> NovaRenderer::get_renderpass_gpu_times() const {
+        if(gpu_profiler == nullptr) {
+            return {};
+        }
+
+        return gpu_profiler->get_renderpass_times();
+    }
+
+    float NovaRenderer::get_render_scale() const { return dynamic_resolution.get_render_scale(); }
+
+    mem::FragmentationStats NovaRenderer::get_mesh_memory_fragmentation() const {
+        if(mesh_memory_defragmenter == nullptr) {
+            return {};
+        }
+
+        return mesh_memory_defragmenter->get_fragmentation_stats();
+    }
+
+    FrameStatistics NovaRenderer::get_frame_statistics() const {
+        rx::concurrency::scope_lock l(frame_statistics_mutex);
+
+        if(frame_statistics_history.is_empty()) {
+            return {};
+        }
+
+        const auto num_frames = frame_statistics_history.size();
+        return frame_statistics_history[(oldest_frame_statistics_idx + num_frames - 1) % num_frames];
+    }
+
+    rx::vector<FrameStatistics> NovaRenderer::get_frame_statistics_history() const {
+        rx::concurrency::scope_lock l(frame_statistics_mutex);
+
+        const auto num_frames = frame_statistics_history.size();
+
+        rx::vector<FrameStatistics> history{global_allocator};
+        history.reserve(num_frames);
+        for(rx_size i = 0; i < num_frames; i++) {
+            history.push_back(frame_statistics_history[(oldest_frame_statistics_idx + i) % num_frames]);
+        }
+
+        return history;
+    }
+
     void NovaRenderer::execute_frame() {
-        MTR_SCOPE("RenderLoop", "execute_frame");
         frame_count++;
+        tracing::begin_frame(frame_count);
 
-        rx::memory::bump_point_allocator* frame_allocator = frame_allocators[frame_count % NUM_IN_FLIGHT_FRAMES];
-        frame_allocator->reset();
+        NOVA_TRACE_SCOPE("RenderLoop", "execute_frame");
 
-        cur_frame_idx = device->get_swapchain()->acquire_next_swapchain_image(frame_allocator);
+        cur_frame_idx = static_cast<uint32_t>(frame_count % num_in_flight_frames);
 
+        // Wait for the GPU to finish the last frame that used this frame index, so that we can reuse its resources. The GPU is free to
+        // keep working on the other in-flight frames
         rx::vector<rhi::RhiFence*> cur_frame_fences{global_allocator};
         cur_frame_fences.push_back(frame_fences[cur_frame_idx]);
 
         device->wait_for_fences(cur_frame_fences);
-        device->reset_fences(cur_frame_fences);
 
-        rhi::CommandList* cmds = device->create_command_list(0,
-                                                             rhi::QueueType::Graphics,
-                                                             rhi::CommandList::Level::Primary,
-                                                             frame_allocator);
-        cmds->set_debug_name("RendergraphCommands");
+        {
+            rx::concurrency::scope_lock l(upload_mutex);
+            waited_upload_semaphores[cur_frame_idx].each_fwd(
+                [&](rhi::RhiSemaphore* semaphore) { free_upload_semaphores.push_back(semaphore); });
+            waited_upload_semaphores[cur_frame_idx].clear();
+        }
+
+        // The fence we just waited for belongs to the frame that was `num_in_flight_frames` frames ago, so that frame and every frame
+        // before it is done
+        if(frame_count >= num_in_flight_frames) {
+            // Retires the old buffers of finished mesh moves, so it has to happen before the retired buffers are destroyed
+            defragment_mesh_memory(frame_count - num_in_flight_frames);
+
+            destroy_retired_buffers(frame_count - num_in_flight_frames);
+
+            if(staging_buffer_strategy != nullptr) {
+                staging_buffer_strategy->retire_frames(frame_count - num_in_flight_frames);
+            }
+        }
+
+        if(needs_new_swapchain()) {
+            const auto window_size = get_window_framebuffer_size();
+            if(window_size.x == 0 || window_size.y == 0) {
+                // The window is minimized, so there's nothing to render to
+                return;
+            }
+
+            recreate_swapchain(window_size);
+        }
+
+        update_render_scale();
+
+        rx::memory::bump_point_allocator* frame_allocator = frame_allocators[cur_frame_idx];
+        frame_allocator->reset();
+
+        device->begin_frame(cur_frame_idx);
+
+        cur_swapchain_image_idx = device->get_swapchain()->acquire_next_swapchain_image(image_acquired_semaphores[cur_frame_idx],
+                                                                                        frame_allocator);
+        if(device->get_swapchain()->is_out_of_date()) {
+            // The window changed after we checked it. No image was acquired, so we can try again with a new swapchain
+            recreate_swapchain(get_window_framebuffer_size());
+            cur_swapchain_image_idx = device->get_swapchain()->acquire_next_swapchain_image(image_acquired_semaphores[cur_frame_idx],
+                                                                                            frame_allocator);
+            if(device->get_swapchain()->is_out_of_date()) {
+                return;
+            }
+        }
+
+        // Only reset the fence once we know that this frame will be submitted, or the next wait on it would never finish
+        device->reset_fences(cur_frame_fences);
 
         FrameContext ctx = {};
         ctx.frame_count = frame_count;
         ctx.nova = this;
         ctx.allocator = frame_allocator;
-        ctx.swapchain_framebuffer = swapchain->get_framebuffer(cur_frame_idx);
-        ctx.swapchain_image = swapchain->get_image(cur_frame_idx);
+        ctx.swapchain_framebuffer = swapchain->get_framebuffer(cur_swapchain_image_idx);
+        ctx.swapchain_image = swapchain->get_image(cur_swapchain_image_idx);
+        ctx.gpu_profiler = gpu_profiler;
+        ctx.render_scale = dynamic_resolution.get_render_scale();
+
+        // The GPU may still be reading the model matrices of the other in-flight frames
+        ctx.cur_model_matrix_index = cur_frame_idx * MODEL_MATRICES_PER_FRAME;
+        ctx.model_matrix_slice_end = (cur_frame_idx + 1) * MODEL_MATRICES_PER_FRAME;
+
+        const auto& renderpasses = rendergraph->get_compiled_renderpasses();
+        rendergraph->skip_empty_renderpasses(ctx);
+
+        if(gpu_profiler != nullptr) {
+            gpu_profiler->begin_frame(cur_frame_idx, renderpasses);
+        }
+
+        const auto renderpass_contents = record_renderpass_contents(renderpasses, ctx);
+
+        const auto& submissions = rendergraph->get_submissions();
+
+        // Every submission that waits for another submission gets its own semaphore for that wait, since a binary semaphore can only
+        // be waited on once
+        rx::vector<rx::vector<rhi::RhiSemaphore*>> wait_semaphores{frame_allocator};
+        rx::vector<rx::vector<rhi::RhiSemaphore*>> signal_semaphores{frame_allocator};
+        wait_semaphores.resize(submissions.size(), rx::vector<rhi::RhiSemaphore*>{frame_allocator});
+        signal_semaphores.resize(submissions.size(), rx::vector<rhi::RhiSemaphore*>{frame_allocator});
+
+        auto& semaphores = submission_semaphores[cur_frame_idx];
+        uint32_t num_used_semaphores = 0;
+        for(uint32_t i = 0; i < submissions.size(); i++) {
+            submissions[i].wait_submissions.each_fwd([&](const uint32_t waited_submission) {
+                if(num_used_semaphores == semaphores.size()) {
+                    semaphores.push_back(device->create_semaphore(global_allocator));
+                }
+
+                auto* semaphore = semaphores[num_used_semaphores];
+                num_used_semaphores++;
+
+                wait_semaphores[i].push_back(semaphore);
+                signal_semaphores[waited_submission].push_back(semaphore);
+            });
+        }
+
+        wait_semaphores[0].push_back(image_acquired_semaphores[cur_frame_idx]);
+        signal_semaphores.last().push_back(render_finished_semaphores[cur_frame_idx]);
+
+        {
+            // The frame's first submission waits for every upload that was submitted since the last frame, so the frame's fence also
+            // covers those uploads. Their staging memory is reclaimed once that fence is signaled
+            rx::concurrency::scope_lock l(upload_mutex);
+
+            pending_upload_semaphores.each_fwd([&](rhi::RhiSemaphore* semaphore) { wait_semaphores[0].push_back(semaphore); });
+            waited_upload_semaphores[cur_frame_idx] = rx::utility::move(pending_upload_semaphores);
+            pending_upload_semaphores = rx::vector<rhi::RhiSemaphore*>{global_allocator};
+
+            pending_staging_buffers.each_fwd([&](rhi::RhiBuffer* staging_buffer) { retire_buffer(staging_buffer, frame_count); });
+            pending_staging_buffers.clear();
+
+            if(staging_buffer_strategy != nullptr) {
+                staging_buffer_strategy->end_frame(frame_count);
+            }
+        }
+
+        for(uint32_t i = 0; i < submissions.size(); i++) {
+            const auto queue = submissions[i].queue;
+
+            rhi::CommandList* cmds = device->create_command_list(0, queue, rhi::CommandList::Level::Primary, frame_allocator);
+            cmds->set_debug_name(rx::string::format("RendergraphCommands%u", i));
+
+            // Every other submission runs after the first one, so the first one resets the frame's timestamps
+            if(i == 0 && gpu_profiler != nullptr) {
+                gpu_profiler->reset_queries(*cmds);
+            }
+
+            // The backbuffer output pass reads the render scale on the graphics queue, so the render scale is copied on that queue
+            if(render_scale_changed && queue == rhi::QueueType::Graphics) {
+                write_render_scale_uniforms(*cmds);
+                render_scale_changed = false;
+            }
+
+            rendergraph->execute(*cmds, ctx, renderpass_contents, i);
+
+            const auto is_last_submission = i == submissions.size() - 1;
+            device->submit_command_list(cmds,
+                                        queue,
+                                        is_last_submission ? frame_fences[cur_frame_idx] : nullptr,
+                                        wait_semaphores[i],
+                                        signal_semaphores[i]);
+        }
+
+        device->get_swapchain()->present(cur_swapchain_image_idx, render_finished_semaphores[cur_frame_idx]);
+
+        auto frame_statistics = statistics::end_frame(frame_count, renderpasses, global_allocator);
+
+        rx::concurrency::scope_lock l(frame_statistics_mutex);
+        if(frame_statistics_history.size() < FRAME_STATISTICS_HISTORY_SIZE) {
+            frame_statistics_history.push_back(rx::utility::move(frame_statistics));
+
+        } else {
+            frame_statistics_history[oldest_frame_statistics_idx] = rx::utility::move(frame_statistics);
+            oldest_frame_statistics_idx = (oldest_frame_statistics_idx + 1) % FRAME_STATISTICS_HISTORY_SIZE;
+        }
+    }
+
+    glm::uvec2 NovaRenderer::get_window_framebuffer_size() const {
+        if(render_settings->api == GraphicsApi::Headless) {
+            return {render_settings->window.width, render_settings->window.height};
+        }
+
+        return window->get_framebuffer_size();
+    }
+
+    bool NovaRenderer::needs_new_swapchain() const {
+        const auto& swapchain_options = render_settings->swapchain;
+
+        return device->get_swapchain()->is_out_of_date() || get_window_framebuffer_size() != applied_window_size ||
+               swapchain_options.present_mode != applied_swapchain_options.present_mode ||
+               swapchain_options.num_images != applied_swapchain_options.num_images;
+    }
+
+    void NovaRenderer::recreate_swapchain(const glm::uvec2& window_size) {
+        NOVA_TRACE_SCOPE("RenderLoop", "recreate_swapchain");
+
+        // The other in-flight frames may still be rendering to the swapchain or to the render targets that we're about to resize
+        wait_for_all_frames();
+
+        const auto old_swapchain_size = device->get_swapchain()->get_size();
+
+        device->recreate_swapchain(window_size);
+        swapchain = device->get_swapchain();
+
+        applied_swapchain_options = render_settings->swapchain;
+        applied_window_size = window_size;
+
+        const auto new_swapchain_size = swapchain->get_size();
+        if(new_swapchain_size != old_swapchain_size) {
+            resize_screen_relative_textures(new_swapchain_size);
+
+            // The part of the scene output that's rendered to is rounded to whole pixels, so its UV scale depends on the output's size
+            render_scale_changed = true;
+        }
+
+        logger(rx::log::level::k_info,
+               "Recreated the swapchain with %u images at %ux%u",
+               swapchain->get_num_images(),
+               new_swapchain_size.x,
+               new_swapchain_size.y);
+    }
+
+    void NovaRenderer::wait_for_all_frames() {
+        rx::vector<rhi::RhiFence*> in_flight_fences{global_allocator};
+        for(uint32_t i = 0; i < num_in_flight_frames; i++) {
+            in_flight_fences.push_back(frame_fences[i]);
+        }
+        device->wait_for_fences(in_flight_fences);
+    }
+
+    void NovaRenderer::update_render_scale() {
+        const auto& options = render_settings->dynamic_resolution;
+
+        if(!options.enabled) {
+            if(dynamic_resolution.get_render_scale() != 1.0F) {
+                dynamic_resolution.reset();
+
+                render_scale_changed = true;
+            }
+
+            return;
+        }
+
+        if(gpu_profiler == nullptr) {
+            if(!warned_about_dynamic_resolution) {
+                logger(rx::log::level::k_warning, "Dynamic resolution needs GPU profiling, so the render scale will stay at 1");
+                warned_about_dynamic_resolution = true;
+            }
+
+            return;
+        }
+
+        const auto frame_time = gpu_profiler->get_frame_time();
+        if(!frame_time || !dynamic_resolution.add_frame_time(*frame_time, options)) {
+            return;
+        }
+
+        render_scale_changed = true;
+    }
+
+    void NovaRenderer::write_render_scale_uniforms(rhi::CommandList& cmds) {
+        const auto render_scale_buffer = device_resources->get_uniform_buffer(RENDER_SCALE_DATA_NAME);
+        const auto scene_output = device_resources->get_render_target(SCENE_OUTPUT_RT_NAME);
+        if(!render_scale_buffer || !scene_output || render_scale_staging_buffer == nullptr) {
+            return;
+        }
+
+        NOVA_TRACE_SCOPE("RenderLoop", "write_render_scale_uniforms");
+
+        const auto render_scale = dynamic_resolution.get_render_scale();
+        const glm::uvec2 scene_output_size((*scene_output)->width, (*scene_output)->height);
+        const auto scaled_size = get_scaled_size(scene_output_size, render_scale);
+
+        RenderScaleUniforms uniforms = {};
+        uniforms.scene_uv_scale = glm::vec2(scaled_size) / glm::vec2(scene_output_size);
+        uniforms.render_scale = render_scale;
+
+        // The GPU finished the last frame that used this frame's slot, but the other in-flight frames may still be copying from theirs
+        const Bytes slot_offset = sizeof(RenderScaleUniforms) * cur_frame_idx;
+        device->write_data_to_buffer(&uniforms, sizeof(RenderScaleUniforms), slot_offset, render_scale_staging_buffer);
+
+        // The copy is ordered after the earlier frames' reads of the buffer, so they keep the render scale that they were recorded with
+        auto* buffer = (*render_scale_buffer)->buffer;
+        cmds.transition_resource(buffer, rhi::ResourceState::CopyDestination);
+        cmds.copy_buffer(buffer, 0, render_scale_staging_buffer, slot_offset, sizeof(RenderScaleUniforms));
+        cmds.transition_resource(buffer, rhi::ResourceState::UniformBuffer);
+    }
+
+    void NovaRenderer::resize_screen_relative_textures(const glm::uvec2& swapchain_size) {
+        rx::vector<rhi::RhiImage*> resized_images{global_allocator};
+        const auto was_resized = [&](const rhi::RhiImage* image) {
+            return resized_images.find_if([&](const rhi::RhiImage* resized_image) { return resized_image == image; }) !=
+                   rx::vector<rhi::RhiImage*>::k_npos;
+        };
+
+        const auto resize_texture = [&](const rx::string& name, const renderpack::TextureCreateInfo& create_info) {
+            const auto render_target = device_resources->get_render_target(name);
+            if(!render_target) {
+                return;
+            }
+
+            auto* image = (*render_target)->image;
+
+            // A texture which shares memory with a resized texture must be recreated in the new memory, even if its size didn't change
+            const auto is_screen_relative = create_info.format.dimension_type == renderpack::TextureDimensionType::ScreenRelative;
+            if(!is_screen_relative && !was_resized(image->aliased_image)) {
+                return;
+            }
 
-        const auto& renderpass_order = rendergraph->calculate_renderpass_execution_order();
+            // The image view has to be destroyed with the allocator it was created with
+            const auto is_renderpack_texture = loaded_renderpack &&
+                                               loaded_renderpack->resources.render_targets.find_if(
+                                                   [&](const renderpack::TextureCreateInfo& info) { return info.name == name; }) !=
+                                                   rx::vector<renderpack::TextureCreateInfo>::k_npos;
+            auto* allocator = is_renderpack_texture ? renderpack_allocator : global_allocator;
 
-        renderpass_order.each_fwd([&](const rx::string& renderpass_name) {
-            auto* renderpass = rendergraph->get_renderpass(renderpass_name);
-            renderpass->execute(*cmds, ctx);
+            const auto size = create_info.format.get_size_in_pixels(swapchain_size);
+            if(device_resources->resize_render_target(name, size.x, size.y, allocator)) {
+                resized_images.push_back(image);
+            }
+        };
+
+        // Textures which own their memory go first, so that the textures which alias them can use their new memory
+        dynamic_texture_infos.each_pair([&](const rx::string& name, const renderpack::TextureCreateInfo& create_info) {
+            if(const auto render_target = device_resources->get_render_target(name);
+               render_target && (*render_target)->image->aliased_image == nullptr) {
+                resize_texture(name, create_info);
+            }
+        });
+        dynamic_texture_infos.each_pair([&](const rx::string& name, const renderpack::TextureCreateInfo& create_info) {
+            if(const auto render_target = device_resources->get_render_target(name);
+               render_target && (*render_target)->image->aliased_image != nullptr) {
+                resize_texture(name, create_info);
+            }
         });
 
-        device->submit_command_list(cmds, rhi::QueueType::Graphics, frame_fences[cur_frame_idx]);
+        rendergraph->resize_framebuffers(resized_images, *device_resources);
 
-        // Wait for the GPU to finish before presenting. This destroys pipelining and throughput, however at this time I'm not sure how
-        // best to say "when GPU finishes this task, CPU should do something"
-        device->wait_for_fences(cur_frame_fences);
+        if(loaded_renderpack) {
+            loaded_renderpack->graph_data.passes.each_fwd([&](const renderpack::RenderPassCreateInfo& pass_info) {
+                const auto* pass = rendergraph->get_renderpass(pass_info.name);
+                if(pass != nullptr && pass->is_compute) {
+                    pass->pipeline_names.each_fwd(
+                        [&](const rx::string& pipeline_name) { pipeline_storage->resize_dispatches(pipeline_name, pass->output_size); });
+                }
+            });
+        }
 
-        device->get_swapchain()->present(cur_frame_idx);
+        // The descriptor sets still refer to the old image views
+        material_metadatas.each_pair([&](const FullMaterialPassName& name, const MaterialPassMetadata& metadata) {
+            bool uses_resized_image = false;
+            metadata.data.bindings.each_value([&](const rx::string& resource_name) {
+                if(const auto render_target = device_resources->get_render_target(resource_name);
+                   render_target && was_resized((*render_target)->image)) {
+                    uses_resized_image = true;
+                }
+            });
+
+            if(!uses_resized_image) {
+                return;
+            }
+
+            const auto* key = material_pass_keys.find(name);
+            if(key == nullptr) {
+                return;
+            }
+
+            auto* pipeline_interface = pipeline_storage->get_pipeline_interface(key->pipeline_name);
+            const auto* passes = pipeline_interface != nullptr ? passes_by_pipeline.find(pipeline_interface) : nullptr;
+            if(passes == nullptr) {
+                return;
+            }
 
-        mtr_flush();
+            bind_data_to_material_descriptor_sets((*passes)[key->material_pass_index],
+                                                  metadata.data.bindings,
+                                                  pipeline_interface->bindings);
+        });
+    }
+
+    rx::vector<rhi::CommandList*> NovaRenderer::record_renderpass_contents(const rx::vector<CompiledRenderpass>& renderpasses,
+                                                                           FrameContext& ctx) const {
+        NOVA_TRACE_SCOPE("RenderLoop", "record_renderpass_contents");
+
+        rx::vector<rhi::CommandList*> contents{ctx.allocator};
+        if(recording_threads == nullptr || renderpasses.is_empty()) {
+            return contents;
+        }
+
+        contents.resize(renderpasses.size(), nullptr);
+
+        const rx_size num_jobs = rx::algorithm::min<rx_size>(renderpasses.size(), render_settings->num_recording_threads);
+        rx::concurrency::wait_group jobs_done{num_jobs};
+
+        for(rx_size job_idx = 0; job_idx < num_jobs; job_idx++) {
+            recording_threads->add([&, job_idx](int /* thread_id */) {
+                NOVA_TRACE_SCOPE("RenderLoop", "record_renderpasses");
+
+                // Each job gets its own command pools. Thread index 0 belongs to the main thread
+                const auto thread_idx = static_cast<uint32_t>(job_idx + 1);
+
+                for(rx_size pass_idx = job_idx; pass_idx < renderpasses.size(); pass_idx += num_jobs) {
+                    if(renderpasses[pass_idx].is_skipped) {
+                        continue;
+                    }
+
+                    auto* renderpass = renderpasses[pass_idx].renderpass;
+                    statistics::RenderpassScope stats_scope{static_cast<uint32_t>(pass_idx)};
+
+                    // Compute passes have no renderpass or framebuffer, and the device ignores those when they're null
+                    auto* pass_cmds = device->create_command_list(thread_idx,
+                                                                  renderpasses[pass_idx].queue,
+                                                                  rhi::CommandList::Level::Secondary,
+                                                                  ctx.allocator,
+                                                                  renderpass->get_renderpass(),
+                                                                  renderpass->get_framebuffer(ctx),
+                                                                  renderpass->subpass_index);
+                    pass_cmds->set_debug_name(renderpass->name);
+
+                    // Renderpasses which begin an RHI renderpass can only write timestamps inside their secondary command list
+                    const auto writes_timestamps = ctx.gpu_profiler != nullptr && !renderpass->is_compute;
+                    if(writes_timestamps) {
+                        ctx.gpu_profiler->begin_renderpass(*pass_cmds, static_cast<uint32_t>(pass_idx));
+                    }
+
+                    renderpass->record_contents(*pass_cmds, ctx);
+
+                    if(writes_timestamps) {
+                        ctx.gpu_profiler->end_renderpass(*pass_cmds, static_cast<uint32_t>(pass_idx));
+                    }
+
+                    contents[pass_idx] = pass_cmds;
+                }
+
+                jobs_done.signal();
+            });
+        }
+
+        jobs_done.wait();
+
+        return contents;
     }
 
     void NovaRenderer::set_num_meshes(const uint32_t /* num_meshes */) { /* TODO? */
@@ -323,6 +852,9 @@ namespace nova::renderer {
         // TODO: Try to get staging buffers from a pool
 
         {
+            // The staging memory must belong to the same frame as the semaphore that the upload signals
+            rx::concurrency::scope_lock l(upload_mutex);
+
             rhi::RhiBufferCreateInfo staging_vertex_buffer_create_info = vertex_buffer_create_info;
             staging_vertex_buffer_create_info.buffer_usage = rhi::BufferUsage::StagingBuffer;
 
@@ -336,24 +868,11 @@ namespace nova::renderer {
                                                                                rhi::CommandList::Level::Primary,
                                                                                global_allocator);
             vertex_upload_cmds->set_debug_name("VertexDataUpload");
+            vertex_upload_cmds->transition_resource(vertex_buffer, rhi::ResourceState::CopyDestination, rhi::QueueType::Transfer);
             vertex_upload_cmds->copy_buffer(vertex_buffer, 0, staging_vertex_buffer, 0, vertex_buffer_create_info.size);
+            vertex_upload_cmds->transition_resource(vertex_buffer, rhi::ResourceState::VertexBuffer);
 
-            rhi::RhiResourceBarrier vertex_barrier = {};
-            vertex_barrier.resource_to_barrier = vertex_buffer;
-            vertex_barrier.old_state = rhi::ResourceState::CopyDestination;
-            vertex_barrier.new_state = rhi::ResourceState::Common;
-            vertex_barrier.access_before_barrier = rhi::ResourceAccess::CopyWrite;
-            vertex_barrier.access_after_barrier = rhi::ResourceAccess::VertexAttributeRead;
-            vertex_barrier.source_queue = rhi::QueueType::Transfer;
-            vertex_barrier.destination_queue = rhi::QueueType::Graphics;
-            vertex_barrier.buffer_memory_barrier.offset = 0;
-            vertex_barrier.buffer_memory_barrier.size = vertex_buffer->size;
-
-            rx::vector<rhi::RhiResourceBarrier> barriers{global_allocator};
-            barriers.push_back(vertex_barrier);
-            vertex_upload_cmds->resource_barriers(rhi::PipelineStage::Transfer, rhi::PipelineStage::VertexInput, barriers);
-
-            device->submit_command_list(vertex_upload_cmds, rhi::QueueType::Transfer);
+            submit_upload(vertex_upload_cmds, staging_vertex_buffer);
 
             // TODO: Barrier on the mesh's first usage
         }
@@ -364,7 +883,15 @@ namespace nova::renderer {
 
         rhi::RhiBuffer* index_buffer = device->create_buffer(index_buffer_create_info, *mesh_memory, global_allocator);
 
+        uint64_t upload_frame;
+
         {
+            rx::concurrency::scope_lock l(upload_mutex);
+
+            // The next frame to take the pending uploads waits for both of this mesh's uploads. That's either the frame that's being
+            // recorded or the one after it
+            upload_frame = frame_count.load() + 1;
+
             rhi::RhiBufferCreateInfo staging_index_buffer_create_info = index_buffer_create_info;
             staging_index_buffer_create_info.buffer_usage = rhi::BufferUsage::StagingBuffer;
             rhi::RhiBuffer* staging_index_buffer = device->create_buffer(staging_index_buffer_create_info,
@@ -377,29 +904,19 @@ namespace nova::renderer {
                                                                                 rhi::CommandList::Level::Primary,
                                                                                 global_allocator);
             indices_upload_cmds->set_debug_name("IndexDataUpload");
+            indices_upload_cmds->transition_resource(index_buffer, rhi::ResourceState::CopyDestination, rhi::QueueType::Transfer);
             indices_upload_cmds->copy_buffer(index_buffer, 0, staging_index_buffer, 0, index_buffer_create_info.size);
+            indices_upload_cmds->transition_resource(index_buffer, rhi::ResourceState::IndexBuffer);
 
-            rhi::RhiResourceBarrier index_barrier = {};
-            index_barrier.resource_to_barrier = index_buffer;
-            index_barrier.old_state = rhi::ResourceState::CopyDestination;
-            index_barrier.new_state = rhi::ResourceState::Common;
-            index_barrier.access_before_barrier = rhi::ResourceAccess::CopyWrite;
-            index_barrier.access_after_barrier = rhi::ResourceAccess::IndexRead;
-            index_barrier.source_queue = rhi::QueueType::Transfer;
-            index_barrier.destination_queue = rhi::QueueType::Graphics;
-            index_barrier.buffer_memory_barrier.offset = 0;
-            index_barrier.buffer_memory_barrier.size = index_buffer->size;
-
-            rx::vector<rhi::RhiResourceBarrier> barriers{global_allocator};
-            barriers.push_back(index_barrier);
-            indices_upload_cmds->resource_barriers(rhi::PipelineStage::Transfer, rhi::PipelineStage::VertexInput, barriers);
-
-            device->submit_command_list(indices_upload_cmds, rhi::QueueType::Transfer);
+            submit_upload(indices_upload_cmds, staging_index_buffer);
 
             // TODO: Barrier on the mesh's first usage
         }
 
-        // TODO: Clean up staging buffers
+        if(mesh_memory_defragmenter != nullptr) {
+            mesh_memory_defragmenter->add_buffer(vertex_buffer, vertex_buffer_create_info, rhi::ResourceState::VertexBuffer, upload_frame);
+            mesh_memory_defragmenter->add_buffer(index_buffer, index_buffer_create_info, rhi::ResourceState::IndexBuffer, upload_frame);
+        }
 
         Mesh mesh;
         mesh.num_vertex_attributes = mesh_data.num_vertex_attributes;
@@ -423,8 +940,123 @@ namespace nova::renderer {
         return ProceduralMeshAccessor{&proc_meshes, our_id};
     }
 
+    void NovaRenderer::destroy_mesh(const MeshId mesh_to_destroy) {
+        if(proc_meshes.find(mesh_to_destroy) != nullptr) {
+            proc_meshes.erase(mesh_to_destroy);
+            return;
+        }
+
+        const auto* mesh = meshes.find(mesh_to_destroy);
+        if(mesh == nullptr) {
+            logger(rx::log::level::k_error, "Could not find a mesh with ID %u", mesh_to_destroy);
+            return;
+        }
+
+#if NOVA_DEBUG
+        passes_by_pipeline.each_value([&](const rx::vector<MaterialPass>& passes) {
+            passes.each_fwd([&](const MaterialPass& pass) {
+                pass.static_mesh_draws.each_fwd([&](const MeshBatch<StaticMeshRenderCommand>& batch) {
+                    if(batch.vertex_buffer == mesh->vertex_buffer && !batch.commands.is_empty()) {
+                        logger(rx::log::level::k_error, "Destroying mesh %u while renderables still use it", mesh_to_destroy);
+                    }
+                });
+            });
+        });
+#endif
+
+        if(mesh_memory_defragmenter != nullptr) {
+            mesh_memory_defragmenter->remove_buffer(mesh->vertex_buffer);
+            mesh_memory_defragmenter->remove_buffer(mesh->index_buffer);
+        }
+
+        // The frames that are in flight may still be drawing the mesh, so its buffers are destroyed once they're done
+        const uint64_t last_frame = frame_count.load();
+        retire_buffer(mesh->vertex_buffer, last_frame);
+        retire_buffer(mesh->index_buffer, last_frame);
+
+        meshes.erase(mesh_to_destroy);
+    }
+
+    void NovaRenderer::submit_upload(rhi::CommandList* cmds, rhi::RhiBuffer* staging_buffer) {
+        rhi::RhiSemaphore* semaphore;
+        if(free_upload_semaphores.is_empty()) {
+            semaphore = device->create_semaphore(global_allocator);
+
+        } else {
+            semaphore = free_upload_semaphores.last();
+            free_upload_semaphores.erase(free_upload_semaphores.size() - 1, free_upload_semaphores.size());
+        }
+
+        rx::vector<rhi::RhiSemaphore*> signal_semaphores{global_allocator};
+        signal_semaphores.push_back(semaphore);
+        device->submit_command_list(cmds, rhi::QueueType::Transfer, nullptr, {}, signal_semaphores);
+
+        pending_upload_semaphores.push_back(semaphore);
+        pending_staging_buffers.push_back(staging_buffer);
+    }
+
+    void NovaRenderer::retire_buffer(rhi::RhiBuffer* buffer, const uint64_t last_frame) {
+        rx::concurrency::scope_lock l(retired_buffers_mutex);
+        retired_buffers.push_back(RetiredBuffer{buffer, last_frame});
+    }
+
+    void NovaRenderer::destroy_retired_buffers(const uint64_t last_finished_frame) {
+        rx::concurrency::scope_lock l(retired_buffers_mutex);
+
+        rx::vector<RetiredBuffer> still_in_use{global_allocator};
+        retired_buffers.each_fwd([&](const RetiredBuffer& retired_buffer) {
+            if(retired_buffer.frame_count <= last_finished_frame) {
+                device->destroy_buffer(retired_buffer.buffer, global_allocator);
+            } else {
+                still_in_use.push_back(retired_buffer);
+            }
+        });
+
+        retired_buffers = rx::utility::move(still_in_use);
+    }
+
+    void NovaRenderer::defragment_mesh_memory(const uint64_t last_finished_frame) {
+        if(mesh_memory_defragmenter == nullptr) {
+            return;
+        }
+
+        NOVA_TRACE_SCOPE("RenderLoop", "defragment_mesh_memory");
+
+        const auto moves = mesh_memory_defragmenter->update(render_settings->mesh_defragmentation, last_finished_frame);
+        if(moves.is_empty()) {
+            return;
+        }
+
+        rx::map<rhi::RhiBuffer*, rhi::RhiBuffer*> new_buffers{global_allocator};
+        moves.each_fwd([&](const BufferMove& move) { new_buffers.insert(move.old_buffer, move.new_buffer); });
+
+        const auto replace_buffer = [&](rhi::RhiBuffer*& buffer) {
+            if(auto* const* new_buffer = new_buffers.find(buffer)) {
+                buffer = *new_buffer;
+            }
+        };
+
+        meshes.each_value([&](Mesh& mesh) {
+            replace_buffer(mesh.vertex_buffer);
+            replace_buffer(mesh.index_buffer);
+        });
+
+        passes_by_pipeline.each_value([&](rx::vector<MaterialPass>& passes) {
+            passes.each_fwd([&](MaterialPass& pass) {
+                pass.static_mesh_draws.each_fwd([&](MeshBatch<StaticMeshRenderCommand>& batch) {
+                    replace_buffer(batch.vertex_buffer);
+                    replace_buffer(batch.index_buffer);
+                });
+            });
+        });
+
+        // The frame that's about to be recorded uses the new buffers, so the old buffers are done after the frame before it
+        const uint64_t last_frame = frame_count == 0 ? 0 : frame_count - 1;
+        moves.each_fwd([&](const BufferMove& move) { retire_buffer(move.old_buffer, last_frame); });
+    }
+
     void NovaRenderer::load_renderpack(const rx::string& renderpack_name) {
-        MTR_SCOPE("RenderpackLoading", "load_renderpack");
+        NOVA_TRACE_SCOPE("RenderpackLoading", "load_renderpack");
         glslang::InitializeProcess();
 
         const renderpack::RenderpackData data = renderpack::load_renderpack_data(renderpack_name);
@@ -436,8 +1068,12 @@ namespace nova::renderer {
             rg_log(rx::log::level::k_verbose, "Resources from old renderpack destroyed");
         }
 
-        create_dynamic_textures(data.resources.render_targets);
+        const auto num_bytes_saved = create_dynamic_textures(data.resources.render_targets, data.graph_data.passes);
         rg_log(rx::log::level::k_verbose, "Dynamic textures created");
+        rg_log(rx::log::level::k_info,
+               "Renderpack %s saved %.2f MB of VRAM by sharing memory between dynamic textures",
+               renderpack_name,
+               static_cast<double>(num_bytes_saved) / (1024.0 * 1024.0));
 
         create_render_passes(data.graph_data.passes, data.pipelines);
 
@@ -447,35 +1083,109 @@ namespace nova::renderer {
 
         rg_log(rx::log::level::k_verbose, "Created pipelines and materials");
 
+        // When pipelines compile in the background, the pipeline storage saves the pipeline cache once they've all compiled
+        if(!pipeline_storage->is_async()) {
+            device->save_pipeline_cache();
+        }
+
         renderpacks_loaded = true;
 
         rg_log(rx::log::level::k_verbose, "Renderpack %s loaded successfully", renderpack_name);
     }
 
-    const rx::vector<MaterialPass>& NovaRenderer::get_material_passes_for_pipeline(rhi::RhiPipeline* const pipeline) {
-        return *passes_by_pipeline.find(pipeline);
+    const rx::vector<MaterialPass>& NovaRenderer::get_material_passes_for_pipeline(const rhi::RhiPipelineInterface* pipeline_interface) {
+        return *passes_by_pipeline.find(pipeline_interface);
     }
 
     rx::optional<RenderpassMetadata> NovaRenderer::get_renderpass_metadata(const rx::string& renderpass_name) const {
         return rendergraph->get_metadata_for_renderpass(renderpass_name);
     }
 
-    void NovaRenderer::create_dynamic_textures(const rx::vector<renderpack::TextureCreateInfo>& texture_create_infos) {
-        texture_create_infos.each_fwd([&](const renderpack::TextureCreateInfo& create_info) {
+    uint64_t NovaRenderer::create_dynamic_textures(const rx::vector<renderpack::TextureCreateInfo>& texture_create_infos,
+                                                   const rx::vector<renderpack::RenderPassCreateInfo>& pass_create_infos) {
+        rx::map<rx::string, renderpack::TextureCreateInfo> textures;
+        texture_create_infos.each_fwd(
+            [&](const renderpack::TextureCreateInfo& create_info) { textures.insert(create_info.name, create_info); });
+
+        // Map from texture name to the name of the texture whose memory it uses
+        rx::map<rx::string, rx::string> aliases;
+
+        rendergraph->order_renderpasses_with(pass_create_infos)
+            .map([&](const rx::vector<renderpack::RenderPassCreateInfo>& ordered_passes) {
+                rx::map<rx::string, renderpack::Range> resource_used_range;
+                rx::vector<rx::string> resources_in_order;
+                renderpack::determine_usage_order_of_textures(ordered_passes, resource_used_range, resources_in_order);
+
+                aliases = renderpack::determine_aliasing_of_textures(textures, resource_used_range, resources_in_order);
+
+                return true;
+            })
+            .on_error([&](const auto& err) {
+                rg_log(rx::log::level::k_warning,
+                       "Could not order the renderpasses, so every dynamic texture gets its own memory: %s",
+                       err.to_string());
+            });
+
+        uint64_t num_bytes_saved = 0;
+
+        const auto create_texture = [&](const renderpack::TextureCreateInfo& create_info, rhi::RhiImage* aliased_image) {
             const auto size = create_info.format.get_size_in_pixels(device->get_swapchain()->get_size());
 
             const auto render_target = device_resources->create_render_target(create_info.name,
                                                                               size.x,
                                                                               size.y,
                                                                               create_info.format.pixel_format,
-                                                                              renderpack_allocator);
+                                                                              renderpack_allocator,
+                                                                              false,
+                                                                              aliased_image);
+
+            if(render_target && (*render_target)->image->aliased_image != nullptr) {
+                num_bytes_saved += static_cast<uint64_t>(size.x) * size.y * size_in_bytes(create_info.format.pixel_format);
+            }
 
             dynamic_texture_infos.insert(create_info.name, create_info);
+        };
+
+        // Create the textures that have their own memory first, so that the other textures can use their memory
+        texture_create_infos.each_fwd([&](const renderpack::TextureCreateInfo& create_info) {
+            if(aliases.find(create_info.name) == nullptr) {
+                create_texture(create_info, nullptr);
+            }
         });
+
+        texture_create_infos.each_fwd([&](const renderpack::TextureCreateInfo& create_info) {
+            if(const auto* aliased_texture_name = aliases.find(create_info.name)) {
+                rhi::RhiImage* aliased_image = nullptr;
+                if(const auto aliased_texture = device_resources->get_render_target(*aliased_texture_name); aliased_texture) {
+                    aliased_image = (*aliased_texture)->image;
+                }
+
+                create_texture(create_info, aliased_image);
+            }
+        });
+
+        return num_bytes_saved;
     }
 
     void NovaRenderer::create_render_passes(const rx::vector<renderpack::RenderPassCreateInfo>& pass_create_infos,
                                             const rx::vector<renderpack::PipelineData>& pipelines) const {
+        // The UI is drawn over the upscaled scene, so it's always rendered at full resolution
+        const auto renders_at_render_scale = [&](const renderpack::RenderPassCreateInfo& create_info) {
+            const auto is_scaled_output = [&](const rx::string& name) {
+                const auto* texture_info = dynamic_texture_infos.find(name);
+                return name != UI_OUTPUT_RT_NAME && texture_info != nullptr &&
+                       texture_info->format.dimension_type == renderpack::TextureDimensionType::ScreenRelative;
+            };
+
+            if(create_info.depth_texture && is_scaled_output(create_info.depth_texture->name)) {
+                return true;
+            }
+
+            return create_info.texture_outputs.find_if([&](const renderpack::TextureAttachmentInfo& output) {
+                return is_scaled_output(output.name);
+            }) != rx::vector<renderpack::TextureAttachmentInfo>::k_npos;
+        };
+
 
         device->set_num_renderpasses(static_cast<uint32_t>(pass_create_infos.size()));
 
@@ -487,28 +1197,52 @@ namespace nova::renderer {
                         renderpass->pipeline_names.emplace_back(pipeline.name);
                     }
                 });
+
+                renderpass->scales_with_resolution = !renderpass->is_compute && renders_at_render_scale(create_info);
             } else {
                 rg_log(rx::log::level::k_error, "Could not create renderpass %s", create_info.name);
             }
         });
+
+        if(render_settings->merge_renderpasses) {
+            rendergraph->merge_renderpasses();
+        }
     }
 
     void NovaRenderer::create_pipelines_and_materials(const rx::vector<renderpack::PipelineData>& pipeline_create_infos,
                                                       const rx::vector<renderpack::MaterialData>& materials) {
         pipeline_create_infos.each_fwd([&](const renderpack::PipelineData& pipeline_create_info) {
+            if(pipeline_create_info.compute_shader) {
+                const auto compute_pipeline_create_info = renderpack::to_compute_pipeline_create_info(pipeline_create_info, *rendergraph);
+                if(!compute_pipeline_create_info) {
+                    logger(rx::log::level::k_error, "Could not create compute pipeline %s", pipeline_create_info.name);
+                    return;
+                }
+
+                // Compute pipelines are created synchronously because they don't have fallbacks to render with while they compile
+                if(pipeline_storage->create_compute_pipeline(*compute_pipeline_create_info)) {
+                    auto* pipeline_interface = pipeline_storage->get_pipeline_interface(compute_pipeline_create_info->name);
+                    create_materials_for_pipeline(pipeline_interface, materials, pipeline_create_info.name);
+                }
+
+                return;
+            }
+
             const auto pipeline_state_create_info = renderpack::to_pipeline_state_create_info(pipeline_create_info, *rendergraph);
             if(!pipeline_state_create_info) {
                 logger(rx ::log::level::k_error, "Could not create pipeline %s", pipeline_create_info.name);
+                return;
             }
 
-            if(pipeline_storage->create_pipeline(*pipeline_state_create_info)) {
-                auto pipeline = pipeline_storage->get_pipeline(pipeline_state_create_info->name);
-                create_materials_for_pipeline(*pipeline, materials, pipeline_create_info.name);
+            const rx::string fallback_name = pipeline_create_info.fallback ? *pipeline_create_info.fallback : "";
+            if(pipeline_storage->create_pipeline_async(*pipeline_state_create_info, fallback_name)) {
+                auto* pipeline_interface = pipeline_storage->get_pipeline_interface(pipeline_state_create_info->name);
+                create_materials_for_pipeline(pipeline_interface, materials, pipeline_create_info.name);
             }
         });
     }
 
-    void NovaRenderer::create_materials_for_pipeline(const Pipeline& pipeline,
+    void NovaRenderer::create_materials_for_pipeline(rhi::RhiPipelineInterface* pipeline_interface,
                                                      const rx::vector<renderpack::MaterialData>& materials,
                                                      const rx::string& pipeline_name) {
 
@@ -525,15 +1259,15 @@ namespace nova::renderer {
             material_data.passes.each_fwd([&](const renderpack::MaterialPass& pass_data) {
                 if(pass_data.pipeline == pipeline_name) {
                     MaterialPass pass = {};
-                    pass.pipeline_interface = pipeline.pipeline_interface;
+                    pass.pipeline_interface = pipeline_interface;
 
-                    if(!pipeline.pipeline_interface->bindings.is_empty()) {
-                        pass.descriptor_sets = device->create_descriptor_sets(pipeline.pipeline_interface,
+                    if(!pipeline_interface->bindings.is_empty()) {
+                        pass.descriptor_sets = device->create_descriptor_sets(pipeline_interface,
                                                                               global_descriptor_pool,
                                                                               renderpack_allocator);
                     }
 
-                    bind_data_to_material_descriptor_sets(pass, pass_data.bindings, pipeline.pipeline_interface->bindings);
+                    bind_data_to_material_descriptor_sets(pass, pass_data.bindings, pipeline_interface->bindings);
 
                     const FullMaterialPassName full_pass_name{pass_data.material_name, pass_data.name};
 
@@ -551,7 +1285,7 @@ namespace nova::renderer {
             });
         });
 
-        passes_by_pipeline.insert(pipeline.pipeline, passes);
+        passes_by_pipeline.insert(pipeline_interface, passes);
     }
 
     void NovaRenderer::bind_data_to_material_descriptor_sets(
@@ -578,7 +1312,12 @@ namespace nova::renderer {
                 resource_info.image_info.image = image;
                 resource_info.image_info.format = dynamic_texture_infos.find(resource_name)->format;
 
-                write.type = rhi::DescriptorType::Texture;
+                // Render targets can be bound as input attachments or storage images, everything else reads them as textures
+                if(binding_desc.type == rhi::DescriptorType::InputAttachment || binding_desc.type == rhi::DescriptorType::StorageImage) {
+                    write.type = binding_desc.type;
+                } else {
+                    write.type = rhi::DescriptorType::Texture;
+                }
 
                 writes.push_back(write);
 
@@ -596,6 +1335,12 @@ namespace nova::renderer {
 
                 writes.push_back(write);
 
+            } else if(resource_name == LINEAR_SAMPLER_NAME) {
+                resource_info.sampler_info.sampler = linear_sampler;
+                write.type = rhi::DescriptorType::Sampler;
+
+                writes.push_back(write);
+
             } else {
                 rg_log(rx::log::level::k_error, "Resource %s is not known to Nova", resource_name);
             }
@@ -642,7 +1387,7 @@ namespace nova::renderer {
 
                 material.static_mesh_draws.each_fwd([&](MeshBatch<StaticMeshRenderCommand>& batch) {
                     if(batch.vertex_buffer == mesh->vertex_buffer) {
-                        batch.commands.emplace_back(command);
+                        batch.add_command(command);
 
                         need_to_add_batch = false;
                         return false;
@@ -656,7 +1401,7 @@ namespace nova::renderer {
                     batch.num_indices = mesh->num_indices;
                     batch.vertex_buffer = mesh->vertex_buffer;
                     batch.index_buffer = mesh->index_buffer;
-                    batch.commands.emplace_back(command);
+                    batch.add_command(command);
 
                     material.static_mesh_draws.emplace_back(batch);
                 }
@@ -669,7 +1414,7 @@ namespace nova::renderer {
 
                 material.static_procedural_mesh_draws.each_fwd([&](ProceduralMeshBatch<StaticMeshRenderCommand>& batch) {
                     if(batch.mesh.get_key() == renderable.mesh) {
-                        batch.commands.emplace_back(command);
+                        batch.add_command(command);
 
                         need_to_add_batch = false;
                         return false;
@@ -680,7 +1425,7 @@ namespace nova::renderer {
 
                 if(need_to_add_batch) {
                     ProceduralMeshBatch<StaticMeshRenderCommand> batch(&proc_meshes, renderable.mesh);
-                    batch.commands.emplace_back(command);
+                    batch.add_command(command);
 
                     material.static_procedural_mesh_draws.emplace_back(batch);
                 }
@@ -690,9 +1435,8 @@ namespace nova::renderer {
         }
 
         // Figure out where to put the renderable
-        const auto pipeline = pipeline_storage->get_pipeline(pass_key->pipeline_name);
-        if(pipeline) {
-            auto* passes = passes_by_pipeline.find(pipeline->pipeline);
+        if(const auto* pipeline_interface = pipeline_storage->get_pipeline_interface(pass_key->pipeline_name)) {
+            auto* passes = passes_by_pipeline.find(pipeline_interface);
             passes->emplace_back(material);
 
         } else {
@@ -724,6 +1468,27 @@ namespace nova::renderer {
         }
     }
 
+    void NovaRenderer::create_recording_threads() {
+        const auto num_threads = render_settings->num_recording_threads;
+        if(num_threads > 0) {
+            NOVA_TRACE_SCOPE("Init", "CreateRecordingThreads");
+            recording_threads = global_allocator->create<rx::concurrency::thread_pool>(global_allocator, num_threads, 64_z);
+        }
+    }
+
+    void NovaRenderer::create_gpu_profiler() {
+        if(!render_settings->profile_gpu) {
+            return;
+        }
+
+        if(!device->info.supports_timestamps) {
+            logger(rx::log::level::k_warning, "The GPU can't write timestamps, so renderpasses won't be profiled");
+            return;
+        }
+
+        gpu_profiler = global_allocator->create<GpuProfiler>(*device, global_allocator);
+    }
+
     void NovaRenderer::initialize_virtual_filesystem() {
         // The host application MUST register its data directory before initializing Nova
 
@@ -741,12 +1506,16 @@ namespace nova::renderer {
                                                                                           rhi::ObjectType::Buffer,
                                                                                           global_allocator);
         const ntl::Result<DeviceMemoryResource*> mesh_memory_result = memory_result.map([&](rhi::RhiDeviceMemory* memory) {
-            auto* allocator = global_allocator->create<BlockAllocationStrategy>(global_allocator, Bytes(mesh_memory_size), 64_b);
-            return global_allocator->create<DeviceMemoryResource>(memory, allocator);
+            mesh_memory_strategy = global_allocator->create<TlsfAllocationStrategy>(global_allocator, Bytes(mesh_memory_size), 64_b);
+            return global_allocator->create<DeviceMemoryResource>(memory, mesh_memory_strategy);
         });
 
         if(mesh_memory_result) {
-            mesh_memory = global_allocator->create<DeviceMemoryResource>(*mesh_memory_result.value);
+            mesh_memory = mesh_memory_result.value;
+            mesh_memory_defragmenter = global_allocator->create<DeviceMemoryDefragmenter>(*device,
+                                                                                          *mesh_memory,
+                                                                                          *mesh_memory_strategy,
+                                                                                          global_allocator);
 
         } else {
             logger(rx::log::level::k_error, "Could not create mesh memory pool: %s", mesh_memory_result.error.to_string());
@@ -767,14 +1536,15 @@ namespace nova::renderer {
                                     });
 
         if(ubo_memory_result) {
-            ubo_memory = global_allocator->create<DeviceMemoryResource>(*ubo_memory_result.value);
+            ubo_memory = ubo_memory_result.value;
 
         } else {
             logger(rx::log::level::k_error, "Could not create mesh memory pool: %s", ubo_memory_result.error.to_string());
         }
 
-        // Staging buffers will be pooled, so we don't need a _ton_ of memory for them
-        const Bytes staging_memory_size = 256_kb;
+        // Staging memory is reclaimed once the frames that used it are done, so it only needs to hold a few frames of uploads. Larger
+        // uploads get their own memory
+        const Bytes staging_memory_size = 16_mb;
         const ntl::Result<DeviceMemoryResource*>
             staging_memory_result = device
                                         ->allocate_device_memory(staging_memory_size.b_count(),
@@ -782,13 +1552,14 @@ namespace nova::renderer {
                                                                  rhi::ObjectType::Buffer,
                                                                  global_allocator)
                                         .map([=](rhi::RhiDeviceMemory* memory) {
-                                            auto* allocator = global_allocator->create<BumpPointAllocationStrategy>(staging_memory_size,
-                                                                                                                    64_b);
-                                            return global_allocator->create<DeviceMemoryResource>(memory, allocator);
+                                            staging_buffer_strategy = global_allocator->create<RingAllocationStrategy>(global_allocator,
+                                                                                                                       staging_memory_size,
+                                                                                                                       64_b);
+                                            return global_allocator->create<DeviceMemoryResource>(memory, staging_buffer_strategy);
                                         });
 
         if(staging_memory_result) {
-            staging_buffer_memory = global_allocator->create<DeviceMemoryResource>(*staging_memory_result.value);
+            staging_buffer_memory = staging_memory_result.value;
 
         } else {
             logger(rx::log::level::k_error, "Could not create staging buffer memory pool: %s", staging_memory_result.error.to_string());
@@ -796,9 +1567,15 @@ namespace nova::renderer {
     }
 
     void NovaRenderer::create_global_sync_objects() {
+        num_in_flight_frames = rx::algorithm::clamp<uint32_t>(render_settings->max_in_flight_frames, 1, NUM_IN_FLIGHT_FRAMES);
+
         const rx::vector<rhi::RhiFence*>& fences = device->create_fences(NUM_IN_FLIGHT_FRAMES, true, global_allocator);
+        const auto image_acquired = device->create_semaphores(NUM_IN_FLIGHT_FRAMES, global_allocator);
+        const auto render_finished = device->create_semaphores(NUM_IN_FLIGHT_FRAMES, global_allocator);
         for(uint32_t i = 0; i < NUM_IN_FLIGHT_FRAMES; i++) {
             frame_fences[i] = fences[i];
+            image_acquired_semaphores[i] = image_acquired[i];
+            render_finished_semaphores[i] = render_finished[i];
         }
     }
 
@@ -807,6 +1584,13 @@ namespace nova::renderer {
             // Default sampler create info will give us a delicious point sampler
             point_sampler = device->create_sampler({}, global_allocator);
         }
+
+        {
+            rhi::RhiSamplerCreateInfo create_info = {};
+            create_info.min_filter = rhi::TextureFilter::Bilinear;
+            create_info.mag_filter = rhi::TextureFilter::Bilinear;
+            linear_sampler = device->create_sampler(create_info, global_allocator);
+        }
     }
 
     void NovaRenderer::create_resource_storage() {
@@ -865,12 +1649,24 @@ namespace nova::renderer {
             logger(rx::log::level::k_error, "Could not create builtin buffer ", PER_FRAME_DATA_NAME);
         }
 
-        if(device_resources->create_uniform_buffer(MODEL_MATRIX_BUFFER_NAME, sizeof(glm::mat4) * 0xFFFF)) {
+        if(device_resources->create_uniform_buffer(MODEL_MATRIX_BUFFER_NAME,
+                                                   sizeof(glm::mat4) * MODEL_MATRICES_PER_FRAME * NUM_IN_FLIGHT_FRAMES)) {
             builtin_buffer_names.emplace_back(MODEL_MATRIX_BUFFER_NAME);
 
         } else {
             logger(rx::log::level::k_error, "Could not create builtin buffer %s", MODEL_MATRIX_BUFFER_NAME);
         }
+
+        if(device_resources->create_uniform_buffer(RENDER_SCALE_DATA_NAME, sizeof(RenderScaleUniforms))) {
+            builtin_buffer_names.emplace_back(RENDER_SCALE_DATA_NAME);
+
+            render_scale_staging_buffer = device_resources->get_staging_buffer_with_size(sizeof(RenderScaleUniforms) *
+                                                                                          NUM_IN_FLIGHT_FRAMES);
+            render_scale_changed = true;
+
+        } else {
+            logger(rx::log::level::k_error, "Could not create builtin buffer %s", RENDER_SCALE_DATA_NAME);
+        }
     }
 
     void NovaRenderer::create_builtin_meshes() {
@@ -890,11 +1686,7 @@ namespace nova::renderer {
     void NovaRenderer::create_renderpass_manager() { rendergraph = global_allocator->create<Rendergraph>(global_allocator, *device); }
 
     void NovaRenderer::create_builtin_renderpasses() {
-        const auto& ui_output = *device_resources->get_render_target(UI_OUTPUT_RT_NAME);
-        const auto& scene_output = *device_resources->get_render_target(SCENE_OUTPUT_RT_NAME);
-
-        if(rendergraph->create_renderpass<BackbufferOutputRenderpass>(*device_resources, ui_output->image, scene_output->image) ==
-           nullptr) {
+        if(rendergraph->create_renderpass<BackbufferOutputRenderpass>(*device_resources) == nullptr) {
             logger(rx::log::level::k_error, "Could not create the backbuffer output renderpass");
         }
 
@@ -903,7 +1695,7 @@ namespace nova::renderer {
             logger(rx::log::level::k_error, "Could not create builtin pipeline %s", backbuffer_output_pipeline_create_info->name);
 
         } else {
-            const auto pipeline = pipeline_storage->get_pipeline(backbuffer_output_pipeline_create_info->name);
+            auto* pipeline_interface = pipeline_storage->get_pipeline_interface(backbuffer_output_pipeline_create_info->name);
 
             const renderpack::MaterialData material{BACKBUFFER_OUTPUT_MATERIAL_NAME,
                                                     rx::array{
@@ -912,12 +1704,14 @@ namespace nova::renderer {
                                                                                  BACKBUFFER_OUTPUT_PIPELINE_NAME,
                                                                                  rx::array{rx::pair{"ui_output", UI_OUTPUT_RT_NAME},
                                                                                            rx::pair{"scene_output", SCENE_OUTPUT_RT_NAME},
-                                                                                           rx::pair{"tex_sampler", POINT_SAMPLER_NAME}},
+                                                                                           rx::pair{"tex_sampler", POINT_SAMPLER_NAME},
+                                                                                           rx::pair{"render_scale", RENDER_SCALE_DATA_NAME},
+                                                                                           rx::pair{"scene_sampler", LINEAR_SAMPLER_NAME}},
                                                                                  {}}},
                                                     "block"};
 
             const rx::vector<renderpack::MaterialData> materials = rx::array{material};
-            create_materials_for_pipeline(*pipeline, materials, backbuffer_output_pipeline_create_info->name);
+            create_materials_for_pipeline(pipeline_interface, materials, backbuffer_output_pipeline_create_info->name);
 
             const static FullMaterialPassName BACKBUFFER_OUTPUT_MATERIAL{BACKBUFFER_OUTPUT_MATERIAL_NAME, "main"};
             const static StaticMeshRenderableData FULLSCREEN_TRIANGLE_RENDERABLE{{fullscreen_triangle_id}};
@@ -929,7 +1723,9 @@ namespace nova::renderer {
     void NovaRenderer::initialize_descriptor_pool() {
         global_descriptor_pool = device->create_descriptor_pool(rx::array{rx::pair{rhi::DescriptorType::UniformBuffer, 4096},
                                                                           rx::pair{rhi::DescriptorType::CombinedImageSampler, 4096},
-                                                                          rx::pair{rhi::DescriptorType::Sampler, 5}},
+                                                                          rx::pair{rhi::DescriptorType::Sampler, 5},
+                                                                          rx::pair{rhi::DescriptorType::InputAttachment, 256},
+                                                                          rx::pair{rhi::DescriptorType::StorageImage, 256}},
                                                                 global_allocator);
     }
 
@@ -191,44 +191,14 @@ namespace nova::renderer {
         auto* cur_vertex_buffer = vertex_buffers[frame_idx];
         auto* cur_index_buffer = index_buffers[frame_idx];
 
-        rx::vector<RhiResourceBarrier> barriers_before_upload;
-
         if(should_upload_vertex_buffer) {
-            RhiResourceBarrier barrier_before_vertex_upload = {};
-            barrier_before_vertex_upload.resource_to_barrier = cur_vertex_buffer;
-            barrier_before_vertex_upload.access_before_barrier = ResourceAccess::VertexAttributeRead;
-            barrier_before_vertex_upload.access_after_barrier = ResourceAccess::MemoryWrite;
-            barrier_before_vertex_upload.old_state = ResourceState::VertexBuffer;
-            barrier_before_vertex_upload.new_state = ResourceState::CopyDestination;
-            barrier_before_vertex_upload.source_queue = QueueType::Graphics;
-            barrier_before_vertex_upload.destination_queue = QueueType::Graphics;
-            barrier_before_vertex_upload.buffer_memory_barrier.offset = 0;
-            barrier_before_vertex_upload.buffer_memory_barrier.size = num_vertex_bytes_to_upload;
-
-            barriers_before_upload.push_back(barrier_before_vertex_upload);
+            cmds->transition_resource(cur_vertex_buffer, ResourceState::CopyDestination);
         }
 
         if(should_upload_index_buffer) {
-            RhiResourceBarrier barrier_before_index_upload = {};
-            barrier_before_index_upload.resource_to_barrier = cur_index_buffer;
-            barrier_before_index_upload.access_before_barrier = ResourceAccess::IndexRead;
-            barrier_before_index_upload.access_after_barrier = ResourceAccess::MemoryWrite;
-            barrier_before_index_upload.old_state = ResourceState::IndexBuffer;
-            barrier_before_index_upload.new_state = ResourceState::CopyDestination;
-            barrier_before_index_upload.source_queue = QueueType::Graphics;
-            barrier_before_index_upload.destination_queue = QueueType::Graphics;
-            barrier_before_index_upload.buffer_memory_barrier.offset = 0;
-            barrier_before_index_upload.buffer_memory_barrier.size = num_index_bytes_to_upload;
-
-            barriers_before_upload.push_back(barrier_before_index_upload);
-        }
-
-        if(barriers_before_upload.is_empty()) {
-            return;
+            cmds->transition_resource(cur_index_buffer, ResourceState::CopyDestination);
         }
 
-        cmds->resource_barriers(PipelineStage::VertexInput, PipelineStage::Transfer, barriers_before_upload);
-
         if(should_upload_vertex_buffer) {
             cmds->copy_buffer(cur_vertex_buffer, 0, cached_vertex_buffer, 0, num_vertex_bytes_to_upload);
         }
@@ -237,41 +207,14 @@ namespace nova::renderer {
             cmds->copy_buffer(cur_index_buffer, 0, cached_index_buffer, 0, num_index_bytes_to_upload);
         }
 
-        rx::vector<RhiResourceBarrier> barriers_after_upload;
-
+        // Transition the buffers after both copies, so that they share a barrier
         if(should_upload_vertex_buffer) {
-            RhiResourceBarrier barrier_after_vertex_upload = {};
-            barrier_after_vertex_upload.resource_to_barrier = cur_vertex_buffer;
-            barrier_after_vertex_upload.access_before_barrier = ResourceAccess::MemoryWrite;
-            barrier_after_vertex_upload.access_after_barrier = ResourceAccess::VertexAttributeRead;
-            barrier_after_vertex_upload.old_state = ResourceState::CopyDestination;
-            barrier_after_vertex_upload.new_state = ResourceState::VertexBuffer;
-            barrier_after_vertex_upload.source_queue = QueueType::Graphics;
-            barrier_after_vertex_upload.destination_queue = QueueType::Graphics;
-            barrier_after_vertex_upload.buffer_memory_barrier.offset = 0;
-            barrier_after_vertex_upload.buffer_memory_barrier.size = num_vertex_bytes_to_upload;
-            barriers_after_upload.push_back(barrier_after_vertex_upload);
+            cmds->transition_resource(cur_vertex_buffer, ResourceState::VertexBuffer);
         }
 
         if(should_upload_index_buffer) {
-            RhiResourceBarrier barrier_after_index_upload = {};
-            barrier_after_index_upload.resource_to_barrier = cur_index_buffer;
-            barrier_after_index_upload.access_before_barrier = ResourceAccess::MemoryWrite;
-            barrier_after_index_upload.access_after_barrier = ResourceAccess::IndexRead;
-            barrier_after_index_upload.old_state = ResourceState::CopyDestination;
-            barrier_after_index_upload.new_state = ResourceState::IndexBuffer;
-            barrier_after_index_upload.source_queue = QueueType::Graphics;
-            barrier_after_index_upload.destination_queue = QueueType::Graphics;
-            barrier_after_index_upload.buffer_memory_barrier.offset = 0;
-            barrier_after_index_upload.buffer_memory_barrier.size = num_index_bytes_to_upload;
-            barriers_after_upload.push_back(barrier_after_index_upload);
-        }
-
-        if(barriers_after_upload.is_empty()) {
-            return;
+            cmds->transition_resource(cur_index_buffer, ResourceState::IndexBuffer);
         }
-
-        cmds->resource_barriers(PipelineStage::Transfer, PipelineStage::VertexInput, barriers_after_upload);
     }
 
     ProceduralMesh::Buffers ProceduralMesh::get_buffers_for_frame(const uint8_t frame_idx) const {
@@ -52,4 +52,18 @@ namespace nova::renderer {
         float eyeAltitude;
         float centerDepthSmooth;
     };
+
+    /*!
+     * \brief The contents of the render scale uniform buffer
+     */
+    struct RenderScaleUniforms {
+        /*!
+         * \brief Converts UVs of the whole scene output to UVs of the part of the scene output that was rendered to
+         */
+        glm::vec2 scene_uv_scale;
+
+        float render_scale;
+
+        float padding;
+    };
 } // namespace nova::renderer
@@ -25,49 +25,7 @@ namespace nova::renderer {
 
     RX_GLOBAL<BackbufferOutputRenderpassCreateInfo> backbuffer_output_create_info{"Nova", "BackbufferOutputCreateInfo"};
 
-    BackbufferOutputRenderpass::BackbufferOutputRenderpass(rhi::RhiResource* ui_output, rhi::RhiResource* scene_output)
-        : Renderpass(BACKBUFFER_OUTPUT_RENDER_PASS_NAME, true) {
-        rhi::RhiResourceBarrier pre_pass_barrier;
-        pre_pass_barrier.access_before_barrier = rhi::ResourceAccess::ColorAttachmentWrite;
-        pre_pass_barrier.access_after_barrier = rhi::ResourceAccess::ShaderRead;
-        pre_pass_barrier.old_state = rhi::ResourceState::RenderTarget;
-        pre_pass_barrier.new_state = rhi::ResourceState::ShaderRead;
-        pre_pass_barrier.source_queue = rhi::QueueType::Graphics;
-        pre_pass_barrier.destination_queue = rhi::QueueType::Graphics;
-        pre_pass_barrier.image_memory_barrier.aspect = rhi::ImageAspect::Color;
-
-        read_texture_barriers.reserve(2);
-
-        pre_pass_barrier.resource_to_barrier = ui_output;
-        read_texture_barriers.push_back(pre_pass_barrier);
-
-        pre_pass_barrier.resource_to_barrier = scene_output;
-        read_texture_barriers.push_back(pre_pass_barrier);
-
-        rhi::RhiResourceBarrier post_pass_barrier;
-        post_pass_barrier.access_before_barrier = rhi::ResourceAccess::ShaderRead;        
-        post_pass_barrier.access_after_barrier = rhi::ResourceAccess::ColorAttachmentWrite;
-        post_pass_barrier.old_state = rhi::ResourceState::ShaderRead;
-        post_pass_barrier.new_state = rhi::ResourceState::RenderTarget;
-        post_pass_barrier.source_queue = rhi::QueueType::Graphics;
-        post_pass_barrier.destination_queue = rhi::QueueType::Graphics;
-        post_pass_barrier.image_memory_barrier.aspect = rhi::ImageAspect::Color;
-
-        post_pass_barriers.reserve(2);
-
-        post_pass_barrier.resource_to_barrier = ui_output;
-        post_pass_barriers.push_back(post_pass_barrier);
-
-        post_pass_barrier.resource_to_barrier = scene_output;
-        post_pass_barriers.push_back(post_pass_barrier);
-    }
+    BackbufferOutputRenderpass::BackbufferOutputRenderpass() : Renderpass(BACKBUFFER_OUTPUT_RENDER_PASS_NAME, true) {}
 
     const renderpack::RenderPassCreateInfo& BackbufferOutputRenderpass::get_create_info() { return *backbuffer_output_create_info; }
-
-    void BackbufferOutputRenderpass::record_post_renderpass_barriers(rhi::CommandList& cmds, FrameContext& ctx) const {
-        Renderpass::record_post_renderpass_barriers(cmds, ctx);
-
-        // TODO: Figure out how to make the backend deal with the barriers
-        cmds.resource_barriers(rhi::PipelineStage::FragmentShader, rhi::PipelineStage::ColorAttachmentOutput, post_pass_barriers);
-    }
 } // namespace nova::renderer
@@ -4,14 +4,8 @@
 namespace nova::renderer {
     class BackbufferOutputRenderpass final : public Renderpass {
     public:
-        explicit BackbufferOutputRenderpass(rhi::RhiResource* ui_output, rhi::RhiResource* scene_output);
+        BackbufferOutputRenderpass();
 
         static const renderpack::RenderPassCreateInfo& get_create_info();
-
-    protected:
-        void record_post_renderpass_barriers(rhi::CommandList& cmds, FrameContext& ctx) const override;
-
-    private:
-        rx::vector<rhi::RhiResourceBarrier> post_pass_barriers;
     };
 } // namespace nova::renderer
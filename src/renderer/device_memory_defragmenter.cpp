@@ -0,0 +1,183 @@
+#include "nova_renderer/device_memory_defragmenter.hpp"
+
+#include <rx/core/algorithm/quick_sort.h>
+#include <rx/core/concurrency/scope_lock.h>
+#include <rx/core/log.h>
+
+#include "nova_renderer/memory/tlsf_allocation_strategy.hpp"
+#include "nova_renderer/rhi/command_list.hpp"
+#include "nova_renderer/rhi/render_device.hpp"
+
+using namespace nova::mem::operators;
+
+namespace nova::renderer {
+    RX_LOG("DeviceMemoryDefragmenter", logger);
+
+    DeviceMemoryDefragmenter::DeviceMemoryDefragmenter(rhi::RenderDevice& device,
+                                                       DeviceMemoryResource& memory,
+                                                       mem::TlsfAllocationStrategy& strategy,
+                                                       rx::memory::allocator* allocator)
+        : device(device),
+          memory(memory),
+          strategy(strategy),
+          allocator(allocator),
+          movable_buffers(allocator),
+          pending_moves(allocator),
+          copy_fences(device.create_fences(1, false, allocator)) {}
+
+    DeviceMemoryDefragmenter::~DeviceMemoryDefragmenter() {
+        if(!pending_moves.is_empty()) {
+            device.wait_for_fences(copy_fences);
+        }
+
+        pending_moves.each_fwd([&](const PendingMove& pending_move) { device.destroy_buffer(pending_move.move.new_buffer, allocator); });
+
+        device.destroy_fences(copy_fences, allocator);
+    }
+
+    void DeviceMemoryDefragmenter::add_buffer(rhi::RhiBuffer* buffer,
+                                              const rhi::RhiBufferCreateInfo& create_info,
+                                              const rhi::ResourceState state,
+                                              const uint64_t upload_frame) {
+        if(buffer->memory_resource != &memory) {
+            // The buffer got memory of its own, so moving it wouldn't make the pool any less fragmented
+            return;
+        }
+
+        rx::concurrency::scope_lock l(buffers_mutex);
+        movable_buffers.push_back(MovableBuffer{buffer, create_info, state, upload_frame});
+    }
+
+    void DeviceMemoryDefragmenter::remove_buffer(rhi::RhiBuffer* buffer) {
+        rx::concurrency::scope_lock l(buffers_mutex);
+
+        for(rx_size i = 0; i < movable_buffers.size(); i++) {
+            if(movable_buffers[i].buffer == buffer) {
+                movable_buffers[i] = movable_buffers.last();
+                movable_buffers.erase(movable_buffers.size() - 1, movable_buffers.size());
+                break;
+            }
+        }
+
+        pending_moves.each_fwd([&](PendingMove& pending_move) {
+            if(pending_move.move.old_buffer == buffer) {
+                pending_move.is_cancelled = true;
+            }
+        });
+    }
+
+    rx::vector<BufferMove> DeviceMemoryDefragmenter::update(const NovaSettings::MeshDefragmentationOptions& options,
+                                                            const uint64_t last_finished_frame) {
+        rx::concurrency::scope_lock l(buffers_mutex);
+
+        auto finished_moves = finish_pending_moves();
+
+        if(options.enabled && get_fragmentation_stats().get_fragmentation() >= options.fragmentation_threshold) {
+            start_moves(options, last_finished_frame);
+        }
+
+        return finished_moves;
+    }
+
+    mem::FragmentationStats DeviceMemoryDefragmenter::get_fragmentation_stats() const { return strategy.get_fragmentation_stats(); }
+
+    rx::vector<BufferMove> DeviceMemoryDefragmenter::finish_pending_moves() {
+        rx::vector<BufferMove> finished_moves(allocator);
+        if(pending_moves.is_empty()) {
+            return finished_moves;
+        }
+
+        device.wait_for_fences(copy_fences);
+        device.reset_fences(copy_fences);
+
+        pending_moves.each_fwd([&](const PendingMove& pending_move) {
+            if(pending_move.is_cancelled) {
+                device.destroy_buffer(pending_move.move.new_buffer, allocator);
+                return;
+            }
+
+            // The buffer is still registered, because removing it would have cancelled the move
+            movable_buffers.each_fwd([&](MovableBuffer& movable_buffer) {
+                if(movable_buffer.buffer == pending_move.move.old_buffer) {
+                    movable_buffer.buffer = pending_move.move.new_buffer;
+                    return false;
+                }
+
+                return true;
+            });
+
+            finished_moves.push_back(pending_move.move);
+        });
+
+        pending_moves.clear();
+
+        return finished_moves;
+    }
+
+    void DeviceMemoryDefragmenter::start_moves(const NovaSettings::MeshDefragmentationOptions& options,
+                                               const uint64_t last_finished_frame) {
+        if(movable_buffers.is_empty()) {
+            return;
+        }
+
+        // Move the buffers at the end of the pool first, so that the free memory collects at the end
+        rx::algorithm::quick_sort(movable_buffers.data(),
+                                  movable_buffers.data() + movable_buffers.size(),
+                                  [](const MovableBuffer& lhs, const MovableBuffer& rhs) {
+                                      return lhs.buffer->memory_allocation.allocation_info.offset >
+                                             rhs.buffer->memory_allocation.allocation_info.offset;
+                                  });
+
+        rhi::CommandList* cmds = nullptr;
+        mem::Bytes bytes_moved = 0;
+
+        for(rx_size i = 0; i < movable_buffers.size(); i++) {
+            const auto& movable_buffer = movable_buffers[i];
+            if(movable_buffer.upload_frame > last_finished_frame) {
+                // The upload may still be writing to the buffer
+                continue;
+            }
+
+            // Always move at least one buffer, so that buffers larger than the budget still get moved eventually
+            if(bytes_moved > 0_b && bytes_moved + movable_buffer.create_info.size > mem::Bytes(options.max_bytes_per_frame)) {
+                break;
+            }
+
+            auto* new_buffer = device.create_buffer(movable_buffer.create_info, memory, allocator);
+            if(new_buffer == nullptr) {
+                break;
+            }
+
+            if(new_buffer->memory_resource != &memory || new_buffer->memory_allocation.allocation_info.offset >=
+                                                             movable_buffer.buffer->memory_allocation.allocation_info.offset) {
+                // The free memory before this buffer is too small for it. The buffers after this one in the list are closer to the start
+                // of the pool, so they probably wouldn't fit either
+                device.destroy_buffer(new_buffer, allocator);
+                break;
+            }
+
+            if(cmds == nullptr) {
+                cmds = device.create_command_list(0, rhi::QueueType::Transfer, rhi::CommandList::Level::Primary, allocator);
+                cmds->set_debug_name("DefragmentMemory");
+            }
+
+            // The old buffer stays in its state, because the GPU may still be reading from it for the frames in flight
+            cmds->transition_resource(new_buffer, rhi::ResourceState::CopyDestination, rhi::QueueType::Transfer);
+            cmds->copy_buffer(new_buffer, 0, movable_buffer.buffer, 0, movable_buffer.create_info.size);
+            cmds->transition_resource(new_buffer, movable_buffer.state);
+
+            pending_moves.push_back(PendingMove{BufferMove{movable_buffer.buffer, new_buffer}});
+
+            bytes_moved += movable_buffer.create_info.size;
+        }
+
+        if(cmds != nullptr) {
+            device.submit_command_list(cmds, rhi::QueueType::Transfer, copy_fences[0]);
+
+            logger(rx::log::level::k_verbose,
+                   "Moving %zu buffers (%zu bytes) to defragment memory",
+                   pending_moves.size(),
+                   bytes_moved.b_count());
+        }
+    }
+} // namespace nova::renderer
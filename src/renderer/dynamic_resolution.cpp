@@ -0,0 +1,93 @@
+#include "nova_renderer/dynamic_resolution.hpp"
+
+#include <cmath>
+
+#include <rx/core/algorithm/clamp.h>
+#include <rx/core/algorithm/max.h>
+#include <rx/core/algorithm/min.h>
+
+#include "nova_renderer/constants.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief Frame times between this fraction of the target frame time and the target frame time don't change the render scale
+     */
+    constexpr double MIN_ACCEPTED_FRAME_TIME_FRACTION = 0.85;
+
+    /*!
+     * \brief The controller aims for the middle of the accepted frame times, so that it has room to spare in both directions
+     */
+    constexpr double AIMED_FRAME_TIME_FRACTION = (MIN_ACCEPTED_FRAME_TIME_FRACTION + 1.0) / 2.0;
+
+    /*!
+     * \brief The smallest change to the render scale that's worth rewriting the render scale uniforms for
+     */
+    constexpr float MIN_SCALE_CHANGE = 0.01F;
+
+    bool DynamicResolutionController::add_frame_time(const double gpu_frame_time, const NovaSettings::DynamicResolutionOptions& options) {
+        const auto min_scale = rx::algorithm::clamp(options.min_scale, MIN_SCALE_CHANGE, 1.0F);
+        const auto max_scale = rx::algorithm::clamp(options.max_scale, min_scale, 1.0F);
+
+        if(num_frame_times_to_skip > 0) {
+            num_frame_times_to_skip--;
+            return false;
+        }
+
+        frame_time_sum += gpu_frame_time;
+        num_frame_times++;
+
+        if(num_frame_times < rx::algorithm::max(options.adjustment_interval, 1u)) {
+            return false;
+        }
+
+        const auto average_frame_time = frame_time_sum / num_frame_times;
+        frame_time_sum = 0;
+        num_frame_times = 0;
+
+        const auto target_frame_time = static_cast<double>(options.target_frame_time);
+        auto new_scale = render_scale;
+
+        const auto is_too_slow = average_frame_time > target_frame_time;
+        const auto is_too_fast = average_frame_time < target_frame_time * MIN_ACCEPTED_FRAME_TIME_FRACTION;
+        if((is_too_slow || is_too_fast) && average_frame_time > 0) {
+            // The GPU's work scales with the number of pixels, which is the square of the render scale
+            const auto scale_factor = std::sqrt(target_frame_time * AIMED_FRAME_TIME_FRACTION / average_frame_time);
+            const auto desired_scale = static_cast<float>(render_scale * scale_factor);
+
+            const auto max_step = rx::algorithm::max(options.max_scale_step, MIN_SCALE_CHANGE);
+            new_scale = rx::algorithm::clamp(desired_scale, render_scale - max_step, render_scale + max_step);
+        }
+
+        // The options may have changed since the render scale was picked, so clamp it even if the frame time was fine
+        new_scale = rx::algorithm::clamp(new_scale, min_scale, max_scale);
+
+        // Always land exactly on the bounds, so the render scale can get back to full resolution
+        const auto is_at_bound = new_scale == min_scale || new_scale == max_scale;
+        if(new_scale == render_scale || (std::abs(new_scale - render_scale) < MIN_SCALE_CHANGE && !is_at_bound)) {
+            return false;
+        }
+
+        render_scale = new_scale;
+        num_frame_times_to_skip = NUM_IN_FLIGHT_FRAMES;
+
+        return true;
+    }
+
+    float DynamicResolutionController::get_render_scale() const { return render_scale; }
+
+    void DynamicResolutionController::reset() {
+        render_scale = 1.0F;
+        frame_time_sum = 0;
+        num_frame_times = 0;
+        num_frame_times_to_skip = 0;
+    }
+
+    glm::uvec2 get_scaled_size(const glm::uvec2& size, const float render_scale) {
+        const auto scale_dimension = [&](const uint32_t dimension) {
+            const auto scaled = static_cast<uint32_t>(std::ceil(static_cast<float>(dimension) * render_scale));
+            return rx::algorithm::max(rx::algorithm::min(scaled, dimension), 1u);
+        };
+
+        return {scale_dimension(size.x), scale_dimension(size.y)};
+    }
+} // namespace nova::renderer
@@ -0,0 +1,24 @@
+#include "nova_renderer/frame_context.hpp"
+
+#include <rx/core/log.h>
+
+namespace nova::renderer {
+    RX_LOG("FrameContext", logger);
+
+    rx::optional<size_t> FrameContext::reserve_model_matrices(const size_t num_matrices) {
+        const auto first_index = cur_model_matrix_index.fetch_add(num_matrices);
+        if(first_index + num_matrices <= model_matrix_slice_end) {
+            return first_index;
+        }
+
+        // The index never goes back down, so every later reservation in this frame fails too. Only the first failure logs, so that we don't
+        // log once per batch
+        if(first_index <= model_matrix_slice_end) {
+            logger(rx::log::level::k_error,
+                   "Frame %zu ran out of room in the model matrix buffer. Some meshes won't be drawn this frame",
+                   frame_count);
+        }
+
+        return rx::nullopt;
+    }
+} // namespace nova::renderer
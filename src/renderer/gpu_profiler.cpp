@@ -0,0 +1,134 @@
+#include "nova_renderer/gpu_profiler.hpp"
+
+#include <rx/core/algorithm/max.h>
+#include <rx/core/algorithm/min.h>
+#include <rx/core/concurrency/scope_lock.h>
+#include <rx/core/time/qpc.h>
+
+#include "nova_renderer/rendergraph.hpp"
+#include "nova_renderer/rhi/render_device.hpp"
+#include "nova_renderer/tracing.hpp"
+
+namespace nova::renderer {
+    GpuProfiler::GpuProfiler(rhi::RenderDevice& device, rx::memory::allocator* allocator)
+        : device(device),
+          allocator(allocator),
+          timestamp_period(device.info.timestamp_period),
+          gpu_track(tracing::create_track("GPU")),
+          renderpass_times(allocator) {}
+
+    GpuProfiler::~GpuProfiler() {
+        for(uint32_t i = 0; i < NUM_IN_FLIGHT_FRAMES; i++) {
+            if(frames[i].pool != nullptr) {
+                device.destroy_query_pool(frames[i].pool, allocator);
+            }
+        }
+    }
+
+    void GpuProfiler::begin_frame(const uint32_t frame_idx, const rx::vector<CompiledRenderpass>& renderpasses) {
+        NOVA_TRACE_SCOPE("GpuProfiler", "begin_frame");
+
+        cur_frame_idx = frame_idx;
+        auto& queries = frames[frame_idx];
+
+        read_timestamps(queries);
+
+        const auto num_queries = static_cast<uint32_t>(renderpasses.size() * 2);
+        if(num_queries > 0 && (queries.pool == nullptr || queries.pool->num_queries < num_queries)) {
+            // The GPU has finished the last frame that used this pool, so nothing is using it anymore
+            if(queries.pool != nullptr) {
+                device.destroy_query_pool(queries.pool, allocator);
+            }
+
+            queries.pool = device.create_timestamp_query_pool(num_queries, allocator);
+        }
+
+        queries.renderpass_names.clear();
+        renderpasses.each_fwd([&](const CompiledRenderpass& pass) { queries.renderpass_names.push_back(pass.renderpass->name); });
+
+        queries.cpu_start_ticks = rx::time::qpc_ticks();
+        queries.is_traced = tracing::is_recording();
+    }
+
+    void GpuProfiler::reset_queries(rhi::CommandList& cmds) const {
+        const auto& queries = frames[cur_frame_idx];
+        if(!queries.renderpass_names.is_empty()) {
+            cmds.reset_queries(queries.pool, 0, static_cast<uint32_t>(queries.renderpass_names.size() * 2));
+        }
+    }
+
+    void GpuProfiler::begin_renderpass(rhi::CommandList& cmds, const uint32_t renderpass_idx) const {
+        cmds.write_timestamp(frames[cur_frame_idx].pool, renderpass_idx * 2, rhi::PipelineStage::TopOfPipe);
+    }
+
+    void GpuProfiler::end_renderpass(rhi::CommandList& cmds, const uint32_t renderpass_idx) const {
+        cmds.write_timestamp(frames[cur_frame_idx].pool, renderpass_idx * 2 + 1, rhi::PipelineStage::BottomOfPipe);
+    }
+
+    rx::vector<RenderpassGpuTime> GpuProfiler::get_renderpass_times() const {
+        rx::concurrency::scope_lock l(times_mutex);
+        return renderpass_times;
+    }
+
+    rx::optional<double> GpuProfiler::get_frame_time() const {
+        rx::concurrency::scope_lock l(times_mutex);
+        return frame_time;
+    }
+
+    void GpuProfiler::read_timestamps(FrameQueries& queries) {
+        if(queries.renderpass_names.is_empty()) {
+            return;
+        }
+
+        const auto num_renderpasses = static_cast<uint32_t>(queries.renderpass_names.size());
+        const auto timestamps = device.get_timestamps(queries.pool, 0, num_renderpasses * 2, allocator);
+
+        rx::vector<RenderpassGpuTime> times{allocator};
+        times.reserve(num_renderpasses);
+
+        const auto cpu_ticks_per_gpu_tick = static_cast<double>(timestamp_period) * static_cast<double>(rx::time::qpc_frequency()) /
+                                            1000000000.0;
+
+        // The GPU's timestamps are placed relative to the earliest one. Renderpasses on the async compute queue may start before the first
+        // renderpass on the graphics queue
+        uint64_t first_timestamp = UINT64_MAX;
+        uint64_t last_timestamp = 0;
+        for(uint32_t i = 0; i < num_renderpasses; i++) {
+            if(timestamps[i * 2]) {
+                first_timestamp = rx::algorithm::min(first_timestamp, *timestamps[i * 2]);
+            }
+        }
+
+        for(uint32_t i = 0; i < num_renderpasses; i++) {
+            const auto& start = timestamps[i * 2];
+            const auto& end = timestamps[i * 2 + 1];
+
+            // Skipped renderpasses don't write their timestamps
+            if(!start || !end || *end < *start) {
+                continue;
+            }
+
+            last_timestamp = rx::algorithm::max(last_timestamp, *end);
+
+            const auto& name = queries.renderpass_names[i];
+            const auto milliseconds = static_cast<double>(*end - *start) * timestamp_period / 1000000.0;
+            times.push_back(RenderpassGpuTime{name, milliseconds});
+
+            if(queries.is_traced) {
+                const auto to_cpu_ticks = [&](const uint64_t gpu_timestamp) {
+                    const auto gpu_ticks = static_cast<double>(gpu_timestamp - first_timestamp);
+                    return queries.cpu_start_ticks + static_cast<uint64_t>(gpu_ticks * cpu_ticks_per_gpu_tick);
+                };
+
+                tracing::record_event(gpu_track, "GPU", tracing::intern(name), to_cpu_ticks(*start), to_cpu_ticks(*end));
+            }
+        }
+
+        rx::concurrency::scope_lock l(times_mutex);
+        renderpass_times = times;
+
+        if(last_timestamp > first_timestamp) {
+            frame_time = static_cast<double>(last_timestamp - first_timestamp) * timestamp_period / 1000000.0;
+        }
+    }
+} // namespace nova::renderer
@@ -1,8 +1,12 @@
 #include "nova_renderer/pipeline_storage.hpp"
 
+#include <rx/core/concurrency/scope_lock.h>
+#include <rx/core/concurrency/thread_pool.h>
+
 #include "nova_renderer/nova_renderer.hpp"
 #include "nova_renderer/rhi/pipeline_create_info.hpp"
 #include "nova_renderer/rhi/render_device.hpp"
+#include "nova_renderer/tracing.hpp"
 
 #include "spirv_glsl.hpp"
 
@@ -16,15 +20,70 @@ namespace nova::renderer {
     using namespace renderpack;
 
     PipelineStorage::PipelineStorage(NovaRenderer& renderer, rx::memory::allocator* allocator)
-        : renderer(renderer), device(renderer.get_engine()), allocator(allocator) {}
+        : renderer(renderer), device(renderer.get_engine()), allocator(allocator) {
+        const auto num_threads = renderer.get_settings()->num_pipeline_compile_threads;
+        if(num_threads > 0) {
+            compile_threads = allocator->create<rx::concurrency::thread_pool>(allocator, num_threads, 64_z);
+        }
+    }
+
+    PipelineStorage::~PipelineStorage() {
+        if(compile_threads != nullptr) {
+            // The thread pool finishes all its jobs before it's destroyed
+            allocator->destroy<rx::concurrency::thread_pool>(compile_threads);
+        }
+    }
 
     rx::optional<renderer::Pipeline> PipelineStorage::get_pipeline(const rx::string& pipeline_name) const {
+        rx::concurrency::scope_lock l(pipelines_mutex);
+
         if(const auto* pipeline = pipelines.find(pipeline_name)) {
             return *pipeline;
+        }
 
-        } else {
+        auto* waiting_pipeline = waiting_pipelines.find(pipeline_name);
+        if(waiting_pipeline == nullptr) {
             return rx::nullopt;
         }
+
+        const auto* fallback = pipelines.find(waiting_pipeline->fallback_name);
+        if(fallback == nullptr) {
+            return rx::nullopt;
+        }
+
+        if(waiting_pipeline->fallback_state == FallbackState::Unchecked) {
+            if(can_draw_with_fallback(pipeline_name, *waiting_pipeline->pipeline_interface, waiting_pipeline->fallback_name)) {
+                waiting_pipeline->fallback_state = FallbackState::Compatible;
+
+            } else {
+                logger(rx::log::level::k_warning,
+                       "Pipeline %s can't draw with its fallback %s, so its materials won't be drawn until it's compiled",
+                       pipeline_name,
+                       waiting_pipeline->fallback_name);
+                waiting_pipeline->fallback_state = FallbackState::Incompatible;
+            }
+        }
+
+        if(waiting_pipeline->fallback_state == FallbackState::Compatible) {
+            // Bind the fallback's RhiPipeline, but keep our interface so we draw our own material passes
+            return Pipeline{fallback->pipeline, waiting_pipeline->pipeline_interface};
+        }
+
+        return rx::nullopt;
+    }
+
+    rhi::RhiPipelineInterface* PipelineStorage::get_pipeline_interface(const rx::string& pipeline_name) const {
+        rx::concurrency::scope_lock l(pipelines_mutex);
+
+        if(const auto* pipeline = pipelines.find(pipeline_name)) {
+            return pipeline->pipeline_interface;
+
+        } else if(const auto* waiting_pipeline = waiting_pipelines.find(pipeline_name)) {
+            return waiting_pipeline->pipeline_interface;
+
+        } else {
+            return nullptr;
+        }
     }
 
     bool PipelineStorage::create_pipeline(const PipelineStateCreateInfo& create_info) {
@@ -42,6 +101,7 @@ namespace nova::renderer {
         if(pipeline_result) {
             auto [pipeline, pipeline_metadata] = *pipeline_result;
 
+            rx::concurrency::scope_lock l(pipelines_mutex);
             pipelines.insert(create_info.name, pipeline);
             pipeline_metadatas.insert(create_info.name, pipeline_metadata);
 
@@ -53,6 +113,168 @@ namespace nova::renderer {
         }
     }
 
+    bool PipelineStorage::create_pipeline_async(const PipelineStateCreateInfo& create_info, const rx::string& fallback_name) {
+        if(compile_threads == nullptr) {
+            return create_pipeline(create_info);
+        }
+
+        Result<rhi::RhiPipelineInterface*> pipeline_interface = create_pipeline_interface(create_info);
+        if(!pipeline_interface) {
+            logger(rx::log::level::k_error,
+                   "Pipeline %s has an invalid interface: %s",
+                   create_info.name,
+                   pipeline_interface.error.to_string());
+            return false;
+        }
+
+        {
+            rx::concurrency::scope_lock l(pipelines_mutex);
+
+            WaitingPipeline waiting_pipeline;
+            waiting_pipeline.pipeline_interface = *pipeline_interface;
+            waiting_pipeline.fallback_name = fallback_name;
+            if(fallback_name.is_empty()) {
+                waiting_pipeline.fallback_state = FallbackState::Incompatible;
+            }
+            waiting_pipelines.insert(create_info.name, waiting_pipeline);
+
+            PipelineMetadata metadata;
+            metadata.data = create_info;
+            pipeline_metadatas.insert(create_info.name, metadata);
+
+            num_compiling_pipelines++;
+        }
+
+        // The job may run after the caller's create info is gone, so it gets its own copy
+        auto* job_create_info = allocator->create<PipelineStateCreateInfo>(create_info);
+        rhi::RhiPipelineInterface* job_pipeline_interface = *pipeline_interface;
+        compile_threads->add([this, job_pipeline_interface, job_create_info](int /* thread_id */) {
+            compile_pipeline(job_pipeline_interface, *job_create_info);
+
+            allocator->destroy<PipelineStateCreateInfo>(job_create_info);
+        });
+
+        return true;
+    }
+
+    bool PipelineStorage::create_compute_pipeline(const ComputePipelineCreateInfo& create_info) {
+        rx::map<rx::string, rhi::RhiResourceBindingDescription> bindings;
+        get_shader_module_descriptors(create_info.compute_shader.source, rhi::ShaderStage::Compute, bindings);
+
+        Result<rhi::RhiPipelineInterface*> pipeline_interface = device.create_pipeline_interface(bindings, {}, rx::nullopt, allocator);
+        if(!pipeline_interface) {
+            logger(rx::log::level::k_error,
+                   "Compute pipeline %s has an invalid interface: %s",
+                   create_info.name,
+                   pipeline_interface.error.to_string());
+            return false;
+        }
+
+        Result<rhi::RhiPipeline*> rhi_pipeline = device.create_compute_pipeline(*pipeline_interface, create_info, allocator);
+        if(!rhi_pipeline) {
+            logger(rx::log::level::k_error, "Could not create compute pipeline %s:%s", create_info.name, rhi_pipeline.error.to_string());
+            return false;
+        }
+
+        Pipeline pipeline;
+        pipeline.pipeline = *rhi_pipeline;
+        pipeline.pipeline_interface = *pipeline_interface;
+        pipeline.is_compute = true;
+        pipeline.workgroup_count = create_info.workgroup_count;
+        pipeline.workgroup_size = create_info.workgroup_size;
+
+        rx::concurrency::scope_lock l(pipelines_mutex);
+        pipelines.insert(create_info.name, pipeline);
+
+        return true;
+    }
+
+    void PipelineStorage::resize_dispatches(const rx::string& pipeline_name, const glm::uvec2& output_size) {
+        rx::concurrency::scope_lock l(pipelines_mutex);
+
+        auto* pipeline = pipelines.find(pipeline_name);
+        if(pipeline == nullptr || !pipeline->is_compute || pipeline->workgroup_size.x == 0) {
+            return;
+        }
+
+        const auto& workgroup_size = pipeline->workgroup_size;
+        pipeline->workgroup_count = {(output_size.x + workgroup_size.x - 1) / workgroup_size.x,
+                                     (output_size.y + workgroup_size.y - 1) / workgroup_size.y,
+                                     1};
+    }
+
+    bool PipelineStorage::is_async() const { return compile_threads != nullptr; }
+
+    void PipelineStorage::compile_pipeline(rhi::RhiPipelineInterface* pipeline_interface, const PipelineStateCreateInfo& create_info) {
+        NOVA_TRACE_SCOPE("PipelineStorage", "compile_pipeline");
+
+        Result<PipelineReturn> pipeline_result = create_graphics_pipeline(pipeline_interface, create_info);
+
+        bool compiled_last_pipeline;
+        {
+            rx::concurrency::scope_lock l(pipelines_mutex);
+
+            if(pipeline_result) {
+                waiting_pipelines.erase(create_info.name);
+                pipelines.insert(create_info.name, pipeline_result->pipeline);
+
+            } else {
+                // Leave the pipeline waiting, so that its materials keep drawing with its fallback
+                logger(rx::log::level::k_error, "Could not create pipeline %s:%s", create_info.name, pipeline_result.error.to_string());
+            }
+
+            num_compiling_pipelines--;
+            compiled_last_pipeline = num_compiling_pipelines == 0;
+        }
+
+        if(compiled_last_pipeline) {
+            logger(rx::log::level::k_verbose, "Compiled all pipelines");
+            device.save_pipeline_cache();
+        }
+    }
+
+    bool PipelineStorage::can_draw_with_fallback(const rx::string& pipeline_name,
+                                                 const rhi::RhiPipelineInterface& pipeline_interface,
+                                                 const rx::string& fallback_name) const {
+        const auto* fallback = pipelines.find(fallback_name);
+        const auto* metadata = pipeline_metadatas.find(pipeline_name);
+        const auto* fallback_metadata = pipeline_metadatas.find(fallback_name);
+        if(fallback == nullptr || metadata == nullptr || fallback_metadata == nullptr) {
+            return false;
+        }
+
+        // The material passes' descriptor sets are bound with our interface, so the fallback must have the same bindings
+        const auto& fallback_bindings = fallback->pipeline_interface->bindings;
+        if(fallback_bindings.size() != pipeline_interface.bindings.size()) {
+            return false;
+        }
+
+        const bool same_bindings = pipeline_interface.bindings.each_pair(
+            [&](const rx::string& name, const rhi::RhiResourceBindingDescription& binding) {
+                const auto* fallback_binding = fallback_bindings.find(name);
+                return fallback_binding != nullptr && rhi::RhiResourceBindingDescription{binding} == *fallback_binding;
+            });
+        if(!same_bindings) {
+            return false;
+        }
+
+        // The fallback must also be able to render to the renderpass that we render to
+        const auto& data = metadata->data;
+        const auto& fallback_data = fallback_metadata->data;
+        if(data.color_attachments.size() != fallback_data.color_attachments.size() ||
+           data.depth_texture.has_value() != fallback_data.depth_texture.has_value()) {
+            return false;
+        }
+
+        for(rx_size i = 0; i < data.color_attachments.size(); i++) {
+            if(!(data.color_attachments[i] == fallback_data.color_attachments[i])) {
+                return false;
+            }
+        }
+
+        return !data.depth_texture || *data.depth_texture == *fallback_data.depth_texture;
+    }
+
     Result<PipelineReturn> PipelineStorage::create_graphics_pipeline(rhi::RhiPipelineInterface* pipeline_interface,
                                                                      const PipelineStateCreateInfo& pipeline_create_info) const {
         Pipeline pipeline;
@@ -118,6 +340,14 @@ namespace nova::renderer {
         for(const auto& resource : resources.storage_buffers) {
             add_resource_to_bindings(bindings, shader_stage, shader_compiler, resource, rhi::DescriptorType::StorageBuffer);
         }
+
+        for(const auto& resource : resources.subpass_inputs) {
+            add_resource_to_bindings(bindings, shader_stage, shader_compiler, resource, rhi::DescriptorType::InputAttachment);
+        }
+
+        for(const auto& resource : resources.storage_images) {
+            add_resource_to_bindings(bindings, shader_stage, shader_compiler, resource, rhi::DescriptorType::StorageImage);
+        }
     }
 
     void PipelineStorage::add_resource_to_bindings(rx::map<rx::string, rhi::RhiResourceBindingDescription>& bindings,
@@ -1,7 +1,11 @@
 #include "nova_renderer/rendergraph.hpp"
 
+#include "nova_renderer/dynamic_resolution.hpp"
+#include "nova_renderer/gpu_profiler.hpp"
 #include "nova_renderer/nova_renderer.hpp"
+#include "nova_renderer/render_statistics.hpp"
 #include "nova_renderer/rhi/command_list.hpp"
+#include "nova_renderer/tracing.hpp"
 
 #include "../loading/renderpack/render_graph_builder.hpp"
 
@@ -10,60 +14,90 @@ namespace nova::renderer {
 
     RX_LOG("Rendergraph", logger);
 
-    Renderpass::Renderpass(rx::string name, const bool is_builtin) : name(std::move(name)), is_builtin(is_builtin) {}
+    static rhi::RhiImage* get_depth_texture(const Renderpass& renderpass) {
+        const auto depth_idx = renderpass.write_textures.find_if([](const rhi::RhiImage* image) { return image->is_depth_tex; });
+        return depth_idx != rx::vector<rhi::RhiImage*>::k_npos ? renderpass.write_textures[depth_idx] : nullptr;
+    }
+
+    static const rhi::RhiImage* get_memory(const rhi::RhiImage* image) {
+        return image->aliased_image != nullptr ? image->aliased_image : image;
+    }
+
+    static bool contains(const rx::vector<rhi::RhiImage*>& images, const rhi::RhiImage* image) {
+        return images.find_if([&](const rhi::RhiImage* other) { return other == image; }) != rx::vector<rhi::RhiImage*>::k_npos;
+    }
+
+    static bool uses_memory(const Renderpass& renderpass, const rhi::RhiImage* memory) {
+        const auto is_memory = [&](const rhi::RhiImage* image) { return get_memory(image) == memory; };
+        return renderpass.read_textures.find_if(is_memory) != rx::vector<rhi::RhiImage*>::k_npos ||
+               renderpass.write_textures.find_if(is_memory) != rx::vector<rhi::RhiImage*>::k_npos;
+    }
+
+    /*!
+     * \brief Checks if two renderpasses use any of the same memory, so one of them has to wait for the other
+     */
+    static bool shares_memory(const Renderpass& renderpass, const Renderpass& other) {
+        const auto is_shared = [&](const rhi::RhiImage* image) { return uses_memory(other, get_memory(image)); };
+        return renderpass.read_textures.find_if(is_shared) != rx::vector<rhi::RhiImage*>::k_npos ||
+               renderpass.write_textures.find_if(is_shared) != rx::vector<rhi::RhiImage*>::k_npos;
+    }
 
-    void Renderpass::execute(rhi::CommandList& cmds, FrameContext& ctx) {
-        // TODO: Figure if any of these barriers are implicit
-        // TODO: Use shader reflection to figure our the stage that the pipelines in this renderpass need access to this resource instead of
-        // using a robust default
+    Renderpass::Renderpass(rx::string name, const bool is_builtin) : name(std::move(name)), is_builtin(is_builtin) {}
 
+    void Renderpass::execute(rhi::CommandList& cmds, FrameContext& ctx, rhi::CommandList* recorded_contents) {
         record_pre_renderpass_barriers(cmds, ctx);
 
         setup_renderpass(cmds, ctx);
 
-        const auto framebuffer = get_framebuffer(ctx);
+        if(is_compute) {
+            // Compute renderpasses don't begin an RHI renderpass, they just dispatch
+            if(recorded_contents != nullptr) {
+                rx::vector<rhi::CommandList*> contents{ctx.allocator};
+                contents.push_back(recorded_contents);
+                cmds.execute_command_lists(contents);
 
-        cmds.begin_renderpass(renderpass, framebuffer);
+            } else {
+                record_renderpass_contents(cmds, ctx);
+            }
 
-        record_renderpass_contents(cmds, ctx);
+            record_post_renderpass_barriers(cmds, ctx);
+            return;
+        }
 
-        cmds.end_renderpass();
+        const auto contents_type = recorded_contents != nullptr ? rhi::CommandList::RenderpassContents::SecondaryCommandLists :
+                                                                  rhi::CommandList::RenderpassContents::Inline;
 
-        record_post_renderpass_barriers(cmds, ctx);
-    }
+        // Later subpasses of a merged renderpass continue the renderpass that the first subpass began
+        if(subpass_index == 0) {
+            cmds.begin_renderpass(get_renderpass(), get_framebuffer(ctx), contents_type);
+        } else {
+            cmds.next_subpass(contents_type);
+        }
 
-    void Renderpass::record_pre_renderpass_barriers(rhi::CommandList& cmds, FrameContext& ctx) const {
-        if(read_texture_barriers.size() > 0) {
-            // TODO: Use shader reflection to figure our the stage that the pipelines in this renderpass need access to this resource
-            // instead of using a robust default
-            cmds.resource_barriers(rhi::PipelineStage::ColorAttachmentOutput, rhi::PipelineStage::FragmentShader, read_texture_barriers);
+        if(recorded_contents != nullptr) {
+            rx::vector<rhi::CommandList*> contents{ctx.allocator};
+            contents.push_back(recorded_contents);
+            cmds.execute_command_lists(contents);
+
+        } else {
+            set_scaled_viewport(cmds, ctx);
+            record_renderpass_contents(cmds, ctx);
         }
 
-        if(write_texture_barriers.size() > 0) {
-            // TODO: Use shader reflection to figure our the stage that the pipelines in this renderpass need access to this resource
-            // instead of using a robust default
-            cmds.resource_barriers(rhi::PipelineStage::ColorAttachmentOutput, rhi::PipelineStage::FragmentShader, write_texture_barriers);
+        if(is_last_subpass) {
+            cmds.end_renderpass();
         }
 
-        if(writes_to_backbuffer) {
-            rhi::RhiResourceBarrier backbuffer_barrier{};
-            backbuffer_barrier.resource_to_barrier = ctx.swapchain_image;
-            backbuffer_barrier.access_before_barrier = rhi::ResourceAccess::MemoryRead;
-            backbuffer_barrier.access_after_barrier = rhi::ResourceAccess::ColorAttachmentWrite;
-            backbuffer_barrier.old_state = rhi::ResourceState::PresentSource;
-            backbuffer_barrier.new_state = rhi::ResourceState::RenderTarget;
-            backbuffer_barrier.source_queue = rhi::QueueType::Graphics;
-            backbuffer_barrier.destination_queue = rhi::QueueType::Graphics;
-            backbuffer_barrier.image_memory_barrier.aspect = rhi::ImageAspect::Color;
+        record_post_renderpass_barriers(cmds, ctx);
+    }
 
-            // TODO: Use shader reflection to figure our the stage that the pipelines in this renderpass need access to this resource
-            // instead of using a robust default
-            rx::vector<rhi::RhiResourceBarrier> barriers{&rx::memory::g_system_allocator};
-            barriers.push_back(backbuffer_barrier);
-            cmds.resource_barriers(rhi::PipelineStage::TopOfPipe, rhi::PipelineStage::ColorAttachmentOutput, barriers);
-        }
+    void Renderpass::record_contents(rhi::CommandList& cmds, FrameContext& ctx) {
+        set_scaled_viewport(cmds, ctx);
+        record_renderpass_contents(cmds, ctx);
     }
 
+    void Renderpass::record_pre_renderpass_barriers(rhi::CommandList& /* cmds */, FrameContext& /* ctx */) const {}
+
     void Renderpass::record_renderpass_contents(rhi::CommandList& cmds, FrameContext& ctx) {
         auto& pipeline_storage = ctx.nova->get_pipeline_storage();
 
@@ -76,53 +110,104 @@ namespace nova::renderer {
         });
     }
 
-    void Renderpass::record_post_renderpass_barriers(rhi::CommandList& cmds, FrameContext& ctx) const {
-        if(writes_to_backbuffer) {
-            rhi::RhiResourceBarrier backbuffer_barrier{};
-            backbuffer_barrier.resource_to_barrier = ctx.swapchain_image;
-            backbuffer_barrier.access_before_barrier = rhi::ResourceAccess::ColorAttachmentWrite;
-            backbuffer_barrier.access_after_barrier = rhi::ResourceAccess::MemoryRead;
-            backbuffer_barrier.old_state = rhi::ResourceState::RenderTarget;
-            backbuffer_barrier.new_state = rhi::ResourceState::PresentSource;
-            backbuffer_barrier.source_queue = rhi::QueueType::Graphics;
-            backbuffer_barrier.destination_queue = rhi::QueueType::Graphics;
-            backbuffer_barrier.image_memory_barrier.aspect = rhi::ImageAspect::Color;
+    uint32_t Renderpass::get_num_draws(FrameContext& ctx) const {
+        auto& pipeline_storage = ctx.nova->get_pipeline_storage();
+
+        uint32_t num_draws = 0;
+        pipeline_names.each_fwd([&](const rx::string& pipeline_name) {
+            if(const auto pipeline = pipeline_storage.get_pipeline(pipeline_name)) {
+                num_draws += pipeline->get_num_draws(ctx);
+            }
+        });
+
+        return num_draws;
+    }
+
+    void Renderpass::record_post_renderpass_barriers(rhi::CommandList& /* cmds */, FrameContext& /* ctx */) const {}
 
-            rx::vector<rhi::RhiResourceBarrier> barriers{&rx::memory::g_system_allocator};
-            barriers.push_back(backbuffer_barrier);
-            cmds.resource_barriers(rhi::PipelineStage::ColorAttachmentOutput, rhi::PipelineStage::BottomOfPipe, barriers);
+    void Renderpass::set_scaled_viewport(rhi::CommandList& cmds, const FrameContext& ctx) const {
+        if(!scales_with_resolution || ctx.render_scale >= 1.0F) {
+            return;
         }
+
+        const auto scaled_size = get_scaled_size(output_size, ctx.render_scale);
+        cmds.set_viewport(0, 0, static_cast<float>(scaled_size.x), static_cast<float>(scaled_size.y));
+        cmds.set_scissor_rect(0, 0, scaled_size.x, scaled_size.y);
     }
 
     Rendergraph::Rendergraph(rx::memory::allocator* allocator, rhi::RenderDevice& device) : allocator(allocator), device(device) {}
 
     void Rendergraph::destroy_renderpass(const rx::string& name) {
         if(Renderpass** renderpass = renderpasses.find(name)) {
+            split_merged_renderpasses();
+
             if((*renderpass)->framebuffer) {
                 device.destroy_framebuffer((*renderpass)->framebuffer, allocator);
             }
 
-            device.destroy_renderpass((*renderpass)->renderpass, allocator);
+            if((*renderpass)->renderpass) {
+                device.destroy_renderpass((*renderpass)->renderpass, allocator);
+            }
 
             renderpasses.erase(name);
             renderpass_metadatas.erase(name);
 
+            const auto name_idx = renderpass_names.find(name);
+            renderpass_names.erase(name_idx, name_idx + 1);
+
             is_dirty = true;
+            is_compiled = false;
         }
     }
 
-    rx::vector<rx::string> Rendergraph::calculate_renderpass_execution_order() {
-        if(is_dirty) {
-            const auto create_infos = [&]() {
-                rx::vector<RenderPassCreateInfo> create_info_temp(allocator);
-                create_info_temp.reserve(renderpass_metadatas.size());
+    void Rendergraph::merge_renderpasses() {
+        NOVA_TRACE_SCOPE("Rendergraph", "merge_renderpasses");
 
-                renderpass_metadatas.each_value([&](const RenderpassMetadata& metadata) { create_info_temp.emplace_back(metadata.data); });
+        split_merged_renderpasses();
 
-                return create_info_temp;
-            }();
+        const auto& execution_order = calculate_renderpass_execution_order();
 
-            order_passes(create_infos)
+        rx::vector<Renderpass*> subpasses{allocator};
+        uint32_t num_merged_renderpasses = 0;
+
+        const auto finish_merged_renderpass = [&] {
+            if(subpasses.size() > 1) {
+                create_merged_renderpass(subpasses);
+                num_merged_renderpasses += static_cast<uint32_t>(subpasses.size());
+            }
+
+            subpasses.clear();
+        };
+
+        execution_order.each_fwd([&](const rx::string& renderpass_name) {
+            auto* renderpass = get_renderpass(renderpass_name);
+            if(renderpass == nullptr) {
+                return;
+            }
+
+            if(!subpasses.is_empty() && can_merge(subpasses, *renderpass, allocator)) {
+                subpasses.push_back(renderpass);
+                return;
+            }
+
+            finish_merged_renderpass();
+
+            if(!renderpass->is_builtin && !renderpass->writes_to_backbuffer && !renderpass->is_compute) {
+                subpasses.push_back(renderpass);
+            }
+        });
+
+        finish_merged_renderpass();
+
+        rg_log(rx::log::level::k_info,
+               "Merged %u renderpasses into %u renderpasses",
+               num_merged_renderpasses,
+               static_cast<uint32_t>(merged_renderpasses.size()));
+    }
+
+    const rx::vector<rx::string>& Rendergraph::calculate_renderpass_execution_order() {
+        if(is_dirty) {
+            order_renderpasses_with({})
                 .map([&](const rx::vector<RenderPassCreateInfo>& order) {
                     cached_execution_order.clear();
                     cached_execution_order.reserve(order.size());
@@ -140,6 +225,723 @@ namespace nova::renderer {
         return cached_execution_order;
     }
 
+    ntl::Result<rx::vector<RenderPassCreateInfo>> Rendergraph::order_renderpasses_with(
+        const rx::vector<RenderPassCreateInfo>& new_passes) const {
+        rx::vector<RenderPassCreateInfo> create_infos(allocator);
+        create_infos.reserve(renderpass_names.size() + new_passes.size());
+
+        renderpass_names.each_fwd([&](const rx::string& name) {
+            const auto is_replaced = new_passes.find_if([&](const RenderPassCreateInfo& pass) { return pass.name == name; }) !=
+                                     rx::vector<RenderPassCreateInfo>::k_npos;
+            if(!is_replaced) {
+                create_infos.push_back(renderpass_metadatas.find(name)->data);
+            }
+        });
+
+        new_passes.each_fwd([&](const RenderPassCreateInfo& pass) { create_infos.push_back(pass); });
+
+        return order_passes(create_infos, device.settings->reorder_renderpasses);
+    }
+
+    const rx::vector<CompiledRenderpass>& Rendergraph::get_compiled_renderpasses() {
+        if(is_dirty || !is_compiled) {
+            compile();
+        }
+
+        return compiled_renderpasses;
+    }
+
+    const rx::vector<RendergraphSubmission>& Rendergraph::get_submissions() const { return compiled_submissions; }
+
+    void Rendergraph::execute(rhi::CommandList& cmds,
+                              FrameContext& ctx,
+                              const rx::vector<rhi::CommandList*>& renderpass_contents,
+                              const uint32_t submission_idx) const {
+        const auto& submission = compiled_submissions[submission_idx];
+        const auto is_graphics = submission.queue == rhi::QueueType::Graphics;
+
+        for(uint32_t i = submission.first_renderpass; i < submission.first_renderpass + submission.num_renderpasses; i++) {
+            const auto& pass = compiled_renderpasses[i];
+            statistics::RenderpassScope stats_scope{i};
+
+            // The graphics submission before an async compute submission records its transitions
+            if(is_graphics) {
+                record_transitions(cmds, ctx, pass.first_transition_before, pass.num_transitions_before);
+            }
+
+            if(!pass.is_skipped) {
+                auto* contents = renderpass_contents.is_empty() ? nullptr : renderpass_contents[i];
+
+                // Inside a renderpass whose contents are in a secondary command list, the secondary command list writes the timestamps
+                const auto writes_timestamps = ctx.gpu_profiler != nullptr && (contents == nullptr || pass.renderpass->is_compute);
+                if(writes_timestamps) {
+                    ctx.gpu_profiler->begin_renderpass(cmds, i);
+                }
+
+                pass.renderpass->execute(cmds, ctx, contents);
+
+                if(writes_timestamps) {
+                    ctx.gpu_profiler->end_renderpass(cmds, i);
+                }
+            }
+
+            record_transitions(cmds, ctx, pass.first_transition_after, pass.num_transitions_after);
+        }
+
+        if(!is_graphics) {
+            return;
+        }
+
+        // The async compute submissions which follow this submission wait for it, so their transitions happen at the end of it
+        for(auto i = submission_idx + 1; i < compiled_submissions.size(); i++) {
+            const auto& compute_submission = compiled_submissions[i];
+            if(compute_submission.queue == rhi::QueueType::Graphics) {
+                break;
+            }
+
+            const auto& pass = compiled_renderpasses[compute_submission.first_renderpass];
+            record_transitions(cmds, ctx, pass.first_transition_before, pass.num_transitions_before);
+        }
+    }
+
+    void Rendergraph::skip_empty_renderpasses(FrameContext& ctx) {
+        NOVA_TRACE_SCOPE("Rendergraph", "skip_empty_renderpasses");
+
+        compiled_renderpasses.each_fwd([&](CompiledRenderpass& pass) {
+            pass.is_skipped = pass.can_skip && pass.renderpass->get_num_draws(ctx) == 0;
+        });
+    }
+
+    void Rendergraph::compile() {
+        NOVA_TRACE_SCOPE("Rendergraph", "compile");
+
+        const auto& execution_order = calculate_renderpass_execution_order();
+
+        compiled_renderpasses.clear();
+        compiled_renderpasses.reserve(execution_order.size());
+
+        compiled_transitions.clear();
+        compiled_submissions.clear();
+
+        struct ResourceUse {
+            rhi::ResourceState state;
+            rx::optional<rhi::PipelineStage> stages;
+        };
+
+        // The state of every resource after the renderpasses compiled so far, and the stages which use it. The swapchain image is nullptr
+        rx::map<const rhi::RhiResource*, ResourceUse> resource_states{allocator};
+
+        // The index of the last compiled renderpass that used each resource
+        rx::map<const rhi::RhiResource*, uint32_t> last_uses{allocator};
+
+        // The index of the renderpass whose transitions are the last ones in `compiled_transitions`, if later renderpasses can still add
+        // their transitions to them
+        rx::optional<uint32_t> open_batch;
+
+        // Whether the transitions of the renderpass being compiled have to wait for a renderpass after the open batch
+        bool needs_barrier = false;
+
+        uint32_t num_barriers = 0;
+        uint32_t num_shared_barriers = 0;
+
+        const auto add_transition = [&](rhi::RhiResource* resource,
+                                        const rhi::ResourceState state,
+                                        const rx::optional<rhi::PipelineStage> stages = rx::nullopt) {
+            if(auto* cur_use = resource_states.find(resource)) {
+                const auto same_stages = cur_use->stages.has_value() == stages.has_value() && (!stages || *cur_use->stages == *stages);
+
+                // Shader writes always have to wait for the writes before them
+                if(cur_use->state == state && same_stages && state != rhi::ResourceState::ShaderWrite) {
+                    return;
+                }
+
+                *cur_use = ResourceUse{state, stages};
+
+            } else {
+                resource_states.insert(resource, ResourceUse{state, stages});
+            }
+
+            const auto* last_use = last_uses.find(resource);
+            if(!open_batch || (last_use != nullptr && *last_use >= *open_batch)) {
+                needs_barrier = true;
+            }
+
+            compiled_transitions.push_back(RendergraphTransition{resource, state, stages});
+        };
+
+        // The image which currently uses the memory of each image that shares its memory. Images are keyed by the image which owns their
+        // memory
+        rx::map<const rhi::RhiImage*, rhi::RhiImage*> memory_users{allocator};
+
+        // At the start of a frame, each image's memory is still used by the image which used it last in the previous frame
+        execution_order.each_fwd([&](const rx::string& renderpass_name) {
+            if(const auto* renderpass = get_renderpass(renderpass_name)) {
+                const auto set_memory_user = [&](rhi::RhiImage* image) {
+                    if(auto* user = memory_users.find(get_memory(image))) {
+                        *user = image;
+                    } else {
+                        memory_users.insert(get_memory(image), image);
+                    }
+                };
+
+                renderpass->read_textures.each_fwd([&](rhi::RhiImage* image) { set_memory_user(image); });
+                renderpass->write_textures.each_fwd([&](rhi::RhiImage* image) { set_memory_user(image); });
+            }
+        });
+
+        const auto take_over_memory = [&](rhi::RhiImage* image) {
+            auto* user = memory_users.find(get_memory(image));
+            if(*user == image) {
+                return;
+            }
+
+            // The image has to wait for the last use of the previous image. Its contents are lost, so the rendergraph has to transition it
+            // again
+            const auto* last_use = last_uses.find(*user);
+            if(!open_batch || (last_use != nullptr && *last_use >= *open_batch)) {
+                needs_barrier = true;
+            }
+
+            compiled_transitions.push_back(RendergraphTransition{image, rhi::ResourceState::Undefined, rx::nullopt, *user});
+
+            resource_states.erase(image);
+            *user = image;
+        };
+
+        const auto mark_used = [&](const rhi::RhiResource* resource, const uint32_t renderpass_idx) {
+            if(auto* last_use = last_uses.find(resource)) {
+                *last_use = renderpass_idx;
+            } else {
+                last_uses.insert(resource, renderpass_idx);
+            }
+        };
+
+        const auto use_async_compute = device.settings->async_compute;
+
+        // The async compute submissions that no graphics submission has waited for yet
+        rx::vector<uint32_t> pending_computes{allocator};
+
+        uint32_t last_graphics_submission = 0;
+        uint32_t num_async_renderpasses = 0;
+
+        const auto shares_memory_with_submission = [&](const Renderpass& renderpass, const uint32_t submission_idx) {
+            const auto& submission = compiled_submissions[submission_idx];
+            return shares_memory(renderpass, *compiled_renderpasses[submission.first_renderpass].renderpass);
+        };
+
+        const auto start_submission = [&](const rhi::QueueType queue, const uint32_t first_renderpass) -> RendergraphSubmission& {
+            RendergraphSubmission submission;
+            submission.queue = queue;
+            submission.first_renderpass = first_renderpass;
+            submission.wait_submissions = rx::vector<uint32_t>{allocator};
+
+            if(queue == rhi::QueueType::Graphics) {
+                last_graphics_submission = static_cast<uint32_t>(compiled_submissions.size());
+            }
+
+            compiled_submissions.push_back(submission);
+
+            // Transitions can't share a barrier with the transitions of an earlier submission, since this submission may have to wait
+            // for another queue before its transitions can happen
+            open_batch = rx::nullopt;
+
+            return compiled_submissions.last();
+        };
+
+        execution_order.each_fwd([&](const rx::string& renderpass_name) {
+            auto* renderpass = get_renderpass(renderpass_name);
+            if(renderpass == nullptr) {
+                return;
+            }
+
+            const auto renderpass_idx = static_cast<uint32_t>(compiled_renderpasses.size());
+
+            CompiledRenderpass pass;
+            pass.renderpass = renderpass;
+            pass.can_skip = can_skip_renderpass(*renderpass);
+
+            // Two async compute renderpasses which use the same memory could run at the same time, so the later one runs on the graphics
+            // queue instead
+            if(use_async_compute && renderpass->allows_async_compute &&
+               pending_computes.find_if([&](const uint32_t submission_idx) {
+                   return shares_memory_with_submission(*renderpass, submission_idx);
+               }) == rx::vector<uint32_t>::k_npos) {
+                pass.queue = rhi::QueueType::AsyncCompute;
+            }
+
+            if(pass.queue == rhi::QueueType::AsyncCompute) {
+                // The first submission waits for the swapchain image, which only the graphics queue can do
+                if(compiled_submissions.is_empty()) {
+                    start_submission(rhi::QueueType::Graphics, renderpass_idx);
+                }
+
+                const auto graphics_submission = last_graphics_submission;
+
+                pending_computes.push_back(static_cast<uint32_t>(compiled_submissions.size()));
+
+                auto& submission = start_submission(rhi::QueueType::AsyncCompute, renderpass_idx);
+                submission.num_renderpasses = 1;
+                submission.wait_submissions.push_back(graphics_submission);
+
+                num_async_renderpasses++;
+
+            } else {
+                // A graphics renderpass which uses the memory of an async compute renderpass has to wait for it
+                rx::vector<uint32_t> wait_submissions{allocator};
+                for(rx_size i = pending_computes.size(); i > 0; i--) {
+                    if(shares_memory_with_submission(*renderpass, pending_computes[i - 1])) {
+                        wait_submissions.push_back(pending_computes[i - 1]);
+                        pending_computes.erase(i - 1, i);
+                    }
+                }
+
+                if(compiled_submissions.is_empty() || compiled_submissions.last().queue != rhi::QueueType::Graphics ||
+                   !wait_submissions.is_empty()) {
+                    start_submission(rhi::QueueType::Graphics, renderpass_idx).wait_submissions = wait_submissions;
+                }
+
+                compiled_submissions.last().num_renderpasses++;
+            }
+
+            pass.first_transition_before = static_cast<uint32_t>(compiled_transitions.size());
+            needs_barrier = false;
+
+            // The first subpass of a merged renderpass transitions the images of all its subpasses, and the other subpasses transition
+            // nothing
+            rx::vector<Renderpass*> subpasses{allocator};
+            if(renderpass->merged_renderpass == nullptr) {
+                subpasses.push_back(renderpass);
+
+            } else if(renderpass->subpass_index == 0) {
+                const auto merged_idx = merged_renderpasses.find_if(
+                    [&](const MergedRenderpass& merged_renderpass) { return merged_renderpass.subpasses[0] == renderpass; });
+                subpasses = merged_renderpasses[merged_idx].subpasses;
+            }
+
+            subpasses.each_fwd([&](Renderpass* subpass) {
+                subpass->read_textures.each_fwd([&](rhi::RhiImage* image) { take_over_memory(image); });
+                subpass->write_textures.each_fwd([&](rhi::RhiImage* image) { take_over_memory(image); });
+            });
+
+            // Images that earlier subpasses already used stay in the state of their first use
+            rx::vector<rhi::RhiImage*> used_images{allocator};
+
+            subpasses.each_fwd([&](Renderpass* subpass) {
+                // TODO: Use shader reflection to figure out the stage that the pipelines in this renderpass need access to this resource
+                // instead of assuming that only fragment shaders read render targets
+                const auto read_stage = subpass->is_compute ? rhi::PipelineStage::ComputeShader : rhi::PipelineStage::FragmentShader;
+
+                subpass->read_textures.each_fwd([&](rhi::RhiImage* texture) {
+                    if(!contains(used_images, texture)) {
+                        add_transition(texture, rhi::ResourceState::ShaderRead, read_stage);
+                    }
+                });
+
+                subpass->write_textures.each_fwd([&](rhi::RhiImage* texture) {
+                    if(contains(used_images, texture)) {
+                        return;
+                    }
+
+                    if(subpass->is_compute) {
+                        add_transition(texture, rhi::ResourceState::ShaderWrite, rhi::PipelineStage::ComputeShader);
+                    } else {
+                        add_transition(texture,
+                                       texture->is_depth_tex ? rhi::ResourceState::DepthWrite : rhi::ResourceState::RenderTarget);
+                    }
+                });
+
+                subpass->read_textures.each_fwd([&](rhi::RhiImage* texture) { used_images.push_back(texture); });
+                subpass->write_textures.each_fwd([&](rhi::RhiImage* texture) { used_images.push_back(texture); });
+            });
+
+            if(renderpass->writes_to_backbuffer) {
+                add_transition(nullptr, rhi::ResourceState::RenderTarget);
+            }
+
+            const auto num_transitions = static_cast<uint32_t>(compiled_transitions.size()) - pass.first_transition_before;
+            if(num_transitions > 0) {
+                if(needs_barrier) {
+                    pass.num_transitions_before = num_transitions;
+                    open_batch = renderpass_idx;
+                    num_barriers++;
+
+                } else {
+                    // None of the resources that this renderpass transitions were used since the open batch, so the transitions can move
+                    // up to the open batch and share its barrier
+                    compiled_renderpasses[*open_batch].num_transitions_before += num_transitions;
+                    num_shared_barriers++;
+                }
+            }
+
+            renderpass->read_textures.each_fwd([&](const rhi::RhiImage* texture) { mark_used(texture, renderpass_idx); });
+            renderpass->write_textures.each_fwd([&](const rhi::RhiImage* texture) { mark_used(texture, renderpass_idx); });
+            if(renderpass->writes_to_backbuffer) {
+                mark_used(nullptr, renderpass_idx);
+            }
+
+            pass.first_transition_after = static_cast<uint32_t>(compiled_transitions.size());
+
+            if(renderpass->writes_to_backbuffer) {
+                needs_barrier = false;
+                add_transition(nullptr, rhi::ResourceState::PresentSource);
+            }
+
+            pass.num_transitions_after = static_cast<uint32_t>(compiled_transitions.size()) - pass.first_transition_after;
+            if(pass.num_transitions_after > 0) {
+                // Later transitions can't join the open batch, because they'd come after these transitions in `compiled_transitions`
+                open_batch = rx::nullopt;
+                num_barriers++;
+            }
+
+            compiled_renderpasses.push_back(pass);
+        });
+
+        // The last submission signals that the frame is done, so it has to be on the graphics queue and wait for every async compute
+        // submission
+        if(compiled_submissions.is_empty() || compiled_submissions.last().queue != rhi::QueueType::Graphics ||
+           !pending_computes.is_empty()) {
+            start_submission(rhi::QueueType::Graphics, static_cast<uint32_t>(compiled_renderpasses.size())).wait_submissions =
+                pending_computes;
+        }
+
+        rg_log(rx::log::level::k_info,
+               "Compiled %u renderpasses with %u barriers. Sharing barriers between renderpasses saved %u barriers",
+               static_cast<uint32_t>(compiled_renderpasses.size()),
+               num_barriers,
+               num_shared_barriers);
+
+        if(num_async_renderpasses > 0) {
+            rg_log(rx::log::level::k_info,
+                   "%u renderpasses run on the async compute queue, in %u submissions",
+                   num_async_renderpasses,
+                   static_cast<uint32_t>(compiled_submissions.size()));
+        }
+
+        is_compiled = true;
+    }
+
+    bool Rendergraph::can_merge(const rx::vector<Renderpass*>& subpasses,
+                                const Renderpass& renderpass,
+                                rx::memory::allocator* allocator) {
+        if(renderpass.is_builtin || renderpass.writes_to_backbuffer || renderpass.is_compute || renderpass.framebuffer == nullptr) {
+            return false;
+        }
+
+        const auto* first_framebuffer = subpasses[0]->framebuffer;
+        if(renderpass.framebuffer->size.x != first_framebuffer->size.x || renderpass.framebuffer->size.y != first_framebuffer->size.y) {
+            return false;
+        }
+
+        // Merging only pays off when the renderpass reads the merged renderpass's outputs at the pixel it's shading
+        bool reads_outputs = false;
+
+        // The subpasses share one depth texture
+        auto* depth_texture = get_depth_texture(renderpass);
+
+        bool is_compatible = true;
+        subpasses.each_fwd([&](const Renderpass* subpass) {
+            auto* subpass_depth_texture = get_depth_texture(*subpass);
+            if(depth_texture != nullptr && subpass_depth_texture != nullptr && depth_texture != subpass_depth_texture) {
+                is_compatible = false;
+                return false;
+            }
+
+            // Sampling a texture can read any pixel, which isn't ready until the merged renderpass ends
+            renderpass.read_textures.each_fwd([&](const rhi::RhiImage* texture) {
+                if(!contains(subpass->write_textures, texture)) {
+                    return true;
+                }
+
+                if(contains(renderpass.input_attachments, texture)) {
+                    reads_outputs = true;
+                } else {
+                    is_compatible = false;
+                }
+
+                return is_compatible;
+            });
+
+            // Earlier subpasses can't read anything that the renderpass writes, since there are no barriers inside a renderpass
+            renderpass.write_textures.each_fwd([&](const rhi::RhiImage* texture) {
+                if(contains(subpass->read_textures, texture)) {
+                    is_compatible = false;
+                }
+
+                return is_compatible;
+            });
+
+            return is_compatible;
+        });
+
+        if(!is_compatible || !reads_outputs) {
+            return false;
+        }
+
+        // Attachments of one renderpass are all alive at the same time, so they can't share memory
+        rx::vector<rhi::RhiImage*> images{allocator};
+        const auto add_image = [&](rhi::RhiImage* image) {
+            if(!contains(images, image)) {
+                images.push_back(image);
+            }
+        };
+
+        subpasses.each_fwd([&](const Renderpass* subpass) {
+            subpass->read_textures.each_fwd([&](rhi::RhiImage* image) { add_image(image); });
+            subpass->write_textures.each_fwd([&](rhi::RhiImage* image) { add_image(image); });
+        });
+        renderpass.read_textures.each_fwd([&](rhi::RhiImage* image) { add_image(image); });
+        renderpass.write_textures.each_fwd([&](rhi::RhiImage* image) { add_image(image); });
+
+        for(rx_size i = 0; i < images.size(); i++) {
+            for(rx_size j = i + 1; j < images.size(); j++) {
+                if(get_memory(images[i]) == get_memory(images[j])) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void Rendergraph::create_merged_renderpass(const rx::vector<Renderpass*>& subpasses) {
+        rx::vector<RenderPassCreateInfo> create_infos{allocator};
+        create_infos.reserve(subpasses.size());
+        subpasses.each_fwd([&](const Renderpass* subpass) { create_infos.push_back(renderpass_metadatas.find(subpass->name)->data); });
+
+        const auto framebuffer_size = subpasses[0]->framebuffer->size;
+
+        auto renderpass_result = device.create_merged_renderpass(create_infos, framebuffer_size, allocator);
+        if(!renderpass_result) {
+            rg_log(rx::log::level::k_error,
+                   "Could not merge renderpasses %s to %s: %s",
+                   subpasses[0]->name,
+                   subpasses.last()->name,
+                   renderpass_result.error.to_string());
+            return;
+        }
+
+        MergedRenderpass merged_renderpass;
+        merged_renderpass.renderpass = renderpass_result.value;
+        merged_renderpass.framebuffer = create_merged_framebuffer(merged_renderpass.renderpass, subpasses, framebuffer_size);
+        merged_renderpass.subpasses = subpasses;
+
+        for(uint32_t i = 0; i < subpasses.size(); i++) {
+            auto* subpass = subpasses[i];
+            subpass->merged_renderpass = merged_renderpass.renderpass;
+            subpass->merged_framebuffer = merged_renderpass.framebuffer;
+            subpass->subpass_index = i;
+            subpass->is_last_subpass = i == subpasses.size() - 1;
+        }
+
+        merged_renderpasses.push_back(merged_renderpass);
+
+        is_compiled = false;
+    }
+
+    rhi::RhiFramebuffer* Rendergraph::create_merged_framebuffer(rhi::RhiRenderpass* renderpass,
+                                                                const rx::vector<Renderpass*>& subpasses,
+                                                                const glm::uvec2& framebuffer_size) {
+        // The attachments have to be in the same order as the attachments of the RHI renderpass: the outputs and then the input
+        // attachments of each subpass, and the depth texture at the end
+        rx::vector<rhi::RhiImage*> color_attachments{allocator};
+        rx::optional<rhi::RhiImage*> depth_attachment;
+
+        const auto add_attachment = [&](rhi::RhiImage* image) {
+            if(image->is_depth_tex) {
+                depth_attachment = image;
+            } else if(!contains(color_attachments, image)) {
+                color_attachments.push_back(image);
+            }
+        };
+
+        subpasses.each_fwd([&](const Renderpass* subpass) {
+            subpass->write_textures.each_fwd([&](rhi::RhiImage* image) { add_attachment(image); });
+            subpass->input_attachments.each_fwd([&](rhi::RhiImage* image) { add_attachment(image); });
+        });
+
+        return device.create_framebuffer(renderpass, color_attachments, depth_attachment, framebuffer_size, allocator);
+    }
+
+    static bool uses_any_image(const Renderpass& renderpass, const rx::vector<rhi::RhiImage*>& images) {
+        const auto is_in_images = [&](const rhi::RhiImage* image) { return contains(images, image); };
+
+        return renderpass.write_textures.find_if(is_in_images) != rx::vector<rhi::RhiImage*>::k_npos ||
+               renderpass.input_attachments.find_if(is_in_images) != rx::vector<rhi::RhiImage*>::k_npos;
+    }
+
+    /*!
+     * \brief Gets the size of the first render target that a renderpass renders to
+     */
+    static rx::optional<glm::uvec2> get_output_size(const RenderPassCreateInfo& create_info, DeviceResources& resource_storage) {
+        const auto& texture_name = !create_info.texture_outputs.is_empty() ? create_info.texture_outputs[0].name :
+                                   create_info.depth_texture                ? create_info.depth_texture->name :
+                                                                              rx::string{};
+        if(const auto render_target = resource_storage.get_render_target(texture_name); render_target) {
+            return glm::uvec2((*render_target)->width, (*render_target)->height);
+        }
+
+        return rx::nullopt;
+    }
+
+    void Rendergraph::resize_framebuffers(const rx::vector<rhi::RhiImage*>& resized_images, DeviceResources& resource_storage) {
+        renderpass_names.each_fwd([&](const rx::string& name) {
+            auto* renderpass = *renderpasses.find(name);
+
+            if(renderpass->writes_to_backbuffer) {
+                renderpass->output_size = device.get_swapchain()->get_size();
+                return;
+            }
+
+            if(!uses_any_image(*renderpass, resized_images)) {
+                return;
+            }
+
+            const auto& create_info = renderpass_metadatas.find(name)->data;
+            if(const auto output_size = get_output_size(create_info, resource_storage); output_size) {
+                renderpass->output_size = *output_size;
+            }
+
+            if(renderpass->framebuffer == nullptr) {
+                return;
+            }
+
+            // Same attachments as in `add_renderpass`: the outputs, then the input attachments which aren't also outputs
+            rx::vector<rhi::RhiImage*> color_attachments{allocator};
+            rx::optional<rhi::RhiImage*> depth_attachment;
+            renderpass->write_textures.each_fwd([&](rhi::RhiImage* image) {
+                if(image->is_depth_tex) {
+                    depth_attachment = image;
+                } else {
+                    color_attachments.push_back(image);
+                }
+            });
+            renderpass->input_attachments.each_fwd([&](rhi::RhiImage* image) {
+                if(!contains(color_attachments, image)) {
+                    color_attachments.push_back(image);
+                }
+            });
+
+            device.destroy_framebuffer(renderpass->framebuffer, allocator);
+            renderpass->framebuffer = device.create_framebuffer(renderpass->renderpass,
+                                                                color_attachments,
+                                                                depth_attachment,
+                                                                renderpass->output_size,
+                                                                allocator);
+        });
+
+        merged_renderpasses.each_fwd([&](MergedRenderpass& merged_renderpass) {
+            const auto& subpasses = merged_renderpass.subpasses;
+            if(subpasses.find_if([&](const Renderpass* subpass) { return uses_any_image(*subpass, resized_images); }) ==
+               rx::vector<Renderpass*>::k_npos) {
+                return;
+            }
+
+            const auto framebuffer_size = subpasses[0]->output_size;
+            subpasses.each_fwd([&](const Renderpass* subpass) {
+                if(subpass->output_size != framebuffer_size) {
+                    rg_log(rx::log::level::k_error,
+                           "Subpass %s of merged renderpass %s now renders at %ux%u, but the merged renderpass renders at %ux%u. Resize all "
+                           "of a merged renderpass's render targets together",
+                           subpass->name,
+                           subpasses[0]->name,
+                           subpass->output_size.x,
+                           subpass->output_size.y,
+                           framebuffer_size.x,
+                           framebuffer_size.y);
+                }
+            });
+
+            device.destroy_framebuffer(merged_renderpass.framebuffer, allocator);
+            merged_renderpass.framebuffer = create_merged_framebuffer(merged_renderpass.renderpass, subpasses, framebuffer_size);
+
+            subpasses.each_fwd([&](Renderpass* subpass) { subpass->merged_framebuffer = merged_renderpass.framebuffer; });
+        });
+    }
+
+    void Rendergraph::split_merged_renderpasses() {
+        if(merged_renderpasses.is_empty()) {
+            return;
+        }
+
+        merged_renderpasses.each_fwd([&](const MergedRenderpass& merged_renderpass) {
+            merged_renderpass.subpasses.each_fwd([&](Renderpass* subpass) {
+                subpass->merged_renderpass = nullptr;
+                subpass->merged_framebuffer = nullptr;
+                subpass->subpass_index = 0;
+                subpass->is_last_subpass = true;
+            });
+
+            device.destroy_framebuffer(merged_renderpass.framebuffer, allocator);
+            device.destroy_renderpass(merged_renderpass.renderpass, allocator);
+        });
+
+        merged_renderpasses.clear();
+
+        is_compiled = false;
+    }
+
+    static bool uses_texture(const RenderPassCreateInfo& pass, const rx::string& texture_name) {
+        if(pass.depth_texture && pass.depth_texture->name == texture_name) {
+            return true;
+        }
+
+        return pass.texture_inputs.find(texture_name) != rx::vector<rx::string>::k_npos ||
+               pass.texture_outputs.find_if([&](const TextureAttachmentInfo& output) { return output.name == texture_name; }) !=
+                   rx::vector<TextureAttachmentInfo>::k_npos;
+    }
+
+    bool Rendergraph::can_skip_renderpass(const Renderpass& renderpass) const {
+        if(renderpass.is_builtin || renderpass.writes_to_backbuffer || renderpass.merged_renderpass != nullptr) {
+            return false;
+        }
+
+        const auto& create_info = renderpass_metadatas.find(renderpass.name)->data;
+
+        rx::vector<rx::string> cleared_textures{allocator};
+        create_info.texture_outputs.each_fwd([&](const TextureAttachmentInfo& output) {
+            if(output.clear) {
+                cleared_textures.push_back(output.name);
+            }
+        });
+        if(create_info.depth_texture && create_info.depth_texture->clear) {
+            cleared_textures.push_back(create_info.depth_texture->name);
+        }
+
+        // Other renderpasses may read a cleared texture in this frame or in the next one, so the order of the renderpasses doesn't matter
+        bool is_clear_used = false;
+        renderpass_names.each_fwd([&](const rx::string& name) {
+            if(name == renderpass.name) {
+                return true;
+            }
+
+            const auto& other_create_info = renderpass_metadatas.find(name)->data;
+            cleared_textures.each_fwd([&](const rx::string& texture_name) {
+                is_clear_used = uses_texture(other_create_info, texture_name);
+                return !is_clear_used;
+            });
+
+            return !is_clear_used;
+        });
+
+        return !is_clear_used;
+    }
+
+    void Rendergraph::record_transitions(rhi::CommandList& cmds,
+                                         const FrameContext& ctx,
+                                         const uint32_t first_transition,
+                                         const uint32_t num_transitions) const {
+        for(uint32_t i = first_transition; i < first_transition + num_transitions; i++) {
+            const auto& transition = compiled_transitions[i];
+            auto* resource = transition.resource != nullptr ? transition.resource : ctx.swapchain_image;
+
+            if(transition.previous_resource != nullptr) {
+                cmds.alias_resource(transition.previous_resource, resource);
+            } else {
+                cmds.transition_resource(resource, transition.state, rhi::QueueType::Graphics, transition.stages);
+            }
+        }
+    }
+
     Renderpass* Rendergraph::get_renderpass(const rx::string& name) const {
         if(Renderpass* const* renderpass = renderpasses.find(name)) {
             return *renderpass;
@@ -157,13 +959,17 @@ namespace nova::renderer {
     }
 
     rhi::RhiFramebuffer* Renderpass::get_framebuffer(const FrameContext& ctx) const {
-        if(!writes_to_backbuffer) {
+        if(merged_framebuffer != nullptr) {
+            return merged_framebuffer;
+        } else if(!writes_to_backbuffer) {
             return framebuffer;
         } else {
             return ctx.swapchain_framebuffer;
         }
     }
 
+    rhi::RhiRenderpass* Renderpass::get_renderpass() const { return merged_renderpass != nullptr ? merged_renderpass : renderpass; }
+
     void Renderpass::setup_renderpass(rhi::CommandList& cmds, FrameContext& ctx) {}
 
     void renderer::MaterialPass::record(rhi::CommandList& cmds, FrameContext& ctx) const {
@@ -176,70 +982,141 @@ namespace nova::renderer {
             [&](const ProceduralMeshBatch<StaticMeshRenderCommand>& batch) { record_rendering_static_mesh_batch(batch, cmds, ctx); });
     }
 
+    uint32_t renderer::MaterialPass::get_num_draws() const {
+        uint32_t num_draws = 0;
+        static_mesh_draws.each_fwd([&](const MeshBatch<StaticMeshRenderCommand>& batch) {
+            if(batch.num_visible_commands > 0) {
+                num_draws++;
+            }
+        });
+
+        static_procedural_mesh_draws.each_fwd([&](const ProceduralMeshBatch<StaticMeshRenderCommand>& batch) {
+            if(batch.num_visible_commands > 0) {
+                num_draws++;
+            }
+        });
+
+        return num_draws;
+    }
+
     void renderer::MaterialPass::record_rendering_static_mesh_batch(const MeshBatch<StaticMeshRenderCommand>& batch,
                                                                     rhi::CommandList& cmds,
                                                                     FrameContext& ctx) {
-        const uint64_t start_index = ctx.cur_model_matrix_index;
+        const uint64_t num_visible_commands = batch.num_visible_commands;
+        if(num_visible_commands == 0) {
+            return;
+        }
+
+        // Other renderpasses write model matrices at the same time, so grab all our slots at once
+        const auto first_model_matrix_index = ctx.reserve_model_matrices(num_visible_commands);
+        if(!first_model_matrix_index) {
+            return;
+        }
+
+        uint64_t model_matrix_index = *first_model_matrix_index;
 
         batch.commands.each_fwd([&](const StaticMeshRenderCommand& command) {
             if(command.is_visible) {
                 auto model_matrix_buffer = ctx.nova->get_resource_manager().get_uniform_buffer(MODEL_MATRIX_BUFFER_NAME);
                 ctx.nova->get_engine().write_data_to_buffer(&command.model_matrix,
                                                             sizeof(glm::mat4),
-                                                            ctx.cur_model_matrix_index * sizeof(glm::mat4),
+                                                            model_matrix_index * sizeof(glm::mat4),
                                                             (*model_matrix_buffer)->buffer);
-                ctx.cur_model_matrix_index++;
+                model_matrix_index++;
             }
         });
 
-        if(start_index != ctx.cur_model_matrix_index) {
-            // TODO: There's probably a better way to do this
-            rx::vector<rhi::RhiBuffer*> vertex_buffers;
-            vertex_buffers.reserve(batch.num_vertex_attributes);
-            for(uint32_t i = 0; i < batch.num_vertex_attributes; i++) {
-                vertex_buffers.push_back(batch.vertex_buffer);
-            }
-            cmds.bind_vertex_buffers(vertex_buffers);
-            cmds.bind_index_buffer(batch.index_buffer, rhi::IndexType::Uint32);
-
-            cmds.draw_indexed_mesh(batch.num_indices);
+        // TODO: There's probably a better way to do this
+        rx::vector<rhi::RhiBuffer*> vertex_buffers;
+        vertex_buffers.reserve(batch.num_vertex_attributes);
+        for(uint32_t i = 0; i < batch.num_vertex_attributes; i++) {
+            vertex_buffers.push_back(batch.vertex_buffer);
         }
+        cmds.bind_vertex_buffers(vertex_buffers);
+        cmds.bind_index_buffer(batch.index_buffer, rhi::IndexType::Uint32);
+
+        cmds.draw_indexed_mesh(batch.num_indices);
     }
 
     void renderer::MaterialPass::record_rendering_static_mesh_batch(const ProceduralMeshBatch<StaticMeshRenderCommand>& batch,
                                                                     rhi::CommandList& cmds,
                                                                     FrameContext& ctx) {
-        const uint64_t start_index = ctx.cur_model_matrix_index;
+        const uint64_t num_visible_commands = batch.num_visible_commands;
+        if(num_visible_commands == 0) {
+            return;
+        }
+
+        // Other renderpasses write model matrices at the same time, so grab all our slots at once
+        const auto first_model_matrix_index = ctx.reserve_model_matrices(num_visible_commands);
+        if(!first_model_matrix_index) {
+            return;
+        }
+
+        uint64_t model_matrix_index = *first_model_matrix_index;
 
         batch.commands.each_fwd([&](const StaticMeshRenderCommand& command) {
             if(command.is_visible) {
                 auto model_matrix_buffer = ctx.nova->get_resource_manager().get_uniform_buffer(MODEL_MATRIX_BUFFER_NAME);
                 ctx.nova->get_engine().write_data_to_buffer(&command.model_matrix,
                                                             sizeof(glm::mat4),
-                                                            ctx.cur_model_matrix_index * sizeof(glm::mat4),
+                                                            model_matrix_index * sizeof(glm::mat4),
                                                             (*model_matrix_buffer)->buffer);
-                ctx.cur_model_matrix_index++;
+                model_matrix_index++;
             }
         });
 
-        if(start_index != ctx.cur_model_matrix_index) {
-            const auto& [vertex_buffer, index_buffer] = batch.mesh->get_buffers_for_frame(ctx.frame_count % NUM_IN_FLIGHT_FRAMES);
-            // TODO: There's probably a better way to do this
-            rx::vector<rhi::RhiBuffer*> vertex_buffers;
-            vertex_buffers.reserve(7);
-            for(uint32_t i = 0; i < 7; i++) {
-                vertex_buffers.push_back(vertex_buffer);
-            }
-            cmds.bind_vertex_buffers(vertex_buffers);
-            cmds.bind_index_buffer(index_buffer, rhi::IndexType::Uint32);
+        const auto& [vertex_buffer, index_buffer] = batch.mesh->get_buffers_for_frame(ctx.frame_count % NUM_IN_FLIGHT_FRAMES);
+        // TODO: There's probably a better way to do this
+        rx::vector<rhi::RhiBuffer*> vertex_buffers;
+        vertex_buffers.reserve(7);
+        for(uint32_t i = 0; i < 7; i++) {
+            vertex_buffers.push_back(vertex_buffer);
         }
+        cmds.bind_vertex_buffers(vertex_buffers);
+        cmds.bind_index_buffer(index_buffer, rhi::IndexType::Uint32);
     }
 
     void Pipeline::record(rhi::CommandList& cmds, FrameContext& ctx) const {
-        cmds.bind_pipeline(pipeline);
+        const auto& passes = ctx.nova->get_material_passes_for_pipeline(pipeline_interface);
+
+        if(is_compute) {
+            if(passes.is_empty()) {
+                return;
+            }
+
+            cmds.bind_pipeline(pipeline);
+            passes.each_fwd([&](const renderer::MaterialPass& pass) {
+                cmds.bind_descriptor_sets(pass.descriptor_sets, pass.pipeline_interface);
+                cmds.dispatch(workgroup_count.x, workgroup_count.y, workgroup_count.z);
+            });
+
+            return;
+        }
+
+        bool is_bound = false;
+        passes.each_fwd([&](const renderer::MaterialPass& pass) {
+            if(pass.get_num_draws() == 0) {
+                return;
+            }
+
+            if(!is_bound) {
+                cmds.bind_pipeline(pipeline);
+                is_bound = true;
+            }
+
+            pass.record(cmds, ctx);
+        });
+    }
+
+    uint32_t Pipeline::get_num_draws(FrameContext& ctx) const {
+        const auto& passes = ctx.nova->get_material_passes_for_pipeline(pipeline_interface);
+        if(is_compute) {
+            return static_cast<uint32_t>(passes.size());
+        }
 
-        const auto& passes = ctx.nova->get_material_passes_for_pipeline(pipeline);
+        uint32_t num_draws = 0;
+        passes.each_fwd([&](const renderer::MaterialPass& pass) { num_draws += pass.get_num_draws(); });
 
-        passes.each_fwd([&](const renderer::MaterialPass& pass) { pass.record(cmds, ctx); });
+        return num_draws;
     }
 } // namespace nova::renderer
@@ -1,5 +1,6 @@
 #include "nova_renderer/resource_loader.hpp"
 
+#include "nova_renderer/memory/buddy_allocation_strategy.hpp"
 #include "nova_renderer/nova_renderer.hpp"
 
 using namespace nova::mem;
@@ -14,9 +15,7 @@ namespace nova::renderer {
     constexpr size_t STAGING_BUFFER_TOTAL_MEMORY_SIZE = 8388608;
 
     constexpr size_t UNIFORM_BUFFER_ALIGNMENT = 64;           // TODO: Get a real value
-    constexpr size_t UNIFORM_BUFFER_TOTAL_MEMORY_SIZE = 8096; // TODO: Get a real value
-
-    size_t size_in_bytes(PixelFormat pixel_format);
+    constexpr size_t UNIFORM_BUFFER_TOTAL_MEMORY_SIZE = 8388608;
 
     DeviceResources::DeviceResources(NovaRenderer& renderer)
         : renderer(renderer), device(renderer.get_engine()), internal_allocator(renderer.get_global_allocator()) {
@@ -52,7 +51,7 @@ namespace nova::renderer {
 
     void DeviceResources::destroy_uniform_buffer(const rx::string& name) {
         if(const BufferResource* res = uniform_buffers.find(name)) {
-            // TODO device.destroy_buffer(res->buffer);
+            device.destroy_buffer(res->buffer, internal_allocator);
         }
         uniform_buffers.erase(name);
     }
@@ -90,34 +89,9 @@ namespace nova::renderer {
             CommandList* cmds = device.create_command_list(0, QueueType::Transfer, CommandList::Level::Primary, allocator);
             cmds->set_debug_name(rx::string::format("UploadTo%s", name));
 
-            RhiResourceBarrier initial_texture_barrier = {};
-            initial_texture_barrier.resource_to_barrier = resource.image;
-            initial_texture_barrier.access_before_barrier = ResourceAccess::CopyRead;
-            initial_texture_barrier.access_after_barrier = ResourceAccess::CopyWrite;
-            initial_texture_barrier.old_state = ResourceState::Undefined;
-            initial_texture_barrier.new_state = ResourceState::CopyDestination;
-            initial_texture_barrier.source_queue = QueueType::Transfer;
-            initial_texture_barrier.destination_queue = QueueType::Transfer;
-            initial_texture_barrier.image_memory_barrier.aspect = ImageAspect::Color;
-
-            rx::vector<RhiResourceBarrier> initial_barriers{allocator};
-            initial_barriers.push_back(initial_texture_barrier);
-            cmds->resource_barriers(PipelineStage::Transfer, PipelineStage::Transfer, initial_barriers);
+            cmds->transition_resource(resource.image, ResourceState::CopyDestination, QueueType::Transfer);
             cmds->upload_data_to_image(resource.image, width, height, pixel_size, staging_buffer, data);
-
-            RhiResourceBarrier final_texture_barrier = {};
-            final_texture_barrier.resource_to_barrier = resource.image;
-            final_texture_barrier.access_before_barrier = ResourceAccess::CopyWrite;
-            final_texture_barrier.access_after_barrier = ResourceAccess::ShaderRead;
-            final_texture_barrier.old_state = ResourceState::CopyDestination;
-            final_texture_barrier.new_state = ResourceState::ShaderRead;
-            final_texture_barrier.source_queue = QueueType::Transfer;
-            final_texture_barrier.destination_queue = QueueType::Graphics;
-            final_texture_barrier.image_memory_barrier.aspect = ImageAspect::Color;
-
-            rx::vector<RhiResourceBarrier> final_barriers{allocator};
-            final_barriers.push_back(final_texture_barrier);
-            cmds->resource_barriers(PipelineStage::Transfer, PipelineStage::VertexShader, final_barriers);
+            cmds->transition_resource(resource.image, ResourceState::ShaderRead);
 
             RhiFence* upload_done_fence = device.create_fence(false, allocator);
             device.submit_command_list(cmds, QueueType::Transfer, upload_done_fence);
@@ -158,7 +132,8 @@ namespace nova::renderer {
                                                                                 const size_t height,
                                                                                 const PixelFormat pixel_format,
                                                                                 rx::memory::allocator* allocator,
-                                                                                const bool /* can_be_sampled // Not yet supported */) {
+                                                                                const bool /* can_be_sampled // Not yet supported */,
+                                                                                RhiImage* aliased_image) {
         renderpack::TextureCreateInfo create_info;
         create_info.name = name;
         create_info.usage = ImageUsage::RenderTarget;
@@ -167,7 +142,8 @@ namespace nova::renderer {
         create_info.format.width = static_cast<float>(width);
         create_info.format.height = static_cast<float>(height);
 
-        auto* image = device.create_image(create_info, allocator);
+        auto* image = aliased_image != nullptr ? device.create_aliased_image(create_info, aliased_image, allocator) :
+                                                 device.create_image(create_info, allocator);
         if(image) {
             // Barrier it into the correct format and return it
 
@@ -180,48 +156,7 @@ namespace nova::renderer {
             resource.width = width;
             resource.image = image;
 
-            {
-                CommandList* cmds = device.create_command_list(0, QueueType::Graphics, CommandList::Level::Primary, allocator);
-                cmds->set_debug_name(rx::string::format("ChangeFormatOf%s", name));
-
-                RhiResourceBarrier initial_texture_barrier = {};
-                initial_texture_barrier.resource_to_barrier = resource.image;
-                initial_texture_barrier.old_state = ResourceState::Undefined;
-                initial_texture_barrier.source_queue = QueueType::Graphics;
-                initial_texture_barrier.destination_queue = QueueType::Graphics;
-
-                PipelineStage stage_after_barrier;
-
-                if(is_depth_format(pixel_format)) {
-                    initial_texture_barrier.image_memory_barrier.aspect = ImageAspect::Depth;
-                    initial_texture_barrier.new_state = ResourceState::DepthWrite;
-                    initial_texture_barrier.access_before_barrier = ResourceAccess::MemoryWrite;
-                    initial_texture_barrier.access_after_barrier = ResourceAccess::DepthStencilAttachmentRead;
-
-                    stage_after_barrier = PipelineStage::EarlyFragmentTests;
-
-                } else {
-                    initial_texture_barrier.image_memory_barrier.aspect = ImageAspect::Color;
-                    initial_texture_barrier.new_state = ResourceState::RenderTarget;
-                    initial_texture_barrier.access_before_barrier = ResourceAccess::MemoryWrite;
-                    initial_texture_barrier.access_after_barrier = ResourceAccess::ColorAttachmentRead;
-
-                    stage_after_barrier = PipelineStage::ColorAttachmentOutput;
-                }
-
-                rx::vector<RhiResourceBarrier> initial_barriers{allocator};
-                initial_barriers.push_back(initial_texture_barrier);
-                cmds->resource_barriers(PipelineStage::TopOfPipe, stage_after_barrier, initial_barriers);
-
-                RhiFence* upload_done_fence = device.create_fence(false, allocator);
-                device.submit_command_list(cmds, QueueType::Graphics, upload_done_fence);
-
-                // Be sure that the data copy is complete, so that this method doesn't return before the GPU is done with the staging buffer
-                rx::vector<RhiFence*> upload_done_fences{allocator};
-                upload_done_fences.push_back(upload_done_fence);
-                device.wait_for_fences(upload_done_fences);
-                device.destroy_fences(upload_done_fences, allocator);
-            }
+            transition_to_render_target_state(resource, allocator);
 
             render_targets.insert(name, resource);
 
@@ -233,6 +168,37 @@ namespace nova::renderer {
         }
     }
 
+    bool DeviceResources::resize_render_target(const rx::string& name,
+                                               const rx_size width,
+                                               const rx_size height,
+                                               rx::memory::allocator* allocator) {
+        auto* resource = render_targets.find(name);
+        if(resource == nullptr) {
+            logger(rx::log::level::k_error, "Could not resize render target %s because it doesn't exist", name);
+            return false;
+        }
+
+        renderpack::TextureCreateInfo create_info;
+        create_info.name = name;
+        create_info.usage = ImageUsage::RenderTarget;
+        create_info.format.pixel_format = resource->format;
+        create_info.format.dimension_type = TextureDimensionType::Absolute;
+        create_info.format.width = static_cast<float>(width);
+        create_info.format.height = static_cast<float>(height);
+
+        if(!device.recreate_image(resource->image, create_info, resource->image->aliased_image, allocator)) {
+            logger(rx::log::level::k_error, "Could not resize render target %s to %zux%zu", name, width, height);
+            return false;
+        }
+
+        resource->width = width;
+        resource->height = height;
+
+        transition_to_render_target_state(*resource, allocator);
+
+        return true;
+    }
+
     rx::optional<TextureResourceAccessor> DeviceResources::get_render_target(const rx::string& name) {
         if(render_targets.find(name) != nullptr) {
             return TextureResourceAccessor{&render_targets, name};
@@ -254,6 +220,23 @@ namespace nova::renderer {
 #endif
     }
 
+    void DeviceResources::transition_to_render_target_state(const TextureResource& resource, rx::memory::allocator* allocator) {
+        CommandList* cmds = device.create_command_list(0, QueueType::Graphics, CommandList::Level::Primary, allocator);
+        cmds->set_debug_name(rx::string::format("ChangeFormatOf%s", resource.name));
+
+        cmds->transition_resource(resource.image,
+                                  is_depth_format(resource.format) ? ResourceState::DepthWrite : ResourceState::RenderTarget);
+
+        RhiFence* transition_done_fence = device.create_fence(false, allocator);
+        device.submit_command_list(cmds, QueueType::Graphics, transition_done_fence);
+
+        // Be sure that the transition is complete, so that the render target is ready to use as soon as the caller gets it
+        rx::vector<RhiFence*> transition_done_fences{allocator};
+        transition_done_fences.push_back(transition_done_fence);
+        device.wait_for_fences(transition_done_fences);
+        device.destroy_fences(transition_done_fences, allocator);
+    }
+
     void DeviceResources::allocate_staging_buffer_memory() {
         RhiDeviceMemory* memory = device
                                    .allocate_device_memory(STAGING_BUFFER_TOTAL_MEMORY_SIZE,
@@ -262,7 +245,8 @@ namespace nova::renderer {
                                                            internal_allocator)
                                    .value;
 
-        auto* strat = internal_allocator->create<BlockAllocationStrategy>(renderer.get_global_allocator(),
+        // Staging buffers are binned by power-of-two sizes, which are exactly the sizes of a buddy allocator's blocks
+        auto* strat = internal_allocator->create<BuddyAllocationStrategy>(renderer.get_global_allocator(),
                                                                           Bytes(STAGING_BUFFER_TOTAL_MEMORY_SIZE),
                                                                           STAGING_BUFFER_ALIGNMENT);
 
@@ -271,7 +255,7 @@ namespace nova::renderer {
 
     void DeviceResources::allocate_uniform_buffer_memory() {
         RhiDeviceMemory* memory = device
-                                   .allocate_device_memory(STAGING_BUFFER_TOTAL_MEMORY_SIZE,
+                                   .allocate_device_memory(UNIFORM_BUFFER_TOTAL_MEMORY_SIZE,
                                                            MemoryUsage::LowFrequencyUpload,
                                                            ObjectType::Buffer,
                                                            internal_allocator)
@@ -285,17 +269,17 @@ namespace nova::renderer {
     }
 
     RhiBuffer* DeviceResources::get_staging_buffer_with_size(const Bytes size) {
-        // Align the size so we can bin the staging buffers
-        // TODO: Experiment and find a good alignment
-        const auto a = size.b_count() % STAGING_BUFFER_ALIGNMENT;
-        const auto needed_size = STAGING_BUFFER_ALIGNMENT + a;
-        const auto actual_size = size.b_count() + needed_size;
+        // Round the size up to a power of two so we can bin the staging buffers
+        size_t actual_size = STAGING_BUFFER_ALIGNMENT;
+        while(actual_size < size.b_count()) {
+            actual_size *= 2;
+        }
 
         if(auto* staging_buffer = staging_buffers.find(actual_size); staging_buffer != nullptr) {
             auto& buffer_list = *staging_buffer;
             if(buffer_list.size() > 0) {
                 auto* buffer = buffer_list.last();
-                buffer_list.erase(buffer_list.size() - 1, buffer_list.size() - 1);
+                buffer_list.erase(buffer_list.size() - 1, buffer_list.size());
 
                 return buffer;
             }
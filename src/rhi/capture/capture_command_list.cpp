@@ -0,0 +1,274 @@
+#include "capture_command_list.hpp"
+
+#include <string.h>
+
+#include "capture_render_device.hpp"
+
+namespace nova::renderer::rhi {
+    CaptureCommandList::CaptureCommandList(CommandList* inner_list,
+                                           rx::vector<rx_byte>&& stream,
+                                           const uint32_t renderpass_id,
+                                           const uint32_t framebuffer_id,
+                                           const uint32_t subpass,
+                                           CaptureRenderDevice* render_device,
+                                           rx::memory::allocator* allocator)
+        : CommandList(allocator),
+          inner_list(inner_list),
+          render_device(*render_device),
+          allocator(allocator),
+          renderpass_id(renderpass_id),
+          framebuffer_id(framebuffer_id),
+          subpass(subpass),
+          stream(rx::utility::move(stream)) {}
+
+    void CaptureCommandList::set_debug_name(const rx::string& name) { inner_list->set_debug_name(name); }
+
+    void CaptureCommandList::resource_barriers(const PipelineStage stages_before_barrier,
+                                               const PipelineStage stages_after_barrier,
+                                               const rx::vector<RhiResourceBarrier>& barriers) {
+        const HeadlessResourceBarriersCommand command{stages_before_barrier,
+                                                      stages_after_barrier,
+                                                      static_cast<uint32_t>(barriers.size())};
+
+        write_header(HeadlessCommandType::ResourceBarriers, sizeof(command) + sizeof(HeadlessBarrier) * barriers.size());
+        write_bytes(&command, sizeof(command));
+
+        barriers.each_fwd([&](const RhiResourceBarrier& barrier) {
+            HeadlessBarrier captured_barrier = {};
+            captured_barrier.resource = render_device.get_object_id(barrier.resource_to_barrier);
+            captured_barrier.access_before_barrier = barrier.access_before_barrier;
+            captured_barrier.access_after_barrier = barrier.access_after_barrier;
+            captured_barrier.old_state = barrier.old_state;
+            captured_barrier.new_state = barrier.new_state;
+            captured_barrier.source_queue = barrier.source_queue;
+            captured_barrier.destination_queue = barrier.destination_queue;
+
+            if(barrier.resource_to_barrier->type == ResourceType::Image) {
+                captured_barrier.aspect = barrier.image_memory_barrier.aspect;
+
+            } else {
+                captured_barrier.offset = barrier.buffer_memory_barrier.offset.b_count();
+                captured_barrier.size = barrier.buffer_memory_barrier.size.b_count();
+            }
+
+            write_bytes(&captured_barrier, sizeof(captured_barrier));
+        });
+
+        inner_list->resource_barriers(stages_before_barrier, stages_after_barrier, barriers);
+    }
+
+    void CaptureCommandList::copy_buffer(RhiBuffer* destination_buffer,
+                                         const mem::Bytes destination_offset,
+                                         RhiBuffer* source_buffer,
+                                         const mem::Bytes source_offset,
+                                         const mem::Bytes num_bytes) {
+        flush_barriers();
+
+        const HeadlessCopyBufferCommand command{render_device.get_object_id(destination_buffer),
+                                                render_device.get_object_id(source_buffer),
+                                                destination_offset.b_count(),
+                                                source_offset.b_count(),
+                                                num_bytes.b_count()};
+        record(HeadlessCommandType::CopyBuffer, command);
+
+        inner_list->copy_buffer(destination_buffer, destination_offset, source_buffer, source_offset, num_bytes);
+    }
+
+    void CaptureCommandList::execute_command_lists(const rx::vector<CommandList*>& lists) {
+        flush_barriers();
+
+        rx_size total_size = sizeof(HeadlessExecuteCommandListsCommand);
+        lists.each_fwd([&](const CommandList* list) {
+            const auto* capture_list = static_cast<const CaptureCommandList*>(list);
+            total_size += sizeof(HeadlessSecondaryCommandListHeader) + capture_list->get_stream().size();
+        });
+
+        const HeadlessExecuteCommandListsCommand command{static_cast<uint32_t>(lists.size())};
+        write_header(HeadlessCommandType::ExecuteCommandLists, total_size);
+        write_bytes(&command, sizeof(command));
+
+        rx::vector<CommandList*> inner_lists{allocator};
+        inner_lists.reserve(lists.size());
+
+        lists.each_fwd([&](CommandList* list) {
+            auto* capture_list = static_cast<CaptureCommandList*>(list);
+            const auto& secondary_stream = capture_list->get_stream();
+
+            const HeadlessSecondaryCommandListHeader secondary_header{secondary_stream.size(),
+                                                                      capture_list->renderpass_id,
+                                                                      capture_list->framebuffer_id,
+                                                                      capture_list->subpass};
+            write_bytes(&secondary_header, sizeof(secondary_header));
+            write_bytes(secondary_stream.data(), secondary_stream.size());
+
+            num_commands += capture_list->get_num_commands();
+
+            render_device.recycle_stream(capture_list->release_stream());
+
+            inner_lists.push_back(capture_list->get_inner_list());
+        });
+
+        inner_list->execute_command_lists(inner_lists);
+    }
+
+    void CaptureCommandList::begin_renderpass(RhiRenderpass* renderpass, RhiFramebuffer* framebuffer, const RenderpassContents contents) {
+        flush_barriers();
+
+        const HeadlessBeginRenderpassCommand command{render_device.get_object_id(renderpass),
+                                                     render_device.get_object_id(framebuffer),
+                                                     contents};
+        record(HeadlessCommandType::BeginRenderpass, command);
+
+        inner_list->begin_renderpass(renderpass, framebuffer, contents);
+    }
+
+    void CaptureCommandList::next_subpass(const RenderpassContents contents) {
+        const HeadlessNextSubpassCommand command{contents};
+        record(HeadlessCommandType::NextSubpass, command);
+
+        inner_list->next_subpass(contents);
+    }
+
+    void CaptureCommandList::end_renderpass() {
+        write_header(HeadlessCommandType::EndRenderpass, 0);
+
+        inner_list->end_renderpass();
+    }
+
+    void CaptureCommandList::bind_pipeline(const RhiPipeline* pipeline) {
+        const HeadlessBindPipelineCommand command{render_device.get_object_id(pipeline)};
+        record(HeadlessCommandType::BindPipeline, command);
+
+        inner_list->bind_pipeline(pipeline);
+    }
+
+    void CaptureCommandList::bind_descriptor_sets(const rx::vector<RhiDescriptorSet*>& descriptor_sets,
+                                                  const RhiPipelineInterface* pipeline_interface) {
+        const HeadlessBindDescriptorSetsCommand command{render_device.get_object_id(pipeline_interface),
+                                                        static_cast<uint32_t>(descriptor_sets.size())};
+
+        write_header(HeadlessCommandType::BindDescriptorSets, sizeof(command) + sizeof(uint32_t) * descriptor_sets.size());
+        write_bytes(&command, sizeof(command));
+
+        descriptor_sets.each_fwd([&](const RhiDescriptorSet* set) {
+            const uint32_t id = render_device.get_object_id(set);
+            write_bytes(&id, sizeof(id));
+        });
+
+        inner_list->bind_descriptor_sets(descriptor_sets, pipeline_interface);
+    }
+
+    void CaptureCommandList::bind_vertex_buffers(const rx::vector<RhiBuffer*>& buffers) {
+        const HeadlessBindVertexBuffersCommand command{static_cast<uint32_t>(buffers.size())};
+
+        write_header(HeadlessCommandType::BindVertexBuffers, sizeof(command) + sizeof(uint32_t) * buffers.size());
+        write_bytes(&command, sizeof(command));
+
+        buffers.each_fwd([&](const RhiBuffer* buffer) {
+            const uint32_t id = render_device.get_object_id(buffer);
+            write_bytes(&id, sizeof(id));
+        });
+
+        inner_list->bind_vertex_buffers(buffers);
+    }
+
+    void CaptureCommandList::bind_index_buffer(const RhiBuffer* buffer, const IndexType index_type) {
+        const HeadlessBindIndexBufferCommand command{render_device.get_object_id(buffer), index_type};
+        record(HeadlessCommandType::BindIndexBuffer, command);
+
+        inner_list->bind_index_buffer(buffer, index_type);
+    }
+
+    void CaptureCommandList::draw_indexed_mesh(const uint32_t num_indices, const uint32_t offset, const uint32_t num_instances) {
+        const HeadlessDrawIndexedMeshCommand command{num_indices, offset, num_instances};
+        record(HeadlessCommandType::DrawIndexedMesh, command);
+
+        inner_list->draw_indexed_mesh(num_indices, offset, num_instances);
+    }
+
+    void CaptureCommandList::set_scissor_rect(const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height) {
+        const HeadlessSetScissorRectCommand command{x, y, width, height};
+        record(HeadlessCommandType::SetScissorRect, command);
+
+        inner_list->set_scissor_rect(x, y, width, height);
+    }
+
+    void CaptureCommandList::set_viewport(const float x, const float y, const float width, const float height) {
+        const HeadlessSetViewportCommand command{x, y, width, height};
+        record(HeadlessCommandType::SetViewport, command);
+
+        inner_list->set_viewport(x, y, width, height);
+    }
+
+    void CaptureCommandList::dispatch(const uint32_t num_groups_x, const uint32_t num_groups_y, const uint32_t num_groups_z) {
+        flush_barriers();
+
+        const HeadlessDispatchCommand command{num_groups_x, num_groups_y, num_groups_z};
+        record(HeadlessCommandType::Dispatch, command);
+
+        inner_list->dispatch(num_groups_x, num_groups_y, num_groups_z);
+    }
+
+    void CaptureCommandList::dispatch_indirect(const RhiBuffer* buffer, const mem::Bytes offset) {
+        flush_barriers();
+
+        const HeadlessDispatchIndirectCommand command{offset.b_count(), render_device.get_object_id(buffer)};
+        record(HeadlessCommandType::DispatchIndirect, command);
+
+        inner_list->dispatch_indirect(buffer, offset);
+    }
+
+    void CaptureCommandList::reset_queries(RhiQueryPool* pool, const uint32_t first_query, const uint32_t num_queries) {
+        // Query pools aren't captured, so the queries are only forwarded
+        inner_list->reset_queries(pool, first_query, num_queries);
+    }
+
+    void CaptureCommandList::write_timestamp(RhiQueryPool* pool, const uint32_t query_idx, const PipelineStage stage) {
+        inner_list->write_timestamp(pool, query_idx, stage);
+    }
+
+    void CaptureCommandList::upload_data_to_image(
+        RhiImage* image, const size_t width, const size_t height, const size_t bytes_per_pixel, RhiBuffer* staging_buffer, const void* data) {
+        flush_barriers();
+
+        const HeadlessUploadDataToImageCommand command{render_device.get_object_id(image),
+                                                       render_device.get_object_id(staging_buffer),
+                                                       width,
+                                                       height,
+                                                       bytes_per_pixel};
+
+        // The texel data goes in the stream too, since it's gone by the time anyone replays the capture
+        const rx_size num_data_bytes = width * height * bytes_per_pixel;
+
+        write_header(HeadlessCommandType::UploadDataToImage, sizeof(command) + num_data_bytes);
+        write_bytes(&command, sizeof(command));
+        write_bytes(data, num_data_bytes);
+
+        inner_list->upload_data_to_image(image, width, height, bytes_per_pixel, staging_buffer, data);
+    }
+
+    CommandList* CaptureCommandList::get_inner_list() const { return inner_list; }
+
+    uint32_t CaptureCommandList::get_num_commands() const { return num_commands; }
+
+    const rx::vector<rx_byte>& CaptureCommandList::get_stream() const { return stream; }
+
+    rx::vector<rx_byte> CaptureCommandList::release_stream() { return rx::utility::move(stream); }
+
+    void CaptureCommandList::write_header(const HeadlessCommandType type, const rx_size size) {
+        const HeadlessCommandHeader header{type, static_cast<uint32_t>(size)};
+        write_bytes(&header, sizeof(header));
+
+        num_commands++;
+    }
+
+    void CaptureCommandList::write_bytes(const void* data, const rx_size size) {
+        if(size == 0) {
+            return;
+        }
+
+        const rx_size old_size = stream.size();
+        stream.resize(old_size + size, rx::utility::uninitialized{});
+        memcpy(stream.data() + old_size, data, size);
+    }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "nova_renderer/rhi/command_list.hpp"
+
+#include "../headless/headless_command_list.hpp"
+
+namespace nova::renderer::rhi {
+    class CaptureRenderDevice;
+
+    /*!
+     * \brief Command list which forwards every command to a command list from another render device, and records each command into a
+     * command stream for the capture file
+     *
+     * The stream has the same layout as a headless command stream. Objects are referred to by their capture IDs
+     */
+    class CaptureCommandList final : public CommandList {
+    public:
+        /*!
+         * \param renderpass_id The capture ID of the renderpass that a secondary command list will be executed in, or 0
+         * \param framebuffer_id The capture ID of the framebuffer that a secondary command list will be executed with, or 0
+         * \param subpass The subpass of the renderpass that a secondary command list will be executed in
+         */
+        CaptureCommandList(CommandList* inner_list,
+                           rx::vector<rx_byte>&& stream,
+                           uint32_t renderpass_id,
+                           uint32_t framebuffer_id,
+                           uint32_t subpass,
+                           CaptureRenderDevice* render_device,
+                           rx::memory::allocator* allocator);
+
+        ~CaptureCommandList() override = default;
+
+        void set_debug_name(const rx::string& name) override;
+
+        void resource_barriers(PipelineStage stages_before_barrier,
+                               PipelineStage stages_after_barrier,
+                               const rx::vector<RhiResourceBarrier>& barriers) override;
+
+        void copy_buffer(RhiBuffer* destination_buffer,
+                         mem::Bytes destination_offset,
+                         RhiBuffer* source_buffer,
+                         mem::Bytes source_offset,
+                         mem::Bytes num_bytes) override;
+
+        void execute_command_lists(const rx::vector<CommandList*>& lists) override;
+
+        void begin_renderpass(RhiRenderpass* renderpass,
+                              RhiFramebuffer* framebuffer,
+                              RenderpassContents contents = RenderpassContents::Inline) override;
+
+        void next_subpass(RenderpassContents contents = RenderpassContents::Inline) override;
+
+        void end_renderpass() override;
+
+        void bind_pipeline(const RhiPipeline* pipeline) override;
+
+        void bind_descriptor_sets(const rx::vector<RhiDescriptorSet*>& descriptor_sets,
+                                  const RhiPipelineInterface* pipeline_interface) override;
+
+        void bind_vertex_buffers(const rx::vector<RhiBuffer*>& buffers) override;
+
+        void bind_index_buffer(const RhiBuffer* buffer, IndexType index_type) override;
+
+        void draw_indexed_mesh(uint32_t num_indices, uint32_t offset, uint32_t num_instances) override;
+
+        void set_scissor_rect(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
+
+        void set_viewport(float x, float y, float width, float height) override;
+
+        void dispatch(uint32_t num_groups_x, uint32_t num_groups_y, uint32_t num_groups_z) override;
+
+        void dispatch_indirect(const RhiBuffer* buffer, mem::Bytes offset) override;
+
+        void reset_queries(RhiQueryPool* pool, uint32_t first_query, uint32_t num_queries) override;
+
+        void write_timestamp(RhiQueryPool* pool, uint32_t query_idx, PipelineStage stage) override;
+
+        void upload_data_to_image(
+            RhiImage* image, size_t width, size_t height, size_t bytes_per_pixel, RhiBuffer* staging_buffer, const void* data) override;
+
+        /*!
+         * \brief Gets the command list that all commands are forwarded to
+         */
+        [[nodiscard]] CommandList* get_inner_list() const;
+
+        [[nodiscard]] uint32_t get_num_commands() const;
+
+        [[nodiscard]] const rx::vector<rx_byte>& get_stream() const;
+
+        /*!
+         * \brief Takes the command stream out of this command list. The command list may not be recorded into afterwards
+         */
+        [[nodiscard]] rx::vector<rx_byte> release_stream();
+
+    private:
+        CommandList* inner_list;
+
+        CaptureRenderDevice& render_device;
+
+        rx::memory::allocator* allocator;
+
+        uint32_t renderpass_id;
+
+        uint32_t framebuffer_id;
+
+        uint32_t subpass;
+
+        uint32_t num_commands = 0;
+
+        rx::vector<rx_byte> stream;
+
+        void write_header(HeadlessCommandType type, rx_size size);
+
+        void write_bytes(const void* data, rx_size size);
+
+        template <typename CommandType>
+        void record(HeadlessCommandType type, const CommandType& command);
+    };
+
+    template <typename CommandType>
+    void CaptureCommandList::record(const HeadlessCommandType type, const CommandType& command) {
+        write_header(type, sizeof(CommandType));
+        write_bytes(&command, sizeof(CommandType));
+    }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <stdint.h>
+
+/*!
+ * \file capture_format.hpp
+ *
+ * \brief Layout of a Nova frame capture file
+ *
+ * A capture file starts with a CaptureFileHeader, then has a sequence of records. Each record is a CaptureRecordHeader followed by
+ * `size` bytes of record data, written with a CaptureWriter
+ *
+ * Objects are referred to by capture IDs, never by pointer. ID 0 means "no object"
+ *
+ * Command lists are stored in the same command stream layout that HeadlessCommandList uses, with one addition: an UploadDataToImage
+ * command is followed by the texel data that was uploaded, so that the upload can be replayed
+ */
+
+namespace nova::renderer::rhi {
+    constexpr uint32_t CAPTURE_FILE_MAGIC = 0x50414356; // "VCAP"
+
+    constexpr uint32_t CAPTURE_FILE_VERSION = 9;
+
+    struct CaptureFileHeader {
+        uint32_t magic = CAPTURE_FILE_MAGIC;
+        uint32_t version = CAPTURE_FILE_VERSION;
+
+        /*!
+         * \brief Size of the swapchain that the capture was made with
+         */
+        uint32_t swapchain_width = 0;
+        uint32_t swapchain_height = 0;
+
+        uint32_t num_swapchain_images = 0;
+    };
+
+    enum class CaptureRecordType : uint32_t {
+        /*!
+         * \brief uint32 image index, uint32 image ID, uint32 framebuffer ID, uint32 fence ID
+         */
+        SwapchainImage,
+
+        /*!
+         * \brief uint32 num_renderpasses
+         */
+        SetNumRenderpasses,
+
+        /*!
+         * \brief uint32 ID, uint64 size, MemoryUsage, ObjectType
+         */
+        AllocateDeviceMemory,
+
+        /*!
+         * \brief uint32 ID, uint32 width, uint32 height, RenderPassCreateInfo
+         */
+        CreateRenderpass,
+
+        /*!
+         * \brief uint32 ID, uint32 width, uint32 height, uint32 number of subpasses, one RenderPassCreateInfo per subpass
+         */
+        CreateMergedRenderpass,
+
+        /*!
+         * \brief uint32 ID, uint32 renderpass ID, uint32 width, uint32 height, uint32 array of color attachment IDs, uint32 depth
+         * attachment ID
+         */
+        CreateFramebuffer,
+
+        /*!
+         * \brief uint32 ID, resource bindings, color attachments, optional depth attachment
+         */
+        CreatePipelineInterface,
+
+        /*!
+         * \brief uint32 ID, array of (DescriptorType, uint32 capacity) pairs
+         */
+        CreateDescriptorPool,
+
+        /*!
+         * \brief uint32 pipeline interface ID, uint32 pool ID, uint32 array of descriptor set IDs
+         */
+        CreateDescriptorSets,
+
+        /*!
+         * \brief Array of descriptor set writes
+         */
+        UpdateDescriptorSets,
+
+        /*!
+         * \brief uint32 pool ID
+         */
+        ResetDescriptorPool,
+
+        /*!
+         * \brief uint32 ID, uint32 pipeline interface ID, PipelineStateCreateInfo, uint32 renderpass ID, uint32 subpass index
+         */
+        CreatePipeline,
+
+        /*!
+         * \brief uint32 ID, uint32 pipeline interface ID, ComputePipelineCreateInfo
+         */
+        CreateComputePipeline,
+
+        /*!
+         * \brief uint32 ID, uint32 device memory ID, RhiBufferCreateInfo
+         */
+        CreateBuffer,
+
+        /*!
+         * \brief uint32 buffer ID, uint64 offset, byte array of data
+         */
+        WriteDataToBuffer,
+
+        /*!
+         * \brief uint32 ID, RhiSamplerCreateInfo
+         */
+        CreateSampler,
+
+        /*!
+         * \brief uint32 ID, TextureCreateInfo
+         */
+        CreateImage,
+
+        /*!
+         * \brief uint32 ID
+         */
+        CreateSemaphore,
+
+        /*!
+         * \brief uint32 ID, bool signaled
+         */
+        CreateFence,
+
+        /*!
+         * \brief uint32 array of fence IDs
+         */
+        WaitForFences,
+
+        /*!
+         * \brief uint32 array of fence IDs
+         */
+        ResetFences,
+
+        /*!
+         * \brief uint32 ID
+         */
+        DestroyRenderpass,
+        DestroyFramebuffer,
+        DestroyPipelineInterface,
+        DestroyPipeline,
+        DestroyTexture,
+        DestroySemaphore,
+        DestroyFence,
+        DestroyBuffer,
+
+        /*!
+         * \brief QueueType, uint32 fence ID, uint32 array of wait semaphore IDs, uint32 array of signal semaphore IDs, uint32 number of
+         * commands, byte array of the command stream
+         */
+        SubmitCommandList,
+
+        /*!
+         * \brief uint32 index of the swapchain image that was acquired, uint32 ID of the semaphore that the acquire signals, or 0 if the
+         * acquire blocked until the image was ready
+         */
+        AcquireSwapchainImage,
+
+        /*!
+         * \brief uint32 index of the swapchain image that was presented, uint32 ID of the semaphore that the present waits for, or 0 if
+         * it didn't wait for a semaphore. Marks the end of a frame
+         */
+        Present,
+
+        /*!
+         * \brief uint32 frame index
+         */
+        BeginFrame,
+    };
+
+    struct CaptureRecordHeader {
+        CaptureRecordType type;
+        uint32_t size;
+    };
+} // namespace nova::renderer::rhi
@@ -0,0 +1,718 @@
+#include "capture_render_device.hpp"
+
+#include <rx/core/log.h>
+
+#include "nova_renderer/rhi/device_memory_resource.hpp"
+
+#include "capture_swapchain.hpp"
+
+using namespace nova::mem;
+
+namespace nova::renderer::rhi {
+    RX_LOG("CaptureRenderDevice", logger);
+
+    CaptureRenderDevice::CaptureRenderDevice(std::unique_ptr<RenderDevice> inner_device,
+                                             NovaSettingsAccessManager& settings,
+                                             NovaWindow& window,
+                                             rx::memory::allocator* allocator)
+        : RenderDevice{settings, window, allocator},
+          inner_device(std::move(inner_device)),
+          object_ids{internal_allocator},
+          capture_file{internal_allocator},
+          record_writer{internal_allocator},
+          free_streams{internal_allocator} {
+        info = this->inner_device->info;
+
+        const auto& capture_settings = settings->capture;
+        num_frames_to_capture = capture_settings.num_frames;
+
+        capture_file = rx::filesystem::file{internal_allocator, capture_settings.file_path, "wb"};
+        if(!capture_file) {
+            logger(rx::log::level::k_error, "Could not open capture file %s. Nothing will be captured", capture_settings.file_path);
+
+        } else {
+            capturing = true;
+        }
+
+        create_swapchain();
+
+        logger(rx::log::level::k_info, "Capturing %u frames to %s", num_frames_to_capture, capture_settings.file_path);
+    }
+
+    CaptureRenderDevice::~CaptureRenderDevice() {
+        {
+            rx::concurrency::scope_lock l(capture_mutex);
+            if(capturing) {
+                logger(rx::log::level::k_warning,
+                       "Nova shut down after capturing only %u of %u frames",
+                       num_captured_frames,
+                       num_frames_to_capture);
+                finish_capture();
+            }
+        }
+
+        internal_allocator->destroy<CaptureSwapchain>(swapchain);
+    }
+
+    void CaptureRenderDevice::set_num_renderpasses(const uint32_t num_renderpasses) {
+        write_record(CaptureRecordType::SetNumRenderpasses, [&](CaptureWriter& writer) { writer.write(num_renderpasses); });
+
+        inner_device->set_num_renderpasses(num_renderpasses);
+    }
+
+    ntl::Result<RhiDeviceMemory*> CaptureRenderDevice::allocate_device_memory(const Bytes size,
+                                                                           const MemoryUsage usage,
+                                                                           const ObjectType allowed_objects,
+                                                                           rx::memory::allocator* allocator) {
+        return inner_device->allocate_device_memory(size, usage, allowed_objects, allocator).map([&](RhiDeviceMemory* memory) {
+            const auto id = register_object(memory);
+            write_record(CaptureRecordType::AllocateDeviceMemory, [&](CaptureWriter& writer) {
+                writer.write(id);
+                writer.write(static_cast<uint64_t>(size.b_count()));
+                writer.write(usage);
+                writer.write(allowed_objects);
+            });
+
+            return memory;
+        });
+    }
+
+    ntl::Result<RhiRenderpass*> CaptureRenderDevice::create_renderpass(const renderpack::RenderPassCreateInfo& data,
+                                                                    const glm::uvec2& framebuffer_size,
+                                                                    rx::memory::allocator* allocator) {
+        return inner_device->create_renderpass(data, framebuffer_size, allocator).map([&](RhiRenderpass* renderpass) {
+            const auto id = register_object(renderpass);
+            write_record(CaptureRecordType::CreateRenderpass, [&](CaptureWriter& writer) {
+                writer.write(id);
+                writer.write(framebuffer_size.x);
+                writer.write(framebuffer_size.y);
+                writer.write_renderpass_create_info(data);
+            });
+
+            return renderpass;
+        });
+    }
+
+    ntl::Result<RhiRenderpass*> CaptureRenderDevice::create_merged_renderpass(const rx::vector<renderpack::RenderPassCreateInfo>& subpasses,
+                                                                           const glm::uvec2& framebuffer_size,
+                                                                           rx::memory::allocator* allocator) {
+        return inner_device->create_merged_renderpass(subpasses, framebuffer_size, allocator).map([&](RhiRenderpass* renderpass) {
+            const auto id = register_object(renderpass);
+            write_record(CaptureRecordType::CreateMergedRenderpass, [&](CaptureWriter& writer) {
+                writer.write(id);
+                writer.write(framebuffer_size.x);
+                writer.write(framebuffer_size.y);
+                writer.write(static_cast<uint32_t>(subpasses.size()));
+                subpasses.each_fwd([&](const renderpack::RenderPassCreateInfo& subpass) { writer.write_renderpass_create_info(subpass); });
+            });
+
+            return renderpass;
+        });
+    }
+
+    RhiFramebuffer* CaptureRenderDevice::create_framebuffer(const RhiRenderpass* renderpass,
+                                                         const rx::vector<RhiImage*>& color_attachments,
+                                                         const rx::optional<RhiImage*> depth_attachment,
+                                                         const glm::uvec2& framebuffer_size,
+                                                         rx::memory::allocator* allocator) {
+        auto* framebuffer = inner_device->create_framebuffer(renderpass, color_attachments, depth_attachment, framebuffer_size, allocator);
+
+        const auto id = register_object(framebuffer);
+        write_record(CaptureRecordType::CreateFramebuffer, [&](CaptureWriter& writer) {
+            writer.write(id);
+            writer.write(get_object_id(renderpass));
+            writer.write(framebuffer_size.x);
+            writer.write(framebuffer_size.y);
+            writer.write_id_array(
+                get_object_ids(reinterpret_cast<const void* const*>(color_attachments.data()), color_attachments.size()));
+            writer.write(depth_attachment ? get_object_id(*depth_attachment) : 0U);
+        });
+
+        return framebuffer;
+    }
+
+    ntl::Result<RhiPipelineInterface*> CaptureRenderDevice::create_pipeline_interface(
+        const rx::map<rx::string, RhiResourceBindingDescription>& bindings,
+        const rx::vector<renderpack::TextureAttachmentInfo>& color_attachments,
+        const rx::optional<renderpack::TextureAttachmentInfo>& depth_texture,
+        rx::memory::allocator* allocator) {
+        return inner_device->create_pipeline_interface(bindings, color_attachments, depth_texture, allocator)
+            .map([&](RhiPipelineInterface* pipeline_interface) {
+                const auto id = register_object(pipeline_interface);
+                write_record(CaptureRecordType::CreatePipelineInterface, [&](CaptureWriter& writer) {
+                    writer.write(id);
+                    writer.write_resource_bindings(bindings);
+                    writer.write_texture_attachments(color_attachments, depth_texture);
+                });
+
+                return pipeline_interface;
+            });
+    }
+
+    RhiDescriptorPool* CaptureRenderDevice::create_descriptor_pool(const rx::map<DescriptorType, uint32_t>& descriptor_capacity,
+                                                                rx::memory::allocator* allocator) {
+        auto* pool = inner_device->create_descriptor_pool(descriptor_capacity, allocator);
+
+        const auto id = register_object(pool);
+        write_record(CaptureRecordType::CreateDescriptorPool, [&](CaptureWriter& writer) {
+            writer.write(id);
+            writer.write(static_cast<uint32_t>(descriptor_capacity.size()));
+            descriptor_capacity.each_pair([&](const DescriptorType& type, const uint32_t count) {
+                writer.write(type);
+                writer.write(count);
+            });
+        });
+
+        return pool;
+    }
+
+    rx::vector<RhiDescriptorSet*> CaptureRenderDevice::create_descriptor_sets(const RhiPipelineInterface* pipeline_interface,
+                                                                           RhiDescriptorPool* pool,
+                                                                           rx::memory::allocator* allocator) {
+        auto sets = inner_device->create_descriptor_sets(pipeline_interface, pool, allocator);
+
+        rx::vector<uint32_t> set_ids{internal_allocator};
+        set_ids.reserve(sets.size());
+        sets.each_fwd([&](const RhiDescriptorSet* set) { set_ids.push_back(register_object(set)); });
+
+        write_record(CaptureRecordType::CreateDescriptorSets, [&](CaptureWriter& writer) {
+            writer.write(get_object_id(pipeline_interface));
+            writer.write(get_object_id(pool));
+            writer.write_id_array(set_ids);
+        });
+
+        return sets;
+    }
+
+    void CaptureRenderDevice::update_descriptor_sets(rx::vector<RhiDescriptorSetWrite>& writes) {
+        write_record(CaptureRecordType::UpdateDescriptorSets, [&](CaptureWriter& writer) {
+            writer.write(static_cast<uint32_t>(writes.size()));
+            writes.each_fwd([&](const RhiDescriptorSetWrite& write) {
+                writer.write(get_object_id(write.set));
+                writer.write(write.binding);
+                writer.write(write.type);
+
+                writer.write(static_cast<uint32_t>(write.resources.size()));
+                write.resources.each_fwd([&](const RhiDescriptorResourceInfo& resource) {
+                    switch(write.type) {
+                        case DescriptorType::CombinedImageSampler:
+                            [[fallthrough]];
+                        case DescriptorType::Texture:
+                            [[fallthrough]];
+                        case DescriptorType::InputAttachment:
+                            [[fallthrough]];
+                        case DescriptorType::StorageImage:
+                            writer.write(get_object_id(resource.image_info.image));
+                            writer.write(resource.image_info.format.pixel_format);
+                            writer.write(resource.image_info.format.dimension_type);
+                            writer.write(resource.image_info.format.width);
+                            writer.write(resource.image_info.format.height);
+                            break;
+
+                        case DescriptorType::UniformBuffer:
+                            [[fallthrough]];
+                        case DescriptorType::StorageBuffer:
+                            writer.write(get_object_id(resource.buffer_info.buffer));
+                            break;
+
+                        case DescriptorType::Sampler:
+                            writer.write(get_object_id(resource.sampler_info.sampler));
+                            break;
+                    }
+                });
+            });
+        });
+
+        inner_device->update_descriptor_sets(writes);
+    }
+
+    void CaptureRenderDevice::reset_descriptor_pool(RhiDescriptorPool* pool) {
+        write_record(CaptureRecordType::ResetDescriptorPool, [&](CaptureWriter& writer) { writer.write(get_object_id(pool)); });
+
+        inner_device->reset_descriptor_pool(pool);
+    }
+
+    ntl::Result<RhiPipeline*> CaptureRenderDevice::create_pipeline(RhiPipelineInterface* pipeline_interface,
+                                                                const PipelineStateCreateInfo& data,
+                                                                rx::memory::allocator* allocator) {
+        return inner_device->create_pipeline(pipeline_interface, data, allocator).map([&](RhiPipeline* pipeline) {
+            const auto id = register_object(pipeline);
+            write_record(CaptureRecordType::CreatePipeline, [&](CaptureWriter& writer) {
+                writer.write(id);
+                writer.write(get_object_id(pipeline_interface));
+                writer.write_pipeline_state_create_info(data);
+                writer.write(get_object_id(data.renderpass));
+                writer.write(data.subpass_index);
+            });
+
+            return pipeline;
+        });
+    }
+
+    ntl::Result<RhiPipeline*> CaptureRenderDevice::create_compute_pipeline(RhiPipelineInterface* pipeline_interface,
+                                                                        const ComputePipelineCreateInfo& data,
+                                                                        rx::memory::allocator* allocator) {
+        return inner_device->create_compute_pipeline(pipeline_interface, data, allocator).map([&](RhiPipeline* pipeline) {
+            const auto id = register_object(pipeline);
+            write_record(CaptureRecordType::CreateComputePipeline, [&](CaptureWriter& writer) {
+                writer.write(id);
+                writer.write(get_object_id(pipeline_interface));
+                writer.write_compute_pipeline_create_info(data);
+            });
+
+            return pipeline;
+        });
+    }
+
+    RhiBuffer* CaptureRenderDevice::create_buffer(const RhiBufferCreateInfo& info,
+                                               DeviceMemoryResource& memory,
+                                               rx::memory::allocator* allocator) {
+        auto* buffer = inner_device->create_buffer(info, memory, allocator);
+
+        const auto id = register_object(buffer);
+        write_record(CaptureRecordType::CreateBuffer, [&](CaptureWriter& writer) {
+            writer.write(id);
+            writer.write(get_object_id(memory.memory));
+            writer.write_string(info.name);
+            writer.write(static_cast<uint64_t>(info.size.b_count()));
+            writer.write(info.buffer_usage);
+        });
+
+        return buffer;
+    }
+
+    void CaptureRenderDevice::write_data_to_buffer(const void* data, const Bytes num_bytes, const Bytes offset, const RhiBuffer* buffer) {
+        write_record(CaptureRecordType::WriteDataToBuffer, [&](CaptureWriter& writer) {
+            writer.write(get_object_id(buffer));
+            writer.write(static_cast<uint64_t>(offset.b_count()));
+            writer.write_byte_array(data, num_bytes.b_count());
+        });
+
+        inner_device->write_data_to_buffer(data, num_bytes, offset, buffer);
+    }
+
+    RhiSampler* CaptureRenderDevice::create_sampler(const RhiSamplerCreateInfo& create_info, rx::memory::allocator* allocator) {
+        auto* sampler = inner_device->create_sampler(create_info, allocator);
+
+        const auto id = register_object(sampler);
+        write_record(CaptureRecordType::CreateSampler, [&](CaptureWriter& writer) {
+            writer.write(id);
+            writer.write(create_info);
+        });
+
+        return sampler;
+    }
+
+    RhiImage* CaptureRenderDevice::create_image(const renderpack::TextureCreateInfo& info, rx::memory::allocator* allocator) {
+        auto* image = inner_device->create_image(info, allocator);
+
+        const auto id = register_object(image);
+        write_record(CaptureRecordType::CreateImage, [&](CaptureWriter& writer) {
+            writer.write(id);
+            writer.write_texture_create_info(info);
+        });
+
+        return image;
+    }
+
+    RhiImage* CaptureRenderDevice::create_aliased_image(const renderpack::TextureCreateInfo& info,
+                                                        RhiImage* aliased_image,
+                                                        rx::memory::allocator* allocator) {
+        auto* image = inner_device->create_aliased_image(info, aliased_image, allocator);
+
+        // Replayed images always get their own memory. Aliasing only saves memory, so the replay renders the same thing
+        const auto id = register_object(image);
+        write_record(CaptureRecordType::CreateImage, [&](CaptureWriter& writer) {
+            writer.write(id);
+            writer.write_texture_create_info(info);
+        });
+
+        return image;
+    }
+
+    bool CaptureRenderDevice::recreate_image(RhiImage* image,
+                                             const renderpack::TextureCreateInfo& info,
+                                             RhiImage* aliased_image,
+                                             rx::memory::allocator* allocator) {
+        // Replays don't recreate images, so the recreated image is a new image with a new ID
+        write_record(CaptureRecordType::DestroyTexture, [&](CaptureWriter& writer) { writer.write(get_object_id(image)); });
+        unregister_object(image);
+
+        if(!inner_device->recreate_image(image, info, aliased_image, allocator)) {
+            return false;
+        }
+
+        const auto id = register_object(image);
+        write_record(CaptureRecordType::CreateImage, [&](CaptureWriter& writer) {
+            writer.write(id);
+            writer.write_texture_create_info(info);
+        });
+
+        return true;
+    }
+
+    RhiSemaphore* CaptureRenderDevice::create_semaphore(rx::memory::allocator* allocator) {
+        auto* semaphore = inner_device->create_semaphore(allocator);
+
+        const auto id = register_object(semaphore);
+        write_record(CaptureRecordType::CreateSemaphore, [&](CaptureWriter& writer) { writer.write(id); });
+
+        return semaphore;
+    }
+
+    rx::vector<RhiSemaphore*> CaptureRenderDevice::create_semaphores(const uint32_t num_semaphores, rx::memory::allocator* allocator) {
+        auto semaphores = rx::vector<RhiSemaphore*>{allocator};
+        semaphores.reserve(num_semaphores);
+
+        for(uint32_t i = 0; i < num_semaphores; i++) {
+            semaphores.emplace_back(create_semaphore(allocator));
+        }
+
+        return semaphores;
+    }
+
+    RhiFence* CaptureRenderDevice::create_fence(const bool signaled, rx::memory::allocator* allocator) {
+        auto* fence = inner_device->create_fence(signaled, allocator);
+
+        const auto id = register_object(fence);
+        write_record(CaptureRecordType::CreateFence, [&](CaptureWriter& writer) {
+            writer.write(id);
+            writer.write(signaled);
+        });
+
+        return fence;
+    }
+
+    rx::vector<RhiFence*> CaptureRenderDevice::create_fences(const uint32_t num_fences,
+                                                           const bool signaled,
+                                                           rx::memory::allocator* allocator) {
+        rx::vector<RhiFence*> fences{allocator};
+        fences.reserve(num_fences);
+
+        for(uint32_t i = 0; i < num_fences; i++) {
+            fences.push_back(create_fence(signaled, allocator));
+        }
+
+        return fences;
+    }
+
+    void CaptureRenderDevice::wait_for_fences(const rx::vector<RhiFence*> fences) {
+        write_record(CaptureRecordType::WaitForFences, [&](CaptureWriter& writer) {
+            writer.write_id_array(get_object_ids(reinterpret_cast<const void* const*>(fences.data()), fences.size()));
+        });
+
+        inner_device->wait_for_fences(fences);
+    }
+
+    void CaptureRenderDevice::reset_fences(const rx::vector<RhiFence*>& fences) {
+        write_record(CaptureRecordType::ResetFences, [&](CaptureWriter& writer) {
+            writer.write_id_array(get_object_ids(reinterpret_cast<const void* const*>(fences.data()), fences.size()));
+        });
+
+        inner_device->reset_fences(fences);
+    }
+
+    RhiQueryPool* CaptureRenderDevice::create_timestamp_query_pool(const uint32_t num_queries, rx::memory::allocator* allocator) {
+        // Timestamps don't change what a frame renders, so query pools and the commands that use them aren't captured
+        return inner_device->create_timestamp_query_pool(num_queries, allocator);
+    }
+
+    rx::vector<rx::optional<uint64_t>> CaptureRenderDevice::get_timestamps(RhiQueryPool* pool,
+                                                                           const uint32_t first_query,
+                                                                           const uint32_t num_queries,
+                                                                           rx::memory::allocator* allocator) {
+        return inner_device->get_timestamps(pool, first_query, num_queries, allocator);
+    }
+
+    void CaptureRenderDevice::destroy_renderpass(RhiRenderpass* pass, rx::memory::allocator* allocator) {
+        write_record(CaptureRecordType::DestroyRenderpass, [&](CaptureWriter& writer) { writer.write(get_object_id(pass)); });
+        unregister_object(pass);
+
+        inner_device->destroy_renderpass(pass, allocator);
+    }
+
+    void CaptureRenderDevice::destroy_framebuffer(RhiFramebuffer* framebuffer, rx::memory::allocator* allocator) {
+        write_record(CaptureRecordType::DestroyFramebuffer, [&](CaptureWriter& writer) { writer.write(get_object_id(framebuffer)); });
+        unregister_object(framebuffer);
+
+        inner_device->destroy_framebuffer(framebuffer, allocator);
+    }
+
+    void CaptureRenderDevice::destroy_pipeline_interface(RhiPipelineInterface* pipeline_interface, rx::memory::allocator* allocator) {
+        write_record(CaptureRecordType::DestroyPipelineInterface,
+                     [&](CaptureWriter& writer) { writer.write(get_object_id(pipeline_interface)); });
+        unregister_object(pipeline_interface);
+
+        inner_device->destroy_pipeline_interface(pipeline_interface, allocator);
+    }
+
+    void CaptureRenderDevice::destroy_pipeline(RhiPipeline* pipeline, rx::memory::allocator* allocator) {
+        write_record(CaptureRecordType::DestroyPipeline, [&](CaptureWriter& writer) { writer.write(get_object_id(pipeline)); });
+        unregister_object(pipeline);
+
+        inner_device->destroy_pipeline(pipeline, allocator);
+    }
+
+    void CaptureRenderDevice::destroy_texture(RhiImage* resource, rx::memory::allocator* allocator) {
+        write_record(CaptureRecordType::DestroyTexture, [&](CaptureWriter& writer) { writer.write(get_object_id(resource)); });
+        unregister_object(resource);
+
+        inner_device->destroy_texture(resource, allocator);
+    }
+
+    void CaptureRenderDevice::destroy_buffer(RhiBuffer* buffer, rx::memory::allocator* allocator) {
+        write_record(CaptureRecordType::DestroyBuffer, [&](CaptureWriter& writer) { writer.write(get_object_id(buffer)); });
+        unregister_object(buffer);
+
+        inner_device->destroy_buffer(buffer, allocator);
+    }
+
+    void CaptureRenderDevice::destroy_semaphores(rx::vector<RhiSemaphore*>& semaphores, rx::memory::allocator* allocator) {
+        semaphores.each_fwd([&](const RhiSemaphore* semaphore) {
+            write_record(CaptureRecordType::DestroySemaphore, [&](CaptureWriter& writer) { writer.write(get_object_id(semaphore)); });
+            unregister_object(semaphore);
+        });
+
+        inner_device->destroy_semaphores(semaphores, allocator);
+    }
+
+    void CaptureRenderDevice::destroy_fences(const rx::vector<RhiFence*>& fences, rx::memory::allocator* allocator) {
+        fences.each_fwd([&](const RhiFence* fence) {
+            write_record(CaptureRecordType::DestroyFence, [&](CaptureWriter& writer) { writer.write(get_object_id(fence)); });
+            unregister_object(fence);
+        });
+
+        inner_device->destroy_fences(fences, allocator);
+    }
+
+    void CaptureRenderDevice::destroy_query_pool(RhiQueryPool* pool, rx::memory::allocator* allocator) {
+        inner_device->destroy_query_pool(pool, allocator);
+    }
+
+    void CaptureRenderDevice::recreate_swapchain(const glm::uvec2& window_size) {
+        {
+            // Replays have one swapchain, with the size and images that the capture started with
+            rx::concurrency::scope_lock l(capture_mutex);
+            if(capturing) {
+                logger(rx::log::level::k_warning,
+                       "The swapchain was recreated, so the capture in %s ends after %u frames",
+                       capture_file.name(),
+                       num_captured_frames);
+                finish_capture();
+            }
+        }
+
+        inner_device->recreate_swapchain(window_size);
+        swapchain_size = inner_device->get_swapchain()->get_size();
+
+        static_cast<CaptureSwapchain*>(swapchain)->update_from_inner_swapchain();
+    }
+
+    void CaptureRenderDevice::begin_frame(const uint32_t frame_idx) {
+        write_record(CaptureRecordType::BeginFrame, [&](CaptureWriter& writer) { writer.write(frame_idx); });
+
+        inner_device->begin_frame(frame_idx);
+    }
+
+    CommandList* CaptureRenderDevice::create_command_list(const uint32_t thread_idx,
+                                                          const QueueType needed_queue_type,
+                                                          const CommandList::Level level,
+                                                          rx::memory::allocator* allocator,
+                                                          const RhiRenderpass* renderpass,
+                                                          const RhiFramebuffer* framebuffer,
+                                                          const uint32_t subpass) {
+        auto* inner_list = inner_device->create_command_list(thread_idx,
+                                                             needed_queue_type,
+                                                             level,
+                                                             allocator,
+                                                             renderpass,
+                                                             framebuffer,
+                                                             subpass);
+
+        return allocator->create<CaptureCommandList>(inner_list,
+                                                     get_free_stream(),
+                                                     get_object_id(renderpass),
+                                                     get_object_id(framebuffer),
+                                                     subpass,
+                                                     this,
+                                                     allocator);
+    }
+
+    void CaptureRenderDevice::submit_command_list(CommandList* cmds,
+                                                  const QueueType queue,
+                                                  RhiFence* fence_to_signal,
+                                                  const rx::vector<RhiSemaphore*>& wait_semaphores,
+                                                  const rx::vector<RhiSemaphore*>& signal_semaphores) {
+        cmds->flush_barriers();
+
+        auto* capture_list = static_cast<CaptureCommandList*>(cmds);
+
+        write_record(CaptureRecordType::SubmitCommandList, [&](CaptureWriter& writer) {
+            writer.write(queue);
+            writer.write(get_object_id(fence_to_signal));
+            writer.write_id_array(get_object_ids(reinterpret_cast<const void* const*>(wait_semaphores.data()), wait_semaphores.size()));
+            writer.write_id_array(
+                get_object_ids(reinterpret_cast<const void* const*>(signal_semaphores.data()), signal_semaphores.size()));
+            writer.write(capture_list->get_num_commands());
+
+            const auto& stream = capture_list->get_stream();
+            writer.write_byte_array(stream.data(), stream.size());
+        });
+
+        inner_device->submit_command_list(capture_list->get_inner_list(), queue, fence_to_signal, wait_semaphores, signal_semaphores);
+
+        recycle_stream(capture_list->release_stream());
+    }
+
+    void CaptureRenderDevice::save_pipeline_cache() { inner_device->save_pipeline_cache(); }
+
+    uint32_t CaptureRenderDevice::get_object_id(const void* object) {
+        if(object == nullptr) {
+            return 0;
+        }
+
+        rx::concurrency::scope_lock l(object_ids_mutex);
+        if(const auto* id = object_ids.find(object)) {
+            return *id;
+        }
+
+        return 0;
+    }
+
+    void CaptureRenderDevice::recycle_stream(rx::vector<rx_byte>&& stream) {
+        stream.clear();
+
+        rx::concurrency::scope_lock l(streams_mutex);
+        free_streams.push_back(rx::utility::move(stream));
+    }
+
+    void CaptureRenderDevice::on_swapchain_image_acquired(const uint32_t image_idx, const RhiSemaphore* image_acquired_semaphore) {
+        const auto semaphore_id = get_object_id(image_acquired_semaphore);
+        write_record(CaptureRecordType::AcquireSwapchainImage, [&](CaptureWriter& writer) {
+            writer.write(image_idx);
+            writer.write(semaphore_id);
+        });
+    }
+
+    void CaptureRenderDevice::on_swapchain_image_presented(const uint32_t image_idx, const RhiSemaphore* render_finished_semaphore) {
+        const auto semaphore_id = get_object_id(render_finished_semaphore);
+
+        rx::concurrency::scope_lock l(capture_mutex);
+        if(!capturing) {
+            return;
+        }
+
+        record_writer.clear();
+        record_writer.write(image_idx);
+        record_writer.write(semaphore_id);
+        flush_record(CaptureRecordType::Present);
+
+        num_captured_frames++;
+        if(capturing && num_captured_frames >= num_frames_to_capture) {
+            logger(rx::log::level::k_info, "Captured %u frames to %s", num_captured_frames, capture_file.name());
+            finish_capture();
+        }
+    }
+
+    bool CaptureRenderDevice::is_capturing() const {
+        rx::concurrency::scope_lock l(capture_mutex);
+        return capturing;
+    }
+
+    uint32_t CaptureRenderDevice::register_object(const void* object) {
+        if(object == nullptr) {
+            return 0;
+        }
+
+        const auto id = next_object_id.fetch_add(1);
+
+        rx::concurrency::scope_lock l(object_ids_mutex);
+        object_ids.insert(object, id);
+
+        return id;
+    }
+
+    void CaptureRenderDevice::unregister_object(const void* object) {
+        rx::concurrency::scope_lock l(object_ids_mutex);
+        object_ids.erase(object);
+    }
+
+    rx::vector<uint32_t> CaptureRenderDevice::get_object_ids(const void* const* objects, const rx_size num_objects) {
+        rx::vector<uint32_t> ids{internal_allocator};
+        ids.reserve(num_objects);
+
+        for(rx_size i = 0; i < num_objects; i++) {
+            ids.push_back(get_object_id(objects[i]));
+        }
+
+        return ids;
+    }
+
+    void CaptureRenderDevice::flush_record(const CaptureRecordType type) {
+        const auto& data = record_writer.get_data();
+        const CaptureRecordHeader header{type, static_cast<uint32_t>(data.size())};
+
+        const auto header_bytes_written = capture_file.write(reinterpret_cast<const rx_byte*>(&header), sizeof(header));
+        const auto data_bytes_written = data.is_empty() ? 0 : capture_file.write(data.data(), data.size());
+
+        if(header_bytes_written != sizeof(header) || data_bytes_written != data.size()) {
+            logger(rx::log::level::k_error, "Could not write to capture file %s. The capture is incomplete", capture_file.name());
+            finish_capture();
+        }
+    }
+
+    void CaptureRenderDevice::finish_capture() {
+        capturing = false;
+        capture_file.close();
+    }
+
+    rx::vector<rx_byte> CaptureRenderDevice::get_free_stream() {
+        rx::concurrency::scope_lock l(streams_mutex);
+
+        if(free_streams.is_empty()) {
+            return rx::vector<rx_byte>{internal_allocator};
+        }
+
+        auto stream = rx::utility::move(free_streams.last());
+        free_streams.erase(free_streams.size() - 1, free_streams.size());
+
+        return stream;
+    }
+
+    void CaptureRenderDevice::create_swapchain() {
+        auto* inner_swapchain = inner_device->get_swapchain();
+        swapchain_size = inner_swapchain->get_size();
+
+        swapchain = internal_allocator->create<CaptureSwapchain>(inner_swapchain, this);
+
+        CaptureFileHeader header{};
+        header.swapchain_width = swapchain_size.x;
+        header.swapchain_height = swapchain_size.y;
+        header.num_swapchain_images = swapchain->get_num_images();
+
+        rx::concurrency::scope_lock l(capture_mutex);
+        if(!capturing) {
+            return;
+        }
+
+        if(capture_file.write(reinterpret_cast<const rx_byte*>(&header), sizeof(header)) != sizeof(header)) {
+            logger(rx::log::level::k_error, "Could not write to capture file %s. Nothing will be captured", capture_file.name());
+            finish_capture();
+            return;
+        }
+
+        // The swapchain's objects were made before this device existed, so they need IDs of their own
+        for(uint32_t i = 0; i < header.num_swapchain_images; i++) {
+            const auto image_id = register_object(swapchain->get_image(i));
+            const auto framebuffer_id = register_object(swapchain->get_framebuffer(i));
+            const auto fence_id = register_object(swapchain->get_fence(i));
+
+            record_writer.clear();
+            record_writer.write(i);
+            record_writer.write(image_id);
+            record_writer.write(framebuffer_id);
+            record_writer.write(fence_id);
+            flush_record(CaptureRecordType::SwapchainImage);
+        }
+    }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include <rx/core/concurrency/mutex.h>
+#include <rx/core/concurrency/scope_lock.h>
+#include <rx/core/filesystem/file.h>
+#include <rx/core/map.h>
+
+#include "nova_renderer/rhi/render_device.hpp"
+
+#include "capture_command_list.hpp"
+#include "capture_format.hpp"
+#include "capture_serialization.hpp"
+
+namespace nova::renderer::rhi {
+    /*!
+     * \brief Render device which forwards everything to another render device, and writes every resource creation and every command
+     * list submission to a capture file
+     *
+     * Capturing starts when the device is created, so that the capture has every resource the captured frames use, and stops after
+     * `NovaSettings::capture.num_frames` frames have been presented. After that, the device only forwards calls
+     *
+     * Use `nova-replay` to replay a capture file
+     */
+    class CaptureRenderDevice final : public RenderDevice {
+    public:
+        CaptureRenderDevice(std::unique_ptr<RenderDevice> inner_device,
+                            NovaSettingsAccessManager& settings,
+                            NovaWindow& window,
+                            rx::memory::allocator* allocator);
+
+        CaptureRenderDevice(CaptureRenderDevice&& old) noexcept = delete;
+        CaptureRenderDevice& operator=(CaptureRenderDevice&& old) noexcept = delete;
+
+        CaptureRenderDevice(const CaptureRenderDevice& other) = delete;
+        CaptureRenderDevice& operator=(const CaptureRenderDevice& other) = delete;
+
+        ~CaptureRenderDevice() override;
+
+#pragma region Render engine interface
+        void set_num_renderpasses(uint32_t num_renderpasses) override;
+
+        ntl::Result<RhiDeviceMemory*> allocate_device_memory(mem::Bytes size,
+                                                          MemoryUsage usage,
+                                                          ObjectType allowed_objects,
+                                                          rx::memory::allocator* allocator) override;
+
+        ntl::Result<RhiRenderpass*> create_renderpass(const renderpack::RenderPassCreateInfo& data,
+                                                   const glm::uvec2& framebuffer_size,
+                                                   rx::memory::allocator* allocator) override;
+
+        ntl::Result<RhiRenderpass*> create_merged_renderpass(const rx::vector<renderpack::RenderPassCreateInfo>& subpasses,
+                                                          const glm::uvec2& framebuffer_size,
+                                                          rx::memory::allocator* allocator) override;
+
+        RhiFramebuffer* create_framebuffer(const RhiRenderpass* renderpass,
+                                        const rx::vector<RhiImage*>& color_attachments,
+                                        const rx::optional<RhiImage*> depth_attachment,
+                                        const glm::uvec2& framebuffer_size,
+                                        rx::memory::allocator* allocator) override;
+
+        ntl::Result<RhiPipelineInterface*> create_pipeline_interface(const rx::map<rx::string, RhiResourceBindingDescription>& bindings,
+                                                                  const rx::vector<renderpack::TextureAttachmentInfo>& color_attachments,
+                                                                  const rx::optional<renderpack::TextureAttachmentInfo>& depth_texture,
+                                                                  rx::memory::allocator* allocator) override;
+
+        RhiDescriptorPool* create_descriptor_pool(const rx::map<DescriptorType, uint32_t>& descriptor_capacity,
+                                               rx::memory::allocator* allocator) override;
+
+        rx::vector<RhiDescriptorSet*> create_descriptor_sets(const RhiPipelineInterface* pipeline_interface,
+                                                          RhiDescriptorPool* pool,
+                                                          rx::memory::allocator* allocator) override;
+
+        void update_descriptor_sets(rx::vector<RhiDescriptorSetWrite>& writes) override;
+
+        void reset_descriptor_pool(RhiDescriptorPool* pool) override;
+
+        ntl::Result<RhiPipeline*> create_pipeline(RhiPipelineInterface* pipeline_interface,
+                                               const PipelineStateCreateInfo& data,
+                                               rx::memory::allocator* allocator) override;
+
+        ntl::Result<RhiPipeline*> create_compute_pipeline(RhiPipelineInterface* pipeline_interface,
+                                                          const ComputePipelineCreateInfo& data,
+                                                          rx::memory::allocator* allocator) override;
+
+        RhiBuffer* create_buffer(const RhiBufferCreateInfo& info, DeviceMemoryResource& memory, rx::memory::allocator* allocator) override;
+
+        void write_data_to_buffer(const void* data, mem::Bytes num_bytes, mem::Bytes offset, const RhiBuffer* buffer) override;
+
+        RhiSampler* create_sampler(const RhiSamplerCreateInfo& create_info, rx::memory::allocator* allocator) override;
+
+        RhiImage* create_image(const renderpack::TextureCreateInfo& info, rx::memory::allocator* allocator) override;
+
+        RhiImage* create_aliased_image(const renderpack::TextureCreateInfo& info,
+                                       RhiImage* aliased_image,
+                                       rx::memory::allocator* allocator) override;
+
+        bool recreate_image(RhiImage* image,
+                            const renderpack::TextureCreateInfo& info,
+                            RhiImage* aliased_image,
+                            rx::memory::allocator* allocator) override;
+
+        RhiSemaphore* create_semaphore(rx::memory::allocator* allocator) override;
+
+        rx::vector<RhiSemaphore*> create_semaphores(uint32_t num_semaphores, rx::memory::allocator* allocator) override;
+
+        RhiFence* create_fence(bool signaled, rx::memory::allocator* allocator) override;
+
+        rx::vector<RhiFence*> create_fences(uint32_t num_fences, bool signaled, rx::memory::allocator* allocator) override;
+
+        void wait_for_fences(rx::vector<RhiFence*> fences) override;
+
+        void reset_fences(const rx::vector<RhiFence*>& fences) override;
+
+        RhiQueryPool* create_timestamp_query_pool(uint32_t num_queries, rx::memory::allocator* allocator) override;
+
+        rx::vector<rx::optional<uint64_t>> get_timestamps(RhiQueryPool* pool,
+                                                          uint32_t first_query,
+                                                          uint32_t num_queries,
+                                                          rx::memory::allocator* allocator) override;
+
+        void destroy_renderpass(RhiRenderpass* pass, rx::memory::allocator* allocator) override;
+
+        void destroy_framebuffer(RhiFramebuffer* framebuffer, rx::memory::allocator* allocator) override;
+
+        void destroy_pipeline_interface(RhiPipelineInterface* pipeline_interface, rx::memory::allocator* allocator) override;
+
+        void destroy_pipeline(RhiPipeline* pipeline, rx::memory::allocator* allocator) override;
+
+        void destroy_texture(RhiImage* resource, rx::memory::allocator* allocator) override;
+
+        void destroy_buffer(RhiBuffer* buffer, rx::memory::allocator* allocator) override;
+
+        void destroy_semaphores(rx::vector<RhiSemaphore*>& semaphores, rx::memory::allocator* allocator) override;
+
+        void destroy_fences(const rx::vector<RhiFence*>& fences, rx::memory::allocator* allocator) override;
+
+        void destroy_query_pool(RhiQueryPool* pool, rx::memory::allocator* allocator) override;
+
+        void recreate_swapchain(const glm::uvec2& window_size) override;
+
+        void begin_frame(uint32_t frame_idx) override;
+
+        CommandList* create_command_list(uint32_t thread_idx,
+                                         QueueType needed_queue_type,
+                                         CommandList::Level level,
+                                         rx::memory::allocator* allocator,
+                                         const RhiRenderpass* renderpass = nullptr,
+                                         const RhiFramebuffer* framebuffer = nullptr,
+                                         uint32_t subpass = 0) override;
+
+        void submit_command_list(CommandList* cmds,
+                                 QueueType queue,
+                                 RhiFence* fence_to_signal = nullptr,
+                                 const rx::vector<RhiSemaphore*>& wait_semaphores = {},
+                                 const rx::vector<RhiSemaphore*>& signal_semaphores = {}) override;
+
+        void save_pipeline_cache() override;
+#pragma endregion
+
+        /*!
+         * \brief Gets the capture ID of an object that this device created, or 0 if this device didn't create the object
+         */
+        [[nodiscard]] uint32_t get_object_id(const void* object);
+
+        /*!
+         * \brief Gives a command stream back to the device so that its memory can be reused by a later command list
+         */
+        void recycle_stream(rx::vector<rx_byte>&& stream);
+
+        void on_swapchain_image_acquired(uint32_t image_idx, const RhiSemaphore* image_acquired_semaphore);
+
+        /*!
+         * \brief Ends the current frame, and finishes the capture if enough frames have been captured
+         */
+        void on_swapchain_image_presented(uint32_t image_idx, const RhiSemaphore* render_finished_semaphore);
+
+        [[nodiscard]] bool is_capturing() const;
+
+    private:
+        std::unique_ptr<RenderDevice> inner_device;
+
+        std::atomic<uint32_t> next_object_id = 1;
+
+        rx::concurrency::mutex object_ids_mutex;
+
+        rx::map<const void*, uint32_t> object_ids;
+
+        /*!
+         * \brief Guards the capture file, the record writer, and the capture progress
+         */
+        mutable rx::concurrency::mutex capture_mutex;
+
+        rx::filesystem::file capture_file;
+
+        CaptureWriter record_writer;
+
+        bool capturing = false;
+
+        uint32_t num_frames_to_capture = 0;
+
+        uint32_t num_captured_frames = 0;
+
+        rx::concurrency::mutex streams_mutex;
+
+        rx::vector<rx::vector<rx_byte>> free_streams;
+
+        uint32_t register_object(const void* object);
+
+        void unregister_object(const void* object);
+
+        [[nodiscard]] rx::vector<uint32_t> get_object_ids(const void* const* objects, rx_size num_objects);
+
+        /*!
+         * \brief Writes a record to the capture file, if we're still capturing
+         *
+         * \param type The type of the record
+         * \param write_data Function which writes the record's data into the CaptureWriter it's given
+         */
+        template <typename WriteFunc>
+        void write_record(CaptureRecordType type, WriteFunc&& write_data);
+
+        /*!
+         * \brief Writes the record writer's data to the capture file. Must be called with capture_mutex held
+         */
+        void flush_record(CaptureRecordType type);
+
+        /*!
+         * \brief Closes the capture file. Must be called with capture_mutex held
+         */
+        void finish_capture();
+
+        [[nodiscard]] rx::vector<rx_byte> get_free_stream();
+
+        void create_swapchain();
+    };
+
+    template <typename WriteFunc>
+    void CaptureRenderDevice::write_record(const CaptureRecordType type, WriteFunc&& write_data) {
+        rx::concurrency::scope_lock l(capture_mutex);
+        if(!capturing) {
+            return;
+        }
+
+        record_writer.clear();
+        write_data(record_writer);
+
+        flush_record(type);
+    }
+} // namespace nova::renderer::rhi
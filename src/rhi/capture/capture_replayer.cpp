@@ -0,0 +1,777 @@
+#include "capture_replayer.hpp"
+
+#include <rx/core/log.h>
+#include <rx/core/memory/bump_point_allocator.h>
+#include <rx/core/time/qpc.h>
+
+#include "nova_renderer/constants.hpp"
+#include "nova_renderer/memory/block_allocation_strategy.hpp"
+#include "nova_renderer/rhi/swapchain.hpp"
+#include "nova_renderer/tracing.hpp"
+
+#include "../headless/headless_command_list.hpp"
+
+using namespace nova::mem;
+
+namespace nova::renderer::rhi {
+    RX_LOG("CaptureReplayer", logger);
+
+    static double ticks_to_ms(const uint64_t ticks) {
+        return static_cast<double>(ticks) * 1000.0 / static_cast<double>(rx::time::qpc_frequency());
+    }
+
+    CaptureReplayer::CaptureReplayer(RenderDevice& device, rx::memory::allocator* allocator)
+        : device(device),
+          allocator(allocator),
+          objects{allocator},
+          memory_resources{allocator},
+          swapchain_image_ids{allocator},
+          frame_statistics{allocator},
+          frame_allocators{allocator} {
+        frame_memory = allocator->allocate(PER_FRAME_MEMORY_SIZE.b_count() * NUM_IN_FLIGHT_FRAMES);
+
+        frame_allocators.reserve(NUM_IN_FLIGHT_FRAMES);
+        for(size_t i = 0; i < NUM_IN_FLIGHT_FRAMES; i++) {
+            rx_byte* ptr = frame_memory + PER_FRAME_MEMORY_SIZE.b_count() * i;
+            auto* mem = allocator->create<rx::memory::bump_point_allocator>(ptr, PER_FRAME_MEMORY_SIZE.b_count());
+            frame_allocators.emplace_back(mem);
+        }
+    }
+
+    CaptureReplayer::~CaptureReplayer() {
+        objects.each_value([&](const ReplayedObject& object) { destroy_object(object); });
+
+        memory_resources.each_value([&](DeviceMemoryResource* resource) {
+            allocator->destroy<BlockAllocationStrategy>(resource->allocation_strategy);
+            allocator->destroy<DeviceMemoryResource>(resource);
+        });
+
+        frame_allocators.each_fwd(
+            [&](rx::memory::bump_point_allocator* frame_allocator) { allocator->destroy<rx::memory::bump_point_allocator>(frame_allocator); });
+        allocator->deallocate(frame_memory);
+    }
+
+    bool CaptureReplayer::replay(const rx::vector<rx_byte>& capture) {
+        NOVA_TRACE_SCOPE("Replay", "replay");
+
+        CaptureReader reader{capture.data(), capture.size(), allocator};
+
+        const auto header = reader.read<CaptureFileHeader>();
+        if(!reader.is_valid() || header.magic != CAPTURE_FILE_MAGIC) {
+            logger(rx::log::level::k_error, "Not a Nova capture file");
+            return false;
+        }
+
+        if(header.version != CAPTURE_FILE_VERSION) {
+            logger(rx::log::level::k_error,
+                   "Capture file has version %u, but this version of Nova can only replay version %u",
+                   header.version,
+                   CAPTURE_FILE_VERSION);
+            return false;
+        }
+
+        const auto swapchain_size = device.get_swapchain()->get_size();
+        if(swapchain_size.x != header.swapchain_width || swapchain_size.y != header.swapchain_height) {
+            logger(rx::log::level::k_warning,
+                   "Capture was made with a %ux%u swapchain, but it's being replayed with a %ux%u swapchain",
+                   header.swapchain_width,
+                   header.swapchain_height,
+                   swapchain_size.x,
+                   swapchain_size.y);
+        }
+
+        swapchain_image_ids.resize(header.num_swapchain_images);
+
+        while(!reader.is_at_end()) {
+            const auto record_header = reader.read<CaptureRecordHeader>();
+            const auto* record_data = reader.read_bytes(record_header.size);
+            if(!reader.is_valid()) {
+                logger(rx::log::level::k_error, "Capture file ends in the middle of a record. Was Nova shut down while capturing?");
+                return false;
+            }
+
+            CaptureReader record_reader{record_data, record_header.size, allocator};
+            if(!replay_record(record_header.type, record_reader) || !record_reader.is_valid()) {
+                logger(rx::log::level::k_error,
+                       "Could not replay record of type %u after %u frames",
+                       static_cast<uint32_t>(record_header.type),
+                       frame_statistics.size());
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const rx::vector<ReplayFrameStatistics>& CaptureReplayer::get_frame_statistics() const { return frame_statistics; }
+
+    bool CaptureReplayer::replay_record(const CaptureRecordType type, CaptureReader& reader) {
+        if(type == CaptureRecordType::SubmitCommandList) {
+            // Submissions keep track of their own time, so they can tell recording apart from submitting
+            replay_submit(reader);
+            return true;
+        }
+
+        const auto start_ticks = rx::time::qpc_ticks();
+
+        switch(type) {
+            case CaptureRecordType::SwapchainImage: {
+                const auto image_idx = reader.read<uint32_t>();
+                if(image_idx >= swapchain_image_ids.size()) {
+                    return false;
+                }
+
+                auto& ids = swapchain_image_ids[image_idx];
+                ids.image = reader.read<uint32_t>();
+                ids.framebuffer = reader.read<uint32_t>();
+                ids.fence = reader.read<uint32_t>();
+
+                remap_swapchain_image(image_idx, image_idx);
+            } break;
+
+            case CaptureRecordType::SetNumRenderpasses: {
+                device.set_num_renderpasses(reader.read<uint32_t>());
+            } break;
+
+            case CaptureRecordType::AllocateDeviceMemory: {
+                const auto id = reader.read<uint32_t>();
+                const auto size = reader.read<uint64_t>();
+                const auto usage = reader.read<MemoryUsage>();
+                const auto allowed_objects = reader.read<ObjectType>();
+
+                device.allocate_device_memory(size, usage, allowed_objects, allocator)
+                    .map([&](RhiDeviceMemory* memory) {
+                        add_object(id, ReplayedObjectType::DeviceMemory, memory);
+
+                        auto* strategy = allocator->create<BlockAllocationStrategy>(allocator, Bytes(size), 64_b);
+                        memory_resources.insert(memory, allocator->create<DeviceMemoryResource>(memory, strategy));
+
+                        return memory;
+                    })
+                    .on_error([&](const ntl::NovaError& error) {
+                        logger(rx::log::level::k_error, "Could not allocate device memory: %s", error.to_string());
+                    });
+            } break;
+
+            case CaptureRecordType::CreateRenderpass: {
+                const auto id = reader.read<uint32_t>();
+                glm::uvec2 framebuffer_size;
+                framebuffer_size.x = reader.read<uint32_t>();
+                framebuffer_size.y = reader.read<uint32_t>();
+                const auto create_info = reader.read_renderpass_create_info();
+
+                device.create_renderpass(create_info, framebuffer_size, allocator)
+                    .map([&](RhiRenderpass* renderpass) {
+                        add_object(id, ReplayedObjectType::Renderpass, renderpass);
+                        return renderpass;
+                    })
+                    .on_error([&](const ntl::NovaError& error) {
+                        logger(rx::log::level::k_error, "Could not create renderpass %s: %s", create_info.name, error.to_string());
+                    });
+            } break;
+
+            case CaptureRecordType::CreateMergedRenderpass: {
+                const auto id = reader.read<uint32_t>();
+                glm::uvec2 framebuffer_size;
+                framebuffer_size.x = reader.read<uint32_t>();
+                framebuffer_size.y = reader.read<uint32_t>();
+
+                rx::vector<renderpack::RenderPassCreateInfo> subpasses{allocator};
+                const auto num_subpasses = reader.read<uint32_t>();
+                for(uint32_t i = 0; i < num_subpasses && reader.is_valid(); i++) {
+                    subpasses.push_back(reader.read_renderpass_create_info());
+                }
+
+                device.create_merged_renderpass(subpasses, framebuffer_size, allocator)
+                    .map([&](RhiRenderpass* renderpass) {
+                        add_object(id, ReplayedObjectType::Renderpass, renderpass);
+                        return renderpass;
+                    })
+                    .on_error([&](const ntl::NovaError& error) {
+                        logger(rx::log::level::k_error, "Could not create merged renderpass: %s", error.to_string());
+                    });
+            } break;
+
+            case CaptureRecordType::CreateFramebuffer: {
+                const auto id = reader.read<uint32_t>();
+                const auto* renderpass = get_object<RhiRenderpass>(reader.read<uint32_t>());
+                glm::uvec2 framebuffer_size;
+                framebuffer_size.x = reader.read<uint32_t>();
+                framebuffer_size.y = reader.read<uint32_t>();
+                const auto color_attachments = get_objects<RhiImage>(reader.read_id_array());
+
+                rx::optional<RhiImage*> depth_attachment;
+                if(const auto depth_id = reader.read<uint32_t>(); depth_id != 0) {
+                    depth_attachment = get_object<RhiImage>(depth_id);
+                }
+
+                auto* framebuffer = device.create_framebuffer(renderpass, color_attachments, depth_attachment, framebuffer_size, allocator);
+                add_object(id, ReplayedObjectType::Framebuffer, framebuffer);
+            } break;
+
+            case CaptureRecordType::CreatePipelineInterface: {
+                const auto id = reader.read<uint32_t>();
+                const auto bindings = reader.read_resource_bindings();
+
+                rx::vector<renderpack::TextureAttachmentInfo> color_attachments{allocator};
+                rx::optional<renderpack::TextureAttachmentInfo> depth_attachment;
+                reader.read_texture_attachments(color_attachments, depth_attachment);
+
+                device.create_pipeline_interface(bindings, color_attachments, depth_attachment, allocator)
+                    .map([&](RhiPipelineInterface* pipeline_interface) {
+                        add_object(id, ReplayedObjectType::PipelineInterface, pipeline_interface);
+                        return pipeline_interface;
+                    })
+                    .on_error([&](const ntl::NovaError& error) {
+                        logger(rx::log::level::k_error, "Could not create pipeline interface: %s", error.to_string());
+                    });
+            } break;
+
+            case CaptureRecordType::CreateDescriptorPool: {
+                const auto id = reader.read<uint32_t>();
+
+                rx::map<DescriptorType, uint32_t> descriptor_capacity{allocator};
+                const auto num_descriptor_types = reader.read<uint32_t>();
+                for(uint32_t i = 0; i < num_descriptor_types && reader.is_valid(); i++) {
+                    const auto descriptor_type = reader.read<DescriptorType>();
+                    descriptor_capacity.insert(descriptor_type, reader.read<uint32_t>());
+                }
+
+                add_object(id, ReplayedObjectType::DescriptorPool, device.create_descriptor_pool(descriptor_capacity, allocator));
+            } break;
+
+            case CaptureRecordType::CreateDescriptorSets: {
+                const auto* pipeline_interface = get_object<RhiPipelineInterface>(reader.read<uint32_t>());
+                auto* pool = get_object<RhiDescriptorPool>(reader.read<uint32_t>());
+                const auto set_ids = reader.read_id_array();
+
+                const auto sets = device.create_descriptor_sets(pipeline_interface, pool, allocator);
+                if(sets.size() != set_ids.size()) {
+                    logger(rx::log::level::k_warning,
+                           "Capture created %u descriptor sets, but the replay device created %u",
+                           set_ids.size(),
+                           sets.size());
+                }
+
+                for(rx_size i = 0; i < sets.size() && i < set_ids.size(); i++) {
+                    add_object(set_ids[i], ReplayedObjectType::DescriptorSet, sets[i]);
+                }
+            } break;
+
+            case CaptureRecordType::UpdateDescriptorSets: {
+                replay_update_descriptor_sets(reader);
+            } break;
+
+            case CaptureRecordType::ResetDescriptorPool: {
+                device.reset_descriptor_pool(get_object<RhiDescriptorPool>(reader.read<uint32_t>()));
+            } break;
+
+            case CaptureRecordType::CreatePipeline: {
+                const auto id = reader.read<uint32_t>();
+                auto* pipeline_interface = get_object<RhiPipelineInterface>(reader.read<uint32_t>());
+                auto create_info = reader.read_pipeline_state_create_info();
+                create_info.renderpass = get_object<RhiRenderpass>(reader.read<uint32_t>());
+                create_info.subpass_index = reader.read<uint32_t>();
+
+                device.create_pipeline(pipeline_interface, create_info, allocator)
+                    .map([&](RhiPipeline* pipeline) {
+                        add_object(id, ReplayedObjectType::Pipeline, pipeline);
+                        return pipeline;
+                    })
+                    .on_error([&](const ntl::NovaError& error) {
+                        logger(rx::log::level::k_error, "Could not create pipeline %s: %s", create_info.name, error.to_string());
+                    });
+            } break;
+
+            case CaptureRecordType::CreateComputePipeline: {
+                const auto id = reader.read<uint32_t>();
+                auto* pipeline_interface = get_object<RhiPipelineInterface>(reader.read<uint32_t>());
+                const auto create_info = reader.read_compute_pipeline_create_info();
+
+                device.create_compute_pipeline(pipeline_interface, create_info, allocator)
+                    .map([&](RhiPipeline* pipeline) {
+                        add_object(id, ReplayedObjectType::Pipeline, pipeline);
+                        return pipeline;
+                    })
+                    .on_error([&](const ntl::NovaError& error) {
+                        logger(rx::log::level::k_error, "Could not create compute pipeline %s: %s", create_info.name, error.to_string());
+                    });
+            } break;
+
+            case CaptureRecordType::CreateBuffer: {
+                const auto id = reader.read<uint32_t>();
+                auto* memory = get_object<RhiDeviceMemory>(reader.read<uint32_t>());
+
+                RhiBufferCreateInfo create_info{};
+                create_info.name = reader.read_string();
+                create_info.size = reader.read<uint64_t>();
+                create_info.buffer_usage = reader.read<BufferUsage>();
+
+                auto** memory_resource = memory_resources.find(memory);
+                if(memory_resource == nullptr) {
+                    logger(rx::log::level::k_error, "Buffer %s was created from memory that wasn't captured", create_info.name);
+                    break;
+                }
+
+                add_object(id, ReplayedObjectType::Buffer, device.create_buffer(create_info, **memory_resource, allocator));
+            } break;
+
+            case CaptureRecordType::WriteDataToBuffer: {
+                const auto* buffer = get_object<RhiBuffer>(reader.read<uint32_t>());
+                const auto offset = reader.read<uint64_t>();
+
+                rx_size num_bytes;
+                const auto* data = reader.read_byte_array(num_bytes);
+
+                if(buffer != nullptr && data != nullptr) {
+                    device.write_data_to_buffer(data, num_bytes, offset, buffer);
+                }
+            } break;
+
+            case CaptureRecordType::CreateSampler: {
+                const auto id = reader.read<uint32_t>();
+                const auto create_info = reader.read<RhiSamplerCreateInfo>();
+
+                add_object(id, ReplayedObjectType::Sampler, device.create_sampler(create_info, allocator));
+            } break;
+
+            case CaptureRecordType::CreateImage: {
+                const auto id = reader.read<uint32_t>();
+                const auto create_info = reader.read_texture_create_info();
+
+                add_object(id, ReplayedObjectType::Image, device.create_image(create_info, allocator));
+            } break;
+
+            case CaptureRecordType::CreateSemaphore: {
+                add_object(reader.read<uint32_t>(), ReplayedObjectType::Semaphore, device.create_semaphore(allocator));
+            } break;
+
+            case CaptureRecordType::CreateFence: {
+                const auto id = reader.read<uint32_t>();
+                const auto signaled = reader.read<bool>();
+
+                add_object(id, ReplayedObjectType::Fence, device.create_fence(signaled, allocator));
+            } break;
+
+            case CaptureRecordType::WaitForFences: {
+                device.wait_for_fences(get_objects<RhiFence>(reader.read_id_array()));
+            } break;
+
+            case CaptureRecordType::ResetFences: {
+                device.reset_fences(get_objects<RhiFence>(reader.read_id_array()));
+            } break;
+
+            case CaptureRecordType::DestroyRenderpass:
+                [[fallthrough]];
+            case CaptureRecordType::DestroyFramebuffer:
+                [[fallthrough]];
+            case CaptureRecordType::DestroyPipelineInterface:
+                [[fallthrough]];
+            case CaptureRecordType::DestroyPipeline:
+                [[fallthrough]];
+            case CaptureRecordType::DestroyTexture:
+                [[fallthrough]];
+            case CaptureRecordType::DestroySemaphore:
+                [[fallthrough]];
+            case CaptureRecordType::DestroyFence:
+                [[fallthrough]];
+            case CaptureRecordType::DestroyBuffer: {
+                const auto id = reader.read<uint32_t>();
+                if(const auto* object = objects.find(id)) {
+                    destroy_object(*object);
+                    objects.erase(id);
+                }
+            } break;
+
+            case CaptureRecordType::BeginFrame: {
+                device.begin_frame(reader.read<uint32_t>());
+            } break;
+
+            case CaptureRecordType::AcquireSwapchainImage: {
+                const auto captured_image_idx = reader.read<uint32_t>();
+                auto* image_acquired_semaphore = get_object<RhiSemaphore>(reader.read<uint32_t>());
+                const auto replay_image_idx = device.get_swapchain()->acquire_next_swapchain_image(image_acquired_semaphore,
+                                                                                                   get_frame_allocator());
+
+                remap_swapchain_image(captured_image_idx, replay_image_idx);
+                current_replay_image_idx = replay_image_idx;
+            } break;
+
+            case CaptureRecordType::Present: {
+                // We present the image that the replay device acquired, which might not be the image that was captured
+                static_cast<void>(reader.read<uint32_t>());
+                auto* render_finished_semaphore = get_object<RhiSemaphore>(reader.read<uint32_t>());
+                device.get_swapchain()->present(current_replay_image_idx, render_finished_semaphore);
+
+                current_frame.other_ms += ticks_to_ms(rx::time::qpc_ticks() - start_ticks);
+                frame_statistics.push_back(current_frame);
+                current_frame = {};
+
+                tracing::begin_frame(frame_statistics.size());
+
+                get_frame_allocator()->reset();
+
+                return true;
+            }
+
+            default:
+                logger(rx::log::level::k_error, "Unknown capture record type %u", static_cast<uint32_t>(type));
+                return false;
+        }
+
+        current_frame.other_ms += ticks_to_ms(rx::time::qpc_ticks() - start_ticks);
+
+        return true;
+    }
+
+    uint32_t CaptureReplayer::replay_command_stream(CommandList& cmds, const rx_byte* stream, const rx_size stream_size) {
+        auto* frame_allocator = get_frame_allocator();
+
+        uint32_t num_commands = 0;
+
+        CaptureReader reader{stream, stream_size, allocator};
+        while(!reader.is_at_end() && reader.is_valid()) {
+            const auto header = reader.read<HeadlessCommandHeader>();
+            num_commands++;
+
+            switch(header.type) {
+                case HeadlessCommandType::ResourceBarriers: {
+                    const auto command = reader.read<HeadlessResourceBarriersCommand>();
+
+                    rx::vector<RhiResourceBarrier> barriers{frame_allocator};
+                    barriers.reserve(command.num_barriers);
+
+                    for(uint32_t i = 0; i < command.num_barriers && reader.is_valid(); i++) {
+                        const auto captured_barrier = reader.read<HeadlessBarrier>();
+
+                        RhiResourceBarrier barrier{};
+                        barrier.resource_to_barrier = get_object<RhiResource>(captured_barrier.resource);
+                        barrier.access_before_barrier = captured_barrier.access_before_barrier;
+                        barrier.access_after_barrier = captured_barrier.access_after_barrier;
+                        barrier.old_state = captured_barrier.old_state;
+                        barrier.new_state = captured_barrier.new_state;
+                        barrier.source_queue = captured_barrier.source_queue;
+                        barrier.destination_queue = captured_barrier.destination_queue;
+
+                        if(barrier.resource_to_barrier == nullptr) {
+                            continue;
+                        }
+
+                        if(barrier.resource_to_barrier->type == ResourceType::Image) {
+                            barrier.image_memory_barrier.aspect = captured_barrier.aspect;
+
+                        } else {
+                            barrier.buffer_memory_barrier.offset = captured_barrier.offset;
+                            barrier.buffer_memory_barrier.size = captured_barrier.size;
+                        }
+
+                        barriers.push_back(barrier);
+                    }
+
+                    cmds.resource_barriers(command.stages_before_barrier, command.stages_after_barrier, barriers);
+                } break;
+
+                case HeadlessCommandType::CopyBuffer: {
+                    const auto command = reader.read<HeadlessCopyBufferCommand>();
+                    cmds.copy_buffer(get_object<RhiBuffer>(command.destination_buffer),
+                                     command.destination_offset,
+                                     get_object<RhiBuffer>(command.source_buffer),
+                                     command.source_offset,
+                                     command.num_bytes);
+                } break;
+
+                case HeadlessCommandType::UploadDataToImage: {
+                    const auto command = reader.read<HeadlessUploadDataToImageCommand>();
+                    const auto* data = reader.read_bytes(command.width * command.height * command.bytes_per_pixel);
+
+                    if(data != nullptr) {
+                        cmds.upload_data_to_image(get_object<RhiImage>(command.image),
+                                                  command.width,
+                                                  command.height,
+                                                  command.bytes_per_pixel,
+                                                  get_object<RhiBuffer>(command.staging_buffer),
+                                                  data);
+                    }
+                } break;
+
+                case HeadlessCommandType::ExecuteCommandLists: {
+                    const auto command = reader.read<HeadlessExecuteCommandListsCommand>();
+
+                    rx::vector<CommandList*> secondary_lists{frame_allocator};
+                    secondary_lists.reserve(command.num_lists);
+
+                    for(uint32_t i = 0; i < command.num_lists && reader.is_valid(); i++) {
+                        const auto secondary_header = reader.read<HeadlessSecondaryCommandListHeader>();
+                        const auto* secondary_stream = reader.read_bytes(secondary_header.stream_size);
+                        if(secondary_stream == nullptr) {
+                            break;
+                        }
+
+                        auto* secondary_list = device.create_command_list(0,
+                                                                          QueueType::Graphics,
+                                                                          CommandList::Level::Secondary,
+                                                                          frame_allocator,
+                                                                          get_object<RhiRenderpass>(secondary_header.renderpass),
+                                                                          get_object<RhiFramebuffer>(secondary_header.framebuffer),
+                                                                          secondary_header.subpass);
+                        num_commands += replay_command_stream(*secondary_list, secondary_stream, secondary_header.stream_size);
+
+                        secondary_lists.push_back(secondary_list);
+                    }
+
+                    cmds.execute_command_lists(secondary_lists);
+                } break;
+
+                case HeadlessCommandType::BeginRenderpass: {
+                    const auto command = reader.read<HeadlessBeginRenderpassCommand>();
+                    cmds.begin_renderpass(get_object<RhiRenderpass>(command.renderpass),
+                                          get_object<RhiFramebuffer>(command.framebuffer),
+                                          command.contents);
+                } break;
+
+                case HeadlessCommandType::NextSubpass: {
+                    const auto command = reader.read<HeadlessNextSubpassCommand>();
+                    cmds.next_subpass(command.contents);
+                } break;
+
+                case HeadlessCommandType::EndRenderpass: {
+                    cmds.end_renderpass();
+                } break;
+
+                case HeadlessCommandType::BindPipeline: {
+                    const auto command = reader.read<HeadlessBindPipelineCommand>();
+                    cmds.bind_pipeline(get_object<RhiPipeline>(command.pipeline));
+                } break;
+
+                case HeadlessCommandType::BindDescriptorSets: {
+                    const auto command = reader.read<HeadlessBindDescriptorSetsCommand>();
+
+                    rx::vector<RhiDescriptorSet*> sets{frame_allocator};
+                    sets.reserve(command.num_sets);
+                    for(uint32_t i = 0; i < command.num_sets && reader.is_valid(); i++) {
+                        sets.push_back(get_object<RhiDescriptorSet>(reader.read<uint32_t>()));
+                    }
+
+                    cmds.bind_descriptor_sets(sets, get_object<RhiPipelineInterface>(command.pipeline_interface));
+                } break;
+
+                case HeadlessCommandType::BindVertexBuffers: {
+                    const auto command = reader.read<HeadlessBindVertexBuffersCommand>();
+
+                    rx::vector<RhiBuffer*> buffers{frame_allocator};
+                    buffers.reserve(command.num_buffers);
+                    for(uint32_t i = 0; i < command.num_buffers && reader.is_valid(); i++) {
+                        buffers.push_back(get_object<RhiBuffer>(reader.read<uint32_t>()));
+                    }
+
+                    cmds.bind_vertex_buffers(buffers);
+                } break;
+
+                case HeadlessCommandType::BindIndexBuffer: {
+                    const auto command = reader.read<HeadlessBindIndexBufferCommand>();
+                    cmds.bind_index_buffer(get_object<RhiBuffer>(command.buffer), command.index_type);
+                } break;
+
+                case HeadlessCommandType::DrawIndexedMesh: {
+                    const auto command = reader.read<HeadlessDrawIndexedMeshCommand>();
+                    cmds.draw_indexed_mesh(command.num_indices, command.offset, command.num_instances);
+                } break;
+
+                case HeadlessCommandType::SetScissorRect: {
+                    const auto command = reader.read<HeadlessSetScissorRectCommand>();
+                    cmds.set_scissor_rect(command.x, command.y, command.width, command.height);
+                } break;
+
+                case HeadlessCommandType::SetViewport: {
+                    const auto command = reader.read<HeadlessSetViewportCommand>();
+                    cmds.set_viewport(command.x, command.y, command.width, command.height);
+                } break;
+
+                case HeadlessCommandType::Dispatch: {
+                    const auto command = reader.read<HeadlessDispatchCommand>();
+                    cmds.dispatch(command.num_groups_x, command.num_groups_y, command.num_groups_z);
+                } break;
+
+                case HeadlessCommandType::DispatchIndirect: {
+                    const auto command = reader.read<HeadlessDispatchIndirectCommand>();
+                    cmds.dispatch_indirect(get_object<RhiBuffer>(command.buffer), command.offset);
+                } break;
+
+                default: {
+                    logger(rx::log::level::k_error, "Unknown command type %u", static_cast<uint32_t>(header.type));
+
+                    // The header knows how big the command is, so we can skip over it
+                    (void) reader.read_bytes(header.size);
+                } break;
+            }
+        }
+
+        if(!reader.is_valid()) {
+            logger(rx::log::level::k_error, "Command stream ends in the middle of a command");
+        }
+
+        return num_commands;
+    }
+
+    void CaptureReplayer::replay_submit(CaptureReader& reader) {
+        const auto queue = reader.read<QueueType>();
+        auto* fence = get_object<RhiFence>(reader.read<uint32_t>());
+        const auto wait_semaphores = get_objects<RhiSemaphore>(reader.read_id_array());
+        const auto signal_semaphores = get_objects<RhiSemaphore>(reader.read_id_array());
+        (void) reader.read<uint32_t>(); // The number of commands. We count them ourselves while replaying
+
+        rx_size stream_size;
+        const auto* stream = reader.read_byte_array(stream_size);
+        if(stream == nullptr) {
+            return;
+        }
+
+        const auto record_start_ticks = rx::time::qpc_ticks();
+
+        CommandList* cmds;
+        {
+            NOVA_TRACE_SCOPE("Replay", "RecordCommandList");
+            cmds = device.create_command_list(0, queue, CommandList::Level::Primary, get_frame_allocator());
+            current_frame.num_commands += replay_command_stream(*cmds, stream, stream_size);
+        }
+
+        const auto submit_start_ticks = rx::time::qpc_ticks();
+
+        {
+            NOVA_TRACE_SCOPE("Replay", "SubmitCommandList");
+            device.submit_command_list(cmds, queue, fence, wait_semaphores, signal_semaphores);
+        }
+
+        const auto submit_end_ticks = rx::time::qpc_ticks();
+
+        current_frame.num_submissions++;
+        current_frame.record_ms += ticks_to_ms(submit_start_ticks - record_start_ticks);
+        current_frame.submit_ms += ticks_to_ms(submit_end_ticks - submit_start_ticks);
+    }
+
+    void CaptureReplayer::replay_update_descriptor_sets(CaptureReader& reader) {
+        rx::vector<RhiDescriptorSetWrite> writes{allocator};
+
+        const auto num_writes = reader.read<uint32_t>();
+        writes.reserve(num_writes);
+
+        for(uint32_t i = 0; i < num_writes && reader.is_valid(); i++) {
+            RhiDescriptorSetWrite write{};
+            write.set = get_object<RhiDescriptorSet>(reader.read<uint32_t>());
+            write.binding = reader.read<uint32_t>();
+            write.type = reader.read<DescriptorType>();
+            write.resources = rx::vector<RhiDescriptorResourceInfo>{allocator};
+
+            const auto num_resources = reader.read<uint32_t>();
+            write.resources.reserve(num_resources);
+
+            for(uint32_t resource_idx = 0; resource_idx < num_resources && reader.is_valid(); resource_idx++) {
+                RhiDescriptorResourceInfo resource{};
+
+                switch(write.type) {
+                    case DescriptorType::CombinedImageSampler:
+                        [[fallthrough]];
+                    case DescriptorType::Texture:
+                        [[fallthrough]];
+                    case DescriptorType::InputAttachment:
+                        [[fallthrough]];
+                    case DescriptorType::StorageImage:
+                        resource.image_info.image = get_object<RhiImage>(reader.read<uint32_t>());
+                        resource.image_info.format.pixel_format = reader.read<PixelFormat>();
+                        resource.image_info.format.dimension_type = reader.read<renderpack::TextureDimensionType>();
+                        resource.image_info.format.width = reader.read<float>();
+                        resource.image_info.format.height = reader.read<float>();
+                        break;
+
+                    case DescriptorType::UniformBuffer:
+                        [[fallthrough]];
+                    case DescriptorType::StorageBuffer:
+                        resource.buffer_info.buffer = get_object<RhiBuffer>(reader.read<uint32_t>());
+                        break;
+
+                    case DescriptorType::Sampler:
+                        resource.sampler_info.sampler = get_object<RhiSampler>(reader.read<uint32_t>());
+                        break;
+                }
+
+                write.resources.push_back(resource);
+            }
+
+            writes.push_back(write);
+        }
+
+        device.update_descriptor_sets(writes);
+    }
+
+    void CaptureReplayer::remap_swapchain_image(const uint32_t captured_image_idx, const uint32_t replay_image_idx) {
+        if(captured_image_idx >= swapchain_image_ids.size()) {
+            logger(rx::log::level::k_error, "Capture acquired swapchain image %u, which doesn't exist", captured_image_idx);
+            return;
+        }
+
+        auto* swapchain = device.get_swapchain();
+        const auto image_idx = replay_image_idx % swapchain->get_num_images();
+
+        const auto& ids = swapchain_image_ids[captured_image_idx];
+        add_object(ids.image, ReplayedObjectType::SwapchainObject, swapchain->get_image(image_idx));
+        add_object(ids.framebuffer, ReplayedObjectType::SwapchainObject, swapchain->get_framebuffer(image_idx));
+        add_object(ids.fence, ReplayedObjectType::SwapchainObject, swapchain->get_fence(image_idx));
+    }
+
+    void CaptureReplayer::add_object(const uint32_t id, const ReplayedObjectType type, void* object) {
+        if(id == 0 || object == nullptr) {
+            return;
+        }
+
+        objects.erase(id);
+        objects.insert(id, ReplayedObject{type, object});
+    }
+
+    rx::memory::bump_point_allocator* CaptureReplayer::get_frame_allocator() const {
+        return frame_allocators[frame_statistics.size() % frame_allocators.size()];
+    }
+
+    void CaptureReplayer::destroy_object(const ReplayedObject& object) {
+        switch(object.type) {
+            case ReplayedObjectType::Renderpass:
+                device.destroy_renderpass(static_cast<RhiRenderpass*>(object.object), allocator);
+                break;
+
+            case ReplayedObjectType::Framebuffer:
+                device.destroy_framebuffer(static_cast<RhiFramebuffer*>(object.object), allocator);
+                break;
+
+            case ReplayedObjectType::PipelineInterface:
+                device.destroy_pipeline_interface(static_cast<RhiPipelineInterface*>(object.object), allocator);
+                break;
+
+            case ReplayedObjectType::Pipeline:
+                device.destroy_pipeline(static_cast<RhiPipeline*>(object.object), allocator);
+                break;
+
+            case ReplayedObjectType::Image:
+                device.destroy_texture(static_cast<RhiImage*>(object.object), allocator);
+                break;
+
+            case ReplayedObjectType::Buffer:
+                device.destroy_buffer(static_cast<RhiBuffer*>(object.object), allocator);
+                break;
+
+            case ReplayedObjectType::Semaphore: {
+                rx::vector<RhiSemaphore*> semaphores{allocator};
+                semaphores.push_back(static_cast<RhiSemaphore*>(object.object));
+                device.destroy_semaphores(semaphores, allocator);
+            } break;
+
+            case ReplayedObjectType::Fence: {
+                rx::vector<RhiFence*> fences{allocator};
+                fences.push_back(static_cast<RhiFence*>(object.object));
+                device.destroy_fences(fences, allocator);
+            } break;
+
+            default:
+                // The render device has no way to destroy these objects, or they belong to the swapchain
+                break;
+        }
+    }
+} // namespace nova::renderer::rhi
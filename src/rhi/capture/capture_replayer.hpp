@@ -0,0 +1,193 @@
+#pragma once
+
+#include <rx/core/map.h>
+#include <rx/core/memory/bump_point_allocator.h>
+#include <rx/core/vector.h>
+
+#include "nova_renderer/rhi/device_memory_resource.hpp"
+#include "nova_renderer/rhi/render_device.hpp"
+
+#include "capture_format.hpp"
+#include "capture_serialization.hpp"
+
+namespace nova::renderer::rhi {
+    /*!
+     * \brief How long one replayed frame took
+     */
+    struct ReplayFrameStatistics {
+        uint32_t num_submissions = 0;
+
+        /*!
+         * \brief Number of commands in all the command lists submitted this frame, including commands in secondary command lists
+         */
+        uint32_t num_commands = 0;
+
+        /*!
+         * \brief Time spent creating command lists and recording commands into them
+         */
+        double record_ms = 0;
+
+        /*!
+         * \brief Time spent in `RenderDevice::submit_command_list`
+         */
+        double submit_ms = 0;
+
+        /*!
+         * \brief Time spent on everything else - creating resources, writing to buffers, waiting for fences, acquiring and presenting
+         * swapchain images
+         */
+        double other_ms = 0;
+    };
+
+    /*!
+     * \brief Replays a capture file from a CaptureRenderDevice against any render device
+     *
+     * Every record is replayed as fast as possible, in the order it was captured. Objects are created on the replay device as the
+     * capture creates them, and every object that the capture didn't destroy is destroyed when the replayer is destroyed
+     */
+    class CaptureReplayer {
+    public:
+        CaptureReplayer(RenderDevice& device, rx::memory::allocator* allocator);
+
+        CaptureReplayer(CaptureReplayer&& old) noexcept = delete;
+        CaptureReplayer& operator=(CaptureReplayer&& old) noexcept = delete;
+
+        CaptureReplayer(const CaptureReplayer& other) = delete;
+        CaptureReplayer& operator=(const CaptureReplayer& other) = delete;
+
+        ~CaptureReplayer();
+
+        /*!
+         * \brief Replays all the records in a capture
+         *
+         * \param capture The contents of a capture file
+         *
+         * \return True if the whole capture was replayed, false if the capture is malformed or was made by an incompatible version of
+         * Nova
+         */
+        [[nodiscard]] bool replay(const rx::vector<rx_byte>& capture);
+
+        /*!
+         * \brief Gets the statistics of every frame that's been replayed so far
+         */
+        [[nodiscard]] const rx::vector<ReplayFrameStatistics>& get_frame_statistics() const;
+
+    private:
+        enum class ReplayedObjectType {
+            DeviceMemory,
+            Renderpass,
+            Framebuffer,
+            PipelineInterface,
+            DescriptorPool,
+            DescriptorSet,
+            Pipeline,
+            Buffer,
+            Sampler,
+            Image,
+            Semaphore,
+            Fence,
+
+            /*!
+             * \brief An image, framebuffer, or fence that's owned by the replay device's swapchain
+             */
+            SwapchainObject,
+        };
+
+        struct ReplayedObject {
+            ReplayedObjectType type;
+            void* object;
+        };
+
+        /*!
+         * \brief The capture IDs of the objects for one swapchain image
+         */
+        struct SwapchainImageIds {
+            uint32_t image;
+            uint32_t framebuffer;
+            uint32_t fence;
+        };
+
+        RenderDevice& device;
+
+        rx::memory::allocator* allocator;
+
+        /*!
+         * \brief All the objects that have been replayed, keyed by their capture IDs
+         */
+        rx::map<uint32_t, ReplayedObject> objects;
+
+        rx::map<RhiDeviceMemory*, DeviceMemoryResource*> memory_resources;
+
+        rx::vector<SwapchainImageIds> swapchain_image_ids;
+
+        rx::vector<ReplayFrameStatistics> frame_statistics;
+
+        ReplayFrameStatistics current_frame;
+
+        /*!
+         * \brief The swapchain image that the replay device acquired most recently
+         */
+        uint32_t current_replay_image_idx = 0;
+
+        /*!
+         * \brief Memory for command lists and other per-frame data. Like NovaRenderer, we use a different allocator for each in-flight
+         * frame
+         */
+        rx::vector<rx::memory::bump_point_allocator*> frame_allocators;
+
+        rx_byte* frame_memory;
+
+        [[nodiscard]] bool replay_record(CaptureRecordType type, CaptureReader& reader);
+
+        /*!
+         * \brief Records the commands in a command stream into a command list
+         *
+         * \return The number of commands in the stream, including the commands in any secondary command lists
+         */
+        uint32_t replay_command_stream(CommandList& cmds, const rx_byte* stream, rx_size stream_size);
+
+        void replay_submit(CaptureReader& reader);
+
+        void replay_update_descriptor_sets(CaptureReader& reader);
+
+        /*!
+         * \brief Points the capture IDs of a swapchain image at the replay device's swapchain image, since the replay device might
+         * acquire a different swapchain image than the captured device did
+         */
+        void remap_swapchain_image(uint32_t captured_image_idx, uint32_t replay_image_idx);
+
+        void add_object(uint32_t id, ReplayedObjectType type, void* object);
+
+        /*!
+         * \brief Gets the replayed object with the given capture ID, or nullptr if there's no such object
+         */
+        template <typename ObjectType>
+        [[nodiscard]] ObjectType* get_object(uint32_t id) const;
+
+        template <typename ObjectType>
+        [[nodiscard]] rx::vector<ObjectType*> get_objects(const rx::vector<uint32_t>& ids) const;
+
+        [[nodiscard]] rx::memory::bump_point_allocator* get_frame_allocator() const;
+
+        void destroy_object(const ReplayedObject& object);
+    };
+
+    template <typename ObjectType>
+    ObjectType* CaptureReplayer::get_object(const uint32_t id) const {
+        if(const auto* object = objects.find(id)) {
+            return static_cast<ObjectType*>(object->object);
+        }
+
+        return nullptr;
+    }
+
+    template <typename ObjectType>
+    rx::vector<ObjectType*> CaptureReplayer::get_objects(const rx::vector<uint32_t>& ids) const {
+        rx::vector<ObjectType*> replayed_objects{allocator};
+        replayed_objects.reserve(ids.size());
+
+        ids.each_fwd([&](const uint32_t id) { replayed_objects.push_back(get_object<ObjectType>(id)); });
+
+        return replayed_objects;
+    }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,386 @@
+#include "capture_serialization.hpp"
+
+namespace nova::renderer::rhi {
+#pragma region CaptureWriter
+    CaptureWriter::CaptureWriter(rx::memory::allocator* allocator) : data{allocator} {}
+
+    void CaptureWriter::write_bytes(const void* bytes, const rx_size size) {
+        if(size == 0) {
+            return;
+        }
+
+        const rx_size old_size = data.size();
+        data.resize(old_size + size, rx::utility::uninitialized{});
+        memcpy(data.data() + old_size, bytes, size);
+    }
+
+    void CaptureWriter::write_byte_array(const void* bytes, const rx_size size) {
+        write(static_cast<uint64_t>(size));
+        write_bytes(bytes, size);
+    }
+
+    void CaptureWriter::write_string(const rx::string& string) { write_byte_array(string.data(), string.size()); }
+
+    void CaptureWriter::write_id_array(const rx::vector<uint32_t>& ids) {
+        write(static_cast<uint32_t>(ids.size()));
+        write_bytes(ids.data(), ids.size() * sizeof(uint32_t));
+    }
+
+    void CaptureWriter::write_texture_attachment_info(const renderpack::TextureAttachmentInfo& info) {
+        write_string(info.name);
+        write(info.pixel_format);
+        write(info.clear);
+    }
+
+    void CaptureWriter::write_texture_attachments(const rx::vector<renderpack::TextureAttachmentInfo>& attachments,
+                                                  const rx::optional<renderpack::TextureAttachmentInfo>& depth_attachment) {
+        write(static_cast<uint32_t>(attachments.size()));
+        attachments.each_fwd([&](const renderpack::TextureAttachmentInfo& info) { write_texture_attachment_info(info); });
+
+        write(depth_attachment.has_value());
+        if(depth_attachment) {
+            write_texture_attachment_info(*depth_attachment);
+        }
+    }
+
+    void CaptureWriter::write_texture_create_info(const renderpack::TextureCreateInfo& info) {
+        write_string(info.name);
+        write(info.usage);
+        write(info.format.pixel_format);
+        write(info.format.dimension_type);
+        write(info.format.width);
+        write(info.format.height);
+    }
+
+    void CaptureWriter::write_renderpass_create_info(const renderpack::RenderPassCreateInfo& info) {
+        write_string(info.name);
+        write_string_array(info.texture_inputs);
+
+        write(static_cast<uint32_t>(info.input_attachments.size()));
+        info.input_attachments.each_fwd([&](const renderpack::TextureAttachmentInfo& input) { write_texture_attachment_info(input); });
+
+        write_texture_attachments(info.texture_outputs, info.depth_texture);
+        write_string_array(info.input_buffers);
+        write_string_array(info.output_buffers);
+        write_string_array(info.pipeline_names);
+    }
+
+    void CaptureWriter::write_resource_bindings(const rx::map<rx::string, RhiResourceBindingDescription>& bindings) {
+        write(static_cast<uint32_t>(bindings.size()));
+        bindings.each_pair([&](const rx::string& name, const RhiResourceBindingDescription& binding) {
+            write_string(name);
+            write(binding);
+        });
+    }
+
+    void CaptureWriter::write_pipeline_state_create_info(const PipelineStateCreateInfo& info) {
+        write_string(info.name);
+
+        write_shader_source(info.vertex_shader);
+
+        write(info.geometry_shader.has_value());
+        if(info.geometry_shader) {
+            write_shader_source(*info.geometry_shader);
+        }
+
+        write(info.pixel_shader.has_value());
+        if(info.pixel_shader) {
+            write_shader_source(*info.pixel_shader);
+        }
+
+        write(static_cast<uint32_t>(info.vertex_fields.size()));
+        info.vertex_fields.each_fwd([&](const RhiVertexField& field) {
+            write_string(field.name);
+            write(field.format);
+        });
+
+        write(info.viewport_size.x);
+        write(info.viewport_size.y);
+        write(info.enable_scissor_test);
+        write(info.topology);
+        write(info.rasterizer_state);
+        write(info.multisampling_state.has_value());
+
+        write(info.depth_state.has_value());
+        if(info.depth_state) {
+            write(info.depth_state->enable_depth_write);
+            write(info.depth_state->compare_op);
+
+            write(info.depth_state->bounds_test_state.has_value());
+            if(info.depth_state->bounds_test_state) {
+                write(*info.depth_state->bounds_test_state);
+            }
+        }
+
+        write(info.stencil_state.has_value());
+        if(info.stencil_state) {
+            write(*info.stencil_state);
+        }
+
+        write(info.blend_state.has_value());
+        if(info.blend_state) {
+            write(static_cast<uint32_t>(info.blend_state->render_target_states.size()));
+            write_bytes(info.blend_state->render_target_states.data(),
+                        info.blend_state->render_target_states.size() * sizeof(RenderTargetBlendState));
+
+            write(info.blend_state->blend_constants.x);
+            write(info.blend_state->blend_constants.y);
+            write(info.blend_state->blend_constants.z);
+            write(info.blend_state->blend_constants.w);
+        }
+
+        write(info.enable_color_write);
+        write(info.enable_alpha_write);
+
+        write_texture_attachments(info.color_attachments, info.depth_texture);
+    }
+
+    void CaptureWriter::write_compute_pipeline_create_info(const ComputePipelineCreateInfo& info) {
+        write_string(info.name);
+        write_shader_source(info.compute_shader);
+        write(info.workgroup_count);
+    }
+
+    const rx::vector<rx_byte>& CaptureWriter::get_data() const { return data; }
+
+    void CaptureWriter::clear() { data.clear(); }
+
+    void CaptureWriter::write_string_array(const rx::vector<rx::string>& strings) {
+        write(static_cast<uint32_t>(strings.size()));
+        strings.each_fwd([&](const rx::string& string) { write_string(string); });
+    }
+
+    void CaptureWriter::write_shader_source(const ShaderSource& source) {
+        write_string(source.filename);
+        write_byte_array(source.source.data(), source.source.size() * sizeof(uint32_t));
+    }
+#pragma endregion
+
+#pragma region CaptureReader
+    CaptureReader::CaptureReader(const rx_byte* data, const rx_size size, rx::memory::allocator* allocator)
+        : data(data), size(size), allocator(allocator) {}
+
+    const rx_byte* CaptureReader::read_bytes(const rx_size num_bytes) {
+        if(!valid || num_bytes > size - read_pos) {
+            valid = false;
+            return nullptr;
+        }
+
+        const rx_byte* bytes = data + read_pos;
+        read_pos += num_bytes;
+
+        return bytes;
+    }
+
+    const rx_byte* CaptureReader::read_byte_array(rx_size& num_bytes) {
+        num_bytes = static_cast<rx_size>(read<uint64_t>());
+
+        const rx_byte* bytes = read_bytes(num_bytes);
+        if(bytes == nullptr) {
+            num_bytes = 0;
+        }
+
+        return bytes;
+    }
+
+    rx::string CaptureReader::read_string() {
+        rx_size length;
+        const auto* chars = reinterpret_cast<const char*>(read_byte_array(length));
+        if(chars == nullptr) {
+            return rx::string{allocator};
+        }
+
+        return rx::string{allocator, chars, length};
+    }
+
+    rx::vector<uint32_t> CaptureReader::read_id_array() {
+        const auto num_ids = read<uint32_t>();
+
+        rx::vector<uint32_t> ids{allocator};
+        const auto* bytes = read_bytes(num_ids * sizeof(uint32_t));
+        if(bytes != nullptr) {
+            ids.resize(num_ids, rx::utility::uninitialized{});
+            memcpy(ids.data(), bytes, num_ids * sizeof(uint32_t));
+        }
+
+        return ids;
+    }
+
+    renderpack::TextureAttachmentInfo CaptureReader::read_texture_attachment_info() {
+        renderpack::TextureAttachmentInfo info{};
+        info.name = read_string();
+        info.pixel_format = read<PixelFormat>();
+        info.clear = read<bool>();
+
+        return info;
+    }
+
+    void CaptureReader::read_texture_attachments(rx::vector<renderpack::TextureAttachmentInfo>& attachments,
+                                                 rx::optional<renderpack::TextureAttachmentInfo>& depth_attachment) {
+        const auto num_attachments = read<uint32_t>();
+        for(uint32_t i = 0; i < num_attachments && valid; i++) {
+            attachments.push_back(read_texture_attachment_info());
+        }
+
+        if(read<bool>()) {
+            depth_attachment = read_texture_attachment_info();
+        }
+    }
+
+    renderpack::TextureCreateInfo CaptureReader::read_texture_create_info() {
+        renderpack::TextureCreateInfo info{};
+        info.name = read_string();
+        info.usage = read<renderpack::ImageUsage>();
+        info.format.pixel_format = read<PixelFormat>();
+        info.format.dimension_type = read<renderpack::TextureDimensionType>();
+        info.format.width = read<float>();
+        info.format.height = read<float>();
+
+        return info;
+    }
+
+    renderpack::RenderPassCreateInfo CaptureReader::read_renderpass_create_info() {
+        renderpack::RenderPassCreateInfo info{};
+        info.name = read_string();
+        info.texture_inputs = read_string_array();
+
+        const auto num_input_attachments = read<uint32_t>();
+        for(uint32_t i = 0; i < num_input_attachments && valid; i++) {
+            info.input_attachments.push_back(read_texture_attachment_info());
+        }
+
+        read_texture_attachments(info.texture_outputs, info.depth_texture);
+        info.input_buffers = read_string_array();
+        info.output_buffers = read_string_array();
+        info.pipeline_names = read_string_array();
+
+        return info;
+    }
+
+    rx::map<rx::string, RhiResourceBindingDescription> CaptureReader::read_resource_bindings() {
+        rx::map<rx::string, RhiResourceBindingDescription> bindings{allocator};
+
+        const auto num_bindings = read<uint32_t>();
+        for(uint32_t i = 0; i < num_bindings && valid; i++) {
+            const auto name = read_string();
+            bindings.insert(name, read<RhiResourceBindingDescription>());
+        }
+
+        return bindings;
+    }
+
+    ComputePipelineCreateInfo CaptureReader::read_compute_pipeline_create_info() {
+        ComputePipelineCreateInfo info{};
+        info.name = read_string();
+        info.compute_shader = read_shader_source();
+        info.workgroup_count = read<glm::uvec3>();
+
+        return info;
+    }
+
+    PipelineStateCreateInfo CaptureReader::read_pipeline_state_create_info() {
+        PipelineStateCreateInfo info{};
+        info.name = read_string();
+
+        info.vertex_shader = read_shader_source();
+
+        if(read<bool>()) {
+            info.geometry_shader = read_shader_source();
+        }
+
+        if(read<bool>()) {
+            info.pixel_shader = read_shader_source();
+        }
+
+        const auto num_vertex_fields = read<uint32_t>();
+        for(uint32_t i = 0; i < num_vertex_fields && valid; i++) {
+            RhiVertexField field{};
+            field.name = read_string();
+            field.format = read<VertexFieldFormat>();
+
+            info.vertex_fields.push_back(field);
+        }
+
+        info.viewport_size.x = read<float>();
+        info.viewport_size.y = read<float>();
+        info.enable_scissor_test = read<bool>();
+        info.topology = read<PrimitiveTopology>();
+        info.rasterizer_state = read<RasterizerState>();
+
+        if(read<bool>()) {
+            info.multisampling_state = MultisamplingState{};
+        }
+
+        if(read<bool>()) {
+            DepthState depth_state{};
+            depth_state.enable_depth_write = read<bool>();
+            depth_state.compare_op = read<CompareOp>();
+
+            if(read<bool>()) {
+                depth_state.bounds_test_state = read<DepthBoundsTestState>();
+            }
+
+            info.depth_state = depth_state;
+
+        } else {
+            info.depth_state = rx::nullopt;
+        }
+
+        if(read<bool>()) {
+            info.stencil_state = read<StencilState>();
+        }
+
+        if(read<bool>()) {
+            BlendState blend_state{};
+
+            const auto num_render_targets = read<uint32_t>();
+            for(uint32_t i = 0; i < num_render_targets && valid; i++) {
+                blend_state.render_target_states.push_back(read<RenderTargetBlendState>());
+            }
+
+            blend_state.blend_constants.x = read<float>();
+            blend_state.blend_constants.y = read<float>();
+            blend_state.blend_constants.z = read<float>();
+            blend_state.blend_constants.w = read<float>();
+
+            info.blend_state = blend_state;
+        }
+
+        info.enable_color_write = read<bool>();
+        info.enable_alpha_write = read<bool>();
+
+        read_texture_attachments(info.color_attachments, info.depth_texture);
+
+        return info;
+    }
+
+    bool CaptureReader::is_valid() const { return valid; }
+
+    bool CaptureReader::is_at_end() const { return read_pos == size; }
+
+    rx::vector<rx::string> CaptureReader::read_string_array() {
+        rx::vector<rx::string> strings{allocator};
+
+        const auto num_strings = read<uint32_t>();
+        for(uint32_t i = 0; i < num_strings && valid; i++) {
+            strings.push_back(read_string());
+        }
+
+        return strings;
+    }
+
+    ShaderSource CaptureReader::read_shader_source() {
+        ShaderSource source{};
+        source.filename = read_string();
+
+        rx_size num_bytes;
+        const auto* bytes = read_byte_array(num_bytes);
+        if(bytes != nullptr) {
+            source.source.resize(num_bytes / sizeof(uint32_t), rx::utility::uninitialized{});
+            memcpy(source.source.data(), bytes, source.source.size() * sizeof(uint32_t));
+        }
+
+        return source;
+    }
+#pragma endregion
+} // namespace nova::renderer::rhi
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <string.h>
+#include <type_traits>
+
+#include <rx/core/map.h>
+#include <rx/core/optional.h>
+#include <rx/core/string.h>
+#include <rx/core/vector.h>
+
+#include "nova_renderer/renderpack_data.hpp"
+#include "nova_renderer/rhi/pipeline_create_info.hpp"
+#include "nova_renderer/rhi/rhi_types.hpp"
+
+namespace nova::renderer::rhi {
+    /*!
+     * \brief Writes values into a byte array in the layout that capture files use
+     *
+     * Trivially copyable values are written as their raw bytes. Everything else - strings, arrays, and the create info structs - is
+     * written field by field, with arrays prefixed by their number of elements
+     */
+    class CaptureWriter {
+    public:
+        explicit CaptureWriter(rx::memory::allocator* allocator);
+
+        template <typename ValueType>
+        void write(const ValueType& value);
+
+        void write_bytes(const void* data, rx_size size);
+
+        /*!
+         * \brief Writes a uint64 size, followed by `size` bytes of data
+         */
+        void write_byte_array(const void* data, rx_size size);
+
+        void write_string(const rx::string& string);
+
+        void write_id_array(const rx::vector<uint32_t>& ids);
+
+        void write_texture_attachment_info(const renderpack::TextureAttachmentInfo& info);
+
+        void write_texture_attachments(const rx::vector<renderpack::TextureAttachmentInfo>& attachments,
+                                       const rx::optional<renderpack::TextureAttachmentInfo>& depth_attachment);
+
+        void write_texture_create_info(const renderpack::TextureCreateInfo& info);
+
+        void write_renderpass_create_info(const renderpack::RenderPassCreateInfo& info);
+
+        void write_resource_bindings(const rx::map<rx::string, RhiResourceBindingDescription>& bindings);
+
+        void write_pipeline_state_create_info(const PipelineStateCreateInfo& info);
+
+        void write_compute_pipeline_create_info(const ComputePipelineCreateInfo& info);
+
+        [[nodiscard]] const rx::vector<rx_byte>& get_data() const;
+
+        /*!
+         * \brief Removes everything that's been written, keeping the memory around for the next record
+         */
+        void clear();
+
+    private:
+        rx::vector<rx_byte> data;
+
+        void write_string_array(const rx::vector<rx::string>& strings);
+
+        void write_shader_source(const ShaderSource& source);
+    };
+
+    /*!
+     * \brief Reads values that a CaptureWriter wrote
+     *
+     * Reading past the end of the data doesn't crash. Instead, the reader becomes invalid and returns default values from then on, so
+     * callers can read a whole record and check `is_valid` once at the end
+     */
+    class CaptureReader {
+    public:
+        CaptureReader(const rx_byte* data, rx_size size, rx::memory::allocator* allocator);
+
+        template <typename ValueType>
+        [[nodiscard]] ValueType read();
+
+        /*!
+         * \brief Reads `size` bytes, returning a pointer to them inside the reader's data
+         */
+        [[nodiscard]] const rx_byte* read_bytes(rx_size size);
+
+        /*!
+         * \brief Reads a byte array that CaptureWriter::write_byte_array wrote, returning a pointer to its data inside the reader's data
+         */
+        [[nodiscard]] const rx_byte* read_byte_array(rx_size& size);
+
+        [[nodiscard]] rx::string read_string();
+
+        [[nodiscard]] rx::vector<uint32_t> read_id_array();
+
+        [[nodiscard]] renderpack::TextureAttachmentInfo read_texture_attachment_info();
+
+        void read_texture_attachments(rx::vector<renderpack::TextureAttachmentInfo>& attachments,
+                                      rx::optional<renderpack::TextureAttachmentInfo>& depth_attachment);
+
+        [[nodiscard]] renderpack::TextureCreateInfo read_texture_create_info();
+
+        [[nodiscard]] renderpack::RenderPassCreateInfo read_renderpass_create_info();
+
+        [[nodiscard]] rx::map<rx::string, RhiResourceBindingDescription> read_resource_bindings();
+
+        [[nodiscard]] PipelineStateCreateInfo read_pipeline_state_create_info();
+
+        [[nodiscard]] ComputePipelineCreateInfo read_compute_pipeline_create_info();
+
+        [[nodiscard]] bool is_valid() const;
+
+        [[nodiscard]] bool is_at_end() const;
+
+    private:
+        const rx_byte* data;
+
+        rx_size size;
+
+        rx_size read_pos = 0;
+
+        bool valid = true;
+
+        rx::memory::allocator* allocator;
+
+        [[nodiscard]] rx::vector<rx::string> read_string_array();
+
+        [[nodiscard]] ShaderSource read_shader_source();
+    };
+
+    template <typename ValueType>
+    void CaptureWriter::write(const ValueType& value) {
+        static_assert(std::is_trivially_copyable_v<ValueType>, "Only trivially copyable values may be written directly");
+
+        write_bytes(&value, sizeof(ValueType));
+    }
+
+    template <typename ValueType>
+    ValueType CaptureReader::read() {
+        static_assert(std::is_trivially_copyable_v<ValueType>, "Only trivially copyable values may be read directly");
+
+        ValueType value{};
+
+        if(const auto* bytes = read_bytes(sizeof(ValueType)); bytes != nullptr) {
+            memcpy(&value, bytes, sizeof(ValueType));
+        }
+
+        return value;
+    }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,51 @@
+#include "capture_swapchain.hpp"
+
+#include "capture_render_device.hpp"
+
+namespace nova::renderer::rhi {
+    CaptureSwapchain::CaptureSwapchain(Swapchain* inner_swapchain, CaptureRenderDevice* render_device)
+        : Swapchain(inner_swapchain->get_num_images(), inner_swapchain->get_size()),
+          inner_swapchain(inner_swapchain),
+          render_device(render_device) {
+        update_from_inner_swapchain();
+    }
+
+    uint8_t CaptureSwapchain::acquire_next_swapchain_image(RhiSemaphore* image_acquired_semaphore, rx::memory::allocator* allocator) {
+        const auto image_idx = inner_swapchain->acquire_next_swapchain_image(image_acquired_semaphore, allocator);
+
+        out_of_date = inner_swapchain->is_out_of_date();
+        if(!out_of_date) {
+            render_device->on_swapchain_image_acquired(image_idx, image_acquired_semaphore);
+        }
+
+        return image_idx;
+    }
+
+    void CaptureSwapchain::present(const uint32_t image_idx, RhiSemaphore* render_finished_semaphore) {
+        inner_swapchain->present(image_idx, render_finished_semaphore);
+
+        out_of_date = inner_swapchain->is_out_of_date();
+
+        render_device->on_swapchain_image_presented(image_idx, render_finished_semaphore);
+    }
+
+    void CaptureSwapchain::update_from_inner_swapchain() {
+        num_images = inner_swapchain->get_num_images();
+        size = inner_swapchain->get_size();
+        out_of_date = inner_swapchain->is_out_of_date();
+
+        swapchain_images.clear();
+        framebuffers.clear();
+        fences.clear();
+
+        swapchain_images.reserve(num_images);
+        framebuffers.reserve(num_images);
+        fences.reserve(num_images);
+
+        for(uint32_t i = 0; i < num_images; i++) {
+            swapchain_images.push_back(inner_swapchain->get_image(i));
+            framebuffers.push_back(inner_swapchain->get_framebuffer(i));
+            fences.push_back(inner_swapchain->get_fence(i));
+        }
+    }
+} // namespace nova::renderer::rhi
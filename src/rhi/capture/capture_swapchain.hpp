@@ -0,0 +1,35 @@
+#pragma once
+
+#include "nova_renderer/rhi/swapchain.hpp"
+
+namespace nova::renderer::rhi {
+    class CaptureRenderDevice;
+
+    /*!
+     * \brief Swapchain which forwards to the swapchain of another render device, and tells the capture device when frames begin and end
+     *
+     * It has the same images, framebuffers, and fences as the swapchain it wraps
+     */
+    class CaptureSwapchain final : public Swapchain {
+    public:
+        CaptureSwapchain(Swapchain* inner_swapchain, CaptureRenderDevice* render_device);
+
+        ~CaptureSwapchain() override = default;
+
+#pragma region Swapchain implementation
+        uint8_t acquire_next_swapchain_image(RhiSemaphore* image_acquired_semaphore, rx::memory::allocator* allocator) override;
+
+        void present(uint32_t image_idx, RhiSemaphore* render_finished_semaphore) override;
+#pragma endregion
+
+        /*!
+         * \brief Gets the images, framebuffers, and fences of the wrapped swapchain again, after it was recreated
+         */
+        void update_from_inner_swapchain();
+
+    private:
+        Swapchain* inner_swapchain;
+
+        CaptureRenderDevice* render_device;
+    };
+} // namespace nova::renderer::rhi
@@ -1 +1,239 @@
-#include "nova_renderer/command_list.hpp"
+#include "nova_renderer/rhi/command_list.hpp"
+
+namespace nova::renderer::rhi {
+    static PipelineStage get_default_stages(const ResourceState state) {
+        switch(state) {
+            case ResourceState::Undefined:
+                return PipelineStage::TopOfPipe;
+
+            case ResourceState::Common:
+                return PipelineStage::AllCommands;
+
+            case ResourceState::CopySource:
+                [[fallthrough]];
+            case ResourceState::CopyDestination:
+                return PipelineStage::Transfer;
+
+            case ResourceState::UniformBuffer:
+                [[fallthrough]];
+            case ResourceState::ShaderRead:
+                [[fallthrough]];
+            case ResourceState::ShaderWrite:
+                return PipelineStage::VertexShader | PipelineStage::FragmentShader;
+
+            case ResourceState::VertexBuffer:
+                [[fallthrough]];
+            case ResourceState::IndexBuffer:
+                return PipelineStage::VertexInput;
+
+            case ResourceState::IndirectBuffer:
+                return PipelineStage::DrawIndirect;
+
+            case ResourceState::RenderTarget:
+                return PipelineStage::ColorAttachmentOutput;
+
+            case ResourceState::DepthWrite:
+                [[fallthrough]];
+            case ResourceState::DepthRead:
+                return PipelineStage::EarlyFragmentTests | PipelineStage::LateFragmentTests;
+
+            case ResourceState::PresentSource:
+                return PipelineStage::BottomOfPipe;
+
+            default:
+                return PipelineStage::AllCommands;
+        }
+    }
+
+    static ResourceAccess get_access(const ResourceState state) {
+        switch(state) {
+            case ResourceState::CopySource:
+                return ResourceAccess::CopyRead;
+
+            case ResourceState::CopyDestination:
+                return ResourceAccess::CopyWrite;
+
+            case ResourceState::UniformBuffer:
+                return ResourceAccess::UniformRead;
+
+            case ResourceState::VertexBuffer:
+                return ResourceAccess::VertexAttributeRead;
+
+            case ResourceState::IndexBuffer:
+                return ResourceAccess::IndexRead;
+
+            case ResourceState::IndirectBuffer:
+                return ResourceAccess::IndirectCommandRead;
+
+            case ResourceState::ShaderRead:
+                return ResourceAccess::ShaderRead;
+
+            case ResourceState::ShaderWrite:
+                return ResourceAccess::ShaderWrite;
+
+            case ResourceState::RenderTarget:
+                return ResourceAccess::ColorAttachmentWrite;
+
+            case ResourceState::DepthWrite:
+                return ResourceAccess::DepthStencilAttachmentWrite;
+
+            case ResourceState::DepthRead:
+                return ResourceAccess::DepthStencilAttachmentRead;
+
+            case ResourceState::Undefined:
+                [[fallthrough]];
+            case ResourceState::Common:
+                [[fallthrough]];
+            case ResourceState::PresentSource:
+                [[fallthrough]];
+            default:
+                return ResourceAccess::MemoryRead;
+        }
+    }
+
+    static bool contains_stages(const PipelineStage stages, const PipelineStage other_stages) {
+        return (static_cast<uint32_t>(stages) & static_cast<uint32_t>(other_stages)) == static_cast<uint32_t>(other_stages);
+    }
+
+    /*!
+     * \brief Checks if a resource which is used by some stages in some state needs a barrier before other stages can use it in the same
+     * state
+     *
+     * Reads don't need to wait for other reads, but writes to a shader-writable resource always need to wait for the previous writes
+     */
+    static bool needs_barrier_within_state(const ResourceState state, const PipelineStage stages, const PipelineStage new_stages) {
+        return state == ResourceState::ShaderWrite || !contains_stages(stages, new_stages);
+    }
+
+    CommandList::CommandList(rx::memory::allocator* allocator) : pending_transitions{allocator} {}
+
+    void CommandList::transition_resource(RhiResource* resource,
+                                          const ResourceState new_state,
+                                          const QueueType queue,
+                                          const rx::optional<PipelineStage> stages) {
+        const auto new_stages = stages ? *stages : get_default_stages(new_state);
+
+        const auto same_state = resource->state == new_state && resource->queue == queue;
+        if(same_state && !needs_barrier_within_state(new_state, resource->stages, new_stages)) {
+            return;
+        }
+
+        const auto pending_idx = pending_transitions.find_if(
+            [&](const ResourceTransition& transition) { return transition.resource == resource; });
+
+        if(pending_idx != rx::vector<ResourceTransition>::k_npos) {
+            // Nothing used the resource since the pending transition, so the resource can go straight to the new state
+            auto& transition = pending_transitions[pending_idx];
+            transition.new_state = new_state;
+            transition.new_stages = new_stages;
+            transition.new_queue = queue;
+
+        } else if(resource->state == ResourceState::Undefined && resource->type == ResourceType::Buffer) {
+            // There's nothing to wait for, and buffers don't have layouts, so there's nothing to barrier
+
+        } else {
+            pending_transitions.push_back(ResourceTransition{resource,
+                                                             resource->state,
+                                                             get_access(resource->state),
+                                                             resource->stages,
+                                                             resource->queue,
+                                                             new_state,
+                                                             new_stages,
+                                                             queue});
+        }
+
+        resource->state = new_state;
+        resource->stages = same_state ? resource->stages | new_stages : new_stages;
+        resource->queue = queue;
+    }
+
+    void CommandList::alias_resource(const RhiResource* previous_resource, RhiResource* resource) {
+        const auto pending_idx = pending_transitions.find_if(
+            [&](const ResourceTransition& transition) { return transition.resource == resource; });
+
+        if(pending_idx != rx::vector<ResourceTransition>::k_npos) {
+            // The pending transition would have preserved contents which are about to be overwritten, so it has to wait for the previous
+            // resource instead
+            auto& transition = pending_transitions[pending_idx];
+            transition.old_state = ResourceState::Undefined;
+            transition.old_access = get_access(previous_resource->state);
+            transition.old_stages = previous_resource->stages;
+
+        } else {
+            pending_transitions.push_back(ResourceTransition{resource,
+                                                             ResourceState::Undefined,
+                                                             get_access(previous_resource->state),
+                                                             previous_resource->stages,
+                                                             resource->queue,
+                                                             ResourceState::Undefined,
+                                                             previous_resource->stages,
+                                                             resource->queue});
+        }
+
+        resource->state = ResourceState::Undefined;
+        resource->stages = previous_resource->stages;
+    }
+
+    void CommandList::flush_barriers() {
+        if(pending_transitions.is_empty()) {
+            return;
+        }
+
+        rx::vector<RhiResourceBarrier> barriers{pending_transitions.allocator()};
+        barriers.reserve(pending_transitions.size());
+
+        auto stages_before_barrier = static_cast<PipelineStage>(0);
+        auto stages_after_barrier = static_cast<PipelineStage>(0);
+
+        pending_transitions.each_fwd([&](const ResourceTransition& transition) {
+            // Resources in the undefined state have no contents to hand over, so the next queue doesn't need to wait for them
+            const auto is_queue_change = transition.old_queue != transition.new_queue &&
+                                         transition.old_state != ResourceState::Undefined;
+            if(!is_queue_change && transition.old_state == transition.new_state &&
+               !needs_barrier_within_state(transition.new_state, transition.old_stages, transition.new_stages)) {
+                // The resource was transitioned back to where it started
+                return;
+            }
+
+            RhiResourceBarrier barrier;
+            barrier.resource_to_barrier = transition.resource;
+            barrier.old_state = transition.old_state;
+            barrier.new_state = transition.new_state;
+            barrier.access_before_barrier = transition.old_access;
+            barrier.source_queue = is_queue_change ? transition.old_queue : transition.new_queue;
+            barrier.destination_queue = transition.new_queue;
+
+            stages_before_barrier |= transition.old_stages;
+
+            if(is_queue_change) {
+                // Every queue family shares resources, so there's no ownership to transfer. This barrier finishes the old queue's work
+                // and any layout transition before the semaphore that the next queue waits on. The stages after it might not exist on
+                // the old queue, so it waits for the bottom of the pipe instead
+                barrier.access_after_barrier = ResourceAccess::MemoryRead;
+                stages_after_barrier |= PipelineStage::BottomOfPipe;
+
+            } else {
+                barrier.access_after_barrier = get_access(transition.new_state);
+                stages_after_barrier |= transition.new_stages;
+            }
+
+            if(transition.resource->type == ResourceType::Image) {
+                const auto* image = static_cast<RhiImage*>(transition.resource);
+                barrier.image_memory_barrier.aspect = image->is_depth_tex ? ImageAspect::Depth : ImageAspect::Color;
+
+            } else {
+                const auto* buffer = static_cast<RhiBuffer*>(transition.resource);
+                barrier.buffer_memory_barrier.offset = 0;
+                barrier.buffer_memory_barrier.size = buffer->size;
+            }
+
+            barriers.push_back(barrier);
+        });
+
+        pending_transitions.clear();
+
+        if(!barriers.is_empty()) {
+            resource_barriers(stages_before_barrier, stages_after_barrier, barriers);
+        }
+    }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,250 @@
+#include "headless_command_list.hpp"
+
+#include <string.h>
+
+#include "nova_renderer/render_statistics.hpp"
+
+#include "headless_render_device.hpp"
+#include "headless_structs.hpp"
+
+namespace nova::renderer::rhi {
+    HeadlessCommandList::HeadlessCommandList(rx::vector<rx_byte>&& stream,
+                                             const Level level,
+                                             const uint32_t renderpass_id,
+                                             const uint32_t framebuffer_id,
+                                             const uint32_t subpass,
+                                             HeadlessRenderDevice* render_device,
+                                             rx::memory::allocator* allocator)
+        : CommandList(allocator),
+          render_device(*render_device),
+          level(level),
+          renderpass_id(renderpass_id),
+          framebuffer_id(framebuffer_id),
+          subpass(subpass),
+          stream(rx::utility::move(stream)) {}
+
+    void HeadlessCommandList::set_debug_name(const rx::string& name) { debug_name = name; }
+
+    void HeadlessCommandList::resource_barriers(const PipelineStage stages_before_barrier,
+                                                const PipelineStage stages_after_barrier,
+                                                const rx::vector<RhiResourceBarrier>& barriers) {
+        const HeadlessResourceBarriersCommand command{stages_before_barrier,
+                                                      stages_after_barrier,
+                                                      static_cast<uint32_t>(barriers.size())};
+
+        write_header(HeadlessCommandType::ResourceBarriers, sizeof(command) + sizeof(HeadlessBarrier) * barriers.size());
+        write_bytes(&command, sizeof(command));
+
+        barriers.each_fwd([&](const RhiResourceBarrier& barrier) {
+            HeadlessBarrier headless_barrier = {};
+            headless_barrier.resource = get_headless_resource_id(barrier.resource_to_barrier);
+            headless_barrier.access_before_barrier = barrier.access_before_barrier;
+            headless_barrier.access_after_barrier = barrier.access_after_barrier;
+            headless_barrier.old_state = barrier.old_state;
+            headless_barrier.new_state = barrier.new_state;
+            headless_barrier.source_queue = barrier.source_queue;
+            headless_barrier.destination_queue = barrier.destination_queue;
+
+            if(barrier.resource_to_barrier->type == ResourceType::Image) {
+                headless_barrier.aspect = barrier.image_memory_barrier.aspect;
+
+            } else {
+                headless_barrier.offset = barrier.buffer_memory_barrier.offset.b_count();
+                headless_barrier.size = barrier.buffer_memory_barrier.size.b_count();
+            }
+
+            write_bytes(&headless_barrier, sizeof(headless_barrier));
+        });
+
+        statistics::count(&RenderStatistics::num_barriers, barriers.size());
+    }
+
+    void HeadlessCommandList::copy_buffer(RhiBuffer* destination_buffer,
+                                          const mem::Bytes destination_offset,
+                                          RhiBuffer* source_buffer,
+                                          const mem::Bytes source_offset,
+                                          const mem::Bytes num_bytes) {
+        flush_barriers();
+
+        const HeadlessCopyBufferCommand command{get_headless_resource_id(destination_buffer),
+                                                get_headless_resource_id(source_buffer),
+                                                destination_offset.b_count(),
+                                                source_offset.b_count(),
+                                                num_bytes.b_count()};
+        record(HeadlessCommandType::CopyBuffer, command);
+
+        statistics::count(&RenderStatistics::num_staging_bytes_uploaded, num_bytes.b_count());
+    }
+
+    void HeadlessCommandList::execute_command_lists(const rx::vector<CommandList*>& lists) {
+        flush_barriers();
+
+        rx_size total_size = sizeof(HeadlessExecuteCommandListsCommand);
+        lists.each_fwd([&](const CommandList* list) {
+            const auto* headless_list = static_cast<const HeadlessCommandList*>(list);
+            total_size += sizeof(HeadlessSecondaryCommandListHeader) + headless_list->get_stream().size();
+        });
+
+        const HeadlessExecuteCommandListsCommand command{static_cast<uint32_t>(lists.size())};
+        write_header(HeadlessCommandType::ExecuteCommandLists, total_size);
+        write_bytes(&command, sizeof(command));
+
+        // Secondary command lists are inlined into this stream. Their own streams go back to the device, since nothing else will ever
+        // submit them
+        lists.each_fwd([&](CommandList* list) {
+            auto* headless_list = static_cast<HeadlessCommandList*>(list);
+            const auto& secondary_stream = headless_list->get_stream();
+
+            const HeadlessSecondaryCommandListHeader secondary_header{secondary_stream.size(),
+                                                                      headless_list->renderpass_id,
+                                                                      headless_list->framebuffer_id,
+                                                                      headless_list->subpass};
+            write_bytes(&secondary_header, sizeof(secondary_header));
+            write_bytes(secondary_stream.data(), secondary_stream.size());
+
+            num_commands += headless_list->get_num_commands();
+
+            render_device.recycle_stream(headless_list->release_stream());
+        });
+    }
+
+    void HeadlessCommandList::begin_renderpass(RhiRenderpass* renderpass, RhiFramebuffer* framebuffer, const RenderpassContents contents) {
+        flush_barriers();
+
+        const HeadlessBeginRenderpassCommand command{static_cast<HeadlessRenderpass*>(renderpass)->id,
+                                                     static_cast<HeadlessFramebuffer*>(framebuffer)->id,
+                                                     contents};
+        record(HeadlessCommandType::BeginRenderpass, command);
+    }
+
+    void HeadlessCommandList::next_subpass(const RenderpassContents contents) {
+        const HeadlessNextSubpassCommand command{contents};
+        record(HeadlessCommandType::NextSubpass, command);
+    }
+
+    void HeadlessCommandList::end_renderpass() { write_header(HeadlessCommandType::EndRenderpass, 0); }
+
+    void HeadlessCommandList::bind_pipeline(const RhiPipeline* pipeline) {
+        const HeadlessBindPipelineCommand command{static_cast<const HeadlessPipeline*>(pipeline)->id};
+        record(HeadlessCommandType::BindPipeline, command);
+
+        statistics::count(&RenderStatistics::num_pipeline_binds);
+    }
+
+    void HeadlessCommandList::bind_descriptor_sets(const rx::vector<RhiDescriptorSet*>& descriptor_sets,
+                                                   const RhiPipelineInterface* pipeline_interface) {
+        const HeadlessBindDescriptorSetsCommand command{static_cast<const HeadlessPipelineInterface*>(pipeline_interface)->id,
+                                                        static_cast<uint32_t>(descriptor_sets.size())};
+
+        write_header(HeadlessCommandType::BindDescriptorSets, sizeof(command) + sizeof(uint32_t) * descriptor_sets.size());
+        write_bytes(&command, sizeof(command));
+
+        descriptor_sets.each_fwd([&](const RhiDescriptorSet* set) {
+            const uint32_t id = static_cast<const HeadlessDescriptorSet*>(set)->id;
+            write_bytes(&id, sizeof(id));
+        });
+
+        statistics::count(&RenderStatistics::num_descriptor_set_binds, descriptor_sets.size());
+    }
+
+    void HeadlessCommandList::bind_vertex_buffers(const rx::vector<RhiBuffer*>& buffers) {
+        const HeadlessBindVertexBuffersCommand command{static_cast<uint32_t>(buffers.size())};
+
+        write_header(HeadlessCommandType::BindVertexBuffers, sizeof(command) + sizeof(uint32_t) * buffers.size());
+        write_bytes(&command, sizeof(command));
+
+        buffers.each_fwd([&](const RhiBuffer* buffer) {
+            const uint32_t id = get_headless_resource_id(buffer);
+            write_bytes(&id, sizeof(id));
+        });
+    }
+
+    void HeadlessCommandList::bind_index_buffer(const RhiBuffer* buffer, const IndexType index_type) {
+        const HeadlessBindIndexBufferCommand command{get_headless_resource_id(buffer), index_type};
+        record(HeadlessCommandType::BindIndexBuffer, command);
+    }
+
+    void HeadlessCommandList::draw_indexed_mesh(const uint32_t num_indices, const uint32_t offset, const uint32_t num_instances) {
+        const HeadlessDrawIndexedMeshCommand command{num_indices, offset, num_instances};
+        record(HeadlessCommandType::DrawIndexedMesh, command);
+
+        statistics::count(&RenderStatistics::num_draw_calls);
+        statistics::count(&RenderStatistics::num_indices, static_cast<uint64_t>(num_indices) * num_instances);
+    }
+
+    void HeadlessCommandList::set_scissor_rect(const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height) {
+        const HeadlessSetScissorRectCommand command{x, y, width, height};
+        record(HeadlessCommandType::SetScissorRect, command);
+    }
+
+    void HeadlessCommandList::set_viewport(const float x, const float y, const float width, const float height) {
+        const HeadlessSetViewportCommand command{x, y, width, height};
+        record(HeadlessCommandType::SetViewport, command);
+    }
+
+    void HeadlessCommandList::dispatch(const uint32_t num_groups_x, const uint32_t num_groups_y, const uint32_t num_groups_z) {
+        flush_barriers();
+
+        const HeadlessDispatchCommand command{num_groups_x, num_groups_y, num_groups_z};
+        record(HeadlessCommandType::Dispatch, command);
+    }
+
+    void HeadlessCommandList::dispatch_indirect(const RhiBuffer* buffer, const mem::Bytes offset) {
+        flush_barriers();
+
+        const HeadlessDispatchIndirectCommand command{offset.b_count(), get_headless_resource_id(buffer)};
+        record(HeadlessCommandType::DispatchIndirect, command);
+    }
+
+    void HeadlessCommandList::reset_queries(RhiQueryPool* /* pool */, uint32_t /* first_query */, uint32_t /* num_queries */) {
+        // Headless devices don't support timestamps, so there are no queries to reset
+    }
+
+    void HeadlessCommandList::write_timestamp(RhiQueryPool* /* pool */, uint32_t /* query_idx */, PipelineStage /* stage */) {
+        // Headless devices don't support timestamps
+    }
+
+    void HeadlessCommandList::upload_data_to_image(
+        RhiImage* image, const size_t width, const size_t height, const size_t bytes_per_pixel, RhiBuffer* staging_buffer, const void* data) {
+        flush_barriers();
+
+        // Copy the data into the staging buffer like a real backend would, so that the CPU cost of the upload is still measured
+        render_device.write_data_to_buffer(data, width * height * bytes_per_pixel, 0, staging_buffer);
+
+        const HeadlessUploadDataToImageCommand command{get_headless_resource_id(image),
+                                                       get_headless_resource_id(staging_buffer),
+                                                       width,
+                                                       height,
+                                                       bytes_per_pixel};
+        record(HeadlessCommandType::UploadDataToImage, command);
+
+        statistics::count(&RenderStatistics::num_staging_bytes_uploaded, width * height * bytes_per_pixel);
+    }
+
+    CommandList::Level HeadlessCommandList::get_level() const { return level; }
+
+    const rx::string& HeadlessCommandList::get_debug_name() const { return debug_name; }
+
+    uint32_t HeadlessCommandList::get_num_commands() const { return num_commands; }
+
+    const rx::vector<rx_byte>& HeadlessCommandList::get_stream() const { return stream; }
+
+    rx::vector<rx_byte> HeadlessCommandList::release_stream() { return rx::utility::move(stream); }
+
+    void HeadlessCommandList::write_header(const HeadlessCommandType type, const rx_size size) {
+        const HeadlessCommandHeader header{type, static_cast<uint32_t>(size)};
+        write_bytes(&header, sizeof(header));
+
+        num_commands++;
+    }
+
+    void HeadlessCommandList::write_bytes(const void* data, const rx_size size) {
+        if(size == 0) {
+            return;
+        }
+
+        const rx_size old_size = stream.size();
+        stream.resize(old_size + size, rx::utility::uninitialized{});
+        memcpy(stream.data() + old_size, data, size);
+    }
+} // namespace nova::renderer::rhi
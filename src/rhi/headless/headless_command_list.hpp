@@ -0,0 +1,286 @@
+#pragma once
+
+#include "nova_renderer/rhi/command_list.hpp"
+#include "nova_renderer/rhi/rhi_enums.hpp"
+#include "nova_renderer/rhi/rhi_types.hpp"
+
+namespace nova::renderer::rhi {
+    class HeadlessRenderDevice;
+
+    /*!
+     * \brief All the commands that can be in a headless command stream
+     */
+    enum class HeadlessCommandType : uint32_t {
+        ResourceBarriers,
+        CopyBuffer,
+        UploadDataToImage,
+        ExecuteCommandLists,
+        BeginRenderpass,
+        NextSubpass,
+        EndRenderpass,
+        BindPipeline,
+        BindDescriptorSets,
+        BindVertexBuffers,
+        BindIndexBuffer,
+        DrawIndexedMesh,
+        SetScissorRect,
+        Dispatch,
+        DispatchIndirect,
+        SetViewport,
+    };
+
+#pragma region Command stream layout
+    // None of these structs have implicit padding, so that recording the same commands always makes the same stream, byte for byte
+
+    /*!
+     * \brief Precedes every command in a headless command stream
+     *
+     * `size` is the number of bytes of command data that directly follow the header
+     */
+    struct HeadlessCommandHeader {
+        HeadlessCommandType type;
+        uint32_t size;
+    };
+
+    /*!
+     * \brief Followed by `num_barriers` HeadlessBarrier structs
+     */
+    struct HeadlessResourceBarriersCommand {
+        PipelineStage stages_before_barrier;
+        PipelineStage stages_after_barrier;
+        uint32_t num_barriers;
+    };
+
+    struct HeadlessBarrier {
+        uint32_t resource;
+        ResourceAccess access_before_barrier;
+        ResourceAccess access_after_barrier;
+        ResourceState old_state;
+        ResourceState new_state;
+        QueueType source_queue;
+        QueueType destination_queue;
+        ImageAspect aspect;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct HeadlessCopyBufferCommand {
+        uint32_t destination_buffer;
+        uint32_t source_buffer;
+        uint64_t destination_offset;
+        uint64_t source_offset;
+        uint64_t num_bytes;
+    };
+
+    struct HeadlessUploadDataToImageCommand {
+        uint32_t image;
+        uint32_t staging_buffer;
+        uint64_t width;
+        uint64_t height;
+        uint64_t bytes_per_pixel;
+    };
+
+    /*!
+     * \brief Followed by the command streams of `num_lists` secondary command lists. Each stream is prefixed by a
+     * HeadlessSecondaryCommandListHeader
+     */
+    struct HeadlessExecuteCommandListsCommand {
+        uint32_t num_lists;
+    };
+
+    struct HeadlessSecondaryCommandListHeader {
+        uint64_t stream_size;
+
+        /*!
+         * \brief The renderpass the secondary command list was created for, or 0 if it's executed outside of a renderpass
+         */
+        uint32_t renderpass;
+        uint32_t framebuffer;
+        uint32_t subpass;
+
+        uint32_t padding = 0;
+    };
+
+    struct HeadlessBeginRenderpassCommand {
+        uint32_t renderpass;
+        uint32_t framebuffer;
+        CommandList::RenderpassContents contents;
+    };
+
+    struct HeadlessNextSubpassCommand {
+        CommandList::RenderpassContents contents;
+    };
+
+    struct HeadlessBindPipelineCommand {
+        uint32_t pipeline;
+    };
+
+    /*!
+     * \brief Followed by `num_sets` descriptor set IDs, as uint32_ts
+     */
+    struct HeadlessBindDescriptorSetsCommand {
+        uint32_t pipeline_interface;
+        uint32_t num_sets;
+    };
+
+    /*!
+     * \brief Followed by `num_buffers` buffer IDs, as uint32_ts
+     */
+    struct HeadlessBindVertexBuffersCommand {
+        uint32_t num_buffers;
+    };
+
+    struct HeadlessBindIndexBufferCommand {
+        uint32_t buffer;
+        IndexType index_type;
+    };
+
+    struct HeadlessDrawIndexedMeshCommand {
+        uint32_t num_indices;
+        uint32_t offset;
+        uint32_t num_instances;
+    };
+
+    struct HeadlessSetScissorRectCommand {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct HeadlessSetViewportCommand {
+        float x;
+        float y;
+        float width;
+        float height;
+    };
+
+    struct HeadlessDispatchCommand {
+        uint32_t num_groups_x;
+        uint32_t num_groups_y;
+        uint32_t num_groups_z;
+    };
+
+    struct HeadlessDispatchIndirectCommand {
+        uint64_t offset;
+        uint32_t buffer;
+
+        uint32_t padding = 0;
+    };
+#pragma endregion
+
+    /*!
+     * \brief Command list which records every command into a compact in-memory command stream, instead of sending them to a GPU
+     *
+     * The stream is a sequence of HeadlessCommandHeaders, each followed by the command's data. Objects are referred to by their headless
+     * IDs, never by pointer, so a stream is meaningful on its own
+     */
+    class HeadlessCommandList final : public CommandList {
+    public:
+        /*!
+         * \param renderpass_id The ID of the renderpass that a secondary command list will be executed in, or 0
+         * \param framebuffer_id The ID of the framebuffer that a secondary command list will be executed with, or 0
+         * \param subpass The subpass of the renderpass that a secondary command list will be executed in
+         */
+        HeadlessCommandList(rx::vector<rx_byte>&& stream,
+                            Level level,
+                            uint32_t renderpass_id,
+                            uint32_t framebuffer_id,
+                            uint32_t subpass,
+                            HeadlessRenderDevice* render_device,
+                            rx::memory::allocator* allocator);
+
+        ~HeadlessCommandList() override = default;
+
+        void set_debug_name(const rx::string& name) override;
+
+        void resource_barriers(PipelineStage stages_before_barrier,
+                               PipelineStage stages_after_barrier,
+                               const rx::vector<RhiResourceBarrier>& barriers) override;
+
+        void copy_buffer(RhiBuffer* destination_buffer,
+                         mem::Bytes destination_offset,
+                         RhiBuffer* source_buffer,
+                         mem::Bytes source_offset,
+                         mem::Bytes num_bytes) override;
+
+        void execute_command_lists(const rx::vector<CommandList*>& lists) override;
+
+        void begin_renderpass(RhiRenderpass* renderpass,
+                              RhiFramebuffer* framebuffer,
+                              RenderpassContents contents = RenderpassContents::Inline) override;
+
+        void next_subpass(RenderpassContents contents = RenderpassContents::Inline) override;
+
+        void end_renderpass() override;
+
+        void bind_pipeline(const RhiPipeline* pipeline) override;
+
+        void bind_descriptor_sets(const rx::vector<RhiDescriptorSet*>& descriptor_sets,
+                                  const RhiPipelineInterface* pipeline_interface) override;
+
+        void bind_vertex_buffers(const rx::vector<RhiBuffer*>& buffers) override;
+
+        void bind_index_buffer(const RhiBuffer* buffer, IndexType index_type) override;
+
+        void draw_indexed_mesh(uint32_t num_indices, uint32_t offset, uint32_t num_instances) override;
+
+        void set_scissor_rect(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
+
+        void set_viewport(float x, float y, float width, float height) override;
+
+        void dispatch(uint32_t num_groups_x, uint32_t num_groups_y, uint32_t num_groups_z) override;
+
+        void dispatch_indirect(const RhiBuffer* buffer, mem::Bytes offset) override;
+
+        void reset_queries(RhiQueryPool* pool, uint32_t first_query, uint32_t num_queries) override;
+
+        void write_timestamp(RhiQueryPool* pool, uint32_t query_idx, PipelineStage stage) override;
+
+        void upload_data_to_image(
+            RhiImage* image, size_t width, size_t height, size_t bytes_per_pixel, RhiBuffer* staging_buffer, const void* data) override;
+
+        [[nodiscard]] Level get_level() const;
+
+        [[nodiscard]] const rx::string& get_debug_name() const;
+
+        [[nodiscard]] uint32_t get_num_commands() const;
+
+        [[nodiscard]] const rx::vector<rx_byte>& get_stream() const;
+
+        /*!
+         * \brief Takes the command stream out of this command list. The command list may not be recorded into afterwards
+         */
+        [[nodiscard]] rx::vector<rx_byte> release_stream();
+
+    private:
+        HeadlessRenderDevice& render_device;
+
+        Level level;
+
+        uint32_t renderpass_id;
+
+        uint32_t framebuffer_id;
+
+        uint32_t subpass;
+
+        rx::string debug_name;
+
+        uint32_t num_commands = 0;
+
+        rx::vector<rx_byte> stream;
+
+        void write_header(HeadlessCommandType type, rx_size size);
+
+        void write_bytes(const void* data, rx_size size);
+
+        template <typename CommandType>
+        void record(HeadlessCommandType type, const CommandType& command);
+    };
+
+    template <typename CommandType>
+    void HeadlessCommandList::record(const HeadlessCommandType type, const CommandType& command) {
+        write_header(type, sizeof(CommandType));
+        write_bytes(&command, sizeof(CommandType));
+    }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,438 @@
+#include "headless_render_device.hpp"
+
+#include <string.h>
+
+#include <rx/core/concurrency/scope_lock.h>
+#include <rx/core/log.h>
+
+#include "nova_renderer/constants.hpp"
+#include "nova_renderer/render_statistics.hpp"
+#include "nova_renderer/rhi/pipeline_create_info.hpp"
+
+#include "headless_swapchain.hpp"
+
+using namespace nova::mem;
+
+namespace nova::renderer::rhi {
+    RX_LOG("HeadlessRenderDevice", logger);
+
+    HeadlessRenderDevice::HeadlessRenderDevice(NovaSettingsAccessManager& settings, NovaWindow& window, rx::memory::allocator* allocator)
+        : RenderDevice{settings, window, allocator}, submitted_streams{internal_allocator}, free_streams{internal_allocator} {
+        info.architecture = DeviceArchitecture::Unknown;
+        info.max_texture_size = 16384;
+        info.is_uma = true;
+
+        create_swapchain();
+
+        logger(rx::log::level::k_info, "Created headless render device. Nothing will be drawn");
+    }
+
+    HeadlessRenderDevice::~HeadlessRenderDevice() { internal_allocator->destroy<HeadlessSwapchain>(swapchain); }
+
+    void HeadlessRenderDevice::set_num_renderpasses(uint32_t /* num_renderpasses */) {
+        // Nothing to prepare
+    }
+
+    ntl::Result<RhiDeviceMemory*> HeadlessRenderDevice::allocate_device_memory(const Bytes size,
+                                                                            MemoryUsage /* usage */,
+                                                                            ObjectType /* allowed_objects */,
+                                                                            rx::memory::allocator* allocator) {
+        auto* memory = allocator->create<HeadlessDeviceMemory>();
+        memory->id = make_object_id();
+        memory->size = size;
+
+        return ntl::Result<RhiDeviceMemory*>(memory);
+    }
+
+    ntl::Result<RhiRenderpass*> HeadlessRenderDevice::create_renderpass(const renderpack::RenderPassCreateInfo& /* data */,
+                                                                     const glm::uvec2& /* framebuffer_size */,
+                                                                     rx::memory::allocator* allocator) {
+        auto* renderpass = allocator->create<HeadlessRenderpass>();
+        renderpass->id = make_object_id();
+
+        return ntl::Result<RhiRenderpass*>(renderpass);
+    }
+
+    ntl::Result<RhiRenderpass*> HeadlessRenderDevice::create_merged_renderpass(
+        const rx::vector<renderpack::RenderPassCreateInfo>& /* subpasses */,
+        const glm::uvec2& /* framebuffer_size */,
+        rx::memory::allocator* allocator) {
+        auto* renderpass = allocator->create<HeadlessRenderpass>();
+        renderpass->id = make_object_id();
+
+        return ntl::Result<RhiRenderpass*>(renderpass);
+    }
+
+    RhiFramebuffer* HeadlessRenderDevice::create_framebuffer(const RhiRenderpass* /* renderpass */,
+                                                          const rx::vector<RhiImage*>& color_attachments,
+                                                          const rx::optional<RhiImage*> depth_attachment,
+                                                          const glm::uvec2& framebuffer_size,
+                                                          rx::memory::allocator* allocator) {
+        auto* framebuffer = allocator->create<HeadlessFramebuffer>();
+        framebuffer->id = make_object_id();
+        framebuffer->size = framebuffer_size;
+        framebuffer->num_attachments = static_cast<uint32_t>(color_attachments.size()) + (depth_attachment ? 1 : 0);
+
+        return framebuffer;
+    }
+
+    ntl::Result<RhiPipelineInterface*> HeadlessRenderDevice::create_pipeline_interface(
+        const rx::map<rx::string, RhiResourceBindingDescription>& bindings,
+        const rx::vector<renderpack::TextureAttachmentInfo>& /* color_attachments */,
+        const rx::optional<renderpack::TextureAttachmentInfo>& /* depth_texture */,
+        rx::memory::allocator* allocator) {
+        auto* pipeline_interface = allocator->create<HeadlessPipelineInterface>();
+        pipeline_interface->id = make_object_id();
+        pipeline_interface->bindings = bindings;
+
+        bindings.each_value([&](const RhiResourceBindingDescription& binding) {
+            if(binding.set + 1 > pipeline_interface->num_sets) {
+                pipeline_interface->num_sets = binding.set + 1;
+            }
+        });
+
+        return ntl::Result<RhiPipelineInterface*>(pipeline_interface);
+    }
+
+    RhiDescriptorPool* HeadlessRenderDevice::create_descriptor_pool(const rx::map<DescriptorType, uint32_t>& /* descriptor_capacity */,
+                                                                 rx::memory::allocator* allocator) {
+        auto* pool = allocator->create<HeadlessDescriptorPool>();
+        pool->id = make_object_id();
+
+        return pool;
+    }
+
+    rx::vector<RhiDescriptorSet*> HeadlessRenderDevice::create_descriptor_sets(const RhiPipelineInterface* pipeline_interface,
+                                                                            RhiDescriptorPool* /* pool */,
+                                                                            rx::memory::allocator* allocator) {
+        const auto* headless_interface = static_cast<const HeadlessPipelineInterface*>(pipeline_interface);
+
+        rx::vector<RhiDescriptorSet*> sets{allocator};
+        sets.reserve(headless_interface->num_sets);
+
+        for(uint32_t i = 0; i < headless_interface->num_sets; i++) {
+            auto* set = allocator->create<HeadlessDescriptorSet>();
+            set->id = make_object_id();
+
+            sets.push_back(set);
+        }
+
+        return sets;
+    }
+
+    void HeadlessRenderDevice::update_descriptor_sets(rx::vector<RhiDescriptorSetWrite>& /* writes */) {
+        // Descriptor sets don't hold anything in a headless device
+    }
+
+    void HeadlessRenderDevice::reset_descriptor_pool(RhiDescriptorPool* /* pool */) {
+        // Descriptor pools don't hold anything in a headless device
+    }
+
+    ntl::Result<RhiPipeline*> HeadlessRenderDevice::create_pipeline(RhiPipelineInterface* /* pipeline_interface */,
+                                                                 const PipelineStateCreateInfo& /* data */,
+                                                                 rx::memory::allocator* allocator) {
+        auto* pipeline = allocator->create<HeadlessPipeline>();
+        pipeline->id = make_object_id();
+
+        return ntl::Result<RhiPipeline*>(pipeline);
+    }
+
+    ntl::Result<RhiPipeline*> HeadlessRenderDevice::create_compute_pipeline(RhiPipelineInterface* /* pipeline_interface */,
+                                                                         const ComputePipelineCreateInfo& /* data */,
+                                                                         rx::memory::allocator* allocator) {
+        auto* pipeline = allocator->create<HeadlessPipeline>();
+        pipeline->id = make_object_id();
+
+        return ntl::Result<RhiPipeline*>(pipeline);
+    }
+
+    RhiBuffer* HeadlessRenderDevice::create_buffer(const RhiBufferCreateInfo& info,
+                                                DeviceMemoryResource& memory,
+                                                rx::memory::allocator* allocator) {
+        auto* buffer = allocator->create<HeadlessBuffer>();
+        buffer->id = make_object_id();
+        buffer->type = ResourceType::Buffer;
+        buffer->size = info.size;
+
+        // Allocate from the memory resource like a real device would, so that running out of room in it shows up in headless runs too
+        if(const auto allocation = memory.allocate(info.size)) {
+            buffer->memory_resource = &memory;
+            buffer->memory_allocation = *allocation;
+
+        } else {
+            logger(rx::log::level::k_verbose, "Memory resource has no room for buffer %s, giving it its own memory", info.name);
+        }
+
+        // Only buffers the host writes to need storage
+        if(info.buffer_usage == BufferUsage::UniformBuffer || info.buffer_usage == BufferUsage::StagingBuffer) {
+            buffer->data = rx::vector<rx_byte>{allocator, info.size.b_count(), rx::utility::uninitialized{}};
+        }
+
+        return buffer;
+    }
+
+    void HeadlessRenderDevice::write_data_to_buffer(const void* data, const Bytes num_bytes, const Bytes offset, const RhiBuffer* buffer) {
+        const auto* headless_buffer = static_cast<const HeadlessBuffer*>(buffer);
+
+        if(offset.b_count() + num_bytes.b_count() > headless_buffer->data.size()) {
+            logger(rx::log::level::k_error,
+                   "Can not write %u bytes at offset %u to buffer %u, which only has %u bytes of host-visible storage",
+                   num_bytes.b_count(),
+                   offset.b_count(),
+                   headless_buffer->id,
+                   headless_buffer->data.size());
+            return;
+        }
+
+        // The data pointer is const because RenderDevice::write_data_to_buffer promises not to change the buffer object itself, only the
+        // memory it owns
+        auto* destination = const_cast<rx_byte*>(headless_buffer->data.data()) + offset.b_count();
+        memcpy(destination, data, num_bytes.b_count());
+
+        statistics::count(&RenderStatistics::num_bytes_written, num_bytes.b_count());
+
+        rx::concurrency::scope_lock l(stats_mutex);
+        stats.num_bytes_written_to_buffers += num_bytes.b_count();
+    }
+
+    RhiSampler* HeadlessRenderDevice::create_sampler(const RhiSamplerCreateInfo& /* create_info */, rx::memory::allocator* allocator) {
+        auto* sampler = allocator->create<HeadlessSampler>();
+        sampler->id = make_object_id();
+
+        return sampler;
+    }
+
+    RhiImage* HeadlessRenderDevice::create_image(const renderpack::TextureCreateInfo& info, rx::memory::allocator* allocator) {
+        auto* image = allocator->create<HeadlessImage>();
+        image->id = make_object_id();
+        image->is_dynamic = true;
+        image->type = ResourceType::Image;
+        image->is_depth_tex = is_depth_format(info.format.pixel_format);
+
+        return image;
+    }
+
+    RhiImage* HeadlessRenderDevice::create_aliased_image(const renderpack::TextureCreateInfo& info,
+                                                         RhiImage* aliased_image,
+                                                         rx::memory::allocator* allocator) {
+        auto* image = create_image(info, allocator);
+        image->aliased_image = aliased_image;
+
+        return image;
+    }
+
+    bool HeadlessRenderDevice::recreate_image(RhiImage* image,
+                                              const renderpack::TextureCreateInfo& info,
+                                              RhiImage* aliased_image,
+                                              rx::memory::allocator* /* allocator */) {
+        image->is_depth_tex = is_depth_format(info.format.pixel_format);
+        image->aliased_image = aliased_image;
+        image->state = ResourceState::Undefined;
+        image->stages = PipelineStage::TopOfPipe;
+        image->queue = QueueType::Graphics;
+
+        return true;
+    }
+
+    RhiSemaphore* HeadlessRenderDevice::create_semaphore(rx::memory::allocator* allocator) {
+        auto* semaphore = allocator->create<HeadlessSemaphore>();
+        semaphore->id = make_object_id();
+
+        return semaphore;
+    }
+
+    rx::vector<RhiSemaphore*> HeadlessRenderDevice::create_semaphores(const uint32_t num_semaphores, rx::memory::allocator* allocator) {
+        auto semaphores = rx::vector<RhiSemaphore*>{allocator};
+        semaphores.reserve(num_semaphores);
+
+        for(uint32_t i = 0; i < num_semaphores; i++) {
+            semaphores.emplace_back(create_semaphore(allocator));
+        }
+
+        return semaphores;
+    }
+
+    RhiFence* HeadlessRenderDevice::create_fence(bool /* signaled */, rx::memory::allocator* allocator) {
+        auto* fence = allocator->create<HeadlessFence>();
+        fence->id = make_object_id();
+
+        return fence;
+    }
+
+    rx::vector<RhiFence*> HeadlessRenderDevice::create_fences(const uint32_t num_fences,
+                                                            const bool signaled,
+                                                            rx::memory::allocator* allocator) {
+        rx::vector<RhiFence*> fences{allocator};
+        fences.reserve(num_fences);
+
+        for(uint32_t i = 0; i < num_fences; i++) {
+            fences.push_back(create_fence(signaled, allocator));
+        }
+
+        return fences;
+    }
+
+    void HeadlessRenderDevice::wait_for_fences(rx::vector<RhiFence*> /* fences */) {
+        // Headless fences are always signaled
+    }
+
+    void HeadlessRenderDevice::reset_fences(const rx::vector<RhiFence*>& /* fences */) {
+        // Headless fences are always signaled
+    }
+
+    RhiQueryPool* HeadlessRenderDevice::create_timestamp_query_pool(const uint32_t num_queries, rx::memory::allocator* allocator) {
+        auto* pool = allocator->create<HeadlessQueryPool>();
+        pool->id = make_object_id();
+        pool->num_queries = num_queries;
+
+        return pool;
+    }
+
+    rx::vector<rx::optional<uint64_t>> HeadlessRenderDevice::get_timestamps(RhiQueryPool* /* pool */,
+                                                                            uint32_t /* first_query */,
+                                                                            const uint32_t num_queries,
+                                                                            rx::memory::allocator* allocator) {
+        // Nothing ever writes a timestamp on a headless device
+        rx::vector<rx::optional<uint64_t>> timestamps{allocator};
+        timestamps.resize(num_queries, rx::nullopt);
+
+        return timestamps;
+    }
+
+    void HeadlessRenderDevice::destroy_renderpass(RhiRenderpass* pass, rx::memory::allocator* allocator) {
+        allocator->destroy<HeadlessRenderpass>(pass);
+    }
+
+    void HeadlessRenderDevice::destroy_framebuffer(RhiFramebuffer* framebuffer, rx::memory::allocator* allocator) {
+        allocator->destroy<HeadlessFramebuffer>(framebuffer);
+    }
+
+    void HeadlessRenderDevice::destroy_pipeline_interface(RhiPipelineInterface* pipeline_interface, rx::memory::allocator* allocator) {
+        allocator->destroy<HeadlessPipelineInterface>(pipeline_interface);
+    }
+
+    void HeadlessRenderDevice::destroy_pipeline(RhiPipeline* pipeline, rx::memory::allocator* allocator) {
+        allocator->destroy<HeadlessPipeline>(pipeline);
+    }
+
+    void HeadlessRenderDevice::destroy_texture(RhiImage* resource, rx::memory::allocator* allocator) {
+        allocator->destroy<HeadlessImage>(resource);
+    }
+
+    void HeadlessRenderDevice::destroy_buffer(RhiBuffer* buffer, rx::memory::allocator* allocator) {
+        auto* headless_buffer = static_cast<HeadlessBuffer*>(buffer);
+        if(headless_buffer->memory_resource != nullptr) {
+            headless_buffer->memory_resource->free(headless_buffer->memory_allocation);
+        }
+
+        allocator->destroy<HeadlessBuffer>(buffer);
+    }
+
+    void HeadlessRenderDevice::destroy_semaphores(rx::vector<RhiSemaphore*>& semaphores, rx::memory::allocator* allocator) {
+        semaphores.each_fwd([&](RhiSemaphore* semaphore) { allocator->destroy<HeadlessSemaphore>(semaphore); });
+    }
+
+    void HeadlessRenderDevice::destroy_fences(const rx::vector<RhiFence*>& fences, rx::memory::allocator* allocator) {
+        fences.each_fwd([&](RhiFence* fence) { allocator->destroy<HeadlessFence>(fence); });
+    }
+
+    void HeadlessRenderDevice::destroy_query_pool(RhiQueryPool* pool, rx::memory::allocator* allocator) {
+        allocator->destroy<HeadlessQueryPool>(pool);
+    }
+
+    void HeadlessRenderDevice::recreate_swapchain(const glm::uvec2& window_size) {
+        swapchain_size = window_size;
+
+        static_cast<HeadlessSwapchain*>(swapchain)->recreate(settings->swapchain.num_images, swapchain_size);
+    }
+
+    void HeadlessRenderDevice::begin_frame(uint32_t /* frame_idx */) {
+        // Command streams go back to the free list as soon as they're submitted, so there's nothing to reclaim here
+    }
+
+    CommandList* HeadlessRenderDevice::create_command_list(uint32_t /* thread_idx */,
+                                                           QueueType /* needed_queue_type */,
+                                                           const CommandList::Level level,
+                                                           rx::memory::allocator* allocator,
+                                                           const RhiRenderpass* renderpass,
+                                                           const RhiFramebuffer* framebuffer,
+                                                           const uint32_t subpass) {
+        statistics::count(&RenderStatistics::num_command_lists);
+
+        const uint32_t renderpass_id = renderpass != nullptr ? static_cast<const HeadlessRenderpass*>(renderpass)->id : 0;
+        const uint32_t framebuffer_id = framebuffer != nullptr ? static_cast<const HeadlessFramebuffer*>(framebuffer)->id : 0;
+
+        return allocator->create<HeadlessCommandList>(get_free_stream(), level, renderpass_id, framebuffer_id, subpass, this, allocator);
+    }
+
+    void HeadlessRenderDevice::submit_command_list(CommandList* cmds,
+                                                   QueueType /* queue */,
+                                                   RhiFence* /* fence_to_signal */,
+                                                   const rx::vector<RhiSemaphore*>& /* wait_semaphores */,
+                                                   const rx::vector<RhiSemaphore*>& /* signal_semaphores */) {
+        cmds->flush_barriers();
+
+        auto* headless_list = static_cast<HeadlessCommandList*>(cmds);
+
+        {
+            rx::concurrency::scope_lock l(stats_mutex);
+            stats.num_submissions++;
+            stats.num_commands += headless_list->get_num_commands();
+            stats.num_command_bytes += headless_list->get_stream().size();
+
+            if(should_keep_submitted_streams) {
+                submitted_streams.push_back(headless_list->get_stream());
+            }
+        }
+
+        // There's no GPU to consume the commands, so we're done with them as soon as they're counted
+        recycle_stream(headless_list->release_stream());
+    }
+
+    void HeadlessRenderDevice::save_pipeline_cache() {
+        // Headless pipelines aren't compiled, so there's nothing to save
+    }
+
+    void HeadlessRenderDevice::recycle_stream(rx::vector<rx_byte>&& stream) {
+        stream.clear();
+
+        rx::concurrency::scope_lock l(streams_mutex);
+        free_streams.push_back(rx::utility::move(stream));
+    }
+
+    HeadlessSubmissionStatistics HeadlessRenderDevice::get_submission_statistics() const {
+        rx::concurrency::scope_lock l(stats_mutex);
+        return stats;
+    }
+
+    void HeadlessRenderDevice::reset_submission_statistics() {
+        rx::concurrency::scope_lock l(stats_mutex);
+        stats = {};
+    }
+
+    void HeadlessRenderDevice::keep_submitted_streams() {
+        rx::concurrency::scope_lock l(stats_mutex);
+        should_keep_submitted_streams = true;
+    }
+
+    const rx::vector<rx::vector<rx_byte>>& HeadlessRenderDevice::get_submitted_streams() const { return submitted_streams; }
+
+    uint32_t HeadlessRenderDevice::make_object_id() { return next_object_id.fetch_add(1); }
+
+    rx::vector<rx_byte> HeadlessRenderDevice::get_free_stream() {
+        rx::concurrency::scope_lock l(streams_mutex);
+
+        if(free_streams.is_empty()) {
+            return rx::vector<rx_byte>{internal_allocator};
+        }
+
+        auto stream = rx::utility::move(free_streams.last());
+        free_streams.erase(free_streams.size() - 1, free_streams.size());
+
+        return stream;
+    }
+
+    void HeadlessRenderDevice::create_swapchain() {
+        swapchain = internal_allocator->create<HeadlessSwapchain>(settings->swapchain.num_images, this, swapchain_size, internal_allocator);
+    }
+} // namespace nova::renderer::rhi
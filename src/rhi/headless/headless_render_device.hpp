@@ -0,0 +1,218 @@
+#pragma once
+
+#include <atomic>
+
+#include <rx/core/concurrency/mutex.h>
+
+#include "nova_renderer/rhi/render_device.hpp"
+
+#include "headless_command_list.hpp"
+#include "headless_structs.hpp"
+
+namespace nova::renderer::rhi {
+    /*!
+     * \brief Counts of everything that's been submitted to a headless render device
+     */
+    struct HeadlessSubmissionStatistics {
+        uint64_t num_submissions = 0;
+
+        /*!
+         * \brief Total number of commands submitted, including the commands in any executed secondary command lists
+         */
+        uint64_t num_commands = 0;
+
+        /*!
+         * \brief Total size of all the submitted command streams
+         */
+        uint64_t num_command_bytes = 0;
+
+        uint64_t num_bytes_written_to_buffers = 0;
+    };
+
+    /*!
+     * \brief Render device that doesn't need a GPU
+     *
+     * Every object this device creates is a fake handle with an ID. Command lists record into an in-memory command stream, fences are
+     * always signaled, and submitting a command list only counts what was in it. This lets us benchmark and regression-test everything
+     * Nova does on the CPU on machines that have no GPU at all
+     */
+    class HeadlessRenderDevice final : public RenderDevice {
+    public:
+        HeadlessRenderDevice(NovaSettingsAccessManager& settings, NovaWindow& window, rx::memory::allocator* allocator);
+
+        HeadlessRenderDevice(HeadlessRenderDevice&& old) noexcept = delete;
+        HeadlessRenderDevice& operator=(HeadlessRenderDevice&& old) noexcept = delete;
+
+        HeadlessRenderDevice(const HeadlessRenderDevice& other) = delete;
+        HeadlessRenderDevice& operator=(const HeadlessRenderDevice& other) = delete;
+
+        ~HeadlessRenderDevice() override;
+
+#pragma region Render engine interface
+        void set_num_renderpasses(uint32_t num_renderpasses) override;
+
+        ntl::Result<RhiDeviceMemory*> allocate_device_memory(mem::Bytes size,
+                                                          MemoryUsage usage,
+                                                          ObjectType allowed_objects,
+                                                          rx::memory::allocator* allocator) override;
+
+        ntl::Result<RhiRenderpass*> create_renderpass(const renderpack::RenderPassCreateInfo& data,
+                                                   const glm::uvec2& framebuffer_size,
+                                                   rx::memory::allocator* allocator) override;
+
+        ntl::Result<RhiRenderpass*> create_merged_renderpass(const rx::vector<renderpack::RenderPassCreateInfo>& subpasses,
+                                                          const glm::uvec2& framebuffer_size,
+                                                          rx::memory::allocator* allocator) override;
+
+        RhiFramebuffer* create_framebuffer(const RhiRenderpass* renderpass,
+                                        const rx::vector<RhiImage*>& color_attachments,
+                                        const rx::optional<RhiImage*> depth_attachment,
+                                        const glm::uvec2& framebuffer_size,
+                                        rx::memory::allocator* allocator) override;
+
+        ntl::Result<RhiPipelineInterface*> create_pipeline_interface(const rx::map<rx::string, RhiResourceBindingDescription>& bindings,
+                                                                  const rx::vector<renderpack::TextureAttachmentInfo>& color_attachments,
+                                                                  const rx::optional<renderpack::TextureAttachmentInfo>& depth_texture,
+                                                                  rx::memory::allocator* allocator) override;
+
+        RhiDescriptorPool* create_descriptor_pool(const rx::map<DescriptorType, uint32_t>& descriptor_capacity,
+                                               rx::memory::allocator* allocator) override;
+
+        rx::vector<RhiDescriptorSet*> create_descriptor_sets(const RhiPipelineInterface* pipeline_interface,
+                                                          RhiDescriptorPool* pool,
+                                                          rx::memory::allocator* allocator) override;
+
+        void update_descriptor_sets(rx::vector<RhiDescriptorSetWrite>& writes) override;
+
+        void reset_descriptor_pool(RhiDescriptorPool* pool) override;
+
+        ntl::Result<RhiPipeline*> create_pipeline(RhiPipelineInterface* pipeline_interface,
+                                               const PipelineStateCreateInfo& data,
+                                               rx::memory::allocator* allocator) override;
+
+        ntl::Result<RhiPipeline*> create_compute_pipeline(RhiPipelineInterface* pipeline_interface,
+                                                          const ComputePipelineCreateInfo& data,
+                                                          rx::memory::allocator* allocator) override;
+
+        RhiBuffer* create_buffer(const RhiBufferCreateInfo& info, DeviceMemoryResource& memory, rx::memory::allocator* allocator) override;
+
+        void write_data_to_buffer(const void* data, mem::Bytes num_bytes, mem::Bytes offset, const RhiBuffer* buffer) override;
+
+        RhiSampler* create_sampler(const RhiSamplerCreateInfo& create_info, rx::memory::allocator* allocator) override;
+
+        RhiImage* create_image(const renderpack::TextureCreateInfo& info, rx::memory::allocator* allocator) override;
+
+        RhiImage* create_aliased_image(const renderpack::TextureCreateInfo& info,
+                                       RhiImage* aliased_image,
+                                       rx::memory::allocator* allocator) override;
+
+        bool recreate_image(RhiImage* image,
+                            const renderpack::TextureCreateInfo& info,
+                            RhiImage* aliased_image,
+                            rx::memory::allocator* allocator) override;
+
+        RhiSemaphore* create_semaphore(rx::memory::allocator* allocator) override;
+
+        rx::vector<RhiSemaphore*> create_semaphores(uint32_t num_semaphores, rx::memory::allocator* allocator) override;
+
+        RhiFence* create_fence(bool signaled, rx::memory::allocator* allocator) override;
+
+        rx::vector<RhiFence*> create_fences(uint32_t num_fences, bool signaled, rx::memory::allocator* allocator) override;
+
+        void wait_for_fences(rx::vector<RhiFence*> fences) override;
+
+        void reset_fences(const rx::vector<RhiFence*>& fences) override;
+
+        RhiQueryPool* create_timestamp_query_pool(uint32_t num_queries, rx::memory::allocator* allocator) override;
+
+        rx::vector<rx::optional<uint64_t>> get_timestamps(RhiQueryPool* pool,
+                                                          uint32_t first_query,
+                                                          uint32_t num_queries,
+                                                          rx::memory::allocator* allocator) override;
+
+        void destroy_renderpass(RhiRenderpass* pass, rx::memory::allocator* allocator) override;
+
+        void destroy_framebuffer(RhiFramebuffer* framebuffer, rx::memory::allocator* allocator) override;
+
+        void destroy_pipeline_interface(RhiPipelineInterface* pipeline_interface, rx::memory::allocator* allocator) override;
+
+        void destroy_pipeline(RhiPipeline* pipeline, rx::memory::allocator* allocator) override;
+
+        void destroy_texture(RhiImage* resource, rx::memory::allocator* allocator) override;
+
+        void destroy_buffer(RhiBuffer* buffer, rx::memory::allocator* allocator) override;
+
+        void destroy_semaphores(rx::vector<RhiSemaphore*>& semaphores, rx::memory::allocator* allocator) override;
+
+        void destroy_fences(const rx::vector<RhiFence*>& fences, rx::memory::allocator* allocator) override;
+
+        void destroy_query_pool(RhiQueryPool* pool, rx::memory::allocator* allocator) override;
+
+        void recreate_swapchain(const glm::uvec2& window_size) override;
+
+        void begin_frame(uint32_t frame_idx) override;
+
+        CommandList* create_command_list(uint32_t thread_idx,
+                                         QueueType needed_queue_type,
+                                         CommandList::Level level,
+                                         rx::memory::allocator* allocator,
+                                         const RhiRenderpass* renderpass = nullptr,
+                                         const RhiFramebuffer* framebuffer = nullptr,
+                                         uint32_t subpass = 0) override;
+
+        void submit_command_list(CommandList* cmds,
+                                 QueueType queue,
+                                 RhiFence* fence_to_signal = nullptr,
+                                 const rx::vector<RhiSemaphore*>& wait_semaphores = {},
+                                 const rx::vector<RhiSemaphore*>& signal_semaphores = {}) override;
+
+        void save_pipeline_cache() override;
+#pragma endregion
+
+        /*!
+         * \brief Gives a command stream back to the device so that its memory can be reused by a later command list
+         */
+        void recycle_stream(rx::vector<rx_byte>&& stream);
+
+        [[nodiscard]] HeadlessSubmissionStatistics get_submission_statistics() const;
+
+        void reset_submission_statistics();
+
+        /*!
+         * \brief Makes the device keep a copy of the command stream of every command list that's submitted from now on, so that tests can
+         * check exactly what was recorded
+         */
+        void keep_submitted_streams();
+
+        /*!
+         * \brief Gets the command streams of the command lists that were submitted since `keep_submitted_streams` was called, in the order
+         * they were submitted
+         */
+        [[nodiscard]] const rx::vector<rx::vector<rx_byte>>& get_submitted_streams() const;
+
+    private:
+        std::atomic<uint32_t> next_object_id = 1;
+
+        mutable rx::concurrency::mutex stats_mutex;
+
+        HeadlessSubmissionStatistics stats;
+
+        bool should_keep_submitted_streams = false;
+
+        rx::vector<rx::vector<rx_byte>> submitted_streams;
+
+        rx::concurrency::mutex streams_mutex;
+
+        /*!
+         * \brief Command streams from submitted command lists. They're kept around so that recording doesn't need to allocate every
+         * frame
+         */
+        rx::vector<rx::vector<rx_byte>> free_streams;
+
+        [[nodiscard]] uint32_t make_object_id();
+
+        [[nodiscard]] rx::vector<rx_byte> get_free_stream();
+
+        void create_swapchain();
+    };
+} // namespace nova::renderer::rhi
@@ -0,0 +1,98 @@
+/*!
+ * \brief Headless definition of the structs forward-declared in render_device.hpp
+ *
+ * Headless objects don't own any GPU resources. Each one has an ID that's unique within its render device, which is what the command
+ * stream refers to objects by
+ */
+
+#pragma once
+
+#include "nova_renderer/rhi/rhi_types.hpp"
+
+namespace nova::renderer::rhi {
+    struct HeadlessDeviceMemory : RhiDeviceMemory {
+        uint32_t id = 0;
+
+        mem::Bytes size = 0;
+    };
+
+    struct HeadlessSampler : RhiSampler {
+        uint32_t id = 0;
+    };
+
+    struct HeadlessImage : RhiImage {
+        uint32_t id = 0;
+    };
+
+    struct HeadlessBuffer : RhiBuffer {
+        uint32_t id = 0;
+
+        /*!
+         * \brief CPU-side storage for the buffer's contents
+         *
+         * Only buffers that the host can write to have storage. Everything else is left empty so that large mesh pools don't cost any
+         * host memory
+         */
+        rx::vector<rx_byte> data;
+    };
+
+    struct HeadlessRenderpass : RhiRenderpass {
+        uint32_t id = 0;
+    };
+
+    struct HeadlessFramebuffer : RhiFramebuffer {
+        uint32_t id = 0;
+    };
+
+    struct HeadlessPipelineInterface : RhiPipelineInterface {
+        uint32_t id = 0;
+
+        uint32_t num_sets = 0;
+    };
+
+    struct HeadlessPipeline : RhiPipeline {
+        uint32_t id = 0;
+    };
+
+    struct HeadlessDescriptorPool : RhiDescriptorPool {
+        uint32_t id = 0;
+    };
+
+    struct HeadlessDescriptorSet : RhiDescriptorSet {
+        uint32_t id = 0;
+    };
+
+    struct HeadlessSemaphore : RhiSemaphore {
+        uint32_t id = 0;
+    };
+
+    /*!
+     * \brief A fence that's always signaled, because there's no GPU work to wait for
+     */
+    struct HeadlessFence : RhiFence {
+        uint32_t id = 0;
+    };
+
+    struct HeadlessQueryPool : RhiQueryPool {
+        uint32_t id = 0;
+    };
+
+    /*!
+     * \brief Gets the ID of a headless image or buffer
+     */
+    [[nodiscard]] inline uint32_t get_headless_resource_id(const RhiResource* resource) {
+        if(resource == nullptr) {
+            return 0;
+        }
+
+        switch(resource->type) {
+            case ResourceType::Image:
+                return static_cast<const HeadlessImage*>(resource)->id;
+
+            case ResourceType::Buffer:
+                [[fallthrough]];
+            default:
+                return static_cast<const HeadlessBuffer*>(resource)->id;
+        }
+    }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,74 @@
+#include "headless_swapchain.hpp"
+
+#include "headless_render_device.hpp"
+
+namespace nova::renderer::rhi {
+    HeadlessSwapchain::HeadlessSwapchain(const uint32_t num_images,
+                                         HeadlessRenderDevice* render_device,
+                                         const glm::uvec2& size,
+                                         rx::memory::allocator* allocator)
+        : Swapchain(num_images, size), render_device(render_device), allocator(allocator) {
+        create_images();
+    }
+
+    HeadlessSwapchain::~HeadlessSwapchain() { destroy_images(); }
+
+    uint8_t HeadlessSwapchain::acquire_next_swapchain_image(RhiSemaphore* /* image_acquired_semaphore */,
+                                                            rx::memory::allocator* /* allocator */) {
+        const uint32_t acquired_image_idx = next_image_idx;
+        next_image_idx = (next_image_idx + 1) % num_images;
+
+        return static_cast<uint8_t>(acquired_image_idx);
+    }
+
+    void HeadlessSwapchain::present(uint32_t /* image_idx */, RhiSemaphore* /* render_finished_semaphore */) {
+        // Nothing to present to
+    }
+
+    void HeadlessSwapchain::recreate(const uint32_t new_num_images, const glm::uvec2& new_size) {
+        destroy_images();
+
+        num_images = new_num_images;
+        size = new_size;
+        next_image_idx = 0;
+        out_of_date = false;
+
+        create_images();
+    }
+
+    void HeadlessSwapchain::create_images() {
+        swapchain_images.reserve(num_images);
+        framebuffers.reserve(num_images);
+
+        for(uint32_t i = 0; i < num_images; i++) {
+            renderpack::TextureCreateInfo image_create_info = {};
+            image_create_info.name = rx::string::format("SwapchainImage%u", i);
+            image_create_info.usage = renderpack::ImageUsage::RenderTarget;
+            image_create_info.format.pixel_format = PixelFormat::Rgba8;
+            image_create_info.format.dimension_type = renderpack::TextureDimensionType::Absolute;
+            image_create_info.format.width = static_cast<float>(size.x);
+            image_create_info.format.height = static_cast<float>(size.y);
+
+            RhiImage* image = render_device->create_image(image_create_info, allocator);
+            image->state = ResourceState::PresentSource;
+            image->stages = PipelineStage::BottomOfPipe;
+            swapchain_images.push_back(image);
+
+            rx::vector<RhiImage*> attachments{allocator};
+            attachments.push_back(image);
+            framebuffers.push_back(render_device->create_framebuffer(nullptr, attachments, rx::nullopt, size, allocator));
+        }
+
+        fences = render_device->create_fences(num_images, true, allocator);
+    }
+
+    void HeadlessSwapchain::destroy_images() {
+        framebuffers.each_fwd([&](RhiFramebuffer* framebuffer) { render_device->destroy_framebuffer(framebuffer, allocator); });
+        swapchain_images.each_fwd([&](RhiImage* image) { render_device->destroy_texture(image, allocator); });
+        render_device->destroy_fences(fences, allocator);
+
+        framebuffers.clear();
+        swapchain_images.clear();
+        fences.clear();
+    }
+} // namespace nova::renderer::rhi
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "nova_renderer/rhi/swapchain.hpp"
+
+namespace nova::renderer::rhi {
+    class HeadlessRenderDevice;
+
+    /*!
+     * \brief Swapchain that has images and framebuffers, but never shows them anywhere
+     *
+     * Images are acquired round-robin and presenting does nothing
+     */
+    class HeadlessSwapchain final : public Swapchain {
+    public:
+        HeadlessSwapchain(uint32_t num_images, HeadlessRenderDevice* render_device, const glm::uvec2& size, rx::memory::allocator* allocator);
+
+        ~HeadlessSwapchain() override;
+
+#pragma region Swapchain implementation
+        uint8_t acquire_next_swapchain_image(RhiSemaphore* image_acquired_semaphore, rx::memory::allocator* allocator) override;
+
+        void present(uint32_t image_idx, RhiSemaphore* render_finished_semaphore) override;
+#pragma endregion
+
+        /*!
+         * \brief Replaces the swapchain's images, framebuffers, and fences with new ones
+         */
+        void recreate(uint32_t new_num_images, const glm::uvec2& new_size);
+
+    private:
+        HeadlessRenderDevice* render_device;
+
+        rx::memory::allocator* allocator;
+
+        uint32_t next_image_idx = 0;
+
+        void create_images();
+
+        void destroy_images();
+    };
+} // namespace nova::renderer::rhi
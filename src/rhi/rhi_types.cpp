@@ -26,6 +26,15 @@ namespace nova::renderer::rhi {
         return static_cast<ShaderStage>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
     }
 
+    PipelineStage operator|(const PipelineStage lhs, const PipelineStage rhs) {
+        return static_cast<PipelineStage>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+    }
+
+    PipelineStage& operator|=(PipelineStage& lhs, const PipelineStage rhs) {
+        lhs = lhs | rhs;
+        return lhs;
+    }
+
     bool is_depth_format(const PixelFormat format) {
         switch(format) {
             case PixelFormat::Rgba8:
@@ -81,6 +90,12 @@ namespace nova::renderer::rhi {
             case DescriptorType::Sampler:
                 return "Sampler";
 
+            case DescriptorType::InputAttachment:
+                return "InputAttachment";
+
+            case DescriptorType::StorageImage:
+                return "StorageImage";
+
             default:
                 return "Unknown";
         }
@@ -10,4 +10,8 @@ namespace nova::renderer::rhi {
     RhiFence* Swapchain::get_fence(const uint32_t frame_idx) const { return fences[frame_idx]; }
 
     glm::uvec2 Swapchain::get_size() const { return size; }
+
+    uint32_t Swapchain::get_num_images() const { return num_images; }
+
+    bool Swapchain::is_out_of_date() const { return out_of_date; }
 } // namespace nova::renderer::rhi
\ No newline at end of file
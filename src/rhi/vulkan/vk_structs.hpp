@@ -13,6 +13,13 @@
 namespace nova::renderer::rhi {
     struct VulkanDeviceMemory : RhiDeviceMemory {
         VkDeviceMemory memory;
+
+        uint32_t memory_type_index = 0;
+
+        /*!
+         * \brief Where the memory is mapped, or nullptr if the host can't access it
+         */
+        void* mapped_data = nullptr;
     };
 
     struct VulkanSampler : RhiSampler {
@@ -27,8 +34,17 @@ namespace nova::renderer::rhi {
 
     struct VulkanBuffer : RhiBuffer {
         VkBuffer buffer = VK_NULL_HANDLE;
+
+        /*!
+         * \brief The buffer's own memory, if it isn't placed in a memory resource
+         */
         VmaAllocation allocation{};
         VmaAllocationInfo allocation_info{};
+
+        /*!
+         * \brief Where the buffer's memory is mapped, or nullptr if the host can't access it
+         */
+        void* mapped_data = nullptr;
     };
 
     struct VulkanRenderpass : RhiRenderpass {
@@ -61,6 +77,8 @@ namespace nova::renderer::rhi {
 
     struct VulkanPipeline : RhiPipeline {
         VkPipeline pipeline = VK_NULL_HANDLE;
+
+        VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
     };
 
     struct VulkanDescriptorPool : RhiDescriptorPool {
@@ -79,6 +97,10 @@ namespace nova::renderer::rhi {
         VkFence fence;
     };
 
+    struct VulkanQueryPool : RhiQueryPool {
+        VkQueryPool pool = VK_NULL_HANDLE;
+    };
+
     struct VulkanGpuInfo {
         VkPhysicalDevice phys_device{};
         rx::vector<VkQueueFamilyProperties> queue_family_props;
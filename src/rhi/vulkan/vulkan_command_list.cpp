@@ -4,6 +4,8 @@
 #include <string.h>
 #include <vk_mem_alloc.h>
 
+#include "nova_renderer/render_statistics.hpp"
+
 #include "vk_structs.hpp"
 #include "vulkan_render_device.hpp"
 #include "vulkan_utils.hpp"
@@ -22,14 +24,25 @@ namespace nova::renderer::rhi {
         }
     }
 
-    VulkanCommandList::VulkanCommandList(VkCommandBuffer cmds, const VulkanRenderDevice* render_device)
-        : cmds(cmds), render_device(*render_device) {
+    VulkanCommandList::VulkanCommandList(VkCommandBuffer cmds,
+                                         const uint32_t frame_idx,
+                                         const Level level,
+                                         const VkCommandBufferInheritanceInfo* inheritance_info,
+                                         const VulkanRenderDevice* render_device,
+                                         rx::memory::allocator* allocator)
+        : CommandList(allocator), cmds(cmds), frame_idx(frame_idx), render_device(*render_device) {
 
-        // TODO: Put this begin info in the constructor parameters
         VkCommandBufferBeginInfo begin_info = {};
         begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
         begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
+        if(level == Level::Secondary) {
+            begin_info.pInheritanceInfo = inheritance_info;
+            if(inheritance_info->renderPass != VK_NULL_HANDLE) {
+                begin_info.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            }
+        }
+
         vkBeginCommandBuffer(cmds, &begin_info);
     }
 
@@ -63,8 +76,8 @@ namespace nova::renderer::rhi {
                     image_barrier.dstAccessMask = to_vk_access_flags(barrier.access_after_barrier);
                     image_barrier.oldLayout = to_vk_image_layout(barrier.old_state);
                     image_barrier.newLayout = to_vk_image_layout(barrier.new_state);
-                    image_barrier.srcQueueFamilyIndex = render_device.get_queue_family_index(barrier.source_queue);
-                    image_barrier.dstQueueFamilyIndex = render_device.get_queue_family_index(barrier.destination_queue);
+                    image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
                     image_barrier.image = image->image;
                     image_barrier.subresourceRange.aspectMask = static_cast<VkImageAspectFlags>(barrier.image_memory_barrier.aspect);
                     image_barrier.subresourceRange.baseMipLevel = 0; // TODO: Something smarter with mips
@@ -82,8 +95,8 @@ namespace nova::renderer::rhi {
                     buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
                     buffer_barrier.srcAccessMask = to_vk_access_flags(barrier.access_before_barrier);
                     buffer_barrier.dstAccessMask = to_vk_access_flags(barrier.access_after_barrier);
-                    buffer_barrier.srcQueueFamilyIndex = render_device.get_queue_family_index(barrier.source_queue);
-                    buffer_barrier.dstQueueFamilyIndex = render_device.get_queue_family_index(barrier.destination_queue);
+                    buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
                     buffer_barrier.buffer = buffer->buffer;
                     buffer_barrier.offset = barrier.buffer_memory_barrier.offset.b_count();
                     buffer_barrier.size = barrier.buffer_memory_barrier.size.b_count();
@@ -103,6 +116,8 @@ namespace nova::renderer::rhi {
                              buffer_barriers.data(),
                              static_cast<uint32_t>(image_barriers.size()),
                              image_barriers.data());
+
+        statistics::count(&RenderStatistics::num_barriers, barriers.size());
     }
 
     void VulkanCommandList::copy_buffer(RhiBuffer* destination_buffer,
@@ -110,6 +125,8 @@ namespace nova::renderer::rhi {
                                         RhiBuffer* source_buffer,
                                         const mem::Bytes source_offset,
                                         const mem::Bytes num_bytes) {
+        flush_barriers();
+
         VkBufferCopy copy;
         copy.srcOffset = source_offset.b_count();
         copy.dstOffset = destination_offset.b_count();
@@ -119,21 +136,31 @@ namespace nova::renderer::rhi {
 
         // TODO: fix the crash on this line
         vkCmdCopyBuffer(cmds, vk_source_buffer->buffer, vk_destination_buffer->buffer, 1, &copy);
+
+        statistics::count(&RenderStatistics::num_staging_bytes_uploaded, num_bytes.b_count());
     }
 
     void VulkanCommandList::execute_command_lists(const rx::vector<CommandList*>& lists) {
+        flush_barriers();
+
         rx::vector<VkCommandBuffer> buffers;
         buffers.reserve(lists.size());
 
         lists.each_fwd([&](CommandList* list) {
             auto* vk_list = dynamic_cast<VulkanCommandList*>(list);
+
+            // Secondary command lists are never submitted, so this is the last time anyone sees them
+            vkEndCommandBuffer(vk_list->cmds);
+
             buffers.push_back(vk_list->cmds);
         });
 
         vkCmdExecuteCommands(cmds, static_cast<uint32_t>(buffers.size()), buffers.data());
     }
 
-    void VulkanCommandList::begin_renderpass(RhiRenderpass* renderpass, RhiFramebuffer* framebuffer) {
+    void VulkanCommandList::begin_renderpass(RhiRenderpass* renderpass, RhiFramebuffer* framebuffer, const RenderpassContents contents) {
+        flush_barriers();
+
         auto* vk_renderpass = static_cast<VulkanRenderpass*>(renderpass);
         auto* vk_framebuffer = static_cast<VulkanFramebuffer*>(framebuffer);
 
@@ -154,15 +181,43 @@ namespace nova::renderer::rhi {
         begin_info.clearValueCount = vk_framebuffer->num_attachments;
         begin_info.pClearValues = CLEAR_VALUES.data();
 
-        // Nova _always_ records command lists in parallel for each renderpass
-        vkCmdBeginRenderPass(cmds, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+        const auto subpass_contents = contents == RenderpassContents::SecondaryCommandLists ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS :
+                                                                                              VK_SUBPASS_CONTENTS_INLINE;
+        vkCmdBeginRenderPass(cmds, &begin_info, subpass_contents);
+
+        if(subpass_contents == VK_SUBPASS_CONTENTS_INLINE) {
+            set_viewport_and_scissor(framebuffer->size);
+        }
+    }
+
+    void VulkanCommandList::set_viewport_and_scissor(const glm::uvec2& size) {
+        VkViewport viewport;
+        viewport.x = 0;
+        viewport.y = 0;
+        viewport.width = static_cast<float>(size.x);
+        viewport.height = static_cast<float>(size.y);
+        viewport.minDepth = 0.0F;
+        viewport.maxDepth = 1.0F;
+        vkCmdSetViewport(cmds, 0, 1, &viewport);
+
+        const VkRect2D scissor = {{0, 0}, {size.x, size.y}};
+        vkCmdSetScissor(cmds, 0, 1, &scissor);
+    }
+
+    void VulkanCommandList::next_subpass(const RenderpassContents contents) {
+        const auto subpass_contents = contents == RenderpassContents::SecondaryCommandLists ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS :
+                                                                                              VK_SUBPASS_CONTENTS_INLINE;
+        vkCmdNextSubpass(cmds, subpass_contents);
     }
 
     void VulkanCommandList::end_renderpass() { vkCmdEndRenderPass(cmds); }
 
     void VulkanCommandList::bind_pipeline(const RhiPipeline* pipeline) {
         const auto* vk_pipeline = static_cast<const VulkanPipeline*>(pipeline);
-        vkCmdBindPipeline(cmds, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_pipeline->pipeline);
+        bind_point = vk_pipeline->bind_point;
+        vkCmdBindPipeline(cmds, bind_point, vk_pipeline->pipeline);
+
+        statistics::count(&RenderStatistics::num_pipeline_binds);
     }
 
     void VulkanCommandList::bind_descriptor_sets(const rx::vector<RhiDescriptorSet*>& descriptor_sets,
@@ -175,7 +230,7 @@ namespace nova::renderer::rhi {
             // logger(rx::log::level::k_verbose, "Binding descriptor set %x", vk_set->descriptor_set);
 
             vkCmdBindDescriptorSets(cmds,
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    bind_point,
                                     vk_interface->pipeline_layout,
                                     i,
                                     1,
@@ -183,6 +238,8 @@ namespace nova::renderer::rhi {
                                     0,
                                     nullptr);
         }
+
+        statistics::count(&RenderStatistics::num_descriptor_set_binds, descriptor_sets.size());
     }
 
     void VulkanCommandList::bind_vertex_buffers(const rx::vector<RhiBuffer*>& buffers) {
@@ -208,6 +265,9 @@ namespace nova::renderer::rhi {
 
     void VulkanCommandList::draw_indexed_mesh(const uint32_t num_indices, const uint32_t offset, const uint32_t num_instances) {
         vkCmdDrawIndexed(cmds, num_indices, num_instances, offset, 0, 0);
+
+        statistics::count(&RenderStatistics::num_draw_calls);
+        statistics::count(&RenderStatistics::num_indices, static_cast<uint64_t>(num_indices) * num_instances);
     }
 
     void VulkanCommandList::set_scissor_rect(const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height) {
@@ -215,12 +275,42 @@ namespace nova::renderer::rhi {
         vkCmdSetScissor(cmds, 0, 1, &scissor_rect);
     }
 
+    void VulkanCommandList::set_viewport(const float x, const float y, const float width, const float height) {
+        const VkViewport viewport = {x, y, width, height, 0.0F, 1.0F};
+        vkCmdSetViewport(cmds, 0, 1, &viewport);
+    }
+
+    void VulkanCommandList::dispatch(const uint32_t num_groups_x, const uint32_t num_groups_y, const uint32_t num_groups_z) {
+        flush_barriers();
+
+        vkCmdDispatch(cmds, num_groups_x, num_groups_y, num_groups_z);
+    }
+
+    void VulkanCommandList::dispatch_indirect(const RhiBuffer* buffer, const mem::Bytes offset) {
+        flush_barriers();
+
+        const auto* vk_buffer = static_cast<const VulkanBuffer*>(buffer);
+        vkCmdDispatchIndirect(cmds, vk_buffer->buffer, offset.b_count());
+    }
+
+    void VulkanCommandList::reset_queries(RhiQueryPool* pool, const uint32_t first_query, const uint32_t num_queries) {
+        const auto* vk_pool = static_cast<const VulkanQueryPool*>(pool);
+        vkCmdResetQueryPool(cmds, vk_pool->pool, first_query, num_queries);
+    }
+
+    void VulkanCommandList::write_timestamp(RhiQueryPool* pool, const uint32_t query_idx, const PipelineStage stage) {
+        const auto* vk_pool = static_cast<const VulkanQueryPool*>(pool);
+        vkCmdWriteTimestamp(cmds, static_cast<VkPipelineStageFlagBits>(stage), vk_pool->pool, query_idx);
+    }
+
     void VulkanCommandList::upload_data_to_image(
         RhiImage* image, const size_t width, const size_t height, const size_t bytes_per_pixel, RhiBuffer* staging_buffer, const void* data) {
+        flush_barriers();
+
         auto* vk_image = static_cast<VulkanImage*>(image);
         auto* vk_buffer = static_cast<VulkanBuffer*>(staging_buffer);
 
-        memcpy(vk_buffer->allocation_info.pMappedData, data, width * height * bytes_per_pixel);
+        memcpy(vk_buffer->mapped_data, data, width * height * bytes_per_pixel);
 
         VkBufferImageCopy image_copy{};
         if(!vk_image->is_depth_tex) {
@@ -232,5 +322,7 @@ namespace nova::renderer::rhi {
         image_copy.imageExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
 
         vkCmdCopyBufferToImage(cmds, vk_buffer->buffer, vk_image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &image_copy);
+
+        statistics::count(&RenderStatistics::num_staging_bytes_uploaded, width * height * bytes_per_pixel);
     }
 } // namespace nova::renderer::rhi
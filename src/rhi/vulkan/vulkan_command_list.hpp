@@ -16,7 +16,27 @@ namespace nova::renderer::rhi {
     public:
         VkCommandBuffer cmds;
 
-        VulkanCommandList(VkCommandBuffer cmds, const VulkanRenderDevice* render_device);
+        /*!
+         * \brief The in-flight frame whose command pool `cmds` was allocated from
+         *
+         * The command buffer can't be reused until that frame's pools are reset, so its submission is tracked with that frame's fences,
+         * even if it's submitted after the next frame begins
+         */
+        uint32_t frame_idx;
+
+        /*!
+         * \brief Begins recording into a command buffer
+         *
+         * \param frame_idx The in-flight frame whose command pool `cmds` was allocated from
+         * \param inheritance_info The renderpass state that a secondary command buffer inherits. Must be non-null if `level` is
+         * `Secondary`, and is ignored for primary command buffers
+         */
+        VulkanCommandList(VkCommandBuffer cmds,
+                          uint32_t frame_idx,
+                          Level level,
+                          const VkCommandBufferInheritanceInfo* inheritance_info,
+                          const VulkanRenderDevice* render_device,
+                          rx::memory::allocator* allocator);
 
         ~VulkanCommandList() override = default;
 
@@ -34,7 +54,11 @@ namespace nova::renderer::rhi {
 
         void execute_command_lists(const rx::vector<CommandList*>& lists) override;
 
-        void begin_renderpass(RhiRenderpass* renderpass, RhiFramebuffer* framebuffer) override;
+        void begin_renderpass(RhiRenderpass* renderpass,
+                              RhiFramebuffer* framebuffer,
+                              RenderpassContents contents = RenderpassContents::Inline) override;
+
+        void next_subpass(RenderpassContents contents = RenderpassContents::Inline) override;
 
         void end_renderpass() override;
 
@@ -50,10 +74,30 @@ namespace nova::renderer::rhi {
 
         void set_scissor_rect(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
 
+        void set_viewport(float x, float y, float width, float height) override;
+
+        void dispatch(uint32_t num_groups_x, uint32_t num_groups_y, uint32_t num_groups_z) override;
+
+        void dispatch_indirect(const RhiBuffer* buffer, mem::Bytes offset) override;
+
+        void reset_queries(RhiQueryPool* pool, uint32_t first_query, uint32_t num_queries) override;
+
+        void write_timestamp(RhiQueryPool* pool, uint32_t query_idx, PipelineStage stage) override;
+
         void upload_data_to_image(
             RhiImage* image, size_t width, size_t height, size_t bytes_per_pixel, RhiBuffer* staging_buffer, const void* data) override;
 
+        /*!
+         * \brief Sets the viewport and the scissor rect to cover the whole of a framebuffer of the given size
+         */
+        void set_viewport_and_scissor(const glm::uvec2& size);
+
     private:
         const VulkanRenderDevice& render_device;
+
+        /*!
+         * \brief The bind point of the most recently bound pipeline, so that descriptor sets get bound to the same bind point
+         */
+        VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
     };
 } // namespace nova::renderer::rhi
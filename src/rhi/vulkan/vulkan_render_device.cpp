@@ -4,6 +4,8 @@
 
 #include <sstream>
 
+#include <rx/core/concurrency/scope_lock.h>
+#include <rx/core/filesystem/file.h>
 #include <rx/core/log.h>
 #include <rx/core/set.h>
 #include <signal.h>
@@ -11,11 +13,13 @@
 
 #include "nova_renderer/constants.hpp"
 #include "nova_renderer/memory/allocation_structs.hpp"
+#include "nova_renderer/render_statistics.hpp"
 #include "nova_renderer/renderables.hpp"
 #include "nova_renderer/rhi/pipeline_create_info.hpp"
 #include "nova_renderer/window.hpp"
 
 #include "rx/core/algorithm/max.h"
+#include "rx/core/algorithm/min.h"
 #include "vk_structs.hpp"
 #include "vulkan_command_list.hpp"
 #include "vulkan_utils.hpp"
@@ -49,7 +53,10 @@ namespace nova::renderer::rhi {
     VulkanRenderDevice::VulkanRenderDevice(NovaSettingsAccessManager& settings, NovaWindow& window, rx::memory::allocator* allocator)
         : RenderDevice{settings, window, allocator},
           vk_internal_allocator{wrap_allocator(internal_allocator)},
-          command_pools_by_thread_idx{internal_allocator} {
+          command_pools{internal_allocator},
+          main_thread_id{std::this_thread::get_id()},
+          untracked_submission_fences{internal_allocator},
+          free_submission_fences{internal_allocator} {
         create_instance();
 
         if(settings.settings.debug.enabled) {
@@ -73,6 +80,15 @@ namespace nova::renderer::rhi {
         create_swapchain();
 
         create_per_thread_command_pools();
+
+        create_pipeline_cache();
+    }
+
+    VulkanRenderDevice::~VulkanRenderDevice() {
+        save_pipeline_cache();
+
+        auto vk_alloc = wrap_allocator(internal_allocator);
+        vkDestroyPipelineCache(device, pipeline_cache, &vk_alloc);
     }
 
     void VulkanRenderDevice::set_num_renderpasses(uint32_t /* num_renderpasses */) {
@@ -103,27 +119,46 @@ namespace nova::renderer::rhi {
 
             case MemoryUsage::LowFrequencyUpload:
                 // Find a memory type that's visible to both the device and the host. Memory that's both device local and host visible would
-                // be amazing, otherwise HOST_CACHED will work I guess
+                // be amazing, otherwise any host visible memory will work. Nova never flushes mapped memory, so it has to be coherent
                 alloc_info.memoryTypeIndex = find_memory_type_with_flags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
-                                                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+                                                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
                 if(alloc_info.memoryTypeIndex == VK_MAX_MEMORY_TYPES) {
-                    alloc_info.memoryTypeIndex = find_memory_type_with_flags(VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+                    alloc_info.memoryTypeIndex = find_memory_type_with_flags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
                 }
                 break;
 
             case MemoryUsage::StagingBuffer:
                 alloc_info.memoryTypeIndex = find_memory_type_with_flags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
                                                                          VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+                if(alloc_info.memoryTypeIndex == VK_MAX_MEMORY_TYPES) {
+                    alloc_info.memoryTypeIndex = find_memory_type_with_flags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+                }
                 break;
         }
 
+        if(alloc_info.memoryTypeIndex == VK_MAX_MEMORY_TYPES) {
+            allocator->destroy<VulkanDeviceMemory>(memory);
+            return ntl::Result<RhiDeviceMemory*>(MAKE_ERROR("Could not find a memory type for %u bytes of device memory", size.b_count()));
+        }
+
+        memory->memory_type_index = alloc_info.memoryTypeIndex;
+
         auto vk_alloc = wrap_allocator(allocator);
-        vkAllocateMemory(device, &alloc_info, &vk_alloc, &memory->memory);
+        const auto result = vkAllocateMemory(device, &alloc_info, &vk_alloc, &memory->memory);
+        if(result != VK_SUCCESS) {
+            allocator->destroy<VulkanDeviceMemory>(memory);
+            return ntl::Result<RhiDeviceMemory*>(
+                MAKE_ERROR("Could not allocate %u bytes of device memory: %s", size.b_count(), to_string(result)));
+        }
 
-        if(usage == MemoryUsage::StagingBuffer) {
-            void* mapped_memory;
-            vkMapMemory(device, memory->memory, 0, VK_WHOLE_SIZE, 0, &mapped_memory);
-            heap_mappings.insert(memory->memory, mapped_memory);
+        // Placed buffers write through the memory's mapping, so every host-visible memory is mapped for as long as it lives
+        const auto& memory_type = gpu.memory_properties.memoryTypes[alloc_info.memoryTypeIndex];
+        if((memory_type.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+            NOVA_CHECK_RESULT(vkMapMemory(device, memory->memory, 0, VK_WHOLE_SIZE, 0, &memory->mapped_data));
         }
 
         return ntl::Result<RhiDeviceMemory*>(memory);
@@ -132,159 +167,255 @@ namespace nova::renderer::rhi {
     ntl::Result<RhiRenderpass*> VulkanRenderDevice::create_renderpass(const renderpack::RenderPassCreateInfo& data,
                                                                    const glm::uvec2& framebuffer_size,
                                                                    rx::memory::allocator* allocator) {
+        rx::vector<renderpack::RenderPassCreateInfo> subpasses{allocator};
+        subpasses.push_back(data);
+
+        return create_merged_renderpass(subpasses, framebuffer_size, allocator);
+    }
+
+    ntl::Result<RhiRenderpass*> VulkanRenderDevice::create_merged_renderpass(const rx::vector<renderpack::RenderPassCreateInfo>& subpasses,
+                                                                          const glm::uvec2& framebuffer_size,
+                                                                          rx::memory::allocator* allocator) {
         auto* vk_swapchain = static_cast<VulkanSwapchain*>(swapchain);
         VkExtent2D swapchain_extent = {swapchain_size.x, swapchain_size.y};
 
-        auto* renderpass = allocator->create<VulkanRenderpass>();
+        const auto num_subpasses = static_cast<uint32_t>(subpasses.size());
 
-        VkSubpassDescription subpass_description = {};
-        subpass_description.flags = 0;
-        subpass_description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        subpass_description.inputAttachmentCount = 0;
-        subpass_description.pInputAttachments = nullptr;
-        subpass_description.preserveAttachmentCount = 0;
-        subpass_description.pPreserveAttachments = nullptr;
-        subpass_description.pResolveAttachments = nullptr;
-        subpass_description.pDepthStencilAttachment = nullptr;
+        rx::string renderpass_name = subpasses[0].name;
+        for(uint32_t subpass_idx = 1; subpass_idx < num_subpasses; subpass_idx++) {
+            renderpass_name = rx::string::format("%s+%s", renderpass_name, subpasses[subpass_idx].name);
+        }
 
-        VkSubpassDependency image_available_dependency = {};
-        image_available_dependency.dependencyFlags = 0;
-        image_available_dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        image_available_dependency.dstSubpass = 0;
-        image_available_dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        image_available_dependency.srcAccessMask = 0;
-        image_available_dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        image_available_dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        uint32_t framebuffer_width = framebuffer_size.x;
+        uint32_t framebuffer_height = framebuffer_size.y;
 
-        VkRenderPassCreateInfo render_pass_create_info = {};
-        render_pass_create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        render_pass_create_info.pNext = nullptr;
-        render_pass_create_info.flags = 0;
-        render_pass_create_info.subpassCount = 1;
-        render_pass_create_info.pSubpasses = &subpass_description;
-        render_pass_create_info.dependencyCount = 1;
-        render_pass_create_info.pDependencies = &image_available_dependency;
+        const auto make_attachment_description = [](const VkFormat format, const VkAttachmentLoadOp load_op, const VkImageLayout layout) {
+            VkAttachmentDescription desc = {};
+            desc.flags = 0;
+            desc.format = format;
+            desc.samples = VK_SAMPLE_COUNT_1_BIT;
+            desc.loadOp = load_op;
+            desc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+            // Attachments go back to the layout of their first use at the end of the renderpass, so that the renderpass looks like a
+            // single subpass from the outside
+            desc.initialLayout = layout;
+            desc.finalLayout = layout;
+
+            return desc;
+        };
+
+        // All subpasses share one depth texture, which is always the last attachment
+        rx::optional<renderpack::TextureAttachmentInfo> depth_texture;
+        subpasses.each_fwd([&](const renderpack::RenderPassCreateInfo& data) {
+            if(data.depth_texture) {
+                depth_texture = data.depth_texture;
+                return false;
+            }
+
+            return true;
+        });
 
-        rx::vector<VkAttachmentReference> attachment_references{allocator};
+        rx::vector<rx::string> attachment_names{allocator};
         rx::vector<VkAttachmentDescription> attachments{allocator};
-        rx::vector<VkImageView> framebuffer_attachments{allocator};
-        uint32_t framebuffer_width = framebuffer_size.x;
-        uint32_t framebuffer_height = framebuffer_size.y;
 
-        bool writes_to_backbuffer = false;
-        // Collect framebuffer size information from color output attachments
-        data.texture_outputs.each_fwd([&](const renderpack::TextureAttachmentInfo& attachment) {
-            if(attachment.name == BACKBUFFER_NAME) {
-                // Handle backbuffer
-                // Backbuffer framebuffers are handled by themselves in their own special snowflake way so we just need to skip
-                // everything
-                writes_to_backbuffer = true;
+        subpasses.each_fwd([&](const renderpack::RenderPassCreateInfo& data) {
+            data.texture_outputs.each_fwd([&](const renderpack::TextureAttachmentInfo& attachment) {
+                if(attachment_names.find(attachment.name) != rx::vector<rx::string>::k_npos) {
+                    return;
+                }
 
-                VkAttachmentDescription desc;
-                desc.flags = 0;
-                desc.format = vk_swapchain->get_swapchain_format();
-                desc.samples = VK_SAMPLE_COUNT_1_BIT;
-                desc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-                desc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-                desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                desc.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                desc.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                attachment_names.push_back(attachment.name);
 
-                attachments.push_back(desc);
+                if(attachment.name == BACKBUFFER_NAME) {
+                    // Backbuffer framebuffers are handled by themselves in their own special snowflake way, so we only need the
+                    // swapchain's format and size
+                    attachments.push_back(make_attachment_description(vk_swapchain->get_swapchain_format(),
+                                                                      VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                                                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
 
-                VkAttachmentReference ref;
+                    framebuffer_width = swapchain_extent.width;
+                    framebuffer_height = swapchain_extent.height;
 
-                ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                ref.attachment = static_cast<uint32_t>(attachments.size()) - 1;
+                } else {
+                    attachments.push_back(make_attachment_description(to_vk_format(attachment.pixel_format),
+                                                                      attachment.clear ? VK_ATTACHMENT_LOAD_OP_CLEAR :
+                                                                                         VK_ATTACHMENT_LOAD_OP_LOAD,
+                                                                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+                }
+            });
 
-                attachment_references.push_back(ref);
+            data.input_attachments.each_fwd([&](const renderpack::TextureAttachmentInfo& attachment) {
+                if(attachment_names.find(attachment.name) == rx::vector<rx::string>::k_npos) {
+                    attachment_names.push_back(attachment.name);
+                    attachments.push_back(make_attachment_description(to_vk_format(attachment.pixel_format),
+                                                                      VK_ATTACHMENT_LOAD_OP_LOAD,
+                                                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+                }
+            });
+        });
 
-                framebuffer_width = swapchain_extent.width;
-                framebuffer_height = swapchain_extent.height;
+        if(depth_texture) {
+            attachment_names.push_back(depth_texture->name);
+            attachments.push_back(make_attachment_description(to_vk_format(depth_texture->pixel_format),
+                                                              depth_texture->clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD,
+                                                              VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL));
+        }
 
-            } else {
-                VkAttachmentDescription desc;
-                desc.flags = 0;
-                desc.format = to_vk_format(attachment.pixel_format);
-                desc.samples = VK_SAMPLE_COUNT_1_BIT;
-                desc.loadOp = attachment.clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
-                desc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-                desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                desc.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                desc.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        const auto num_attachments = static_cast<uint32_t>(attachments.size());
+
+        // The references have to stay where they are until the renderpass is created, so every subpass gets its own vectors
+        rx::vector<rx::vector<VkAttachmentReference>> color_references{allocator};
+        rx::vector<rx::vector<VkAttachmentReference>> input_references{allocator};
+        rx::vector<rx::vector<uint32_t>> preserved_attachments{allocator};
+        rx::vector<VkAttachmentReference> depth_references{allocator};
+        color_references.resize(num_subpasses);
+        input_references.resize(num_subpasses);
+        preserved_attachments.resize(num_subpasses);
+        depth_references.resize(num_subpasses, VkAttachmentReference{VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED});
+
+        rx::vector<uint32_t> first_uses{allocator};
+        rx::vector<uint32_t> last_uses{allocator};
+        rx::vector<bool> is_used{allocator};
+        first_uses.resize(num_attachments, num_subpasses);
+        last_uses.resize(num_attachments, 0);
+        is_used.resize(num_attachments * num_subpasses, false);
+
+        const auto use_attachment = [&](const uint32_t subpass_idx, const uint32_t attachment_idx) {
+            first_uses[attachment_idx] = rx::algorithm::min(first_uses[attachment_idx], subpass_idx);
+            last_uses[attachment_idx] = rx::algorithm::max(last_uses[attachment_idx], subpass_idx);
+            is_used[attachment_idx * num_subpasses + subpass_idx] = true;
+        };
 
-                attachments.push_back(desc);
+        for(uint32_t subpass_idx = 0; subpass_idx < num_subpasses; subpass_idx++) {
+            const auto& data = subpasses[subpass_idx];
 
-                VkAttachmentReference ref;
-                ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-                ref.attachment = static_cast<uint32_t>(attachments.size()) - 1;
+            data.texture_outputs.each_fwd([&](const renderpack::TextureAttachmentInfo& attachment) {
+                const auto attachment_idx = static_cast<uint32_t>(attachment_names.find(attachment.name));
+                color_references[subpass_idx].push_back(VkAttachmentReference{attachment_idx, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+                use_attachment(subpass_idx, attachment_idx);
+            });
 
-                attachment_references.push_back(ref);
+            data.input_attachments.each_fwd([&](const renderpack::TextureAttachmentInfo& attachment) {
+                const auto attachment_idx = static_cast<uint32_t>(attachment_names.find(attachment.name));
+                input_references[subpass_idx].push_back(VkAttachmentReference{attachment_idx, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+                use_attachment(subpass_idx, attachment_idx);
+            });
+
+            if(data.depth_texture) {
+                depth_references[subpass_idx] = VkAttachmentReference{num_attachments - 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+                use_attachment(subpass_idx, num_attachments - 1);
             }
-        });
 
-        VkAttachmentReference depth_reference = {};
-        // Collect framebuffer size information from the depth attachment
-        if(data.depth_texture) {
-            VkAttachmentDescription desc = {};
-            desc.flags = 0;
-            desc.format = to_vk_format(data.depth_texture->pixel_format);
-            desc.samples = VK_SAMPLE_COUNT_1_BIT;
-            desc.loadOp = data.depth_texture->clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
-            desc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-            desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            desc.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            desc.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            if(color_references[subpass_idx].size() > gpu.props.limits.maxColorAttachments) {
+                return ntl::Result<RhiRenderpass*>(MAKE_ERROR(
+                    "Framebuffer for pass {:s} has {:d} color attachments, but your GPU only supports {:d}. Please reduce the number of attachments that this pass uses, possibly by changing some of your input attachments to bound textures",
+                    data.name.data(),
+                    data.texture_outputs.size(),
+                    gpu.props.limits.maxColorAttachments));
+            }
 
-            attachments.push_back(desc);
+            if(data.texture_outputs.size() > 1 && data.texture_outputs.find_if([](const renderpack::TextureAttachmentInfo& attachment) {
+                   return attachment.name == BACKBUFFER_NAME;
+               }) != rx::vector<renderpack::TextureAttachmentInfo>::k_npos) {
+                logger(
+                    rx::log::level::k_error,
+                    "Pass %s writes to the backbuffer, and other textures. Passes that write to the backbuffer are not allowed to write to any other textures",
+                    data.name);
+            }
+        }
 
-            depth_reference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            depth_reference.attachment = static_cast<uint32_t>(attachments.size()) - 1;
+        // Subpasses between two uses of an attachment have to preserve it, or its contents are undefined by the time the later use
+        // reads it
+        for(uint32_t attachment_idx = 0; attachment_idx < num_attachments; attachment_idx++) {
+            for(uint32_t subpass_idx = first_uses[attachment_idx] + 1; subpass_idx < last_uses[attachment_idx]; subpass_idx++) {
+                if(!is_used[attachment_idx * num_subpasses + subpass_idx]) {
+                    preserved_attachments[subpass_idx].push_back(attachment_idx);
+                }
+            }
+        }
 
-            subpass_description.pDepthStencilAttachment = &depth_reference;
+        rx::vector<VkSubpassDescription> subpass_descriptions{allocator};
+        subpass_descriptions.reserve(num_subpasses);
+
+        for(uint32_t subpass_idx = 0; subpass_idx < num_subpasses; subpass_idx++) {
+            VkSubpassDescription subpass_description = {};
+            subpass_description.flags = 0;
+            subpass_description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            subpass_description.inputAttachmentCount = static_cast<uint32_t>(input_references[subpass_idx].size());
+            subpass_description.pInputAttachments = input_references[subpass_idx].data();
+            subpass_description.colorAttachmentCount = static_cast<uint32_t>(color_references[subpass_idx].size());
+            subpass_description.pColorAttachments = color_references[subpass_idx].data();
+            subpass_description.preserveAttachmentCount = static_cast<uint32_t>(preserved_attachments[subpass_idx].size());
+            subpass_description.pPreserveAttachments = preserved_attachments[subpass_idx].data();
+            subpass_description.pResolveAttachments = nullptr;
+            subpass_description.pDepthStencilAttachment = depth_references[subpass_idx].attachment != VK_ATTACHMENT_UNUSED ?
+                                                              &depth_references[subpass_idx] :
+                                                              nullptr;
+
+            subpass_descriptions.push_back(subpass_description);
+        }
+
+        rx::vector<VkSubpassDependency> dependencies{allocator};
+        dependencies.reserve(num_subpasses);
+
+        VkSubpassDependency image_available_dependency = {};
+        image_available_dependency.dependencyFlags = 0;
+        image_available_dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+        image_available_dependency.dstSubpass = 0;
+        image_available_dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        image_available_dependency.srcAccessMask = 0;
+        image_available_dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        image_available_dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies.push_back(image_available_dependency);
+
+        // Each subpass waits for the attachment writes of the subpass before it, but only at the pixels it reads or writes, which is
+        // what lets the GPU keep the attachments in tile memory
+        for(uint32_t subpass_idx = 1; subpass_idx < num_subpasses; subpass_idx++) {
+            VkSubpassDependency subpass_dependency = {};
+            subpass_dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+            subpass_dependency.srcSubpass = subpass_idx - 1;
+            subpass_dependency.dstSubpass = subpass_idx;
+            subpass_dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            subpass_dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            subpass_dependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            subpass_dependency.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                                               VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            dependencies.push_back(subpass_dependency);
         }
 
         if(framebuffer_width == 0) {
             return ntl::Result<RhiRenderpass*>(MAKE_ERROR(
                 "Framebuffer width for pass {:s} is 0. This is illegal! Make sure that there is at least one attachment for this render pass, and ensure that all attachments used by this pass have a non-zero width",
-                data.name.data()));
+                renderpass_name.data()));
         }
 
         if(framebuffer_height == 0) {
             return ntl::Result<RhiRenderpass*>(MAKE_ERROR(
                 "Framebuffer height for pass {:s} is 0. This is illegal! Make sure that there is at least one attachment for this render pass, and ensure that all attachments used by this pass have a non-zero height",
-                data.name.data()));
+                renderpass_name.data()));
         }
 
-        if(framebuffer_attachments.size() > gpu.props.limits.maxColorAttachments) {
-            return ntl::Result<RhiRenderpass*>(MAKE_ERROR(
-                "Framebuffer for pass {:s} has {:d} color attachments, but your GPU only supports {:d}. Please reduce the number of attachments that this pass uses, possibly by changing some of your input attachments to bound textures",
-                data.name.data(),
-                data.texture_outputs.size(),
-                gpu.props.limits.maxColorAttachments));
-        }
-
-        subpass_description.colorAttachmentCount = static_cast<uint32_t>(attachment_references.size());
-        subpass_description.pColorAttachments = attachment_references.data();
-
-        render_pass_create_info.attachmentCount = static_cast<uint32_t>(attachments.size());
+        VkRenderPassCreateInfo render_pass_create_info = {};
+        render_pass_create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        render_pass_create_info.pNext = nullptr;
+        render_pass_create_info.flags = 0;
+        render_pass_create_info.attachmentCount = num_attachments;
         render_pass_create_info.pAttachments = attachments.data();
+        render_pass_create_info.subpassCount = num_subpasses;
+        render_pass_create_info.pSubpasses = subpass_descriptions.data();
+        render_pass_create_info.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        render_pass_create_info.pDependencies = dependencies.data();
+
+        auto* renderpass = allocator->create<VulkanRenderpass>();
 
         auto vk_alloc = wrap_allocator(allocator);
         NOVA_CHECK_RESULT(vkCreateRenderPass(device, &render_pass_create_info, &vk_alloc, &renderpass->pass));
 
-        if(writes_to_backbuffer) {
-            if(data.texture_outputs.size() > 1) {
-                logger(
-                    rx::log::level::k_error,
-                    "Pass %s writes to the backbuffer, and other textures. Passes that write to the backbuffer are not allowed to write to any other textures",
-                    data.name);
-            }
-        }
-
         renderpass->render_area = {{0, 0}, {framebuffer_width, framebuffer_height}};
 
         if(settings.settings.debug.enabled) {
@@ -292,7 +423,7 @@ namespace nova::renderer::rhi {
             object_name.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
             object_name.objectType = VK_OBJECT_TYPE_RENDER_PASS;
             object_name.objectHandle = reinterpret_cast<uint64_t>(renderpass->pass);
-            object_name.pObjectName = data.name.data();
+            object_name.pObjectName = renderpass_name.data();
             NOVA_CHECK_RESULT(vkSetDebugUtilsObjectNameEXT(device, &object_name));
         }
 
@@ -672,6 +803,44 @@ namespace nova::renderer::rhi {
 
                 } break;
 
+                case DescriptorType::InputAttachment: {
+                    // We have a single array for all the image infos, so we need to save the index of the image info for this descriptor
+                    // update
+                    const auto first_image_info_idx = image_infos.size();
+
+                    write.resources.each_fwd([&](const RhiDescriptorResourceInfo& info) {
+                        VkDescriptorImageInfo vk_image_info = {};
+                        vk_image_info.imageView = image_view_for_image(info.image_info.image);
+                        vk_image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+                        image_infos.emplace_back(vk_image_info);
+                    });
+
+                    vk_write.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                    vk_write.pImageInfo = &image_infos[first_image_info_idx];
+
+                    vk_writes.push_back(vk_write);
+                } break;
+
+                case DescriptorType::StorageImage: {
+                    // We have a single array for all the image infos, so we need to save the index of the image info for this descriptor
+                    // update
+                    const auto first_image_info_idx = image_infos.size();
+
+                    write.resources.each_fwd([&](const RhiDescriptorResourceInfo& info) {
+                        VkDescriptorImageInfo vk_image_info = {};
+                        vk_image_info.imageView = image_view_for_image(info.image_info.image);
+                        vk_image_info.imageLayout = to_vk_image_layout(ResourceState::ShaderWrite);
+
+                        image_infos.emplace_back(vk_image_info);
+                    });
+
+                    vk_write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                    vk_write.pImageInfo = &image_infos[first_image_info_idx];
+
+                    vk_writes.push_back(vk_write);
+                } break;
+
                 default:
                     logger(rx::log::level::k_error,
                            "Don't know how to update %s descriptor set %x",
@@ -770,26 +939,15 @@ namespace nova::renderer::rhi {
                 break;
         }
 
-        VkViewport viewport;
-        viewport.x = 0;
-        viewport.y = 0;
-        viewport.width = data.viewport_size.x;
-        viewport.height = data.viewport_size.y;
-        viewport.minDepth = 0.0F;
-        viewport.maxDepth = 1.0F;
-
-        VkRect2D scissor;
-        scissor.offset = {0, 0};
-        scissor.extent = {static_cast<uint32_t>(data.viewport_size.x), static_cast<uint32_t>(data.viewport_size.y)};
-
+        // The viewport and scissor are dynamic, so that pipelines don't have to be recreated when their render targets are resized
         VkPipelineViewportStateCreateInfo viewport_state_create_info;
         viewport_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         viewport_state_create_info.pNext = nullptr;
         viewport_state_create_info.flags = 0;
         viewport_state_create_info.viewportCount = 1;
-        viewport_state_create_info.pViewports = &viewport;
+        viewport_state_create_info.pViewports = nullptr;
         viewport_state_create_info.scissorCount = 1;
-        viewport_state_create_info.pScissors = &scissor;
+        viewport_state_create_info.pScissors = nullptr;
 
         VkPipelineRasterizationStateCreateInfo rasterizer_create_info;
         rasterizer_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -914,11 +1072,11 @@ namespace nova::renderer::rhi {
             color_blend_create_info.pAttachments = attachment_states.data();
         }
 
+        // Command lists set the viewport and scissor to the size of the framebuffer when they begin a renderpass. Pipelines with the
+        // scissor test enabled change the scissor rect after that
         rx::vector<VkDynamicState> dynamic_states;
-
-        if(data.enable_scissor_test) {
-            dynamic_states.emplace_back(VK_DYNAMIC_STATE_SCISSOR);
-        }
+        dynamic_states.emplace_back(VK_DYNAMIC_STATE_VIEWPORT);
+        dynamic_states.emplace_back(VK_DYNAMIC_STATE_SCISSOR);
 
         VkPipelineDynamicStateCreateInfo dynamic_state_create_info = {};
         dynamic_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
@@ -941,12 +1099,18 @@ namespace nova::renderer::rhi {
         pipeline_create_info.pDynamicState = &dynamic_state_create_info;
         pipeline_create_info.layout = vk_interface->pipeline_layout;
 
-        pipeline_create_info.renderPass = vk_interface->pass;
-        pipeline_create_info.subpass = 0;
+        if(data.renderpass != nullptr) {
+            pipeline_create_info.renderPass = static_cast<const VulkanRenderpass*>(data.renderpass)->pass;
+            pipeline_create_info.subpass = data.subpass_index;
+
+        } else {
+            pipeline_create_info.renderPass = vk_interface->pass;
+            pipeline_create_info.subpass = 0;
+        }
         pipeline_create_info.basePipelineIndex = -1;
 
         auto vk_alloc = wrap_allocator(allocator);
-        VkResult result = vkCreateGraphicsPipelines(device, nullptr, 1, &pipeline_create_info, &vk_alloc, &vk_pipeline->pipeline);
+        VkResult result = vkCreateGraphicsPipelines(device, pipeline_cache, 1, &pipeline_create_info, &vk_alloc, &vk_pipeline->pipeline);
         if(result != VK_SUCCESS) {
             return ntl::Result<RhiPipeline*>(MAKE_ERROR("Could not compile pipeline %s", data.name));
         }
@@ -963,6 +1127,54 @@ namespace nova::renderer::rhi {
         return ntl::Result(static_cast<RhiPipeline*>(vk_pipeline));
     }
 
+    ntl::Result<RhiPipeline*> VulkanRenderDevice::create_compute_pipeline(RhiPipelineInterface* pipeline_interface,
+                                                                       const ComputePipelineCreateInfo& data,
+                                                                       rx::memory::allocator* allocator) {
+        logger(rx::log::level::k_verbose, "Creating a compute VkPipeline for pipeline %s", data.name);
+
+        const auto* vk_interface = static_cast<const VulkanPipelineInterface*>(pipeline_interface);
+
+        const auto compute_module = create_shader_module(data.compute_shader.source);
+        if(!compute_module) {
+            return ntl::Result<RhiPipeline*>(MAKE_ERROR("Could not create compute module for pipeline %s", data.name));
+        }
+
+        VkComputePipelineCreateInfo pipeline_create_info = {};
+        pipeline_create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeline_create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipeline_create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipeline_create_info.stage.module = *compute_module;
+        pipeline_create_info.stage.pName = "main";
+        pipeline_create_info.layout = vk_interface->pipeline_layout;
+        pipeline_create_info.basePipelineIndex = -1;
+
+        auto* vk_pipeline = allocator->create<VulkanPipeline>();
+        vk_pipeline->bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+
+        auto vk_alloc = wrap_allocator(allocator);
+        const auto result = vkCreateComputePipelines(device, pipeline_cache, 1, &pipeline_create_info, &vk_alloc, &vk_pipeline->pipeline);
+
+        // The pipeline keeps its own copy of the shader code, so the module isn't needed anymore
+        auto vk_internal_alloc = wrap_allocator(internal_allocator);
+        vkDestroyShaderModule(device, *compute_module, &vk_internal_alloc);
+
+        if(result != VK_SUCCESS) {
+            allocator->destroy<VulkanPipeline>(vk_pipeline);
+            return ntl::Result<RhiPipeline*>(MAKE_ERROR("Could not compile compute pipeline %s", data.name));
+        }
+
+        if(settings.settings.debug.enabled) {
+            VkDebugUtilsObjectNameInfoEXT object_name = {};
+            object_name.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+            object_name.objectType = VK_OBJECT_TYPE_PIPELINE;
+            object_name.objectHandle = reinterpret_cast<uint64_t>(vk_pipeline->pipeline);
+            object_name.pObjectName = data.name.data();
+            NOVA_CHECK_RESULT(vkSetDebugUtilsObjectNameEXT(device, &object_name));
+        }
+
+        return ntl::Result(static_cast<RhiPipeline*>(vk_pipeline));
+    }
+
     RhiBuffer* VulkanRenderDevice::create_buffer(const RhiBufferCreateInfo& info,
                                               DeviceMemoryResource& memory,
                                               rx::memory::allocator* allocator) {
@@ -971,17 +1183,25 @@ namespace nova::renderer::rhi {
         VkBufferCreateInfo vk_create_info = {};
         vk_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         vk_create_info.size = info.size.b_count();
-        vk_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if(shared_queue_families.size() > 1) {
+            vk_create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            vk_create_info.queueFamilyIndexCount = static_cast<uint32_t>(shared_queue_families.size());
+            vk_create_info.pQueueFamilyIndices = shared_queue_families.data();
+
+        } else {
+            vk_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
 
         VmaAllocationCreateInfo vma_alloc{};
 
         switch(info.buffer_usage) {
             case BufferUsage::UniformBuffer: {
+                // Uniform buffers which in-flight frames read are updated with copies on the GPU, so each frame reads its own data
                 if(info.size < gpu.props.limits.maxUniformBufferRange) {
-                    vk_create_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+                    vk_create_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
                 } else {
-                    vk_create_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+                    vk_create_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
                 }
                 vma_alloc.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
                 vma_alloc.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
@@ -1002,40 +1222,100 @@ namespace nova::renderer::rhi {
                 vma_alloc.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
                 vma_alloc.usage = VMA_MEMORY_USAGE_CPU_ONLY;
             } break;
+
+            case BufferUsage::StorageBuffer: {
+                vk_create_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                       VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+                vma_alloc.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+            } break;
         }
 
-        const auto result = vmaCreateBuffer(vma,
-                                            &vk_create_info,
-                                            &vma_alloc,
-                                            &buffer->buffer,
-                                            &buffer->allocation,
-                                            &buffer->allocation_info);
-        if(result == VK_SUCCESS) {
-            buffer->size = info.size;
+        auto result = vkCreateBuffer(device, &vk_create_info, &vk_internal_allocator, &buffer->buffer);
+        if(result != VK_SUCCESS) {
+            logger(rx::log::level::k_error, "Could not create buffer %s: %s", info.name, to_string(result));
+            allocator->destroy<VulkanBuffer>(buffer);
 
-            if(settings->debug.enabled) {
-                VkDebugUtilsObjectNameInfoEXT object_name = {};
-                object_name.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
-                object_name.objectType = VK_OBJECT_TYPE_BUFFER;
-                object_name.objectHandle = reinterpret_cast<uint64_t>(buffer->buffer);
-                object_name.pObjectName = info.name.data();
+            return nullptr;
+        }
 
-                NOVA_CHECK_RESULT(vkSetDebugUtilsObjectNameEXT(device, &object_name));
+        buffer->size = info.size;
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(device, buffer->buffer, &requirements);
+
+        if(!place_buffer(*buffer, requirements, memory)) {
+            // The memory resource is full, or its memory type can't hold this buffer. A dedicated allocation still works, it just costs
+            // one of the device's few allocations
+            logger(rx::log::level::k_verbose, "Could not place buffer %s in its memory resource, giving it its own memory", info.name);
+
+            result = vmaAllocateMemoryForBuffer(vma, buffer->buffer, &vma_alloc, &buffer->allocation, &buffer->allocation_info);
+            if(result == VK_SUCCESS) {
+                result = vmaBindBufferMemory(vma, buffer->allocation, buffer->buffer);
             }
 
-            return buffer;
+            if(result != VK_SUCCESS) {
+                logger(rx::log::level::k_error, "Could not allocate memory for buffer %s: %s", info.name, to_string(result));
+                destroy_buffer(buffer, allocator);
 
-        } else {
-            logger(rx::log::level::k_error, "Could not create buffer %s: %s", info.name, to_string(result));
+                return nullptr;
+            }
 
-            return nullptr;
+            buffer->mapped_data = buffer->allocation_info.pMappedData;
         }
+
+        if(settings->debug.enabled) {
+            VkDebugUtilsObjectNameInfoEXT object_name = {};
+            object_name.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+            object_name.objectType = VK_OBJECT_TYPE_BUFFER;
+            object_name.objectHandle = reinterpret_cast<uint64_t>(buffer->buffer);
+            object_name.pObjectName = info.name.data();
+
+            NOVA_CHECK_RESULT(vkSetDebugUtilsObjectNameEXT(device, &object_name));
+        }
+
+        return buffer;
+    }
+
+    bool VulkanRenderDevice::place_buffer(VulkanBuffer& buffer, const VkMemoryRequirements& requirements, DeviceMemoryResource& memory) {
+        const auto* vk_memory = static_cast<const VulkanDeviceMemory*>(memory.memory);
+        if(vk_memory == nullptr || (requirements.memoryTypeBits & (1U << vk_memory->memory_type_index)) == 0) {
+            return false;
+        }
+
+        const auto allocation = memory.allocate(Bytes(requirements.size), Bytes(requirements.alignment));
+        if(!allocation) {
+            return false;
+        }
+
+        const auto result = vkBindBufferMemory(device, buffer.buffer, vk_memory->memory, allocation->offset.b_count());
+        if(result != VK_SUCCESS) {
+            logger(rx::log::level::k_error, "Could not bind buffer memory: %s", to_string(result));
+            memory.free(*allocation);
+
+            return false;
+        }
+
+        buffer.memory_resource = &memory;
+        buffer.memory_allocation = *allocation;
+
+        if(vk_memory->mapped_data != nullptr) {
+            buffer.mapped_data = static_cast<uint8_t*>(vk_memory->mapped_data) + allocation->offset.b_count();
+        }
+
+        return true;
     }
 
     void VulkanRenderDevice::write_data_to_buffer(const void* data, const Bytes num_bytes, const Bytes offset, const RhiBuffer* buffer) {
         const auto* vulkan_buffer = static_cast<const VulkanBuffer*>(buffer);
 
-        memcpy(vulkan_buffer->allocation_info.pMappedData, data, num_bytes.b_count());
+        if(vulkan_buffer->mapped_data == nullptr) {
+            logger(rx::log::level::k_error, "Can not write to a buffer that the host can't access");
+            return;
+        }
+
+        memcpy(static_cast<uint8_t*>(vulkan_buffer->mapped_data) + offset.b_count(), data, num_bytes.b_count());
+
+        statistics::count(&RenderStatistics::num_bytes_written, num_bytes.b_count());
     }
 
     RhiSampler* VulkanRenderDevice::create_sampler(const RhiSamplerCreateInfo& create_info, rx::memory::allocator* allocator) {
@@ -1061,13 +1341,46 @@ namespace nova::renderer::rhi {
     }
 
     RhiImage* VulkanRenderDevice::create_image(const renderpack::TextureCreateInfo& info, rx::memory::allocator* allocator) {
+        return create_aliased_image(info, nullptr, allocator);
+    }
+
+    RhiImage* VulkanRenderDevice::create_aliased_image(const renderpack::TextureCreateInfo& info,
+                                                       RhiImage* aliased_image,
+                                                       rx::memory::allocator* allocator) {
         auto* image = allocator->create<VulkanImage>();
 
         image->is_dynamic = true;
         image->type = ResourceType::Image;
+
+        if(!create_image_objects(*image, info, static_cast<VulkanImage*>(aliased_image), allocator)) {
+            allocator->destroy<VulkanImage>(image);
+            return nullptr;
+        }
+
+        return image;
+    }
+
+    bool VulkanRenderDevice::recreate_image(RhiImage* image,
+                                            const renderpack::TextureCreateInfo& info,
+                                            RhiImage* aliased_image,
+                                            rx::memory::allocator* allocator) {
+        auto* vk_image = static_cast<VulkanImage*>(image);
+        destroy_image_objects(*vk_image, allocator);
+
+        vk_image->state = ResourceState::Undefined;
+        vk_image->stages = PipelineStage::TopOfPipe;
+        vk_image->queue = QueueType::Graphics;
+
+        return create_image_objects(*vk_image, info, static_cast<VulkanImage*>(aliased_image), allocator);
+    }
+
+    bool VulkanRenderDevice::create_image_objects(VulkanImage& image,
+                                                  const renderpack::TextureCreateInfo& info,
+                                                  VulkanImage* aliased_image,
+                                                  rx::memory::allocator* allocator) {
         const VkFormat format = to_vk_format(info.format.pixel_format);
 
-        // In Nova, images all have a dedicated allocation
+        // In Nova, images all have a dedicated allocation, unless they alias the memory of another image
         // This may or may not change depending on performance data, but given Nova's atlas-centric design I don't think it'll change much
         const auto image_pixel_size = info.format.get_size_in_pixels(swapchain_size);
 
@@ -1086,9 +1399,7 @@ namespace nova::renderer::rhi {
         image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
         image_create_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
 
-        if(format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT) {
-            image->is_depth_tex = true;
-        }
+        image.is_depth_tex = format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT;
 
         if(info.usage == renderpack::ImageUsage::SampledImage) {
             image_create_info.usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
@@ -1101,22 +1412,47 @@ namespace nova::renderer::rhi {
                 image_create_info.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
             } else {
                 image_create_info.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+                // Compute passes write their outputs as storage images, if the format allows it
+                VkFormatProperties format_properties;
+                vkGetPhysicalDeviceFormatProperties(gpu.phys_device, format, &format_properties);
+                if((format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0) {
+                    image_create_info.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+                }
             }
 
             vma_info.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
         }
 
-        image_create_info.queueFamilyIndexCount = 1;
-        image_create_info.pQueueFamilyIndices = &graphics_family_index;
+        // Images are written on one queue and read on another - uploads happen on the transfer queue and async compute passes use render
+        // targets on the compute queue. Sharing every image between the queue families means nothing ever has to transfer their ownership
+        if(shared_queue_families.size() > 1) {
+            image_create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            image_create_info.queueFamilyIndexCount = static_cast<uint32_t>(shared_queue_families.size());
+            image_create_info.pQueueFamilyIndices = shared_queue_families.data();
+
+        } else {
+            image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        }
         image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-        const auto result = vmaCreateImage(vma, &image_create_info, &vma_info, &image->image, &image->allocation, nullptr);
+        image.aliased_image = nullptr;
+
+        auto result = VK_ERROR_INITIALIZATION_FAILED;
+        if(aliased_image != nullptr) {
+            result = bind_aliased_image_memory(image_create_info, aliased_image, image, info.name);
+        }
+
+        if(image.aliased_image == nullptr) {
+            result = vmaCreateImage(vma, &image_create_info, &vma_info, &image.image, &image.allocation, nullptr);
+        }
+
         if(result == VK_SUCCESS) {
             if(settings->debug.enabled) {
                 VkDebugUtilsObjectNameInfoEXT object_name = {};
                 object_name.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
                 object_name.objectType = VK_OBJECT_TYPE_IMAGE;
-                object_name.objectHandle = reinterpret_cast<uint64_t>(image->image);
+                object_name.objectHandle = reinterpret_cast<uint64_t>(image.image);
                 object_name.pObjectName = info.name.data();
 
                 NOVA_CHECK_RESULT(vkSetDebugUtilsObjectNameEXT(device, &object_name));
@@ -1124,7 +1460,7 @@ namespace nova::renderer::rhi {
 
             VkImageViewCreateInfo image_view_create_info = {};
             image_view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-            image_view_create_info.image = image->image;
+            image_view_create_info.image = image.image;
             image_view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
             image_view_create_info.format = image_create_info.format;
             if(format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT) {
@@ -1138,17 +1474,59 @@ namespace nova::renderer::rhi {
             image_view_create_info.subresourceRange.levelCount = 1;
 
             auto vk_alloc = wrap_allocator(allocator);
-            vkCreateImageView(device, &image_view_create_info, &vk_alloc, &image->image_view);
+            vkCreateImageView(device, &image_view_create_info, &vk_alloc, &image.image_view);
 
-            return image;
+            return true;
 
         } else {
             logger(rx::log::level::k_error, "Could not create image %s: %s", info.name, to_string(result));
 
-            return nullptr;
+            return false;
         }
     }
 
+    VkResult VulkanRenderDevice::bind_aliased_image_memory(const VkImageCreateInfo& image_create_info,
+                                                           VulkanImage* aliased_image,
+                                                           VulkanImage& image,
+                                                           const rx::string& name) {
+        // Use the same host allocator as VMA, so that destroy_texture can destroy the image no matter which allocator it gets
+        const auto result = vkCreateImage(device, &image_create_info, &vk_internal_allocator, &image.image);
+        if(result != VK_SUCCESS) {
+            return result;
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device, image.image, &requirements);
+
+        VmaAllocationInfo allocation_info;
+        vmaGetAllocationInfo(vma, aliased_image->allocation, &allocation_info);
+
+        const auto fits_in_allocation = requirements.size <= allocation_info.size &&
+                                        (requirements.memoryTypeBits & (1U << allocation_info.memoryType)) != 0 &&
+                                        allocation_info.offset % requirements.alignment == 0;
+        if(!fits_in_allocation) {
+            logger(rx::log::level::k_warning,
+                   "Image %s doesn't fit in the memory of the image it should alias, so it gets its own memory",
+                   name);
+
+            vkDestroyImage(device, image.image, &vk_internal_allocator);
+            image.image = VK_NULL_HANDLE;
+
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+
+        const auto bind_result = vmaBindImageMemory(vma, aliased_image->allocation, image.image);
+        if(bind_result == VK_SUCCESS) {
+            image.aliased_image = aliased_image;
+
+        } else {
+            vkDestroyImage(device, image.image, &vk_internal_allocator);
+            image.image = VK_NULL_HANDLE;
+        }
+
+        return bind_result;
+    }
+
     RhiSemaphore* VulkanRenderDevice::create_semaphore(rx::memory::allocator* allocator) {
         auto* semaphore = allocator->create<VulkanSemaphore>();
 
@@ -1241,6 +1619,55 @@ namespace nova::renderer::rhi {
         vkResetFences(device, static_cast<uint32_t>(fences.size()), vk_fences.data());
     }
 
+    RhiQueryPool* VulkanRenderDevice::create_timestamp_query_pool(const uint32_t num_queries, rx::memory::allocator* allocator) {
+        auto* pool = allocator->create<VulkanQueryPool>();
+        pool->num_queries = num_queries;
+
+        VkQueryPoolCreateInfo create_info = {};
+        create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        create_info.queryCount = num_queries;
+
+        auto vk_alloc = wrap_allocator(allocator);
+        NOVA_CHECK_RESULT(vkCreateQueryPool(device, &create_info, &vk_alloc, &pool->pool));
+
+        return pool;
+    }
+
+    rx::vector<rx::optional<uint64_t>> VulkanRenderDevice::get_timestamps(RhiQueryPool* pool,
+                                                                          const uint32_t first_query,
+                                                                          const uint32_t num_queries,
+                                                                          rx::memory::allocator* allocator) {
+        const auto* vk_pool = static_cast<const VulkanQueryPool*>(pool);
+
+        // Each query gets its timestamp followed by whether the timestamp is available, so that queries the GPU hasn't written don't
+        // make us wait
+        rx::vector<uint64_t> results{allocator, num_queries * 2};
+        vkGetQueryPoolResults(device,
+                              vk_pool->pool,
+                              first_query,
+                              num_queries,
+                              results.size() * sizeof(uint64_t),
+                              results.data(),
+                              sizeof(uint64_t) * 2,
+                              VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        const auto valid_bits = vk_info.timestamp_valid_bits;
+        const uint64_t timestamp_mask = valid_bits < 64 ? (uint64_t{1} << valid_bits) - 1 : ~uint64_t{0};
+
+        rx::vector<rx::optional<uint64_t>> timestamps{allocator};
+        timestamps.reserve(num_queries);
+        for(uint32_t i = 0; i < num_queries; i++) {
+            if(results[i * 2 + 1] != 0) {
+                timestamps.emplace_back(results[i * 2] & timestamp_mask);
+            } else {
+                timestamps.emplace_back(rx::nullopt);
+            }
+        }
+
+        return timestamps;
+    }
+
     void VulkanRenderDevice::destroy_renderpass(RhiRenderpass* pass, rx::memory::allocator* allocator) {
         auto* vk_renderpass = static_cast<VulkanRenderpass*>(pass);
         vkDestroyRenderPass(device, vk_renderpass->pass, nullptr);
@@ -1270,12 +1697,49 @@ namespace nova::renderer::rhi {
     }
 
     void VulkanRenderDevice::destroy_texture(RhiImage* resource, rx::memory::allocator* allocator) {
-        auto* vk_image = static_cast<VulkanImage*>(resource);
-        vmaDestroyImage(vma, vk_image->image, vk_image->allocation);
+        destroy_image_objects(*static_cast<VulkanImage*>(resource), allocator);
 
         allocator->deallocate(reinterpret_cast<rx_byte*>(resource));
     }
 
+    void VulkanRenderDevice::destroy_buffer(RhiBuffer* buffer, rx::memory::allocator* allocator) {
+        auto* vk_buffer = static_cast<VulkanBuffer*>(buffer);
+
+        vkDestroyBuffer(device, vk_buffer->buffer, &vk_internal_allocator);
+
+        if(vk_buffer->memory_resource != nullptr) {
+            vk_buffer->memory_resource->free(vk_buffer->memory_allocation);
+
+        } else if(vk_buffer->allocation != VK_NULL_HANDLE) {
+            vmaFreeMemory(vma, vk_buffer->allocation);
+        }
+
+        allocator->destroy<VulkanBuffer>(buffer);
+    }
+
+    void VulkanRenderDevice::destroy_image_objects(VulkanImage& image, rx::memory::allocator* allocator) {
+        if(image.image_view != VK_NULL_HANDLE) {
+            auto vk_alloc = wrap_allocator(allocator);
+            vkDestroyImageView(device, image.image_view, &vk_alloc);
+            image.image_view = VK_NULL_HANDLE;
+        }
+
+        if(image.image == VK_NULL_HANDLE) {
+            return;
+        }
+
+        if(image.aliased_image != nullptr) {
+            // The memory belongs to the aliased image
+            vkDestroyImage(device, image.image, &vk_internal_allocator);
+
+        } else {
+            vmaDestroyImage(vma, image.image, image.allocation);
+        }
+
+        image.image = VK_NULL_HANDLE;
+        image.allocation = {};
+    }
+
     void VulkanRenderDevice::destroy_semaphores(rx::vector<RhiSemaphore*>& semaphores, rx::memory::allocator* allocator) {
         semaphores.each_fwd([&](RhiSemaphore* semaphore) {
             auto* vk_semaphore = static_cast<VulkanSemaphore*>(semaphore);
@@ -1294,23 +1758,121 @@ namespace nova::renderer::rhi {
         });
     }
 
+    void VulkanRenderDevice::destroy_query_pool(RhiQueryPool* pool, rx::memory::allocator* allocator) {
+        auto* vk_pool = static_cast<VulkanQueryPool*>(pool);
+        auto vk_alloc = wrap_allocator(allocator);
+        vkDestroyQueryPool(device, vk_pool->pool, &vk_alloc);
+
+        allocator->deallocate(reinterpret_cast<rx_byte*>(pool));
+    }
+
+    void VulkanRenderDevice::recreate_swapchain(const glm::uvec2& window_size) {
+        vkDeviceWaitIdle(device);
+
+        // The surface's size limits change when the window is resized
+        const auto present_modes = query_surface_support();
+
+        static_cast<VulkanSwapchain*>(swapchain)->recreate(settings->swapchain.num_images, window_size, present_modes);
+
+        swapchain_size = swapchain->get_size();
+    }
+
+    void VulkanRenderDevice::begin_frame(const uint32_t frame_idx) {
+        cur_frame_idx = frame_idx;
+
+        // The caller waited for this frame's fence, but submissions which didn't signal that fence might still be running. Other threads
+        // may submit while we wait, so we take the fences out of the list first
+        rx::vector<VkFence> submission_fences{internal_allocator};
+        {
+            rx::concurrency::scope_lock l(submission_mutex);
+            submission_fences = rx::utility::move(untracked_submission_fences[frame_idx]);
+            untracked_submission_fences[frame_idx] = rx::vector<VkFence>{internal_allocator};
+        }
+
+        if(!submission_fences.is_empty()) {
+            const auto num_fences = static_cast<uint32_t>(submission_fences.size());
+            vkWaitForFences(device, num_fences, submission_fences.data(), VK_TRUE, std::numeric_limits<uint64_t>::max());
+            vkResetFences(device, num_fences, submission_fences.data());
+
+            rx::concurrency::scope_lock l(submission_mutex);
+            submission_fences.each_fwd([&](const VkFence fence) { free_submission_fences.push_back(fence); });
+        }
+
+        // Resetting the pools resets every command buffer allocated from them, so they can all go back on the free list
+        rx::concurrency::scope_lock l(command_pools_mutex);
+        command_pools[frame_idx].each_fwd([&](rx::map<uint32_t, CommandPool>& pools_by_queue) {
+            pools_by_queue.each_value([&](CommandPool& pool) {
+                vkResetCommandPool(device, pool.pool, 0);
+
+                pool.primary_buffers.num_used = 0;
+                pool.secondary_buffers.num_used = 0;
+            });
+        });
+    }
+
     CommandList* VulkanRenderDevice::create_command_list(const uint32_t thread_idx,
                                                          const QueueType needed_queue_type,
                                                          const CommandList::Level level,
-                                                         rx::memory::allocator* allocator) {
+                                                         rx::memory::allocator* allocator,
+                                                         const RhiRenderpass* renderpass,
+                                                         const RhiFramebuffer* framebuffer,
+                                                         const uint32_t subpass) {
+        statistics::count(&RenderStatistics::num_command_lists);
+
         const uint32_t queue_family_index = get_queue_family_index(needed_queue_type);
-        const VkCommandPool pool = *command_pools_by_thread_idx[thread_idx].find(queue_family_index);
 
-        VkCommandBufferAllocateInfo create_info = {};
-        create_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        create_info.commandPool = pool;
-        create_info.level = to_vk_command_buffer_level(level);
-        create_info.commandBufferCount = 1;
+        // Another thread may begin the next frame at any time, so we read the frame index once. The command list keeps it, so that its
+        // submission is tracked by the same frame whose pool it came from
+        const uint32_t frame_idx = cur_frame_idx.load();
 
         VkCommandBuffer new_buffer;
-        vkAllocateCommandBuffers(device, &create_info, &new_buffer);
+        {
+            rx::concurrency::scope_lock l(command_pools_mutex);
+
+            CommandPool* pool = command_pools[frame_idx][get_command_pools_idx(thread_idx)].find(queue_family_index);
 
-        auto* list = allocator->create<VulkanCommandList>(new_buffer, this);
+            auto& free_list = level == CommandList::Level::Primary ? pool->primary_buffers : pool->secondary_buffers;
+
+            if(free_list.num_used < free_list.buffers.size()) {
+                // The pool was reset since this buffer was last used, so it's ready to begin again
+                new_buffer = free_list.buffers[free_list.num_used];
+
+            } else {
+                VkCommandBufferAllocateInfo create_info = {};
+                create_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                create_info.commandPool = pool->pool;
+                create_info.level = to_vk_command_buffer_level(level);
+                create_info.commandBufferCount = 1;
+
+                vkAllocateCommandBuffers(device, &create_info, &new_buffer);
+                free_list.buffers.push_back(new_buffer);
+            }
+
+            free_list.num_used++;
+        }
+
+        // Secondary command buffers must know which renderpass they'll be executed in, if any
+        VkCommandBufferInheritanceInfo inheritance_info = {};
+        inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        if(renderpass != nullptr) {
+            inheritance_info.renderPass = static_cast<const VulkanRenderpass*>(renderpass)->pass;
+            inheritance_info.subpass = subpass;
+            if(framebuffer != nullptr) {
+                inheritance_info.framebuffer = static_cast<const VulkanFramebuffer*>(framebuffer)->framebuffer;
+            }
+        }
+
+        auto* list = allocator->create<VulkanCommandList>(new_buffer,
+                                                          frame_idx,
+                                                          level,
+                                                          level == CommandList::Level::Secondary ? &inheritance_info : nullptr,
+                                                          this,
+                                                          allocator);
+
+        // Secondary command buffers don't inherit dynamic state from the primary command buffer that executes them
+        if(level == CommandList::Level::Secondary && framebuffer != nullptr) {
+            list->set_viewport_and_scissor(framebuffer->size);
+        }
 
         return list;
     }
@@ -1320,6 +1882,8 @@ namespace nova::renderer::rhi {
                                                  RhiFence* fence_to_signal,
                                                  const rx::vector<RhiSemaphore*>& wait_semaphores,
                                                  const rx::vector<RhiSemaphore*>& signal_semaphores) {
+        cmds->flush_barriers();
+
         auto* vk_list = static_cast<VulkanCommandList*>(cmds);
         vkEndCommandBuffer(vk_list->cmds);
 
@@ -1349,6 +1913,10 @@ namespace nova::renderer::rhi {
             vk_wait_semaphores.push_back(vk_semaphore->semaphore);
         });
 
+        // We don't know which stage needs the semaphores, so everything waits for them
+        rx::vector<VkPipelineStageFlags> vk_wait_stages(internal_allocator);
+        vk_wait_stages.resize(vk_wait_semaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
         rx::vector<VkSemaphore> vk_signal_semaphores(internal_allocator);
         vk_signal_semaphores.reserve(signal_semaphores.size());
         signal_semaphores.each_fwd([&](const RhiSemaphore* semaphore) {
@@ -1360,17 +1928,23 @@ namespace nova::renderer::rhi {
         submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submit_info.waitSemaphoreCount = static_cast<uint32_t>(vk_wait_semaphores.size());
         submit_info.pWaitSemaphores = vk_wait_semaphores.data();
+        submit_info.pWaitDstStageMask = vk_wait_stages.data();
         submit_info.commandBufferCount = 1;
         submit_info.pCommandBuffers = &vk_list->cmds;
         submit_info.signalSemaphoreCount = static_cast<uint32_t>(vk_signal_semaphores.size());
         submit_info.pSignalSemaphores = vk_signal_semaphores.data();
 
+        rx::concurrency::scope_lock l(submission_mutex);
+
         const auto vk_signal_fence = [&] {
             if(fence_to_signal) {
                 return static_cast<const VulkanFence*>(fence_to_signal)->fence;
 
             } else {
-                return VkFence{};
+                // We need to know when the command buffer is done so that begin_frame can reuse it
+                const auto fence = get_free_submission_fence();
+                untracked_submission_fences[vk_list->frame_idx].push_back(fence);
+                return fence;
             }
         }();
 
@@ -1384,6 +1958,36 @@ namespace nova::renderer::rhi {
         }
     }
 
+    void VulkanRenderDevice::save_pipeline_cache() {
+        const auto cache_file_path = get_pipeline_cache_file_path();
+        if(cache_file_path.is_empty()) {
+            return;
+        }
+
+        size_t cache_size = 0;
+        vkGetPipelineCacheData(device, pipeline_cache, &cache_size, nullptr);
+
+        rx::vector<rx_byte> cache_data{internal_allocator, cache_size};
+        const auto result = vkGetPipelineCacheData(device, pipeline_cache, &cache_size, cache_data.data());
+        if(result != VK_SUCCESS) {
+            logger(rx::log::level::k_error, "Could not get pipeline cache data: %s", to_string(result));
+            return;
+        }
+
+        rx::filesystem::file cache_file{internal_allocator, cache_file_path, "wb"};
+        if(!cache_file) {
+            logger(rx::log::level::k_error, "Could not open pipeline cache file %s", cache_file_path);
+            return;
+        }
+
+        if(cache_file.write(cache_data.data(), cache_size) != cache_size) {
+            logger(rx::log::level::k_error, "Could not write pipeline cache file %s", cache_file_path);
+            return;
+        }
+
+        logger(rx::log::level::k_verbose, "Saved %zu bytes of pipeline cache data to %s", cache_size, cache_file_path);
+    }
+
     uint32_t VulkanRenderDevice::get_queue_family_index(const QueueType type) const {
         switch(type) {
             case QueueType::Graphics:
@@ -1530,6 +2134,11 @@ namespace nova::renderer::rhi {
         vk_info.max_uniform_buffer_size = gpu.props.limits.maxUniformBufferRange;
         info.max_texture_size = gpu.props.limits.maxImageDimension2D;
 
+        vk_info.timestamp_valid_bits = rx::algorithm::min(gpu.queue_family_props[graphics_family_index].timestampValidBits,
+                                                          gpu.queue_family_props[compute_family_index].timestampValidBits);
+        info.supports_timestamps = gpu.props.limits.timestampComputeAndGraphics == VK_TRUE && vk_info.timestamp_valid_bits > 0;
+        info.timestamp_period = gpu.props.limits.timestampPeriod;
+
         // TODO: Something smarter when Intel releases discreet GPUS
         // TODO: Handle integrated AMD GPUs
         info.is_uma = info.architecture == DeviceArchitecture::Intel;
@@ -1706,6 +2315,15 @@ namespace nova::renderer::rhi {
         vkGetDeviceQueue(device, compute_family_idx, 0, &compute_queue);
         transfer_family_index = copy_family_idx;
         vkGetDeviceQueue(device, copy_family_idx, 0, &copy_queue);
+
+        shared_queue_families = rx::vector<uint32_t>{internal_allocator};
+        shared_queue_families.push_back(graphics_family_index);
+        if(compute_family_index != graphics_family_index) {
+            shared_queue_families.push_back(compute_family_index);
+        }
+        if(transfer_family_index != graphics_family_index && transfer_family_index != compute_family_index) {
+            shared_queue_families.push_back(transfer_family_index);
+        }
     }
 
     bool VulkanRenderDevice::does_device_support_extensions(VkPhysicalDevice device, const rx::vector<char*>& required_device_extensions) {
@@ -1733,7 +2351,17 @@ namespace nova::renderer::rhi {
 
     void VulkanRenderDevice::create_swapchain() {
         // Check what formats our rendering supports, and create a swapchain with one of those formats
+        const auto present_modes = query_surface_support();
 
+        swapchain = internal_allocator->create<VulkanSwapchain>(settings->swapchain.num_images,
+                                                                this,
+                                                                window.get_framebuffer_size(),
+                                                                present_modes);
+
+        swapchain_size = swapchain->get_size();
+    }
+
+    rx::vector<VkPresentModeKHR> VulkanRenderDevice::query_surface_support() {
         vkGetPhysicalDeviceSurfaceCapabilitiesKHR(gpu.phys_device, surface, &gpu.surface_capabilities);
 
         uint32_t num_surface_formats;
@@ -1746,44 +2374,149 @@ namespace nova::renderer::rhi {
         rx::vector<VkPresentModeKHR> present_modes(internal_allocator, num_surface_present_modes);
         vkGetPhysicalDeviceSurfacePresentModesKHR(gpu.phys_device, surface, &num_surface_present_modes, present_modes.data());
 
-        swapchain = internal_allocator->create<VulkanSwapchain>(NUM_IN_FLIGHT_FRAMES, this, window.get_framebuffer_size(), present_modes);
-
-        swapchain_size = window.get_framebuffer_size();
+        return present_modes;
     }
 
     void VulkanRenderDevice::create_per_thread_command_pools() {
-        const uint32_t num_threads = 1; // TODO: Make this real
-        command_pools_by_thread_idx.reserve(num_threads);
+        // One set of pools for the main thread, and one for each thread that records renderpasses
+        const uint32_t num_threads = settings->num_recording_threads + 1;
+
+        command_pools.reserve(NUM_IN_FLIGHT_FRAMES);
+        untracked_submission_fences.reserve(NUM_IN_FLIGHT_FRAMES);
+
+        for(uint32_t frame_idx = 0; frame_idx < NUM_IN_FLIGHT_FRAMES; frame_idx++) {
+            rx::vector<rx::map<uint32_t, CommandPool>> pools_by_thread{internal_allocator};
+            pools_by_thread.reserve(num_threads);
+
+            for(uint32_t i = 0; i < num_threads; i++) {
+                pools_by_thread.push_back(make_new_command_pools());
+            }
+
+            command_pools.push_back(pools_by_thread);
+            untracked_submission_fences.emplace_back(internal_allocator);
+        }
+    }
+
+    void VulkanRenderDevice::create_pipeline_cache() {
+        rx::vector<rx_byte> initial_data{internal_allocator};
+
+        const auto cache_file_path = get_pipeline_cache_file_path();
+        if(!cache_file_path.is_empty()) {
+            if(auto cache_data = rx::filesystem::read_binary_file(internal_allocator, cache_file_path)) {
+                if(is_pipeline_cache_data_compatible(*cache_data)) {
+                    initial_data = rx::utility::move(*cache_data);
+                    logger(rx::log::level::k_info, "Loaded %zu bytes of pipeline cache data from %s", initial_data.size(), cache_file_path);
+
+                } else {
+                    logger(rx::log::level::k_info,
+                           "Pipeline cache %s was made by a different GPU or driver, so every pipeline will be compiled from scratch",
+                           cache_file_path);
+                }
+            }
+        }
+
+        VkPipelineCacheCreateInfo cache_create_info = {};
+        cache_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cache_create_info.initialDataSize = initial_data.size();
+        cache_create_info.pInitialData = initial_data.data();
+
+        auto vk_alloc = wrap_allocator(internal_allocator);
+        NOVA_CHECK_RESULT(vkCreatePipelineCache(device, &cache_create_info, &vk_alloc, &pipeline_cache));
+    }
 
-        for(uint32_t i = 0; i < num_threads; i++) {
-            command_pools_by_thread_idx.push_back(make_new_command_pools());
+    rx::string VulkanRenderDevice::get_pipeline_cache_file_path() const {
+        const char* base_path = settings->vulkan.pipeline_cache_path;
+        if(base_path == nullptr) {
+            return rx::string{internal_allocator};
         }
+
+        return rx::string::format(internal_allocator, "%s_%04x_%04x.bin", base_path, gpu.props.vendorID, gpu.props.deviceID);
+    }
+
+    bool VulkanRenderDevice::is_pipeline_cache_data_compatible(const rx::vector<rx_byte>& cache_data) const {
+        // Pipeline cache data starts with the header from the spec for vkGetPipelineCacheData: uint32 header size, uint32 header version,
+        // uint32 vendor ID, uint32 device ID, and the pipeline cache UUID
+        constexpr rx_size HEADER_SIZE = sizeof(uint32_t) * 4 + VK_UUID_SIZE;
+        if(cache_data.size() < HEADER_SIZE) {
+            return false;
+        }
+
+        uint32_t header_fields[4];
+        memcpy(header_fields, cache_data.data(), sizeof(header_fields));
+
+        const auto [header_size, header_version, vendor_id, device_id] = header_fields;
+
+        return header_size >= HEADER_SIZE && header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && vendor_id == gpu.props.vendorID &&
+               device_id == gpu.props.deviceID &&
+               memcmp(cache_data.data() + sizeof(header_fields), gpu.props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
     }
 
-    rx::map<uint32_t, VkCommandPool> VulkanRenderDevice::make_new_command_pools() const {
+    rx::map<uint32_t, VulkanRenderDevice::CommandPool> VulkanRenderDevice::make_new_command_pools() const {
         rx::vector<uint32_t> queue_indices(internal_allocator);
         queue_indices.push_back(graphics_family_index);
         queue_indices.push_back(transfer_family_index);
         queue_indices.push_back(compute_family_index);
 
-        rx::map<uint32_t, VkCommandPool> pools_by_queue(internal_allocator);
+        rx::map<uint32_t, CommandPool> pools_by_queue(internal_allocator);
 
         queue_indices.each_fwd([&](const uint32_t queue_index) {
+            // Several queue types may share a family
+            if(pools_by_queue.find(queue_index) != nullptr) {
+                return;
+            }
+
             VkCommandPoolCreateInfo command_pool_create_info;
             command_pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
             command_pool_create_info.pNext = nullptr;
-            command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+            // Command buffers are only ever reset all at once, by resetting their pool
+            command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
             command_pool_create_info.queueFamilyIndex = queue_index;
 
             auto vk_alloc = wrap_allocator(internal_allocator);
-            VkCommandPool command_pool;
-            NOVA_CHECK_RESULT(vkCreateCommandPool(device, &command_pool_create_info, &vk_alloc, &command_pool));
+            CommandPool command_pool;
+            NOVA_CHECK_RESULT(vkCreateCommandPool(device, &command_pool_create_info, &vk_alloc, &command_pool.pool));
             pools_by_queue.insert(queue_index, command_pool);
         });
 
         return pools_by_queue;
     }
 
+    uint32_t VulkanRenderDevice::get_command_pools_idx(const uint32_t thread_idx) {
+        // Index of this thread's own pools in every frame's list of pools, or 0 if it doesn't have any yet
+        static thread_local uint32_t upload_thread_pools_idx = 0;
+
+        if(thread_idx != 0 || std::this_thread::get_id() == main_thread_id) {
+            return thread_idx;
+        }
+
+        if(upload_thread_pools_idx == 0) {
+            upload_thread_pools_idx = static_cast<uint32_t>(command_pools[0].size());
+            command_pools.each_fwd(
+                [&](rx::vector<rx::map<uint32_t, CommandPool>>& pools_by_thread) { pools_by_thread.push_back(make_new_command_pools()); });
+
+            logger(rx::log::level::k_verbose, "Created command pools %u for a thread that uploads data", upload_thread_pools_idx);
+        }
+
+        return upload_thread_pools_idx;
+    }
+
+    VkFence VulkanRenderDevice::get_free_submission_fence() {
+        if(!free_submission_fences.is_empty()) {
+            const auto fence = free_submission_fences.last();
+            free_submission_fences.erase(free_submission_fences.size() - 1, free_submission_fences.size());
+            return fence;
+        }
+
+        VkFenceCreateInfo fence_create_info = {};
+        fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        auto vk_alloc = wrap_allocator(internal_allocator);
+        VkFence fence;
+        NOVA_CHECK_RESULT(vkCreateFence(device, &fence_create_info, &vk_alloc, &fence));
+
+        return fence;
+    }
+
     uint32_t VulkanRenderDevice::find_memory_type_with_flags(const uint32_t search_flags, const MemorySearchMode search_mode) const {
         for(uint32_t i = 0; i < gpu.memory_properties.memoryTypeCount; i++) {
             const VkMemoryType& memory_type = gpu.memory_properties.memoryTypes[i];
@@ -1795,7 +2528,7 @@ namespace nova::renderer::rhi {
                     break;
 
                 case MemorySearchMode::Fuzzy:
-                    if((memory_type.propertyFlags & search_flags) != 0) {
+                    if((memory_type.propertyFlags & search_flags) == search_flags) {
                         return i;
                     }
                     break;
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <thread>
+
+#include <rx/core/concurrency/mutex.h>
 #include <vk_mem_alloc.h>
 
 #include "nova_renderer/rhi/render_device.hpp"
@@ -14,6 +18,11 @@ namespace nova::renderer::rhi {
 
     struct VulkanDeviceInfo {
         uint64_t max_uniform_buffer_size = 0;
+
+        /*!
+         * \brief The number of bits of a timestamp that are valid on both the graphics and compute queues
+         */
+        uint32_t timestamp_valid_bits = 0;
     };
 
     struct VulkanInputAssemblerLayout {
@@ -39,6 +48,14 @@ namespace nova::renderer::rhi {
         uint32_t compute_family_index;
         uint32_t transfer_family_index;
 
+        /*!
+         * \brief The distinct queue families that Nova submits to
+         *
+         * Buffers and images are shared between all of these families, so the rendergraph and the uploads never have to transfer
+         * their ownership from one queue family to another
+         */
+        rx::vector<uint32_t> shared_queue_families;
+
         VkQueue graphics_queue;
         VkQueue compute_queue;
         VkQueue copy_queue;
@@ -59,7 +76,7 @@ namespace nova::renderer::rhi {
         VulkanRenderDevice(const VulkanRenderDevice& other) = delete;
         VulkanRenderDevice& operator=(const VulkanRenderDevice& other) = delete;
 
-        ~VulkanRenderDevice() = default;
+        ~VulkanRenderDevice() override;
 
 #pragma region Render engine interface
         void set_num_renderpasses(uint32_t num_renderpasses) override;
@@ -73,6 +90,10 @@ namespace nova::renderer::rhi {
                                                    const glm::uvec2& framebuffer_size,
                                                    rx::memory::allocator* allocator) override;
 
+        ntl::Result<RhiRenderpass*> create_merged_renderpass(const rx::vector<renderpack::RenderPassCreateInfo>& subpasses,
+                                                          const glm::uvec2& framebuffer_size,
+                                                          rx::memory::allocator* allocator) override;
+
         RhiFramebuffer* create_framebuffer(const RhiRenderpass* renderpass,
                                         const rx::vector<RhiImage*>& color_attachments,
                                         const rx::optional<RhiImage*> depth_attachment,
@@ -99,6 +120,10 @@ namespace nova::renderer::rhi {
                                                const PipelineStateCreateInfo& data,
                                                rx::memory::allocator* allocator) override;
 
+        ntl::Result<RhiPipeline*> create_compute_pipeline(RhiPipelineInterface* pipeline_interface,
+                                                          const ComputePipelineCreateInfo& data,
+                                                          rx::memory::allocator* allocator) override;
+
         RhiBuffer* create_buffer(const RhiBufferCreateInfo& info, DeviceMemoryResource& memory, rx::memory::allocator* allocator) override;
 
         void write_data_to_buffer(const void* data, mem::Bytes num_bytes, mem::Bytes offset, const RhiBuffer* buffer) override;
@@ -107,6 +132,15 @@ namespace nova::renderer::rhi {
 
         RhiImage* create_image(const renderpack::TextureCreateInfo& info, rx::memory::allocator* allocator) override;
 
+        RhiImage* create_aliased_image(const renderpack::TextureCreateInfo& info,
+                                       RhiImage* aliased_image,
+                                       rx::memory::allocator* allocator) override;
+
+        bool recreate_image(RhiImage* image,
+                            const renderpack::TextureCreateInfo& info,
+                            RhiImage* aliased_image,
+                            rx::memory::allocator* allocator) override;
+
         RhiSemaphore* create_semaphore(rx::memory::allocator* allocator) override;
 
         rx::vector<RhiSemaphore*> create_semaphores(uint32_t num_semaphores, rx::memory::allocator* allocator) override;
@@ -119,6 +153,13 @@ namespace nova::renderer::rhi {
 
         void reset_fences(const rx::vector<RhiFence*>& fences) override;
 
+        RhiQueryPool* create_timestamp_query_pool(uint32_t num_queries, rx::memory::allocator* allocator) override;
+
+        rx::vector<rx::optional<uint64_t>> get_timestamps(RhiQueryPool* pool,
+                                                          uint32_t first_query,
+                                                          uint32_t num_queries,
+                                                          rx::memory::allocator* allocator) override;
+
         void destroy_renderpass(RhiRenderpass* pass, rx::memory::allocator* allocator) override;
 
         void destroy_framebuffer(RhiFramebuffer* framebuffer, rx::memory::allocator* allocator) override;
@@ -129,20 +170,33 @@ namespace nova::renderer::rhi {
 
         void destroy_texture(RhiImage* resource, rx::memory::allocator* allocator) override;
 
+        void destroy_buffer(RhiBuffer* buffer, rx::memory::allocator* allocator) override;
+
         void destroy_semaphores(rx::vector<RhiSemaphore*>& semaphores, rx::memory::allocator* allocator) override;
 
         void destroy_fences(const rx::vector<RhiFence*>& fences, rx::memory::allocator* allocator) override;
 
+        void destroy_query_pool(RhiQueryPool* pool, rx::memory::allocator* allocator) override;
+
+        void recreate_swapchain(const glm::uvec2& window_size) override;
+
+        void begin_frame(uint32_t frame_idx) override;
+
         CommandList* create_command_list(uint32_t thread_idx,
                                          QueueType needed_queue_type,
                                          CommandList::Level level,
-                                         rx::memory::allocator* allocator) override;
+                                         rx::memory::allocator* allocator,
+                                         const RhiRenderpass* renderpass = nullptr,
+                                         const RhiFramebuffer* framebuffer = nullptr,
+                                         uint32_t subpass = 0) override;
 
         void submit_command_list(CommandList* cmds,
                                  QueueType queue,
                                  RhiFence* fence_to_signal = nullptr,
                                  const rx::vector<RhiSemaphore*>& wait_semaphores = {},
                                  const rx::vector<RhiSemaphore*>& signal_semaphores = {}) override;
+
+        void save_pipeline_cache() override;
 #pragma endregion
 
         [[nodiscard]] uint32_t get_queue_family_index(QueueType type) const;
@@ -156,24 +210,78 @@ namespace nova::renderer::rhi {
         VmaAllocator vma;
 
         /*!
-         * The index in the vector is the thread index, the key in the map is the queue family index
+         * \brief Command buffers that have been allocated from a command pool
+         *
+         * The first `num_used` buffers have been handed out since the pool was last reset, the rest are free to be handed out again
          */
-        rx::vector<rx::map<uint32_t, VkCommandPool>> command_pools_by_thread_idx;
+        struct CommandBufferFreeList {
+            rx::vector<VkCommandBuffer> buffers;
+
+            rx_size num_used = 0;
+        };
+
+        struct CommandPool {
+            VkCommandPool pool = VK_NULL_HANDLE;
+
+            CommandBufferFreeList primary_buffers;
+
+            CommandBufferFreeList secondary_buffers;
+        };
 
         /*!
-         * \brief Keeps track of how much has been allocated from each heap
+         * \brief A ring of command pools, with one set of pools for each in-flight frame
          *
-         * In the same order as VulkanGpuInfo::memory_properties::memoryHeaps
+         * The outer index is the frame index, the inner index is the thread index, and the key in the map is the queue family index.
+         * Indices past `NovaSettings::num_recording_threads` belong to threads that upload data, see `get_command_pools_idx`
          */
-        rx::vector<uint32_t> heap_usages;
+        rx::vector<rx::vector<rx::map<uint32_t, CommandPool>>> command_pools;
+
+        /*!
+         * \brief Guards `command_pools` and the command buffer free lists in it, since threads that upload data create command lists while
+         * the render thread resets the pools
+         */
+        rx::concurrency::mutex command_pools_mutex;
+
+        /*!
+         * \brief The thread that created this device. It owns the command pools for thread index 0
+         */
+        std::thread::id main_thread_id;
+
+        /*!
+         * \brief The frame index most recently passed to `begin_frame`. Atomic because any thread may submit command lists
+         */
+        std::atomic<uint32_t> cur_frame_idx{0};
+
+        /*!
+         * \brief Fences for each frame's submissions that weren't given a fence to signal
+         *
+         * We don't know when those submissions finish otherwise, and their command buffers can't be reused until they do
+         */
+        rx::vector<rx::vector<VkFence>> untracked_submission_fences;
+
+        rx::vector<VkFence> free_submission_fences;
 
         /*!
-         * \brief Map from HOST_VISIBLE memory allocations to the memory address they're mapped to
+         * \brief Guards `untracked_submission_fences`, `free_submission_fences`, and the queues, which Vulkan requires to be externally
+         * synchronized
+         */
+        rx::concurrency::mutex submission_mutex;
+
+        /*!
+         * \brief Every pipeline is compiled through this cache. It's loaded from disk when the device is created, and saved by
+         * `save_pipeline_cache`
          *
-         * The Vulkan render engine maps memory when it's allocated, if the memory is for a uniform or a staging
-         * buffer.
+         * Pipeline caches are internally synchronized, so every thread that compiles pipelines can share this one cache instead of
+         * merging per-thread caches
          */
-        rx::map<VkDeviceMemory, void*> heap_mappings;
+        VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+
+        /*!
+         * \brief Keeps track of how much has been allocated from each heap
+         *
+         * In the same order as VulkanGpuInfo::memory_properties::memoryHeaps
+         */
+        rx::vector<uint32_t> heap_usages;
 
 #pragma region Initialization
         rx::vector<const char*> enabled_layer_names;
@@ -197,12 +305,49 @@ namespace nova::renderer::rhi {
 
         void create_swapchain();
 
+        /*!
+         * \brief Refreshes the surface capabilities and formats in `gpu`, and gets the present modes that the surface supports
+         */
+        [[nodiscard]] rx::vector<VkPresentModeKHR> query_surface_support();
+
         void create_per_thread_command_pools();
 
-        [[nodiscard]] rx::map<uint32_t, VkCommandPool> make_new_command_pools() const;
+        /*!
+         * \brief Creates the pipeline cache, filling it with the pipelines that were saved by a previous run on the same GPU, if there are
+         * any
+         */
+        void create_pipeline_cache();
+
+        /*!
+         * \brief Gets the file that the pipeline cache for this GPU is stored in, or an empty string if the pipeline cache shouldn't be
+         * stored
+         */
+        [[nodiscard]] rx::string get_pipeline_cache_file_path() const;
+
+        /*!
+         * \brief Checks that pipeline cache data was written by the same kind of GPU and driver that we're running on. Some drivers crash
+         * when given cache data from somewhere else, so we check before handing data to the driver
+         */
+        [[nodiscard]] bool is_pipeline_cache_data_compatible(const rx::vector<rx_byte>& cache_data) const;
+
+        [[nodiscard]] rx::map<uint32_t, CommandPool> make_new_command_pools() const;
+
+        /*!
+         * \brief Gets the index in `command_pools` of the pools that the calling thread should use
+         *
+         * Threads that upload data, such as the game's loading threads, use thread index 0 like the main thread does. A command pool can
+         * only be used by one thread at a time, so each of those threads gets pools of its own the first time it asks for thread 0's
+         * pools. `command_pools_mutex` must be locked
+         */
+        [[nodiscard]] uint32_t get_command_pools_idx(uint32_t thread_idx);
 #pragma endregion
 
 #pragma region Helpers
+        /*!
+         * \brief Gets a reset fence for a submission. `submission_mutex` must be held
+         */
+        [[nodiscard]] VkFence get_free_submission_fence();
+
         enum class MemorySearchMode { Exact, Fuzzy };
 
         /*!
@@ -225,6 +370,39 @@ namespace nova::renderer::rhi {
             rx::vector<uint32_t>& variable_descriptor_counts,
             rx::memory::allocator* allocator) const;
 
+        /*!
+         * \brief Creates the VkImage, its memory, and its image view for `image`
+         *
+         * \return True if the image was created, false if it wasn't
+         */
+        [[nodiscard]] bool create_image_objects(VulkanImage& image,
+                                                const renderpack::TextureCreateInfo& info,
+                                                VulkanImage* aliased_image,
+                                                rx::memory::allocator* allocator);
+
+        /*!
+         * \brief Destroys the VkImage, its memory, and its image view, but not the VulkanImage itself
+         */
+        void destroy_image_objects(VulkanImage& image, rx::memory::allocator* allocator);
+
+        /*!
+         * \brief Allocates memory for `buffer` from `memory` and binds the buffer to it
+         *
+         * \return True if the buffer was placed, false if `memory` has the wrong memory type or doesn't have enough room
+         */
+        [[nodiscard]] bool place_buffer(VulkanBuffer& buffer, const VkMemoryRequirements& requirements, DeviceMemoryResource& memory);
+
+        /*!
+         * \brief Creates a VkImage for `image` and binds it to the memory of `aliased_image`
+         *
+         * If the new image doesn't fit in the memory of `aliased_image`, the VkImage is destroyed again and `image.aliased_image` stays
+         * nullptr
+         */
+        [[nodiscard]] VkResult bind_aliased_image_memory(const VkImageCreateInfo& image_create_info,
+                                                         VulkanImage* aliased_image,
+                                                         VulkanImage& image,
+                                                         const rx::string& name);
+
         /*!
          * \brief Gets the image view associated with the given image
          *
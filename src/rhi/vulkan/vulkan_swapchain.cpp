@@ -1,5 +1,7 @@
 #include "vulkan_swapchain.hpp"
 
+#include <rx/core/algorithm/max.h>
+#include <rx/core/algorithm/min.h>
 #include <rx/core/log.h>
 
 #include "vulkan_render_device.hpp"
@@ -18,8 +20,28 @@ namespace nova::renderer::rhi {
                                      const rx::vector<VkPresentModeKHR>& present_modes)
         : Swapchain(num_swapchain_images, window_dimensions), render_device(render_device), num_swapchain_images(num_swapchain_images) {
 
-        create_swapchain(num_swapchain_images, present_modes, window_dimensions);
+        create_swapchain(num_swapchain_images, present_modes, window_dimensions, VK_NULL_HANDLE);
 
+        create_frame_resources();
+    }
+
+    void VulkanSwapchain::recreate(const uint32_t requested_num_images,
+                                   const glm::uvec2 window_dimensions,
+                                   const rx::vector<VkPresentModeKHR>& present_modes) {
+        destroy_frame_resources();
+
+        // Passing the old swapchain lets the driver reuse its resources, and lets any images that are still queued for presentation
+        // be shown
+        const auto old_swapchain = swapchain;
+        create_swapchain(requested_num_images, present_modes, window_dimensions, old_swapchain);
+        vkDestroySwapchainKHR(render_device->device, old_swapchain, nullptr);
+
+        create_frame_resources();
+
+        out_of_date = false;
+    }
+
+    void VulkanSwapchain::create_frame_resources() {
         rx::vector<VkImage> vk_images = get_swapchain_images();
 
         if(vk_images.is_empty()) {
@@ -43,45 +65,89 @@ namespace nova::renderer::rhi {
 
         // move the swapchain images into the correct layout cause I guess they aren't for some reason?
         transition_swapchain_images_into_color_attachment_layout(vk_images);
+
+        num_images = num_swapchain_images;
+        size = swapchain_size;
+    }
+
+    void VulkanSwapchain::destroy_frame_resources() {
+        // The swapchain owns its images, so we only delete our wrappers around them
+        swapchain_images.each_fwd([&](const RhiImage* i) { delete static_cast<const VulkanImage*>(i); });
+        swapchain_images.clear();
+
+        swapchain_image_views.each_fwd([&](const VkImageView& iv) { vkDestroyImageView(render_device->device, iv, nullptr); });
+        swapchain_image_views.clear();
+
+        framebuffers.each_fwd([&](const RhiFramebuffer* f) {
+            const auto* vk_framebuffer = static_cast<const VulkanFramebuffer*>(f);
+            vkDestroyFramebuffer(render_device->device, vk_framebuffer->framebuffer, nullptr);
+            delete vk_framebuffer;
+        });
+        framebuffers.clear();
+
+        fences.each_fwd([&](const RhiFence* f) {
+            const VulkanFence* vk_fence = static_cast<const VulkanFence*>(f);
+            vkDestroyFence(render_device->device, vk_fence->fence, nullptr);
+            delete f;
+        });
+        fences.clear();
+
+        swapchain_image_layouts.clear();
     }
 
-    uint8_t VulkanSwapchain::acquire_next_swapchain_image(rx::memory::allocator* allocator) {
-        auto* fence = render_device->create_fence(false, allocator);
-        auto* vk_fence = static_cast<VulkanFence*>(fence);
+    uint8_t VulkanSwapchain::acquire_next_swapchain_image(RhiSemaphore* image_acquired_semaphore, rx::memory::allocator* allocator) {
+        // If we have a semaphore, the GPU waits for the image and we don't have to. Otherwise, block until we have the swapchain image
+        VkSemaphore vk_semaphore = VK_NULL_HANDLE;
+        VulkanFence* vk_fence = nullptr;
+        if(image_acquired_semaphore != nullptr) {
+            vk_semaphore = static_cast<VulkanSemaphore*>(image_acquired_semaphore)->semaphore;
 
-        uint32_t acquired_image_idx;
+        } else {
+            vk_fence = static_cast<VulkanFence*>(render_device->create_fence(false, allocator));
+        }
+
+        uint32_t acquired_image_idx = 0;
         const auto acquire_result = vkAcquireNextImageKHR(render_device->device,
                                                           swapchain,
                                                           std::numeric_limits<uint64_t>::max(),
-                                                          VK_NULL_HANDLE,
-                                                          vk_fence->fence,
+                                                          vk_semaphore,
+                                                          vk_fence != nullptr ? vk_fence->fence : VK_NULL_HANDLE,
                                                           &acquired_image_idx);
-        if(acquire_result == VK_ERROR_OUT_OF_DATE_KHR || acquire_result == VK_SUBOPTIMAL_KHR) {
-            // TODO: Recreate the swapchain and all screen-relative textures
-            logger(rx::log::level::k_error, "Swapchain out of date! One day you'll write the code to recreate it");
-            return 0;
-        }
-        if(acquire_result != VK_SUCCESS) {
+        if(acquire_result == VK_ERROR_OUT_OF_DATE_KHR) {
+            // No image was acquired and the semaphore won't be signalled. A suboptimal swapchain still gives us an image, so we finish
+            // the frame with it and let `present` mark the swapchain as out of date
+            out_of_date = true;
+
+        } else if(acquire_result != VK_SUCCESS && acquire_result != VK_SUBOPTIMAL_KHR) {
             logger(rx::log::level::k_error, "%s:%u=>%s", __FILE__, __LINE__, to_string(acquire_result));
         }
 
-        // Block until we have the swapchain image in order to mimic D3D12. TODO: Reevaluate this decision
-        rx::vector<RhiFence*> fences;
-        fences.push_back(vk_fence);
-        render_device->wait_for_fences(fences);
+        if(vk_fence != nullptr) {
+            rx::vector<RhiFence*> fences;
+            fences.push_back(vk_fence);
+            if(acquire_result == VK_SUCCESS || acquire_result == VK_SUBOPTIMAL_KHR) {
+                render_device->wait_for_fences(fences);
+            }
 
-        render_device->destroy_fences(fences, allocator);
+            render_device->destroy_fences(fences, allocator);
+        }
 
         return static_cast<uint8_t>(acquired_image_idx);
     }
 
-    void VulkanSwapchain::present(const uint32_t image_idx) {
+    void VulkanSwapchain::present(const uint32_t image_idx, RhiSemaphore* render_finished_semaphore) {
         VkResult swapchain_result = {};
 
         VkPresentInfoKHR present_info = {};
         present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-        present_info.waitSemaphoreCount = 0;
-        present_info.pWaitSemaphores = nullptr;
+        if(render_finished_semaphore != nullptr) {
+            present_info.waitSemaphoreCount = 1;
+            present_info.pWaitSemaphores = &static_cast<VulkanSemaphore*>(render_finished_semaphore)->semaphore;
+
+        } else {
+            present_info.waitSemaphoreCount = 0;
+            present_info.pWaitSemaphores = nullptr;
+        }
         present_info.swapchainCount = 1;
         present_info.pSwapchains = &swapchain;
         present_info.pImageIndices = &image_idx;
@@ -89,6 +155,11 @@ namespace nova::renderer::rhi {
 
         const auto result = vkQueuePresentKHR(render_device->graphics_queue, &present_info);
 
+        if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+            out_of_date = true;
+            return;
+        }
+
         if(result != VK_SUCCESS) {
             logger(rx::log::level::k_error, "Could not present swapchain images: vkQueuePresentKHR failed: %s", to_string(result));
         }
@@ -175,22 +246,10 @@ namespace nova::renderer::rhi {
     }
 
     void VulkanSwapchain::deinit() {
-        swapchain_images.each_fwd([&](const RhiImage* i) {
-            const VulkanImage* vk_image = static_cast<const VulkanImage*>(i);
-            vkDestroyImage(render_device->device, vk_image->image, nullptr);
-            delete i;
-        });
-        swapchain_images.clear();
+        destroy_frame_resources();
 
-        swapchain_image_views.each_fwd([&](const VkImageView& iv) { vkDestroyImageView(render_device->device, iv, nullptr); });
-        swapchain_image_views.clear();
-
-        fences.each_fwd([&](const RhiFence* f) {
-            const VulkanFence* vk_fence = static_cast<const VulkanFence*>(f);
-            vkDestroyFence(render_device->device, vk_fence->fence, nullptr);
-            delete f;
-        });
-        fences.clear();
+        vkDestroySwapchainKHR(render_device->device, swapchain, nullptr);
+        swapchain = VK_NULL_HANDLE;
     }
 
     uint32_t VulkanSwapchain::get_num_images() const { return num_swapchain_images; }
@@ -221,18 +280,30 @@ namespace nova::renderer::rhi {
         return formats[0];
     }
 
-    VkPresentModeKHR VulkanSwapchain::choose_present_mode(const rx::vector<VkPresentModeKHR>& modes) {
-        const VkPresentModeKHR desired_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+    VkPresentModeKHR VulkanSwapchain::choose_present_mode(const rx::vector<VkPresentModeKHR>& modes, const PresentMode desired_mode) {
+        if(desired_mode == PresentMode::Immediate && modes.find(VK_PRESENT_MODE_IMMEDIATE_KHR) != rx::vector<VkPresentModeKHR>::k_npos) {
+            return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        }
 
-        // Mailbox mode is best mode (also not sure why)
-        if(modes.find(desired_mode) != rx::vector<VkPresentModeKHR>::k_npos) {
-            return desired_mode;
+        if(desired_mode != PresentMode::Fifo && modes.find(VK_PRESENT_MODE_MAILBOX_KHR) != rx::vector<VkPresentModeKHR>::k_npos) {
+            return VK_PRESENT_MODE_MAILBOX_KHR;
         }
 
         // FIFO, like FIFA, is forever
         return VK_PRESENT_MODE_FIFO_KHR;
     }
 
+    uint32_t VulkanSwapchain::choose_num_images(const VkSurfaceCapabilitiesKHR& caps, const uint32_t requested_num_images) {
+        uint32_t num_images = rx::algorithm::max(requested_num_images, caps.minImageCount);
+
+        // A maxImageCount of 0 means that there's no limit
+        if(caps.maxImageCount > 0) {
+            num_images = rx::algorithm::min(num_images, caps.maxImageCount);
+        }
+
+        return num_images;
+    }
+
     VkExtent2D VulkanSwapchain::choose_surface_extent(const VkSurfaceCapabilitiesKHR& caps, const glm::ivec2& window_dimensions) {
         VkExtent2D extent;
 
@@ -248,17 +319,19 @@ namespace nova::renderer::rhi {
 
     void VulkanSwapchain::create_swapchain(const uint32_t requested_num_swapchain_images,
                                            const rx::vector<VkPresentModeKHR>& present_modes,
-                                           const glm::uvec2& window_dimensions) {
+                                           const glm::uvec2& window_dimensions,
+                                           const VkSwapchainKHR old_swapchain) {
+        const auto& caps = render_device->gpu.surface_capabilities;
 
         const auto surface_format = choose_surface_format(render_device->gpu.surface_formats);
-        const auto present_mode = choose_present_mode(present_modes);
-        const auto extent = choose_surface_extent(render_device->gpu.surface_capabilities, window_dimensions);
+        const auto present_mode = choose_present_mode(present_modes, render_device->settings->swapchain.present_mode);
+        const auto extent = choose_surface_extent(caps, window_dimensions);
 
         VkSwapchainCreateInfoKHR info = {};
         info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
         info.surface = render_device->surface;
 
-        info.minImageCount = requested_num_swapchain_images;
+        info.minImageCount = choose_num_images(caps, requested_num_swapchain_images);
 
         info.imageFormat = surface_format.format;
         info.imageColorSpace = surface_format.colorSpace;
@@ -276,10 +349,18 @@ namespace nova::renderer::rhi {
         info.presentMode = present_mode;
 
         info.clipped = VK_TRUE;
+        info.oldSwapchain = old_swapchain;
 
-        auto res = vkCreateSwapchainKHR(render_device->device, &info, nullptr, &swapchain);
+        const auto result = vkCreateSwapchainKHR(render_device->device, &info, nullptr, &swapchain);
+        if(result != VK_SUCCESS) {
+            logger(rx::log::level::k_error, "Could not create swapchain: %s", to_string(result));
+        }
 
-        logger(rx::log::level::k_error, "%u", res);
+        logger(rx::log::level::k_info,
+               "Created a %ux%u swapchain with present mode %s",
+               extent.width,
+               extent.height,
+               to_string(present_mode));
 
         swapchain_format = surface_format.format;
         this->present_mode = present_mode;
@@ -292,6 +373,10 @@ namespace nova::renderer::rhi {
         vk_image->is_dynamic = true;
         vk_image->image = image;
 
+        // `transition_swapchain_images_into_color_attachment_layout` puts every swapchain image into the present layout
+        vk_image->state = ResourceState::PresentSource;
+        vk_image->stages = PipelineStage::BottomOfPipe;
+
         VkImageViewCreateInfo image_view_create_info = {};
         image_view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <vulkan/vulkan.h>
 
+#include "nova_renderer/nova_settings.hpp"
 #include "nova_renderer/rhi/swapchain.hpp"
 
 namespace nova::renderer::rhi {
@@ -28,11 +29,19 @@ namespace nova::renderer::rhi {
                         const rx::vector<VkPresentModeKHR>& present_modes);
 
 #pragma region Swapchain implementation
-        uint8_t acquire_next_swapchain_image(rx::memory::allocator* allocator) override;
+        uint8_t acquire_next_swapchain_image(RhiSemaphore* image_acquired_semaphore, rx::memory::allocator* allocator) override;
 
-        void present(uint32_t image_idx) override;
+        void present(uint32_t image_idx, RhiSemaphore* render_finished_semaphore) override;
 #pragma endregion
 
+        /*!
+         * \brief Replaces the VkSwapchain and all the per-image resources with new ones
+         *
+         * The caller must make sure that the GPU is no longer using the swapchain, and must refresh the surface capabilities before
+         * calling this method
+         */
+        void recreate(uint32_t requested_num_images, glm::uvec2 window_dimensions, const rx::vector<VkPresentModeKHR>& present_modes);
+
         [[nodiscard]] VkImageLayout get_layout(uint32_t frame_idx);
         [[nodiscard]] VkExtent2D get_swapchain_extent() const;
         [[nodiscard]] VkFormat get_swapchain_format() const;
@@ -58,7 +67,15 @@ namespace nova::renderer::rhi {
 #pragma region Initialization
         static VkSurfaceFormatKHR choose_surface_format(const rx::vector<VkSurfaceFormatKHR>& formats);
 
-        static VkPresentModeKHR choose_present_mode(const rx::vector<VkPresentModeKHR>& modes);
+        /*!
+         * \brief Picks the supported present mode which is closest to the desired mode
+         */
+        static VkPresentModeKHR choose_present_mode(const rx::vector<VkPresentModeKHR>& modes, PresentMode desired_mode);
+
+        /*!
+         * \brief Clamps the requested number of swapchain images to the number that the surface supports
+         */
+        static uint32_t choose_num_images(const VkSurfaceCapabilitiesKHR& caps, uint32_t requested_num_images);
 
         static VkExtent2D choose_surface_extent(const VkSurfaceCapabilitiesKHR& caps, const glm::ivec2& window_dimensions);
 
@@ -69,6 +86,7 @@ namespace nova::renderer::rhi {
          * than you request
          * \param present_modes The present modes you're wiling to use
          * \param window_dimensions The dimensions of the window you'll be presenting to
+         * \param old_swapchain The swapchain that the new swapchain replaces, or VK_NULL_HANDLE
          *
          * \post The swapchain is created
          * \post swapchain_format is set to the swapchain's actual format
@@ -77,7 +95,20 @@ namespace nova::renderer::rhi {
          */
         void create_swapchain(uint32_t requested_num_swapchain_images,
                               const rx::vector<VkPresentModeKHR>& present_modes,
-                              const glm::uvec2& window_dimensions);
+                              const glm::uvec2& window_dimensions,
+                              VkSwapchainKHR old_swapchain);
+
+        /*!
+         * \brief Gets the swapchain's images and creates the image views, framebuffers, and fences for them
+         *
+         * \pre The swapchain exists
+         */
+        void create_frame_resources();
+
+        /*!
+         * \brief Destroys everything that `create_frame_resources` created, but leaves the swapchain alone
+         */
+        void destroy_frame_resources();
 
         /*!
          * \brief Gets the images from the swapchain, so we can create framebuffers and whatnot from them
@@ -94,7 +125,7 @@ namespace nova::renderer::rhi {
          * \param swapchain_size The size of the swapchain
          *
          * \note This method will add to swapchain_image_views, swapchain_images, framebuffers, and fences. Its intended use is to be called
-         * in a loop over all swapchain images, and never called again. It mostly exists to make the constructor cleaner
+         * in a loop over all swapchain images
          */
         void create_resources_for_frame(VkImage image, VkRenderPass renderpass, const glm::uvec2& swapchain_size);
 
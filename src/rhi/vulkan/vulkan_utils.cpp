@@ -315,6 +315,12 @@ namespace nova::renderer::rhi {
             case DescriptorType::Sampler:
                 return VK_DESCRIPTOR_TYPE_SAMPLER;
 
+            case DescriptorType::InputAttachment:
+                return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+
+            case DescriptorType::StorageImage:
+                return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
             default:
                 return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         }
@@ -520,6 +526,21 @@ namespace nova::renderer::rhi {
         }
     }
 
+    rx::string to_string(const VkPresentModeKHR present_mode) {
+        switch(present_mode) {
+            case VK_PRESENT_MODE_IMMEDIATE_KHR:
+                return "Immediate";
+            case VK_PRESENT_MODE_MAILBOX_KHR:
+                return "Mailbox";
+            case VK_PRESENT_MODE_FIFO_KHR:
+                return "FIFO";
+            case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+                return "FIFO Relaxed";
+            default:
+                return "Unknown";
+        }
+    }
+
     VkFormat to_vk_vertex_format(const VertexFieldFormat field) {
         switch(field) {
             case VertexFieldFormat::Uint:
@@ -45,6 +45,8 @@ namespace nova::renderer::rhi {
 
     rx::string to_string(VkObjectType obj_type);
 
+    rx::string to_string(VkPresentModeKHR present_mode);
+
     VkFormat to_vk_vertex_format(VertexFieldFormat field);
 
     /*!
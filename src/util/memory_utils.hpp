@@ -9,6 +9,6 @@
 namespace nova::mem {
     constexpr Bytes align(const Bytes value, const Bytes alignment) noexcept {
         // TODO: Make faster
-        return alignment == Bytes(0) ? value : (value % alignment == Bytes(0) ? value : value + value % alignment);
+        return alignment == Bytes(0) ? value : (value % alignment == Bytes(0) ? value : value + (alignment - value % alignment));
     }
 } // namespace nova::memory
@@ -0,0 +1,123 @@
+/*!
+ * \file allocation_strategy_benchmark.cpp
+ *
+ * \brief Measures how long the block, TLSF, and buddy allocation strategies take to allocate and free mesh-sized allocations while 1000 to
+ * 50000 allocations are live, like when chunks stream in and out
+ *
+ * Usage: nova-benchmark-allocation-strategies
+ */
+
+#include <stdio.h>
+
+#include <rx/core/prng/mt19937.h>
+#include <rx/core/time/qpc.h>
+#include <rx/core/vector.h>
+
+#include "nova_renderer/memory/allocation_structs.hpp"
+#include "nova_renderer/memory/block_allocation_strategy.hpp"
+#include "nova_renderer/memory/buddy_allocation_strategy.hpp"
+#include "nova_renderer/memory/tlsf_allocation_strategy.hpp"
+#include "nova_renderer/nova_renderer.hpp"
+
+namespace nova::renderer {
+    using namespace mem;
+    using namespace mem::operators;
+
+    /*!
+     * \brief Large enough that the benchmark never runs out of memory, since the strategies only hand out offsets
+     *
+     * The buddy strategy's tree has two nodes for every `ALIGNMENT` bytes, so this is also 32 MB of tree
+     */
+    constexpr Bytes POOL_SIZE = 4_gb;
+
+    constexpr Bytes ALIGNMENT = 256_b;
+
+    constexpr Bytes MIN_ALLOCATION_SIZE = 256_b;
+    constexpr Bytes MAX_ALLOCATION_SIZE = 64_kb;
+
+    /*!
+     * \brief The number of allocations that are freed and replaced with new allocations while timing
+     */
+    constexpr uint32_t NUM_REPLACEMENTS = 20000;
+
+    static Bytes get_random_size(rx::prng::mt19937& random) {
+        return MIN_ALLOCATION_SIZE + random.u64() % (MAX_ALLOCATION_SIZE - MIN_ALLOCATION_SIZE).b_count();
+    }
+
+    /*!
+     * \brief Makes `num_live_allocations` allocations, then repeatedly frees a random allocation and makes a new one in its place
+     *
+     * \return The average time to free an allocation and make a new one, in microseconds, or a negative number if an allocation failed
+     */
+    static double time_strategy(AllocationStrategy& strategy, const uint32_t num_live_allocations) {
+        rx::prng::mt19937 random;
+        random.seed(num_live_allocations);
+
+        rx::vector<AllocationInfo> allocations;
+        allocations.reserve(num_live_allocations);
+
+        for(uint32_t i = 0; i < num_live_allocations; i++) {
+            AllocationInfo allocation;
+            if(!strategy.allocate(get_random_size(random), allocation)) {
+                return -1;
+            }
+
+            allocations.push_back(allocation);
+        }
+
+        const auto start_ticks = rx::time::qpc_ticks();
+        for(uint32_t i = 0; i < NUM_REPLACEMENTS; i++) {
+            auto& allocation = allocations[random.u32() % num_live_allocations];
+            strategy.free(allocation);
+
+            if(!strategy.allocate(get_random_size(random), allocation)) {
+                return -1;
+            }
+        }
+        const auto end_ticks = rx::time::qpc_ticks();
+
+        allocations.each_fwd([&](const AllocationInfo& allocation) { strategy.free(allocation); });
+
+        return static_cast<double>(end_ticks - start_ticks) * 1000000.0 / static_cast<double>(rx::time::qpc_frequency()) /
+               NUM_REPLACEMENTS;
+    }
+
+    int main() {
+        static const uint32_t LIVE_ALLOCATION_COUNTS[] = {1000, 5000, 10000, 50000};
+
+        auto* allocator = &rx::memory::g_system_allocator;
+
+        printf("%8s %12s %20s\n", "Strategy", "Live allocs", "Avg replace (us)");
+
+        for(const auto num_live_allocations : LIVE_ALLOCATION_COUNTS) {
+            BlockAllocationStrategy block_strategy(allocator, POOL_SIZE, ALIGNMENT);
+            TlsfAllocationStrategy tlsf_strategy(allocator, POOL_SIZE, ALIGNMENT);
+            BuddyAllocationStrategy buddy_strategy(allocator, POOL_SIZE, ALIGNMENT);
+
+            const auto block_time = time_strategy(block_strategy, num_live_allocations);
+            const auto tlsf_time = time_strategy(tlsf_strategy, num_live_allocations);
+            const auto buddy_time = time_strategy(buddy_strategy, num_live_allocations);
+            if(block_time < 0 || tlsf_time < 0 || buddy_time < 0) {
+                printf("Could not make %u live allocations\n", num_live_allocations);
+                return 1;
+            }
+
+            printf("%8s %12u %20.4f\n", "block", num_live_allocations, block_time);
+            printf("%8s %12u %20.4f\n", "tlsf", num_live_allocations, tlsf_time);
+            printf("%8s %12u %20.4f\n", "buddy", num_live_allocations, buddy_time);
+        }
+
+        return 0;
+    }
+
+    // This is for scoping purposes so that things used in main
+    // don't get destructed after rex_fini has been called
+    int rex_main() {
+        init_rex();
+        auto ret = main();
+        rex_fini();
+        return ret;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::rex_main(); }
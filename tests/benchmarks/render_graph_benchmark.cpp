@@ -0,0 +1,176 @@
+/*!
+ * \file render_graph_benchmark.cpp
+ *
+ * \brief Measures how long `renderpack::order_passes` takes to order synthetic render graphs with 10 to 5000 passes
+ *
+ * Usage: nova-benchmark-rendergraph
+ */
+
+#include <stdio.h>
+
+#include <rx/core/algorithm/max.h>
+#include <rx/core/time/qpc.h>
+
+#include "nova_renderer/constants.hpp"
+#include "nova_renderer/nova_renderer.hpp"
+
+#include "../../src/loading/renderpack/render_graph_builder.hpp"
+#include "../src/render_graph_test_setup.hpp"
+
+namespace nova::renderer {
+    using namespace renderpack;
+
+    enum class GraphShape {
+        /*!
+         * \brief Every pass reads the output of the pass before it
+         */
+        Chain,
+
+        /*!
+         * \brief Every pass reads the outputs of the two passes before it, so every pass can be reached through exponentially many paths
+         */
+        Ladder,
+
+        /*!
+         * \brief Every pass but the last is independent, and the last pass reads all their outputs
+         */
+        FanIn,
+    };
+
+    static const char* to_string(const GraphShape shape) {
+        switch(shape) {
+            case GraphShape::Chain:
+                return "chain";
+
+            case GraphShape::Ladder:
+                return "ladder";
+
+            case GraphShape::FanIn:
+                return "fan-in";
+
+            default:
+                return "unknown";
+        }
+    }
+
+    static rx::string get_texture_name(const uint32_t pass_idx) { return rx::string::format("Texture%u", pass_idx); }
+
+    /*!
+     * \brief Makes a render graph where pass `i` writes to `Texture<i>`, and the last pass writes to the backbuffer
+     *
+     * The passes are returned in reverse order, so that the scheduler has to do some work
+     */
+    static rx::vector<RenderPassCreateInfo> make_graph(const GraphShape shape, const uint32_t num_passes) {
+        rx::vector<RenderPassCreateInfo> passes;
+        passes.reserve(num_passes);
+
+        for(uint32_t i = num_passes; i > 0; i--) {
+            const auto pass_idx = i - 1;
+
+            rx::vector<rx::string> inputs;
+            switch(shape) {
+                case GraphShape::Chain:
+                    if(pass_idx > 0) {
+                        inputs.push_back(get_texture_name(pass_idx - 1));
+                    }
+                    break;
+
+                case GraphShape::Ladder:
+                    if(pass_idx > 0) {
+                        inputs.push_back(get_texture_name(pass_idx - 1));
+                    }
+                    if(pass_idx > 1) {
+                        inputs.push_back(get_texture_name(pass_idx - 2));
+                    }
+                    break;
+
+                case GraphShape::FanIn:
+                    if(pass_idx == num_passes - 1) {
+                        for(uint32_t input_idx = 0; input_idx < pass_idx; input_idx++) {
+                            inputs.push_back(get_texture_name(input_idx));
+                        }
+                    }
+                    break;
+            }
+
+            const auto output_name = pass_idx == num_passes - 1 ? rx::string{BACKBUFFER_NAME} : get_texture_name(pass_idx);
+            passes.push_back(make_pass(rx::string::format("Pass%u", pass_idx), inputs, output_name));
+        }
+
+        return passes;
+    }
+
+    /*!
+     * \brief Checks that every pass comes after all the passes whose outputs it reads
+     */
+    static bool is_valid_order(const rx::vector<RenderPassCreateInfo>& ordered_passes, const uint32_t num_passes) {
+        if(ordered_passes.size() != num_passes) {
+            return false;
+        }
+
+        rx::map<rx::string, bool> written_textures;
+
+        bool is_valid = true;
+        ordered_passes.each_fwd([&](const RenderPassCreateInfo& pass) {
+            pass.texture_inputs.each_fwd([&](const rx::string& input) {
+                if(written_textures.find(input) == nullptr) {
+                    is_valid = false;
+                }
+            });
+
+            pass.texture_outputs.each_fwd([&](const TextureAttachmentInfo& output) { written_textures.insert(output.name, true); });
+        });
+
+        return is_valid;
+    }
+
+    int main() {
+        // The scheduler logs every step it takes, and writing those logs would take longer than the scheduling itself. Clearing the
+        // log handles unregisters the handlers that init_rex registered
+        rx::globals::find("system")->find("log_handles")->cast<LogHandles>()->clear();
+
+        static const GraphShape SHAPES[] = {GraphShape::Chain, GraphShape::Ladder, GraphShape::FanIn};
+        static const uint32_t PASS_COUNTS[] = {10, 50, 100, 500, 1000, 5000};
+
+        printf("%8s %8s %12s %14s\n", "Shape", "Passes", "Iterations", "Avg time (ms)");
+
+        for(const auto shape : SHAPES) {
+            for(const auto num_passes : PASS_COUNTS) {
+                const auto passes = make_graph(shape, num_passes);
+
+                const auto ordered_passes = order_passes(passes);
+                if(!ordered_passes || !is_valid_order(ordered_passes.value, num_passes)) {
+                    printf("Could not order a %s graph with %u passes\n", to_string(shape), num_passes);
+                    return 1;
+                }
+
+                // Order small graphs many times so that the timer has something to measure
+                const auto num_iterations = rx::algorithm::max<uint32_t>(1, 20000 / num_passes);
+
+                const auto start_ticks = rx::time::qpc_ticks();
+                for(uint32_t i = 0; i < num_iterations; i++) {
+                    const auto result = order_passes(passes);
+                    static_cast<void>(result);
+                }
+                const auto end_ticks = rx::time::qpc_ticks();
+
+                const auto total_ms = static_cast<double>(end_ticks - start_ticks) * 1000.0 / static_cast<double>(rx::time::qpc_frequency());
+
+                printf("%8s %8u %12u %14.4f\n", to_string(shape), num_passes, num_iterations, total_ms / num_iterations);
+            }
+        }
+
+        return 0;
+    }
+
+    // This is for scoping purposes so that things used in main
+    // don't get destructed after rex_fini has been called
+    int rex_main() {
+        init_rex();
+        auto ret = main();
+        rex_fini();
+        return ret;
+    }
+} // namespace nova::renderer
+
+int main() { return nova::renderer::rex_main(); }
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+
+#include "nova_renderer/nova_settings.hpp"
+#include "nova_renderer/window.hpp"
+
+#include "../../src/rhi/headless/headless_render_device.hpp"
+
+namespace nova::renderer {
+    /*!
+     * \brief Gets settings for a render device that doesn't need a GPU
+     */
+    inline NovaSettings make_headless_settings() {
+        NovaSettings settings;
+        settings.api = GraphicsApi::Headless;
+
+        return settings;
+    }
+
+    /*!
+     * \brief Everything that a headless render device needs, so that tests can record and submit commands without a GPU
+     *
+     * The window is never shown. Headless render devices only use it to size their swapchain
+     */
+    struct HeadlessDeviceTestSetup {
+        NovaSettingsAccessManager settings;
+
+        NovaWindow window;
+
+        explicit HeadlessDeviceTestSetup(const NovaSettings& options = make_headless_settings()) : settings{options}, window{options} {}
+
+        [[nodiscard]] std::unique_ptr<rhi::HeadlessRenderDevice> make_device() {
+            return std::make_unique<rhi::HeadlessRenderDevice>(settings, window, &rx::memory::g_system_allocator);
+        }
+    };
+} // namespace nova::renderer
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "nova_renderer/renderpack_data.hpp"
+
+namespace nova::renderer::renderpack {
+    /*!
+     * \brief Makes a pass that samples the given textures and writes to a single RGBA8 texture
+     */
+    inline RenderPassCreateInfo make_pass(const rx::string& name, const rx::vector<rx::string>& inputs, const rx::string& output) {
+        RenderPassCreateInfo pass;
+        pass.name = name;
+        pass.texture_inputs = inputs;
+        pass.texture_outputs.emplace_back(output, rhi::PixelFormat::Rgba8, false);
+
+        return pass;
+    }
+
+    /*!
+     * \brief Makes the texture inputs for a pass which reads one or two textures
+     */
+    inline rx::vector<rx::string> make_inputs(const char* first, const char* second = nullptr) {
+        rx::vector<rx::string> inputs;
+        inputs.push_back(first);
+        if(second != nullptr) {
+            inputs.push_back(second);
+        }
+
+        return inputs;
+    }
+} // namespace nova::renderer::renderpack
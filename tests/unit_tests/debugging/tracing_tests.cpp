@@ -0,0 +1,42 @@
+#include <cstdio>
+#include <string>
+
+#include <rx/core/filesystem/file.h>
+
+#include "nova_renderer/tracing.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+static constexpr const char* TRACE_FILE_PATH = "tracing_tests.json";
+
+static rx::string get_event_name(const uint32_t event_idx) { return rx::string::format("\"WraparoundEvent%u\"", event_idx); }
+
+TEST(Tracing, KeepsTheNewestEventsWhenATrackWrapsAround) {
+    constexpr uint32_t NUM_EVENTS_PER_TRACK = 8;
+    constexpr uint32_t NUM_EVENTS = NUM_EVENTS_PER_TRACK * 2 + 4;
+
+    tracing::set_events_per_track(NUM_EVENTS_PER_TRACK);
+    auto& track = tracing::create_track("Wraparound");
+
+    for(uint32_t i = 0; i < NUM_EVENTS; i++) {
+        const auto* name = tracing::intern(rx::string::format("WraparoundEvent%u", i));
+        tracing::record_event(track, "Tests", name, i, i + 1);
+    }
+
+    ASSERT_TRUE(tracing::write_trace(TRACE_FILE_PATH));
+
+    const auto trace_file = rx::filesystem::read_binary_file(&rx::memory::g_system_allocator, TRACE_FILE_PATH);
+    std::remove(TRACE_FILE_PATH);
+    ASSERT_TRUE(trace_file);
+
+    const std::string trace{reinterpret_cast<const char*>(trace_file->data()), trace_file->size()};
+
+    // The oldest event in the ring buffer might be getting overwritten, so the trace only has the newest events before it
+    const auto first_kept_event = NUM_EVENTS - (NUM_EVENTS_PER_TRACK - 1);
+    for(uint32_t i = 0; i < NUM_EVENTS; i++) {
+        const auto is_in_trace = trace.find(get_event_name(i).data()) != std::string::npos;
+        EXPECT_EQ(is_in_trace, i >= first_kept_event) << "Event " << i;
+    }
+}
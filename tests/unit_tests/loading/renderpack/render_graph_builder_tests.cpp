@@ -0,0 +1,171 @@
+#include "nova_renderer/constants.hpp"
+
+#include "../../../../src/loading/renderpack/render_graph_builder.hpp"
+#include "../../../src/render_graph_test_setup.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+using namespace renderpack;
+
+static uint32_t find_position(const rx::vector<RenderPassCreateInfo>& ordered_passes, const char* name) {
+    for(uint32_t i = 0; i < ordered_passes.size(); i++) {
+        if(ordered_passes[i].name == name) {
+            return i;
+        }
+    }
+
+    return ~0U;
+}
+
+/*!
+ * \brief Makes a diamond-shaped render graph, with the passes out of order
+ *
+ * Shadows writes ShadowMap, which Forward and Volumetrics both read. Composite reads the outputs of Forward and Volumetrics and writes
+ * the backbuffer
+ */
+static rx::vector<RenderPassCreateInfo> make_diamond_graph() {
+    rx::vector<RenderPassCreateInfo> passes;
+    passes.push_back(make_pass("Composite", make_inputs("ForwardOutput", "VolumetricsOutput"), BACKBUFFER_NAME));
+    passes.push_back(make_pass("Volumetrics", make_inputs("ShadowMap"), "VolumetricsOutput"));
+    passes.push_back(make_pass("Forward", make_inputs("ShadowMap"), "ForwardOutput"));
+    passes.push_back(make_pass("Shadows", {}, "ShadowMap"));
+
+    return passes;
+}
+
+static void expect_topological_order(const rx::vector<RenderPassCreateInfo>& ordered_passes) {
+    ASSERT_EQ(ordered_passes.size(), 4);
+
+    const auto shadows = find_position(ordered_passes, "Shadows");
+    const auto forward = find_position(ordered_passes, "Forward");
+    const auto volumetrics = find_position(ordered_passes, "Volumetrics");
+    const auto composite = find_position(ordered_passes, "Composite");
+
+    EXPECT_LT(shadows, forward);
+    EXPECT_LT(shadows, volumetrics);
+    EXPECT_LT(forward, composite);
+    EXPECT_LT(volumetrics, composite);
+}
+
+TEST(OrderPasses, PutsDependenciesBeforeTheirDependents) {
+    const auto result = order_passes(make_diamond_graph(), false);
+    ASSERT_TRUE(result);
+
+    expect_topological_order(*result);
+}
+
+TEST(OrderPasses, ReorderingKeepsDependenciesBeforeTheirDependents) {
+    const auto result = order_passes(make_diamond_graph(), true);
+    ASSERT_TRUE(result);
+
+    expect_topological_order(*result);
+}
+
+TEST(OrderPasses, OrdersALongChain) {
+    // Enough resources that the map of resources has to grow several times
+    constexpr uint32_t NUM_PASSES = 100;
+
+    rx::vector<RenderPassCreateInfo> passes;
+    for(uint32_t i = NUM_PASSES; i > 0; i--) {
+        const auto pass_idx = i - 1;
+        const auto output = pass_idx == NUM_PASSES - 1 ? rx::string{BACKBUFFER_NAME} : rx::string::format("Texture%u", pass_idx);
+
+        rx::vector<rx::string> inputs;
+        if(pass_idx > 0) {
+            inputs.push_back(rx::string::format("Texture%u", pass_idx - 1));
+        }
+
+        auto pass = make_pass("", inputs, output);
+        pass.name = rx::string::format("Pass%u", pass_idx);
+        passes.push_back(pass);
+    }
+
+    const auto result = order_passes(passes);
+    ASSERT_TRUE(result);
+
+    ASSERT_EQ(result->size(), NUM_PASSES);
+    for(uint32_t i = 0; i < NUM_PASSES; i++) {
+        EXPECT_EQ((*result)[i].name, rx::string::format("Pass%u", i));
+    }
+}
+
+TEST(OrderPasses, ReorderingKeepsInputAttachmentReadersNextToTheirProducers) {
+    // Grouping by depth alone would submit GBuffer, Bloom, Lighting, Blur, Composite, which separates GBuffer from Lighting
+    rx::vector<RenderPassCreateInfo> passes;
+    passes.push_back(make_pass("Composite", make_inputs("LitScene", "BlurredBloom"), BACKBUFFER_NAME));
+    passes.push_back(make_pass("Blur", make_inputs("Bloom"), "BlurredBloom"));
+    passes.push_back(make_pass("Lighting", make_inputs("Albedo"), "LitScene"));
+    passes.push_back(make_pass("Bloom", {}, "Bloom"));
+    passes.push_back(make_pass("GBuffer", {}, "Albedo"));
+
+    passes[2].input_attachments.emplace_back("Albedo", rhi::PixelFormat::Rgba8, false);
+
+    const auto result = order_passes(passes, true);
+    ASSERT_TRUE(result);
+
+    ASSERT_EQ(result->size(), 5);
+    EXPECT_EQ(find_position(*result, "Lighting"), find_position(*result, "GBuffer") + 1);
+    EXPECT_LT(find_position(*result, "Bloom"), find_position(*result, "Blur"));
+    EXPECT_EQ(find_position(*result, "Composite"), 4);
+}
+
+TEST(OrderPasses, ReorderingWaitsForTheOtherDependenciesOfInputAttachmentReaders) {
+    rx::vector<RenderPassCreateInfo> passes;
+    passes.push_back(make_pass("Lighting", make_inputs("Albedo", "ShadowMap"), BACKBUFFER_NAME));
+    passes.push_back(make_pass("GBuffer", {}, "Albedo"));
+    passes.push_back(make_pass("Shadows", {}, "ShadowMap"));
+
+    passes[0].input_attachments.emplace_back("Albedo", rhi::PixelFormat::Rgba8, false);
+
+    const auto result = order_passes(passes, true);
+    ASSERT_TRUE(result);
+
+    // Lighting can't be pulled in after GBuffer, because it also needs the shadow map
+    ASSERT_EQ(result->size(), 3);
+    EXPECT_EQ(find_position(*result, "Lighting"), 2);
+}
+
+TEST(OrderPasses, FailsOnACycle) {
+    rx::vector<RenderPassCreateInfo> passes;
+    passes.push_back(make_pass("A", make_inputs("BOutput"), "AOutput"));
+    passes.push_back(make_pass("B", make_inputs("AOutput"), "BOutput"));
+    passes.push_back(make_pass("Final", make_inputs("BOutput"), BACKBUFFER_NAME));
+
+    const auto result = order_passes(passes);
+    EXPECT_FALSE(result);
+}
+
+TEST(OrderPasses, PassThatReadsAndWritesTheSameResourceIsNotACycle) {
+    rx::vector<RenderPassCreateInfo> passes;
+    passes.push_back(make_pass("Final", make_inputs("History"), BACKBUFFER_NAME));
+    passes.push_back(make_pass("Accumulate", make_inputs("History"), "History"));
+
+    const auto result = order_passes(passes);
+    ASSERT_TRUE(result);
+
+    ASSERT_EQ(result->size(), 2);
+    EXPECT_EQ((*result)[0].name, "Accumulate");
+    EXPECT_EQ((*result)[1].name, "Final");
+}
+
+TEST(OrderPasses, CullsPassesThatDoNotContributeToTheBackbuffer) {
+    auto passes = make_diamond_graph();
+    passes.push_back(make_pass("Unused", make_inputs("ShadowMap"), "UnusedOutput"));
+    passes.push_back(make_pass("UsesUnused", make_inputs("UnusedOutput"), "AlsoUnusedOutput"));
+
+    const auto result = order_passes(passes);
+    ASSERT_TRUE(result);
+
+    expect_topological_order(*result);
+    EXPECT_EQ(find_position(*result, "Unused"), ~0U);
+    EXPECT_EQ(find_position(*result, "UsesUnused"), ~0U);
+}
+
+TEST(OrderPasses, FailsWithoutABackbufferPass) {
+    rx::vector<RenderPassCreateInfo> passes;
+    passes.push_back(make_pass("Shadows", {}, "ShadowMap"));
+
+    const auto result = order_passes(passes);
+    EXPECT_FALSE(result);
+}
@@ -0,0 +1,107 @@
+#include <rx/core/memory/system_allocator.h>
+
+#include "nova_renderer/memory/allocation_structs.hpp"
+#include "nova_renderer/memory/buddy_allocation_strategy.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::mem;
+using namespace operators;
+
+TEST(BuddyAllocationStrategy, RoundsSizesUpToAPowerOfTwo) {
+    BuddyAllocationStrategy strategy(&rx::memory::g_system_allocator, 64_kb, 256_b);
+
+    AllocationInfo allocation;
+    ASSERT_TRUE(strategy.allocate(1_b, allocation));
+    EXPECT_EQ(allocation.size, 256_b);
+
+    ASSERT_TRUE(strategy.allocate(257_b, allocation));
+    EXPECT_EQ(allocation.size, 512_b);
+
+    ASSERT_TRUE(strategy.allocate(3_kb, allocation));
+    EXPECT_EQ(allocation.size, 4_kb);
+    EXPECT_EQ(allocation.offset.b_count() % (4_kb).b_count(), 0);
+
+    ASSERT_TRUE(strategy.allocate(4_kb, allocation));
+    EXPECT_EQ(allocation.size, 4_kb);
+}
+
+TEST(BuddyAllocationStrategy, SplitsBlocksIntoBuddies) {
+    BuddyAllocationStrategy strategy(&rx::memory::g_system_allocator, 4_kb, 1_kb);
+
+    // The first allocation splits the pool in half, then splits the first half again
+    AllocationInfo first;
+    ASSERT_TRUE(strategy.allocate(1_kb, first));
+    EXPECT_EQ(first.offset, 0_b);
+
+    // The buddy of the first block is used before the other half of the pool gets split
+    AllocationInfo second;
+    ASSERT_TRUE(strategy.allocate(1_kb, second));
+    EXPECT_EQ(second.offset, 1_kb);
+
+    AllocationInfo third;
+    ASSERT_TRUE(strategy.allocate(2_kb, third));
+    EXPECT_EQ(third.offset, 2_kb);
+
+    EXPECT_EQ(strategy.get_free_size(), 0_b);
+}
+
+TEST(BuddyAllocationStrategy, MergesFreeBuddies) {
+    BuddyAllocationStrategy strategy(&rx::memory::g_system_allocator, 4_kb, 1_kb);
+
+    AllocationInfo allocations[4];
+    for(auto& allocation : allocations) {
+        ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+    }
+
+    // Blocks 1 and 2 are both free, but they aren't buddies, so there's no 2 KB block
+    strategy.free(allocations[1]);
+    strategy.free(allocations[2]);
+
+    AllocationInfo allocation;
+    EXPECT_EQ(strategy.get_free_size(), 2_kb);
+    EXPECT_FALSE(strategy.allocate(2_kb, allocation));
+
+    // Freeing their buddies merges each half of the pool, then merges the halves
+    strategy.free(allocations[0]);
+    ASSERT_TRUE(strategy.allocate(2_kb, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+    strategy.free(allocation);
+
+    strategy.free(allocations[3]);
+    ASSERT_TRUE(strategy.allocate(4_kb, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+    EXPECT_EQ(allocation.size, 4_kb);
+}
+
+TEST(BuddyAllocationStrategy, FailsWhenThePoolIsExhausted) {
+    BuddyAllocationStrategy strategy(&rx::memory::g_system_allocator, 4_kb, 1_kb);
+
+    AllocationInfo allocation;
+    EXPECT_FALSE(strategy.allocate(4_kb + 1_b, allocation));
+
+    for(uint32_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(strategy.allocate(1_b, allocation));
+    }
+
+    EXPECT_FALSE(strategy.allocate(1_b, allocation));
+    EXPECT_EQ(strategy.get_free_size(), 0_b);
+}
+
+TEST(BuddyAllocationStrategy, NeverAllocatesPastTheEndOfThePool) {
+    // The tree covers 4 KB, but only the first 3 KB are memory
+    BuddyAllocationStrategy strategy(&rx::memory::g_system_allocator, 3_kb, 1_kb);
+    EXPECT_EQ(strategy.get_free_size(), 3_kb);
+
+    AllocationInfo allocation;
+    EXPECT_FALSE(strategy.allocate(4_kb, allocation));
+
+    ASSERT_TRUE(strategy.allocate(2_kb, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+
+    ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+    EXPECT_EQ(allocation.offset, 2_kb);
+
+    EXPECT_FALSE(strategy.allocate(1_kb, allocation));
+}
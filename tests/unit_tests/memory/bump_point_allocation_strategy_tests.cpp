@@ -0,0 +1,50 @@
+#include "nova_renderer/memory/allocation_structs.hpp"
+#include "nova_renderer/memory/bump_point_allocation_strategy.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::mem;
+using namespace operators;
+
+TEST(BumpPointAllocationStrategy, AllocatesUntilThePoolIsFull) {
+    BumpPointAllocationStrategy strategy(4_kb, 256_b);
+
+    AllocationInfo allocation;
+    ASSERT_TRUE(strategy.allocate(100_b, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+    EXPECT_EQ(allocation.size, 256_b);
+
+    ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+    EXPECT_EQ(allocation.offset, 256_b);
+
+    // Exactly the rest of the pool
+    ASSERT_TRUE(strategy.allocate(4_kb - 1_kb - 256_b, allocation));
+    EXPECT_EQ(allocation.offset, 1_kb + 256_b);
+
+    EXPECT_FALSE(strategy.allocate(1_b, allocation));
+}
+
+TEST(BumpPointAllocationStrategy, FailsWhenTheAllocationIsLargerThanTheFreeSpace) {
+    BumpPointAllocationStrategy strategy(4_kb);
+
+    AllocationInfo allocation;
+    EXPECT_FALSE(strategy.allocate(4_kb + 1_b, allocation));
+
+    ASSERT_TRUE(strategy.allocate(3_kb, allocation));
+    EXPECT_FALSE(strategy.allocate(2_kb, allocation));
+    EXPECT_TRUE(strategy.allocate(1_kb, allocation));
+}
+
+TEST(BumpPointAllocationStrategy, ResetFreesEverything) {
+    BumpPointAllocationStrategy strategy(4_kb);
+
+    AllocationInfo allocation;
+    ASSERT_TRUE(strategy.allocate(4_kb, allocation));
+    EXPECT_FALSE(strategy.allocate(1_b, allocation));
+
+    strategy.reset();
+
+    ASSERT_TRUE(strategy.allocate(4_kb, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+}
@@ -0,0 +1,102 @@
+#include <rx/core/memory/system_allocator.h>
+
+#include "nova_renderer/memory/allocation_structs.hpp"
+#include "nova_renderer/memory/ring_allocation_strategy.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::mem;
+using namespace operators;
+
+TEST(RingAllocationStrategy, AllocatesLinearly) {
+    RingAllocationStrategy strategy(&rx::memory::g_system_allocator, 4_kb, 256_b);
+
+    AllocationInfo allocation;
+    ASSERT_TRUE(strategy.allocate(100_b, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+    EXPECT_EQ(allocation.size, 256_b);
+
+    ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+    EXPECT_EQ(allocation.offset, 256_b);
+    EXPECT_EQ(allocation.size, 1_kb);
+
+    EXPECT_EQ(strategy.get_free_size(), 4_kb - 1_kb - 256_b);
+}
+
+TEST(RingAllocationStrategy, RetiringAFrameReclaimsItsMemory) {
+    RingAllocationStrategy strategy(&rx::memory::g_system_allocator, 4_kb);
+
+    AllocationInfo allocation;
+    ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+    strategy.end_frame(1);
+
+    ASSERT_TRUE(strategy.allocate(2_kb, allocation));
+    strategy.end_frame(2);
+
+    EXPECT_EQ(strategy.get_free_size(), 1_kb);
+
+    // Freeing an allocation does nothing, its memory belongs to its frame
+    strategy.free(allocation);
+    EXPECT_EQ(strategy.get_free_size(), 1_kb);
+
+    strategy.retire_frames(0);
+    EXPECT_EQ(strategy.get_free_size(), 1_kb);
+
+    strategy.retire_frames(1);
+    EXPECT_EQ(strategy.get_free_size(), 2_kb);
+
+    strategy.retire_frames(2);
+    EXPECT_EQ(strategy.get_free_size(), 4_kb);
+}
+
+TEST(RingAllocationStrategy, WrapsAroundToTheStart) {
+    RingAllocationStrategy strategy(&rx::memory::g_system_allocator, 4_kb);
+
+    AllocationInfo allocation;
+    ASSERT_TRUE(strategy.allocate(2_kb, allocation));
+    strategy.end_frame(1);
+
+    ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+    EXPECT_EQ(allocation.offset, 2_kb);
+    strategy.end_frame(2);
+
+    strategy.retire_frames(1);
+
+    // There's 1 KB left at the end of the memory, so the allocation skips it and starts where the first frame's memory was
+    ASSERT_TRUE(strategy.allocate(2_kb, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+    EXPECT_EQ(strategy.get_free_size(), 0_b);
+    strategy.end_frame(3);
+
+    // The skipped memory belongs to the frame that skipped it, so it comes back when that frame is retired
+    strategy.retire_frames(2);
+    EXPECT_EQ(strategy.get_free_size(), 1_kb);
+
+    strategy.retire_frames(3);
+    EXPECT_EQ(strategy.get_free_size(), 4_kb);
+}
+
+TEST(RingAllocationStrategy, FailsWhenTheInFlightFramesUseTheSpace) {
+    RingAllocationStrategy strategy(&rx::memory::g_system_allocator, 4_kb);
+
+    AllocationInfo allocation;
+    EXPECT_FALSE(strategy.allocate(4_kb + 1_b, allocation));
+
+    ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+    strategy.end_frame(1);
+
+    ASSERT_TRUE(strategy.allocate(2_kb, allocation));
+    strategy.end_frame(2);
+
+    strategy.retire_frames(1);
+
+    // 2 KB are free, but they're split between the end and the start of the memory
+    EXPECT_EQ(strategy.get_free_size(), 2_kb);
+    EXPECT_FALSE(strategy.allocate(2_kb, allocation));
+
+    // Once every frame is retired, the memory starts over at the beginning
+    strategy.retire_frames(2);
+    ASSERT_TRUE(strategy.allocate(4_kb, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+}
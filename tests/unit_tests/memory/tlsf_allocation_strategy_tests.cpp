@@ -0,0 +1,121 @@
+#include <rx/core/memory/system_allocator.h>
+#include <rx/core/vector.h>
+
+#include "nova_renderer/memory/allocation_structs.hpp"
+#include "nova_renderer/memory/tlsf_allocation_strategy.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::mem;
+using namespace operators;
+
+TEST(TlsfAllocationStrategy, AllocationsDoNotOverlap) {
+    TlsfAllocationStrategy strategy(&rx::memory::g_system_allocator, 64_kb);
+
+    rx::vector<AllocationInfo> allocations;
+    for(uint64_t i = 0; i < 64; i++) {
+        AllocationInfo allocation;
+        ASSERT_TRUE(strategy.allocate(Bytes(100 + i * 13), allocation));
+        EXPECT_GE(allocation.size.b_count(), 100 + i * 13);
+        EXPECT_LE(allocation.offset.b_count() + allocation.size.b_count(), (64_kb).b_count());
+
+        allocations.push_back(allocation);
+    }
+
+    for(rx_size i = 0; i < allocations.size(); i++) {
+        for(rx_size j = i + 1; j < allocations.size(); j++) {
+            const auto& a = allocations[i];
+            const auto& b = allocations[j];
+            const bool a_before_b = a.offset + a.size <= b.offset;
+            const bool b_before_a = b.offset + b.size <= a.offset;
+            EXPECT_TRUE(a_before_b || b_before_a) << "Allocations " << i << " and " << j << " overlap";
+        }
+    }
+}
+
+TEST(TlsfAllocationStrategy, FreeingEverythingCoalescesIntoOneBlock) {
+    TlsfAllocationStrategy strategy(&rx::memory::g_system_allocator, 64_kb);
+
+    rx::vector<AllocationInfo> allocations;
+    for(uint32_t i = 0; i < 32; i++) {
+        AllocationInfo allocation;
+        ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+        allocations.push_back(allocation);
+    }
+
+    // Free every other allocation first, so that the rest of the frees have to merge with the blocks on both sides
+    for(rx_size i = 0; i < allocations.size(); i += 2) {
+        strategy.free(allocations[i]);
+    }
+    EXPECT_GT(strategy.get_fragmentation_stats().get_fragmentation(), 0.0F);
+
+    for(rx_size i = 1; i < allocations.size(); i += 2) {
+        strategy.free(allocations[i]);
+    }
+
+    const auto stats = strategy.get_fragmentation_stats();
+    EXPECT_EQ(stats.free_size, 64_kb);
+    EXPECT_EQ(stats.largest_free_block, 64_kb);
+    EXPECT_EQ(stats.get_fragmentation(), 0.0F);
+}
+
+TEST(TlsfAllocationStrategy, AllocationsAreAligned) {
+    TlsfAllocationStrategy strategy(&rx::memory::g_system_allocator, 64_kb, 256_b);
+
+    for(uint64_t size = 1; size < 2000; size += 97) {
+        AllocationInfo allocation;
+        ASSERT_TRUE(strategy.allocate(Bytes(size), allocation));
+        EXPECT_EQ(allocation.offset.b_count() % 256, 0);
+        EXPECT_EQ(allocation.size.b_count() % 256, 0);
+        EXPECT_GE(allocation.size.b_count(), size);
+    }
+}
+
+TEST(TlsfAllocationStrategy, CanAllocateTheWholePool) {
+    TlsfAllocationStrategy strategy(&rx::memory::g_system_allocator, 64_kb, 256_b);
+
+    AllocationInfo allocation;
+    ASSERT_TRUE(strategy.allocate(64_kb, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+    EXPECT_EQ(allocation.size, 64_kb);
+    EXPECT_EQ(strategy.get_free_size(), 0_b);
+
+    strategy.free(allocation);
+
+    // The pool's one block went back into the free lists whole
+    ASSERT_TRUE(strategy.allocate(64_kb, allocation));
+    EXPECT_EQ(allocation.offset, 0_b);
+}
+
+TEST(TlsfAllocationStrategy, FailsWhenThePoolIsExhausted) {
+    TlsfAllocationStrategy strategy(&rx::memory::g_system_allocator, 4_kb);
+
+    AllocationInfo allocation;
+    EXPECT_FALSE(strategy.allocate(4_kb + 1_b, allocation));
+
+    for(uint32_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+    }
+
+    EXPECT_FALSE(strategy.allocate(1_b, allocation));
+    EXPECT_EQ(strategy.get_free_size(), 0_b);
+}
+
+TEST(TlsfAllocationStrategy, FailsWhenNoFreeBlockIsLargeEnough) {
+    TlsfAllocationStrategy strategy(&rx::memory::g_system_allocator, 4_kb);
+
+    AllocationInfo allocations[4];
+    for(auto& allocation : allocations) {
+        ASSERT_TRUE(strategy.allocate(1_kb, allocation));
+    }
+
+    strategy.free(allocations[0]);
+    strategy.free(allocations[2]);
+
+    // Half of the pool is free, but it's in two blocks that aren't next to each other
+    AllocationInfo allocation;
+    EXPECT_EQ(strategy.get_free_size(), 2_kb);
+    EXPECT_FALSE(strategy.allocate(2_kb, allocation));
+    EXPECT_TRUE(strategy.allocate(1_kb, allocation));
+}
@@ -0,0 +1,128 @@
+#include "nova_renderer/device_memory_defragmenter.hpp"
+#include "nova_renderer/memory/tlsf_allocation_strategy.hpp"
+#include "nova_renderer/rhi/device_memory_resource.hpp"
+
+#include "../../src/headless_device_test_setup.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+using namespace nova::mem;
+
+static constexpr uint64_t UPLOAD_FRAME = 5;
+
+/*!
+ * \brief A fragmented memory pool on a headless device
+ *
+ * The pool starts with four buffers of the same size, then the first and third are destroyed, so the second and fourth buffers can be
+ * moved towards the start of the pool
+ */
+class DeviceMemoryDefragmenterTest : public testing::Test {
+protected:
+    HeadlessDeviceTestSetup setup;
+
+    std::unique_ptr<rhi::HeadlessRenderDevice> device = setup.make_device();
+
+    TlsfAllocationStrategy strategy{&rx::memory::g_system_allocator, 64_kb, 64_b};
+
+    rx::optional<DeviceMemoryResource> memory;
+
+    std::unique_ptr<DeviceMemoryDefragmenter> defragmenter;
+
+    rhi::RhiBufferCreateInfo buffer_info;
+
+    rhi::RhiBuffer* second_buffer = nullptr;
+    rhi::RhiBuffer* fourth_buffer = nullptr;
+
+    rx::vector<rhi::RhiBuffer*> moved_buffers;
+
+    NovaSettings::MeshDefragmentationOptions options;
+
+    void SetUp() override {
+        auto* allocator = &rx::memory::g_system_allocator;
+
+        auto* device_memory = device->allocate_device_memory(64_kb, rhi::MemoryUsage::DeviceOnly, rhi::ObjectType::Buffer, allocator).value;
+        memory = DeviceMemoryResource{device_memory, &strategy};
+        defragmenter = std::make_unique<DeviceMemoryDefragmenter>(*device, *memory, strategy, allocator);
+
+        buffer_info.name = "Mesh";
+        buffer_info.size = 4_kb;
+        buffer_info.buffer_usage = rhi::BufferUsage::VertexBuffer;
+
+        auto* first_buffer = device->create_buffer(buffer_info, *memory, allocator);
+        second_buffer = device->create_buffer(buffer_info, *memory, allocator);
+        auto* third_buffer = device->create_buffer(buffer_info, *memory, allocator);
+        fourth_buffer = device->create_buffer(buffer_info, *memory, allocator);
+
+        device->destroy_buffer(first_buffer, allocator);
+        device->destroy_buffer(third_buffer, allocator);
+
+        defragmenter->add_buffer(second_buffer, buffer_info, rhi::ResourceState::VertexBuffer, UPLOAD_FRAME);
+        defragmenter->add_buffer(fourth_buffer, buffer_info, rhi::ResourceState::VertexBuffer, UPLOAD_FRAME);
+
+        options.fragmentation_threshold = 0;
+    }
+
+    void TearDown() override {
+        // Finishes the pending moves, so that their new buffers can be destroyed with everything else
+        options.enabled = false;
+        static_cast<void>(update(UPLOAD_FRAME));
+
+        defragmenter.reset();
+
+        auto* allocator = &rx::memory::g_system_allocator;
+        moved_buffers.each_fwd([&](rhi::RhiBuffer* buffer) { device->destroy_buffer(buffer, allocator); });
+        device->destroy_buffer(second_buffer, allocator);
+        device->destroy_buffer(fourth_buffer, allocator);
+    }
+
+    /*!
+     * \brief Updates the defragmenter, and remembers the new buffers of the finished moves so that they can be destroyed
+     */
+    [[nodiscard]] rx::vector<BufferMove> update(const uint64_t last_finished_frame) {
+        auto moves = defragmenter->update(options, last_finished_frame);
+        moves.each_fwd([&](const BufferMove& move) { moved_buffers.push_back(move.new_buffer); });
+
+        return moves;
+    }
+
+    [[nodiscard]] static uint64_t get_offset(const rhi::RhiBuffer* buffer) {
+        return buffer->memory_allocation.allocation_info.offset.b_count();
+    }
+};
+
+TEST_F(DeviceMemoryDefragmenterTest, MovesBuffersTowardsTheStartOfThePool) {
+    EXPECT_GT(defragmenter->get_fragmentation_stats().get_fragmentation(), 0);
+
+    EXPECT_TRUE(update(UPLOAD_FRAME).is_empty());
+
+    const auto moves = update(UPLOAD_FRAME);
+    ASSERT_FALSE(moves.is_empty());
+
+    // The buffer that's furthest from the start of the pool is moved first
+    EXPECT_EQ(moves[0].old_buffer, fourth_buffer);
+
+    moves.each_fwd([&](const BufferMove& move) {
+        EXPECT_LT(get_offset(move.new_buffer), get_offset(move.old_buffer));
+        EXPECT_EQ(move.new_buffer->memory_resource, move.old_buffer->memory_resource);
+    });
+}
+
+TEST_F(DeviceMemoryDefragmenterTest, WaitsForTheUploadsToFinish) {
+    // The GPU hasn't finished the frame that waits for the uploads, so they may still be writing to the buffers
+    EXPECT_TRUE(update(UPLOAD_FRAME - 1).is_empty());
+    EXPECT_TRUE(update(UPLOAD_FRAME - 1).is_empty());
+
+    EXPECT_TRUE(update(UPLOAD_FRAME).is_empty());
+    EXPECT_FALSE(update(UPLOAD_FRAME).is_empty());
+}
+
+TEST_F(DeviceMemoryDefragmenterTest, RemovingABufferCancelsItsMove) {
+    EXPECT_TRUE(update(UPLOAD_FRAME).is_empty());
+
+    defragmenter->remove_buffer(fourth_buffer);
+
+    options.enabled = false;
+    const auto moves = update(UPLOAD_FRAME);
+    moves.each_fwd([&](const BufferMove& move) { EXPECT_NE(move.old_buffer, fourth_buffer); });
+}
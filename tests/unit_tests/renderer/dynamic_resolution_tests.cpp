@@ -0,0 +1,137 @@
+#include "nova_renderer/constants.hpp"
+#include "nova_renderer/dynamic_resolution.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+static NovaSettings::DynamicResolutionOptions make_options() {
+    NovaSettings::DynamicResolutionOptions options;
+    options.enabled = true;
+    options.target_frame_time = 16.0F;
+    options.min_scale = 0.5F;
+    options.max_scale = 1.0F;
+    options.max_scale_step = 0.1F;
+    options.adjustment_interval = 1;
+
+    return options;
+}
+
+/*!
+ * \brief Feeds the controller frame times until it's done ignoring the frames that were rendered before its last change
+ */
+static void skip_frames_after_change(DynamicResolutionController& controller, const NovaSettings::DynamicResolutionOptions& options) {
+    for(uint32_t i = 0; i < NUM_IN_FLIGHT_FRAMES; i++) {
+        ASSERT_FALSE(controller.add_frame_time(options.target_frame_time, options));
+    }
+}
+
+TEST(DynamicResolutionController, StartsAtFullResolution) {
+    const DynamicResolutionController controller;
+
+    EXPECT_EQ(controller.get_render_scale(), 1.0F);
+}
+
+TEST(DynamicResolutionController, IgnoresFrameTimesInTheDeadBand) {
+    const auto options = make_options();
+
+    DynamicResolutionController controller;
+    ASSERT_TRUE(controller.add_frame_time(100.0, options));
+    skip_frames_after_change(controller, options);
+
+    const auto scale = controller.get_render_scale();
+
+    // Slightly under the target, and slightly over the lowest frame time that's accepted
+    EXPECT_FALSE(controller.add_frame_time(15.9, options));
+    EXPECT_FALSE(controller.add_frame_time(13.7, options));
+    EXPECT_EQ(controller.get_render_scale(), scale);
+}
+
+TEST(DynamicResolutionController, ClampsEachChangeToTheMaxStep) {
+    const auto options = make_options();
+
+    DynamicResolutionController controller;
+    ASSERT_TRUE(controller.add_frame_time(1000.0, options));
+
+    EXPECT_FLOAT_EQ(controller.get_render_scale(), 0.9F);
+}
+
+TEST(DynamicResolutionController, AveragesFrameTimesOverTheAdjustmentInterval) {
+    auto options = make_options();
+    options.adjustment_interval = 4;
+
+    DynamicResolutionController controller;
+    EXPECT_FALSE(controller.add_frame_time(40.0, options));
+    EXPECT_FALSE(controller.add_frame_time(40.0, options));
+    EXPECT_FALSE(controller.add_frame_time(40.0, options));
+    EXPECT_TRUE(controller.add_frame_time(40.0, options));
+
+    EXPECT_LT(controller.get_render_scale(), 1.0F);
+}
+
+TEST(DynamicResolutionController, SnapsToTheMinScale) {
+    const auto options = make_options();
+
+    DynamicResolutionController controller;
+    for(uint32_t i = 0; i < 10; i++) {
+        if(controller.add_frame_time(1000.0, options)) {
+            skip_frames_after_change(controller, options);
+        }
+    }
+
+    EXPECT_EQ(controller.get_render_scale(), options.min_scale);
+}
+
+TEST(DynamicResolutionController, SnapsToTheMaxScaleEvenForTinyChanges) {
+    auto options = make_options();
+
+    DynamicResolutionController controller;
+
+    // The change is smaller than the smallest change that the controller usually makes, but it lands on a bound
+    options.max_scale = 0.995F;
+    ASSERT_TRUE(controller.add_frame_time(options.target_frame_time, options));
+
+    EXPECT_EQ(controller.get_render_scale(), 0.995F);
+}
+
+TEST(DynamicResolutionController, GetsBackToFullResolution) {
+    const auto options = make_options();
+
+    DynamicResolutionController controller;
+    ASSERT_TRUE(controller.add_frame_time(1000.0, options));
+    skip_frames_after_change(controller, options);
+
+    ASSERT_TRUE(controller.add_frame_time(0.1, options));
+
+    EXPECT_EQ(controller.get_render_scale(), 1.0F);
+}
+
+TEST(DynamicResolutionController, SkipsFrameTimesAfterAChange) {
+    const auto options = make_options();
+
+    DynamicResolutionController controller;
+    ASSERT_TRUE(controller.add_frame_time(1000.0, options));
+    const auto scale = controller.get_render_scale();
+
+    // These frames were rendered with the old render scale, so they say nothing about the new one
+    for(uint32_t i = 0; i < NUM_IN_FLIGHT_FRAMES; i++) {
+        EXPECT_FALSE(controller.add_frame_time(1000.0, options));
+    }
+    EXPECT_EQ(controller.get_render_scale(), scale);
+
+    EXPECT_TRUE(controller.add_frame_time(1000.0, options));
+    EXPECT_LT(controller.get_render_scale(), scale);
+}
+
+TEST(DynamicResolutionController, ResetGoesBackToFullResolution) {
+    const auto options = make_options();
+
+    DynamicResolutionController controller;
+    ASSERT_TRUE(controller.add_frame_time(1000.0, options));
+
+    controller.reset();
+
+    EXPECT_EQ(controller.get_render_scale(), 1.0F);
+    EXPECT_TRUE(controller.add_frame_time(1000.0, options));
+}
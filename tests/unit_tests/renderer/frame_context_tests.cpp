@@ -0,0 +1,49 @@
+#include "nova_renderer/constants.hpp"
+#include "nova_renderer/frame_context.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+static void use_model_matrix_slice(FrameContext& ctx, const size_t frame_idx) {
+    ctx.cur_model_matrix_index = frame_idx * MODEL_MATRICES_PER_FRAME;
+    ctx.model_matrix_slice_end = (frame_idx + 1) * MODEL_MATRICES_PER_FRAME;
+}
+
+TEST(FrameContext, ReservesModelMatricesInTheFramesSlice) {
+    FrameContext ctx = {};
+    use_model_matrix_slice(ctx, 1);
+
+    const auto first_index = ctx.reserve_model_matrices(10);
+    ASSERT_TRUE(first_index);
+    EXPECT_EQ(*first_index, MODEL_MATRICES_PER_FRAME);
+
+    const auto second_index = ctx.reserve_model_matrices(5);
+    ASSERT_TRUE(second_index);
+    EXPECT_EQ(*second_index, MODEL_MATRICES_PER_FRAME + 10);
+}
+
+TEST(FrameContext, ReservationCanFillTheWholeSlice) {
+    FrameContext ctx = {};
+    use_model_matrix_slice(ctx, 0);
+
+    const auto first_index = ctx.reserve_model_matrices(MODEL_MATRICES_PER_FRAME);
+    ASSERT_TRUE(first_index);
+    EXPECT_EQ(*first_index, 0);
+
+    EXPECT_FALSE(ctx.reserve_model_matrices(1));
+}
+
+TEST(FrameContext, ReservationPastTheSliceFails) {
+    FrameContext ctx = {};
+    use_model_matrix_slice(ctx, NUM_IN_FLIGHT_FRAMES - 1);
+
+    ASSERT_TRUE(ctx.reserve_model_matrices(MODEL_MATRICES_PER_FRAME - 10));
+
+    // The next frame's matrices start right after this slice, so the batch that would run into them gets nothing
+    EXPECT_FALSE(ctx.reserve_model_matrices(11));
+
+    // Reservations never wrap around or reuse slots, even if a later batch would have fit in what was left
+    EXPECT_FALSE(ctx.reserve_model_matrices(1));
+}
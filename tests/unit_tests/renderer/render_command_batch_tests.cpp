@@ -0,0 +1,75 @@
+#include "nova_renderer/rendergraph.hpp"
+
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+static StaticMeshRenderCommand make_command(const RenderableId id, const bool is_visible = true) {
+    StaticMeshRenderCommand command;
+    command.id = id;
+    command.is_visible = is_visible;
+
+    return command;
+}
+
+TEST(RenderCommandBatch, CountsVisibleCommandsWhenTheyAreAdded) {
+    MeshBatch<StaticMeshRenderCommand> batch;
+    batch.add_command(make_command(1));
+    batch.add_command(make_command(2, false));
+    batch.add_command(make_command(3));
+
+    EXPECT_EQ(batch.commands.size(), 3);
+    EXPECT_EQ(batch.num_visible_commands, 2);
+}
+
+TEST(RenderCommandBatch, CountsVisibleCommandsWhenTheyAreRemoved) {
+    MeshBatch<StaticMeshRenderCommand> batch;
+    batch.add_command(make_command(1));
+    batch.add_command(make_command(2, false));
+
+    EXPECT_TRUE(batch.remove_command(2));
+    EXPECT_EQ(batch.num_visible_commands, 1);
+
+    EXPECT_FALSE(batch.remove_command(2));
+
+    EXPECT_TRUE(batch.remove_command(1));
+    EXPECT_EQ(batch.num_visible_commands, 0);
+    EXPECT_TRUE(batch.commands.is_empty());
+}
+
+TEST(RenderCommandBatch, CountsVisibleCommandsWhenTheyAreShownOrHidden) {
+    MeshBatch<StaticMeshRenderCommand> batch;
+    batch.add_command(make_command(1));
+    batch.add_command(make_command(2));
+
+    EXPECT_TRUE(batch.set_command_visible(1, false));
+    EXPECT_EQ(batch.num_visible_commands, 1);
+
+    // Hiding a hidden command doesn't change the count
+    EXPECT_TRUE(batch.set_command_visible(1, false));
+    EXPECT_EQ(batch.num_visible_commands, 1);
+
+    EXPECT_TRUE(batch.set_command_visible(1, true));
+    EXPECT_EQ(batch.num_visible_commands, 2);
+
+    EXPECT_FALSE(batch.set_command_visible(3, true));
+}
+
+TEST(RenderCommandBatch, MaterialPassCountsBatchesWithVisibleCommands) {
+    MaterialPass pass;
+
+    MeshBatch<StaticMeshRenderCommand> visible_batch;
+    visible_batch.add_command(make_command(1));
+    visible_batch.add_command(make_command(2, false));
+    pass.static_mesh_draws.push_back(visible_batch);
+
+    MeshBatch<StaticMeshRenderCommand> hidden_batch;
+    hidden_batch.add_command(make_command(3, false));
+    pass.static_mesh_draws.push_back(hidden_batch);
+
+    EXPECT_EQ(pass.get_num_draws(), 1);
+
+    pass.static_mesh_draws[1].set_command_visible(3, true);
+    EXPECT_EQ(pass.get_num_draws(), 2);
+}
@@ -0,0 +1,193 @@
+#include <rx/core/memory/system_allocator.h>
+
+#include "nova_renderer/constants.hpp"
+#include "nova_renderer/rendergraph.hpp"
+
+#include "../../../src/loading/renderpack/render_graph_builder.hpp"
+#include "../../src/render_graph_test_setup.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+
+/*!
+ * \brief Renderpasses for the merge tests, with images that are looked up by name instead of being created on a device
+ */
+class RendergraphMergeTest : public testing::Test {
+protected:
+    static constexpr uint32_t MAX_IMAGES = 16;
+
+    rhi::RhiFramebuffer framebuffer{glm::uvec2{1920, 1080}, 1};
+
+    rx::vector<rx::string> image_names;
+    rhi::RhiImage images[MAX_IMAGES];
+
+    rx::vector<Renderpass*> renderpasses;
+
+    void TearDown() override {
+        renderpasses.each_fwd([](const Renderpass* renderpass) { delete renderpass; });
+    }
+
+    rhi::RhiImage* get_image(const rx::string& name) {
+        auto idx = image_names.find(name);
+        if(idx == rx::vector<rx::string>::k_npos) {
+            idx = image_names.size();
+            image_names.push_back(name);
+        }
+
+        return &images[idx];
+    }
+
+    Renderpass* make_renderpass(const rx::string& name) {
+        auto* renderpass = new Renderpass(name);
+        renderpass->framebuffer = &framebuffer;
+        renderpasses.push_back(renderpass);
+
+        return renderpass;
+    }
+
+    /*!
+     * \brief Makes a renderpass from a create info, like the rendergraph does when it adds a renderpass
+     */
+    Renderpass* make_renderpass(const renderpack::RenderPassCreateInfo& create_info) {
+        auto* renderpass = make_renderpass(create_info.name);
+
+        create_info.texture_inputs.each_fwd([&](const rx::string& name) { renderpass->read_textures.push_back(get_image(name)); });
+        create_info.input_attachments.each_fwd([&](const renderpack::TextureAttachmentInfo& attachment) {
+            renderpass->input_attachments.push_back(get_image(attachment.name));
+        });
+        create_info.texture_outputs.each_fwd([&](const renderpack::TextureAttachmentInfo& attachment) {
+            if(attachment.name == BACKBUFFER_NAME) {
+                renderpass->writes_to_backbuffer = true;
+            } else {
+                renderpass->write_textures.push_back(get_image(attachment.name));
+            }
+        });
+
+        return renderpass;
+    }
+
+    static bool can_merge(Renderpass* first, const Renderpass& renderpass) {
+        rx::vector<Renderpass*> subpasses;
+        subpasses.push_back(first);
+
+        return Rendergraph::can_merge(subpasses, renderpass, &rx::memory::g_system_allocator);
+    }
+};
+
+TEST_F(RendergraphMergeTest, MergesAReaderOfInputAttachments) {
+    auto* gbuffer = make_renderpass("GBuffer");
+    gbuffer->write_textures.push_back(get_image("Albedo"));
+
+    auto* lighting = make_renderpass("Lighting");
+    lighting->read_textures.push_back(get_image("Albedo"));
+    lighting->input_attachments.push_back(get_image("Albedo"));
+    lighting->write_textures.push_back(get_image("LitScene"));
+
+    EXPECT_TRUE(can_merge(gbuffer, *lighting));
+}
+
+TEST_F(RendergraphMergeTest, RejectsSampledReadsOfTheSubpassOutputs) {
+    auto* gbuffer = make_renderpass("GBuffer");
+    gbuffer->write_textures.push_back(get_image("Albedo"));
+    gbuffer->write_textures.push_back(get_image("Normals"));
+
+    // Albedo is read through an input attachment, but Normals is sampled, so it could be read at any pixel
+    auto* lighting = make_renderpass("Lighting");
+    lighting->read_textures.push_back(get_image("Albedo"));
+    lighting->read_textures.push_back(get_image("Normals"));
+    lighting->input_attachments.push_back(get_image("Albedo"));
+    lighting->write_textures.push_back(get_image("LitScene"));
+
+    EXPECT_FALSE(can_merge(gbuffer, *lighting));
+}
+
+TEST_F(RendergraphMergeTest, RejectsRenderpassesThatDoNotReadTheSubpassOutputs) {
+    auto* gbuffer = make_renderpass("GBuffer");
+    gbuffer->write_textures.push_back(get_image("Albedo"));
+
+    auto* bloom = make_renderpass("Bloom");
+    bloom->write_textures.push_back(get_image("Bloom"));
+
+    EXPECT_FALSE(can_merge(gbuffer, *bloom));
+}
+
+TEST_F(RendergraphMergeTest, RejectsDifferentFramebufferSizes) {
+    auto* gbuffer = make_renderpass("GBuffer");
+    gbuffer->write_textures.push_back(get_image("Albedo"));
+
+    rhi::RhiFramebuffer half_size_framebuffer{glm::uvec2{960, 540}, 1};
+
+    auto* lighting = make_renderpass("Lighting");
+    lighting->framebuffer = &half_size_framebuffer;
+    lighting->read_textures.push_back(get_image("Albedo"));
+    lighting->input_attachments.push_back(get_image("Albedo"));
+    lighting->write_textures.push_back(get_image("LitScene"));
+
+    EXPECT_FALSE(can_merge(gbuffer, *lighting));
+}
+
+TEST_F(RendergraphMergeTest, RejectsAttachmentsThatShareMemory) {
+    auto* gbuffer = make_renderpass("GBuffer");
+    gbuffer->write_textures.push_back(get_image("Albedo"));
+
+    auto* lighting = make_renderpass("Lighting");
+    lighting->read_textures.push_back(get_image("Albedo"));
+    lighting->input_attachments.push_back(get_image("Albedo"));
+    lighting->write_textures.push_back(get_image("LitScene"));
+
+    // The attachments of a merged renderpass are all alive at once
+    get_image("LitScene")->aliased_image = get_image("Albedo");
+
+    EXPECT_FALSE(can_merge(gbuffer, *lighting));
+}
+
+TEST_F(RendergraphMergeTest, MergesWithReorderingEnabled) {
+    rx::vector<renderpack::RenderPassCreateInfo> passes;
+    passes.push_back(renderpack::make_pass("Composite", renderpack::make_inputs("LitScene", "BlurredBloom"), BACKBUFFER_NAME));
+    passes.push_back(renderpack::make_pass("Blur", renderpack::make_inputs("Bloom"), "BlurredBloom"));
+    passes.push_back(renderpack::make_pass("Lighting", renderpack::make_inputs("Albedo"), "LitScene"));
+    passes.push_back(renderpack::make_pass("Bloom", {}, "Bloom"));
+    passes.push_back(renderpack::make_pass("GBuffer", {}, "Albedo"));
+
+    passes[2].input_attachments.emplace_back("Albedo", rhi::PixelFormat::Rgba8, false);
+
+    const auto order = renderpack::order_passes(passes, true);
+    ASSERT_TRUE(order);
+
+    // Merge the renderpasses in execution order, the same way the rendergraph does
+    rx::vector<rx::vector<rx::string>> merged_renderpasses;
+    rx::vector<Renderpass*> subpasses;
+
+    const auto finish_merged_renderpass = [&] {
+        if(subpasses.size() > 1) {
+            rx::vector<rx::string> names;
+            subpasses.each_fwd([&](const Renderpass* subpass) { names.push_back(subpass->name); });
+            merged_renderpasses.push_back(names);
+        }
+
+        subpasses.clear();
+    };
+
+    order->each_fwd([&](const renderpack::RenderPassCreateInfo& create_info) {
+        auto* renderpass = make_renderpass(create_info);
+
+        if(!subpasses.is_empty() && Rendergraph::can_merge(subpasses, *renderpass, &rx::memory::g_system_allocator)) {
+            subpasses.push_back(renderpass);
+            return;
+        }
+
+        finish_merged_renderpass();
+
+        if(!renderpass->writes_to_backbuffer) {
+            subpasses.push_back(renderpass);
+        }
+    });
+
+    finish_merged_renderpass();
+
+    ASSERT_EQ(merged_renderpasses.size(), 1);
+    ASSERT_EQ(merged_renderpasses[0].size(), 2);
+    EXPECT_EQ(merged_renderpasses[0][0], "GBuffer");
+    EXPECT_EQ(merged_renderpasses[0][1], "Lighting");
+}
@@ -0,0 +1,140 @@
+#include <cstdio>
+#include <cstring>
+
+#include <rx/core/filesystem/file.h>
+#include <rx/core/memory/bump_point_allocator.h>
+
+#include "nova_renderer/memory/block_allocation_strategy.hpp"
+#include "nova_renderer/rhi/device_memory_resource.hpp"
+#include "nova_renderer/rhi/swapchain.hpp"
+
+#include "../../../src/rhi/capture/capture_render_device.hpp"
+#include "../../../src/rhi/capture/capture_replayer.hpp"
+#include "../../src/headless_device_test_setup.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+using namespace nova::mem;
+
+static constexpr const char* CAPTURE_FILE_PATH = "capture_replay_tests.capture";
+
+/*!
+ * \brief Creates some resources and submits a frame's worth of commands that use them, then destroys the resources
+ */
+static void record_frame(rhi::RenderDevice& device) {
+    auto* allocator = &rx::memory::g_system_allocator;
+
+    auto* memory = device.allocate_device_memory(64_kb, rhi::MemoryUsage::DeviceOnly, rhi::ObjectType::Buffer, allocator).value;
+    BlockAllocationStrategy strategy{allocator, 64_kb, 64_b};
+    DeviceMemoryResource memory_resource{memory, &strategy};
+
+    rhi::RhiBufferCreateInfo vertex_buffer_info;
+    vertex_buffer_info.name = "Vertices";
+    vertex_buffer_info.size = 4_kb;
+    vertex_buffer_info.buffer_usage = rhi::BufferUsage::VertexBuffer;
+    auto* vertex_buffer = device.create_buffer(vertex_buffer_info, memory_resource, allocator);
+
+    rhi::RhiBufferCreateInfo index_buffer_info;
+    index_buffer_info.name = "Indices";
+    index_buffer_info.size = 1_kb;
+    index_buffer_info.buffer_usage = rhi::BufferUsage::IndexBuffer;
+    auto* index_buffer = device.create_buffer(index_buffer_info, memory_resource, allocator);
+
+    renderpack::RenderPassCreateInfo pass_info;
+    pass_info.name = "Forward";
+    auto* renderpass = device.create_renderpass(pass_info, {640, 480}, allocator).value;
+    auto* framebuffer = device.create_framebuffer(renderpass, {}, rx::nullopt, {640, 480}, allocator);
+
+    // Command lists are never destroyed, so they come from a frame allocator like they do in Nova
+    rx_byte frame_memory[16384];
+    rx::memory::bump_point_allocator frame_allocator{frame_memory, sizeof(frame_memory)};
+
+    auto* cmds = device.create_command_list(0, rhi::QueueType::Graphics, rhi::CommandList::Level::Primary, &frame_allocator);
+    cmds->transition_resource(vertex_buffer, rhi::ResourceState::CopyDestination);
+    cmds->copy_buffer(vertex_buffer, 1_kb, index_buffer, 0_b, 1_kb);
+
+    cmds->transition_resource(vertex_buffer, rhi::ResourceState::VertexBuffer);
+    cmds->transition_resource(index_buffer, rhi::ResourceState::IndexBuffer);
+    cmds->begin_renderpass(renderpass, framebuffer, rhi::CommandList::RenderpassContents::SecondaryCommandLists);
+
+    auto* secondary_cmds = device.create_command_list(0,
+                                                      rhi::QueueType::Graphics,
+                                                      rhi::CommandList::Level::Secondary,
+                                                      &frame_allocator,
+                                                      renderpass,
+                                                      framebuffer);
+    secondary_cmds->set_viewport(0, 0, 640, 480);
+    secondary_cmds->set_scissor_rect(0, 0, 640, 480);
+
+    rx::vector<rhi::RhiBuffer*> vertex_buffers;
+    vertex_buffers.push_back(vertex_buffer);
+    secondary_cmds->bind_vertex_buffers(vertex_buffers);
+    secondary_cmds->bind_index_buffer(index_buffer, rhi::IndexType::Uint16);
+    secondary_cmds->draw_indexed_mesh(36, 0, 2);
+
+    rx::vector<rhi::CommandList*> secondary_lists;
+    secondary_lists.push_back(secondary_cmds);
+    cmds->execute_command_lists(secondary_lists);
+    cmds->end_renderpass();
+
+    cmds->transition_resource(vertex_buffer, rhi::ResourceState::ShaderWrite, rhi::QueueType::Graphics, rhi::PipelineStage::ComputeShader);
+    cmds->dispatch(8, 4, 1);
+
+    device.submit_command_list(cmds, rhi::QueueType::Graphics);
+
+    device.get_swapchain()->present(device.get_swapchain()->acquire_next_swapchain_image());
+
+    device.destroy_framebuffer(framebuffer, allocator);
+    device.destroy_renderpass(renderpass, allocator);
+    device.destroy_buffer(index_buffer, allocator);
+    device.destroy_buffer(vertex_buffer, allocator);
+}
+
+TEST(CaptureReplay, ReplayMakesTheCapturedCalls) {
+    auto* allocator = &rx::memory::g_system_allocator;
+
+    auto settings = make_headless_settings();
+    settings.capture.enabled = true;
+    settings.capture.file_path = CAPTURE_FILE_PATH;
+    settings.capture.num_frames = 1;
+
+    HeadlessDeviceTestSetup setup{settings};
+
+    // The capture device owns the headless device, so we copy its streams out before they're destroyed together
+    rx::vector<rx::vector<rx_byte>> captured_streams;
+    {
+        auto captured_device = setup.make_device();
+        captured_device->keep_submitted_streams();
+        const auto* captured_device_ptr = captured_device.get();
+
+        rhi::CaptureRenderDevice capture_device{std::move(captured_device), setup.settings, setup.window, allocator};
+        record_frame(capture_device);
+
+        captured_streams = captured_device_ptr->get_submitted_streams();
+    }
+
+    const auto capture = rx::filesystem::read_binary_file(allocator, CAPTURE_FILE_PATH);
+    ASSERT_TRUE(capture);
+
+    auto replay_device = setup.make_device();
+    replay_device->keep_submitted_streams();
+    {
+        rhi::CaptureReplayer replayer{*replay_device, allocator};
+        ASSERT_TRUE(replayer.replay(*capture));
+        EXPECT_EQ(replayer.get_frame_statistics().size(), 1);
+    }
+
+    std::remove(CAPTURE_FILE_PATH);
+
+    // The replay device creates every object in the same order as the captured device, so its object IDs are the same and the streams
+    // should match byte for byte
+    const auto& replayed_streams = replay_device->get_submitted_streams();
+    ASSERT_EQ(replayed_streams.size(), captured_streams.size());
+    ASSERT_GT(captured_streams.size(), 0);
+
+    for(rx_size i = 0; i < captured_streams.size(); i++) {
+        ASSERT_EQ(replayed_streams[i].size(), captured_streams[i].size());
+        EXPECT_EQ(memcmp(replayed_streams[i].data(), captured_streams[i].data(), captured_streams[i].size()), 0);
+    }
+}
@@ -0,0 +1,178 @@
+#include <cstring>
+
+#include <rx/core/memory/bump_point_allocator.h>
+
+#include "nova_renderer/memory/block_allocation_strategy.hpp"
+#include "nova_renderer/rhi/device_memory_resource.hpp"
+
+#include "../../../src/rhi/headless/headless_command_list.hpp"
+#include "../../src/headless_device_test_setup.hpp"
+#undef TEST
+#include <gtest/gtest.h>
+
+using namespace nova::renderer;
+using namespace nova::mem;
+
+/*!
+ * \brief Everything that the state tracker tests record commands with
+ */
+struct StateTrackerTest {
+    HeadlessDeviceTestSetup setup;
+
+    std::unique_ptr<rhi::HeadlessRenderDevice> device;
+
+    BlockAllocationStrategy strategy{&rx::memory::g_system_allocator, 64_kb, 64_b};
+
+    rx::optional<DeviceMemoryResource> memory_resource;
+
+    // Command lists are never destroyed, so they come from a frame allocator like they do in Nova
+    rx_byte frame_memory[16384];
+    rx::memory::bump_point_allocator frame_allocator{frame_memory, sizeof(frame_memory)};
+
+    StateTrackerTest() : device{setup.make_device()} {
+        device->keep_submitted_streams();
+
+        auto* memory = device
+                           ->allocate_device_memory(64_kb,
+                                                    rhi::MemoryUsage::DeviceOnly,
+                                                    rhi::ObjectType::Buffer,
+                                                    &rx::memory::g_system_allocator)
+                           .value;
+        memory_resource = DeviceMemoryResource{memory, &strategy};
+    }
+
+    [[nodiscard]] rhi::RhiBuffer* make_buffer(const char* name) {
+        rhi::RhiBufferCreateInfo info;
+        info.name = name;
+        info.size = 1_kb;
+        info.buffer_usage = rhi::BufferUsage::VertexBuffer;
+        return device->create_buffer(info, *memory_resource, &rx::memory::g_system_allocator);
+    }
+
+    [[nodiscard]] rhi::CommandList* make_command_list(const rhi::QueueType queue) {
+        return device->create_command_list(0, queue, rhi::CommandList::Level::Primary, &frame_allocator);
+    }
+
+    /*!
+     * \brief Copies one buffer to another on the given queue, which leaves both buffers in a defined state
+     *
+     * Buffers in the undefined state have no contents to wait for, so they never need a barrier
+     */
+    void copy_buffer(rhi::RhiBuffer* destination, rhi::RhiBuffer* source, const rhi::QueueType queue) {
+        auto* cmds = make_command_list(queue);
+        cmds->transition_resource(source, rhi::ResourceState::CopySource, queue);
+        cmds->transition_resource(destination, rhi::ResourceState::CopyDestination, queue);
+        cmds->copy_buffer(destination, 0_b, source, 0_b, 1_kb);
+        device->submit_command_list(cmds, queue);
+    }
+
+    /*!
+     * \brief Submits a command list and returns the barriers at the start of its stream
+     *
+     * Returns an empty vector if the stream doesn't start with a barrier command
+     */
+    rx::vector<rhi::HeadlessBarrier> submit_and_read_barriers(rhi::CommandList* cmds,
+                                                              const rhi::QueueType queue,
+                                                              rhi::HeadlessResourceBarriersCommand* barriers_command = nullptr) {
+        device->submit_command_list(cmds, queue);
+
+        rx::vector<rhi::HeadlessBarrier> barriers;
+
+        const auto& stream = device->get_submitted_streams().last();
+        if(stream.size() < sizeof(rhi::HeadlessCommandHeader)) {
+            return barriers;
+        }
+
+        rhi::HeadlessCommandHeader header;
+        memcpy(&header, stream.data(), sizeof(header));
+        if(header.type != rhi::HeadlessCommandType::ResourceBarriers) {
+            return barriers;
+        }
+
+        rhi::HeadlessResourceBarriersCommand command;
+        memcpy(&command, stream.data() + sizeof(header), sizeof(command));
+        if(barriers_command != nullptr) {
+            *barriers_command = command;
+        }
+
+        const auto* barrier_data = stream.data() + sizeof(header) + sizeof(command);
+        for(uint32_t i = 0; i < command.num_barriers; i++) {
+            rhi::HeadlessBarrier barrier;
+            memcpy(&barrier, barrier_data + i * sizeof(barrier), sizeof(barrier));
+            barriers.push_back(barrier);
+        }
+
+        return barriers;
+    }
+};
+
+TEST(CommandListStateTracker, TransitionsBeforeACommandMergeIntoOneBarrier) {
+    StateTrackerTest test;
+    auto* source = test.make_buffer("Source");
+    auto* destination = test.make_buffer("Destination");
+    test.copy_buffer(destination, source, rhi::QueueType::Graphics);
+
+    auto* cmds = test.make_command_list(rhi::QueueType::Graphics);
+    cmds->transition_resource(source, rhi::ResourceState::CopyDestination);
+    cmds->transition_resource(source, rhi::ResourceState::VertexBuffer);
+    cmds->transition_resource(destination, rhi::ResourceState::CopySource);
+    cmds->flush_barriers();
+
+    rhi::HeadlessResourceBarriersCommand barriers_command;
+    const auto barriers = test.submit_and_read_barriers(cmds, rhi::QueueType::Graphics, &barriers_command);
+    ASSERT_EQ(barriers.size(), 2);
+
+    // The source buffer's two transitions become a single barrier from its first state to its last
+    EXPECT_EQ(barriers[0].old_state, rhi::ResourceState::CopySource);
+    EXPECT_EQ(barriers[0].new_state, rhi::ResourceState::VertexBuffer);
+    EXPECT_EQ(barriers[1].old_state, rhi::ResourceState::CopyDestination);
+    EXPECT_EQ(barriers[1].new_state, rhi::ResourceState::CopySource);
+
+    EXPECT_EQ(barriers_command.stages_before_barrier, rhi::PipelineStage::Transfer);
+    EXPECT_EQ(barriers_command.stages_after_barrier, rhi::PipelineStage::VertexInput | rhi::PipelineStage::Transfer);
+}
+
+TEST(CommandListStateTracker, TransitionsToTheCurrentStateHaveNoBarrier) {
+    StateTrackerTest test;
+    auto* source = test.make_buffer("Source");
+    auto* destination = test.make_buffer("Destination");
+    test.copy_buffer(destination, source, rhi::QueueType::Graphics);
+
+    auto* cmds = test.make_command_list(rhi::QueueType::Graphics);
+    cmds->transition_resource(source, rhi::ResourceState::CopySource);
+    cmds->transition_resource(destination, rhi::ResourceState::CopyDestination);
+
+    // Transitioning away and back before the next command cancels out
+    cmds->transition_resource(source, rhi::ResourceState::VertexBuffer);
+    cmds->transition_resource(source, rhi::ResourceState::CopySource);
+    cmds->copy_buffer(destination, 0_b, source, 0_b, 1_kb);
+
+    EXPECT_EQ(test.submit_and_read_barriers(cmds, rhi::QueueType::Graphics).size(), 0);
+}
+
+TEST(CommandListStateTracker, ChangingQueuesFinishesTheOldQueuesWork) {
+    StateTrackerTest test;
+    auto* source = test.make_buffer("Source");
+    auto* destination = test.make_buffer("Destination");
+    test.copy_buffer(destination, source, rhi::QueueType::Transfer);
+
+    auto* cmds = test.make_command_list(rhi::QueueType::Transfer);
+    cmds->transition_resource(destination, rhi::ResourceState::VertexBuffer, rhi::QueueType::Graphics);
+    cmds->flush_barriers();
+
+    rhi::HeadlessResourceBarriersCommand barriers_command;
+    const auto barriers = test.submit_and_read_barriers(cmds, rhi::QueueType::Transfer, &barriers_command);
+    ASSERT_EQ(barriers.size(), 1);
+
+    EXPECT_EQ(barriers[0].old_state, rhi::ResourceState::CopyDestination);
+    EXPECT_EQ(barriers[0].new_state, rhi::ResourceState::VertexBuffer);
+    EXPECT_EQ(barriers[0].source_queue, rhi::QueueType::Transfer);
+    EXPECT_EQ(barriers[0].destination_queue, rhi::QueueType::Graphics);
+    EXPECT_EQ(barriers[0].access_after_barrier, rhi::ResourceAccess::MemoryRead);
+
+    // The vertex input stage doesn't exist on the transfer queue, so the barrier waits for the bottom of the pipe
+    EXPECT_EQ(barriers_command.stages_after_barrier, rhi::PipelineStage::BottomOfPipe);
+
+    EXPECT_EQ(destination->state, rhi::ResourceState::VertexBuffer);
+    EXPECT_EQ(destination->queue, rhi::QueueType::Graphics);
+}
@@ -0,0 +1,156 @@
+/*!
+ * \file nova_replay.cpp
+ *
+ * \brief Replays a capture file from Nova's capture mode, and reports how long it took to record and submit every frame
+ *
+ * Usage: nova-replay <capture file> [vulkan|headless]
+ */
+
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+
+#include <rx/core/algorithm/max.h>
+#include <rx/core/algorithm/min.h>
+#include <rx/core/filesystem/file.h>
+#include <rx/core/log.h>
+
+#include "nova_renderer/nova_renderer.hpp"
+#include "nova_renderer/tracing.hpp"
+#include "nova_renderer/window.hpp"
+
+#include "rhi/capture/capture_format.hpp"
+#include "rhi/capture/capture_replayer.hpp"
+#include "rhi/headless/headless_render_device.hpp"
+#include "rhi/vulkan/vulkan_render_device.hpp"
+
+namespace nova::renderer {
+    RX_LOG("NovaReplay", logger);
+
+    static void print_frame_statistics(const rx::vector<rhi::ReplayFrameStatistics>& frame_statistics) {
+        printf("%8s %12s %10s %12s %12s %12s\n", "Frame", "Submissions", "Commands", "Record (ms)", "Submit (ms)", "Other (ms)");
+
+        for(rx_size i = 0; i < frame_statistics.size(); i++) {
+            const auto& frame = frame_statistics[i];
+            printf("%8zu %12u %10u %12.3f %12.3f %12.3f\n",
+                   i,
+                   frame.num_submissions,
+                   frame.num_commands,
+                   frame.record_ms,
+                   frame.submit_ms,
+                   frame.other_ms);
+        }
+
+        // The first frame has everything Nova did before it started rendering, such as loading the renderpack, so it's not counted in the
+        // summary unless it's all we have
+        const rx_size first_frame = frame_statistics.size() > 1 ? 1 : 0;
+        const rx_size num_frames = frame_statistics.size() - first_frame;
+        if(num_frames == 0) {
+            return;
+        }
+
+        double total_ms = 0;
+        double min_ms = frame_statistics[first_frame].record_ms + frame_statistics[first_frame].submit_ms;
+        double max_ms = min_ms;
+
+        for(rx_size i = first_frame; i < frame_statistics.size(); i++) {
+            const auto submission_ms = frame_statistics[i].record_ms + frame_statistics[i].submit_ms;
+
+            total_ms += submission_ms;
+            min_ms = rx::algorithm::min(min_ms, submission_ms);
+            max_ms = rx::algorithm::max(max_ms, submission_ms);
+        }
+
+        printf("\nRecord + submit cost over %zu frames: avg %.3f ms, min %.3f ms, max %.3f ms\n",
+               num_frames,
+               total_ms / static_cast<double>(num_frames),
+               min_ms,
+               max_ms);
+    }
+
+    int main(const int argc, char** argv) {
+        if(argc < 2) {
+            printf("Usage: nova-replay <capture file> [vulkan|headless]\n");
+            return 1;
+        }
+
+        GraphicsApi api = GraphicsApi::Vulkan;
+        if(argc > 2) {
+            if(strcmp(argv[2], "headless") == 0) {
+                api = GraphicsApi::Headless;
+
+            } else if(strcmp(argv[2], "vulkan") != 0) {
+                logger(rx::log::level::k_error, "Unknown graphics API %s", argv[2]);
+                return 1;
+            }
+        }
+
+        auto* allocator = &rx::memory::g_system_allocator;
+
+        const auto capture = rx::filesystem::read_binary_file(allocator, argv[1]);
+        if(!capture) {
+            logger(rx::log::level::k_error, "Could not read capture file %s", argv[1]);
+            return 1;
+        }
+
+        if(capture->size() < sizeof(rhi::CaptureFileHeader)) {
+            logger(rx::log::level::k_error, "%s is not a Nova capture file", argv[1]);
+            return 1;
+        }
+
+        // Make the window the same size as the captured swapchain, so that the replay renders the same number of pixels as the capture
+        rhi::CaptureFileHeader header;
+        memcpy(&header, capture->data(), sizeof(header));
+
+        NovaSettings settings;
+        settings.window.title = "Nova Replay";
+        settings.window.width = header.swapchain_width;
+        settings.window.height = header.swapchain_height;
+        settings.api = api;
+
+        settings.trace.enabled = true;
+        settings.trace.shutdown_trace_path = "replay_trace.json";
+
+        tracing::set_enabled(settings.trace.enabled);
+        tracing::set_thread_name("Main");
+
+        NovaSettingsAccessManager settings_manager{settings};
+        NovaWindow window{settings};
+
+        std::unique_ptr<rhi::RenderDevice> device;
+        switch(api) {
+            case GraphicsApi::Vulkan:
+                device = std::make_unique<rhi::VulkanRenderDevice>(settings_manager, window, allocator);
+                break;
+
+            case GraphicsApi::Headless:
+                device = std::make_unique<rhi::HeadlessRenderDevice>(settings_manager, window, allocator);
+                break;
+        }
+
+        bool replayed;
+        {
+            rhi::CaptureReplayer replayer{*device, allocator};
+            replayed = replayer.replay(*capture);
+
+            print_frame_statistics(replayer.get_frame_statistics());
+        }
+
+        device.reset();
+
+        tracing::write_trace(settings.trace.shutdown_trace_path);
+
+        return replayed ? 0 : 1;
+    }
+
+    // This is for scoping purposes so that things used in main
+    // don't get destructed after rex_fini has been called
+    int rex_main(const int argc, char** argv) {
+        init_rex();
+        auto ret = main(argc, argv);
+        rex_fini();
+        return ret;
+    }
+} // namespace nova::renderer
+
+int main(const int argc, char** argv) { return nova::renderer::rex_main(argc, argv); }